@@ -29,6 +29,7 @@
 #include <vector>
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
 template<int N>
 inline std::array<int, N> calc_strides(const std::array<int, N>& dims)
@@ -115,22 +116,38 @@ class Array
         Array(std::vector<T>&& data, const std::array<int, N>& dims) :
             dims(dims),
             ncells(product<N>(dims)),
-            data(data),
+            data(std::move(data)),
             strides(calc_strides<N>(dims)),
             offsets({})
         {} // CvH Do we need to size check data?
 
-        // Define the default copy constructor and assignment operator.
-        // Array(const Array<T, N>&) = default;
-        // Array<T,N>& operator=(const Array<T, N>&) = default; // CvH does this one need empty checking?
+        // Create a view on external memory without copying, the caller keeps the memory alive.
+        // A copy of a view owns a copy of the data, moving a view keeps it a view.
+        Array(T* data, const std::array<int, N>& dims) :
+            dims(dims),
+            ncells(product<N>(dims)),
+            strides(calc_strides<N>(dims)),
+            offsets({}),
+            view_ptr(data)
+        {}
 
-        // Array(Array<T, N>&& array) :
-        //     dims(std::exchange(array.dims, {})),
-        //     ncells(std::exchange(array.ncells, 0)),
-        //     data(std::move(array.data)),
-        //     strides(std::exchange(array.strides, {})),
-        //     offsets(std::exchange(array.offsets, {}))
-        // {}
+        Array(const Array<T, N>& array) :
+            dims(array.dims),
+            ncells(array.ncells),
+            data(array.view_ptr ? std::vector<T>(array.view_ptr, array.view_ptr + array.ncells) : array.data),
+            strides(array.strides),
+            offsets(array.offsets)
+        {}
+
+        Array<T, N>& operator=(const Array<T, N>& array)
+        {
+            if (this != &array)
+                *this = Array<T, N>(array);
+            return *this;
+        }
+
+        Array(Array<T, N>&&) = default;
+        Array<T, N>& operator=(Array<T, N>&&) = default;
 
         inline void set_offsets(const std::array<int, N>& offsets)
         {
@@ -149,15 +166,43 @@ class Array
             data.resize(ncells);
             strides = calc_strides<N>(dims);
             offsets = {};
+            view_ptr = nullptr;
         }
 
-        inline std::vector<T>& v() { return data; }
-        inline const std::vector<T>& v() const { return data; }
+        // Turn the array into a view on external memory, for bindings that cannot move a view.
+        inline void set_view(T* data, const std::array<int, N>& dims)
+        {
+            *this = Array<T, N>(data, dims);
+        }
+
+        // Return a view on the memory of this array, which has to outlive the view.
+        inline Array<T, N> view()
+        {
+            Array<T, N> array(ptr(), dims);
+            array.offsets = offsets;
+            return array;
+        }
+
+        // Only an array made as a view has no vector, use ptr() for code that can act on views.
+        inline std::vector<T>& v()
+        {
+            if (view_ptr)
+                throw std::runtime_error("Array view has no vector storage");
+            return data;
+        }
+
+        inline const std::vector<T>& v() const
+        {
+            if (view_ptr)
+                throw std::runtime_error("Array view has no vector storage");
+            return data;
+        }
 
-        inline T* ptr() { return data.data(); }
-        inline const T* ptr() const { return data.data(); }
+        inline T* ptr() { return view_ptr ? view_ptr : data.data(); }
+        inline const T* ptr() const { return view_ptr ? view_ptr : data.data(); }
 
         inline int size() const { return ncells; }
+        inline bool is_view() const { return view_ptr != nullptr; }
 
         // inline std::array<int, N> find_indices(const T& value) const
         // {
@@ -167,30 +212,31 @@ class Array
 
         inline T max() const
         {
-            return *std::max_element(data.begin(), data.end());
+            return *std::max_element(ptr(), ptr() + ncells);
         }
 
         inline T min() const
         {
-            return *std::min_element(data.begin(), data.end());
+            return *std::min_element(ptr(), ptr() + ncells);
         }
 
         inline void operator=(std::vector<T>&& data)
         {
             // CvH check size.
-            this->data = data;
+            this->data = std::move(data);
+            view_ptr = nullptr;
         }
 
         inline T& operator()(const std::array<int, N>& indices)
         {
             const int index = calc_index<N>(indices, strides, offsets);
-            return data[index];
+            return ptr()[index];
         }
 
         inline T operator()(const std::array<int, N>& indices) const
         {
             const int index = calc_index<N>(indices, strides, offsets);
-            return data[index];
+            return ptr()[index];
         }
 
         inline int dim(const int i) const { return dims[i-1]; }
@@ -230,7 +276,7 @@ class Array
 
         inline void fill(const T value)
         {
-            std::fill(data.begin(), data.end(), value);
+            std::fill(ptr(), ptr() + ncells, value);
         }
 
     private:
@@ -239,14 +285,15 @@ class Array
         std::vector<T> data;
         std::array<int, N> strides;
         std::array<int, N> offsets;
+        T* view_ptr = nullptr;
 };
 
 template<typename T, int N>
 bool any_vals_outside(const Array<T, N>& array, const T lower_limit, const T upper_limit)
 {
     return std::any_of(
-            array.v().begin(),
-            array.v().end(),
+            array.ptr(),
+            array.ptr() + array.size(),
             [lower_limit, upper_limit](T val){ return (val < lower_limit) || (val > upper_limit); });
 }
 
@@ -254,8 +301,8 @@ template<typename T, int N>
 bool any_vals_less_than(const Array<T, N>& array, const T lower_limit)
 {
     return std::any_of(
-            array.v().begin(),
-            array.v().end(),
+            array.ptr(),
+            array.ptr() + array.size(),
             [lower_limit](T val){ return (val < lower_limit); });
 }
 #endif
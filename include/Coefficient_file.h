@@ -0,0 +1,91 @@
+/*
+ * This file is part of a C++ interface to the Radiative Transfer for Energetics (RTE)
+ * and Rapid Radiative Transfer Model for GCM applications Parallel (RRTMGP).
+ *
+ * The original code is found at https://github.com/earth-system-radiation/rte-rrtmgp.
+ *
+ * Contacts: Robert Pincus and Eli Mlawer
+ * email: rrtmgp@aer.com
+ *
+ * Copyright 2015-2020,  Atmospheric and Environmental Research and
+ * Regents of the University of Colorado.  All right reserved.
+ *
+ * This C++ interface can be downloaded from https://github.com/earth-system-radiation/rte-rrtmgp-cpp
+ *
+ * Contact: Chiel van Heerwaarden
+ * email: chiel.vanheerwaarden@wur.nl
+ *
+ * Copyright 2020, Wageningen University & Research.
+ *
+ * Use and duplication is permitted under the terms of the
+ * BSD 3-clause license, see http://opensource.org/licenses/BSD-3-Clause
+ *
+ */
+
+#ifndef COEFFICIENT_FILE_H
+#define COEFFICIENT_FILE_H
+
+#include <array>
+#include <memory>
+#include <string>
+
+#include "Array.h"
+#include "Gas_concs.h"
+#include "Gas_optics_rrtmgp.h"
+#include "Cloud_optics.h"
+
+// Reader of the NetCDF coefficient files of the gas and cloud optics, from disk or from memory.
+class Coefficient_file
+{
+    public:
+        explicit Coefficient_file(const std::string& file_name);
+        Coefficient_file(const void* buffer, const size_t size);
+        ~Coefficient_file();
+
+        Coefficient_file(const Coefficient_file&) = delete;
+        Coefficient_file& operator=(const Coefficient_file&) = delete;
+
+        int get_dimension_size(const std::string& name) const;
+        bool variable_exists(const std::string& name) const;
+
+        // Read the full variable, the dims are in the order of Array, thus reversed w.r.t. NetCDF.
+        template<typename T, int N>
+        Array<T,N> get_array(const std::string& name, const std::array<int,N>& dims) const
+        {
+            Array<T,N> array(dims);
+            read_variable(name, array.ptr(), array.size());
+            return array;
+        }
+
+        template<typename T>
+        T get_scalar(const std::string& name) const
+        {
+            return get_array<T,1>(name, {1})({1});
+        }
+
+        // Read an array of n fixed length strings with the blanks trimmed.
+        Array<std::string,1> get_strings(const std::string& name, const int n) const;
+
+        // True if the file holds the Planck source of a longwave k-distribution.
+        bool is_longwave() const { return variable_exists("totplnk"); }
+
+    private:
+        int get_var_id(const std::string& name) const;
+        size_t get_var_size(const int var_id) const;
+
+        void read_variable(const std::string& name, double* values, const size_t size) const;
+        void read_variable(const std::string& name, float* values, const size_t size) const;
+        void read_variable(const std::string& name, int* values, const size_t size) const;
+        void read_variable(const std::string& name, signed char* values, const size_t size) const;
+
+        int ncid;
+};
+
+// Construct the k-distribution of a longwave or shortwave coefficient file for the gases in gas_concs.
+template<typename TF>
+std::unique_ptr<Gas_optics_rrtmgp<TF>> load_gas_optics(
+        const Coefficient_file& coef, const Gas_concs<TF>& gas_concs);
+
+template<typename TF>
+std::unique_ptr<Cloud_optics<TF>> load_cloud_optics(const Coefficient_file& coef);
+#endif
@@ -72,10 +72,14 @@ class Fluxes_broadband : public Fluxes<TF>
                 const std::unique_ptr<Optical_props_arry<TF>>& optical_props,
                 const BOOL_TYPE top_at_1);
 
+        // Sum the Jacobian of the upward flux to the surface temperature over the g-points.
+        void reduce_jacobian(const Array<TF,3>& gpt_flux_up_jac);
+
         Array<TF,2>& get_flux_up    () { return flux_up;     }
         Array<TF,2>& get_flux_dn    () { return flux_dn;     }
         Array<TF,2>& get_flux_dn_dir() { return flux_dn_dir; }
         Array<TF,2>& get_flux_net   () { return flux_net;    }
+        Array<TF,2>& get_flux_up_jac() { return flux_up_jac; }
 
         virtual Array<TF,3>& get_bnd_flux_up    () { throw std::runtime_error("Band fluxes are not available"); }
         virtual Array<TF,3>& get_bnd_flux_dn    () { throw std::runtime_error("Band fluxes are not available"); }
@@ -87,6 +91,7 @@ class Fluxes_broadband : public Fluxes<TF>
         Array<TF,2> flux_dn;
         Array<TF,2> flux_dn_dir;
         Array<TF,2> flux_net;
+        Array<TF,2> flux_up_jac;
 };
 
 template<typename TF>
@@ -27,7 +27,9 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
+#include "Validation_policy.h"
 #include "define_bool.h"
 
 template<typename, int> class Array;
@@ -37,21 +39,68 @@ class Gas_concs
 {
     public:
         Gas_concs() {}
+
+        // Create a view on columns start to start+size-1 of gas_concs_ref, the data is not copied.
+        // The columns have to be within those of gas_concs_ref, or of its fields of gases if it is
+        // not a view. The view keeps a pointer to the root that owns the data (gas_concs_ref, or
+        // its parent if it is a view), so the root must not be destroyed or moved while the view
+        // is in use. Gases that are set in the root afterwards are seen by the view.
         Gas_concs(const Gas_concs& gas_concs_ref, const int start, const int size);
 
+        // Copy the gases with the columns in the order given by col_order.
+        Gas_concs(const Gas_concs& gas_concs_ref, const Array<int,1>& col_order);
+
         // Insert new gas into the map.
         void set_vmr(const std::string& name, const TF data);
         void set_vmr(const std::string& name, const Array<TF,1>& data);
         void set_vmr(const std::string& name, const Array<TF,2>& data);
 
-        // Insert new gas into the map.
-        // void get_vmr(const std::string& name, Array<TF,2>& data) const;
-        const Array<TF,2>& get_vmr(const std::string& name) const;
+        // Store a view on the vmr of data without copying, the memory has to outlive this object.
+        void set_vmr_view(const std::string& name, const Array<TF,2>& data);
+
+        // Get the integer id of a gas, this is -1 if the gas does not exist.
+        int get_gas_id(const std::string& name) const;
+
+        // Get a copy of the vmr with the columns of this object, scalars and profiles keep their
+        // single column. Use get_root_vmr to read the stored vmr without copying.
+        Array<TF,2> get_vmr(const std::string& name) const;
+        Array<TF,2> get_vmr(const int gas_id) const;
+
+        // Get the stored vmr of the root. For a view, this is the array of the parent and the
+        // columns of the view start after get_col_offset() in dimension 1.
+        const Array<TF,2>& get_root_vmr(const std::string& name) const;
+        const Array<TF,2>& get_root_vmr(const int gas_id) const;
+        int get_col_offset() const { return col_offset; }
+
+        // Number of columns of a view, zero if the object owns its data.
+        int get_ncol() const { return ncol; }
+
+        // Copy the vmr of the columns of this object to an allocated (ncol, nlay) array.
+        void get_vmr(const std::string& name, Array<TF,2>& data) const;
 
         // Check if gas exists in map.
         BOOL_TYPE exists(const std::string& name) const;
 
+        std::vector<std::string> get_gas_names() const;
+
+        BOOL_TYPE is_view() const { return parent != nullptr; }
+
+        // The range check in set_vmr is skipped if the policy is Off.
+        void set_validation_policy(const Validation_policy policy) { validation_policy = policy; }
+        Validation_policy get_validation_policy() const { return validation_policy; }
+
     private:
-        std::map<std::string, Array<TF,2>> gas_concs_map;
+        const Gas_concs<TF>& get_root() const { return is_view() ? *parent : *this; }
+        void insert_vmr(const std::string& name, Array<TF,2>&& data);
+
+        std::map<std::string, int> gas_ids;
+        std::vector<Array<TF,2>> gas_vmrs;
+
+        Validation_policy validation_policy = Validation_policy::Full;
+
+        // Settings for views.
+        const Gas_concs<TF>* parent = nullptr;
+        int col_offset = 0;
+        int ncol = 0;
 };
 #endif
@@ -29,6 +29,7 @@
 
 #include "Array.h"
 #include "Gas_optics.h"
+#include "Validation_policy.h"
 #include "define_bool.h"
 
 // Forward declarations.
@@ -38,6 +39,21 @@ template<typename TF> class Optical_props_arry;
 template<typename TF> class Gas_concs;
 template<typename TF> class Source_func_lw;
 
+// Part of the gas optics that depends only on p, T and the gas concentrations, and not
+// on the flavors of a k-distribution. It can be computed once per block and shared by
+// the longwave and shortwave k-distributions, if they share the reference grid and gases.
+template<typename TF>
+struct Gas_optics_state
+{
+    Array<TF,2> col_dry;
+    Array<TF,3> col_gas;
+    Array<int,2> jtemp;
+    Array<int,2> jpress;
+    Array<BOOL_TYPE,2> tropo;
+    Array<TF,2> ftemp;
+    Array<TF,2> fpress;
+};
+
 template<typename TF>
 class Gas_optics_rrtmgp : public Gas_optics<TF>
 {
@@ -130,6 +146,9 @@ class Gas_optics_rrtmgp : public Gas_optics<TF>
         TF get_temp_min() const { return temp_ref_min; }
         TF get_temp_max() const { return temp_ref_max; }
 
+        void set_validation_policy(const Validation_policy policy) { validation_policy = policy; }
+        Validation_policy get_validation_policy() const { return validation_policy; }
+
         int get_nflav() const { return flavor.dim(2); }
         int get_neta() const { return kmajor.dim(2); }
         int get_npres() const { return kmajor.dim(3)-1; }
@@ -160,7 +179,65 @@ class Gas_optics_rrtmgp : public Gas_optics<TF>
                 Array<TF,2>& toa_src,
                 const Array<TF,2>& col_dry) const;
 
+        // Compute the state that is shared between k-distributions, col_dry is computed
+        // from the water vapor if it is empty.
+        void compute_state(
+                const Array<TF,2>& play,
+                const Array<TF,2>& plev,
+                const Array<TF,2>& tlay,
+                const Gas_concs<TF>& gas_desc,
+                const Array<TF,2>& col_dry,
+                Gas_optics_state<TF>& state) const;
+
+        // True if the state of other can be used by this k-distribution.
+        bool can_share_state(const Gas_optics_rrtmgp<TF>& other) const;
+
+        // Longwave variant on a precomputed state.
+        void gas_optics(
+                const Array<TF,2>& play,
+                const Array<TF,2>& plev,
+                const Array<TF,2>& tlay,
+                const Array<TF,1>& tsfc,
+                const Gas_optics_state<TF>& state,
+                std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+                Source_func_lw<TF>& sources,
+                const Array<TF,2>& tlev) const;
+
+        // Shortwave variant on a precomputed state.
+        void gas_optics(
+                const Array<TF,2>& play,
+                const Array<TF,2>& plev,
+                const Array<TF,2>& tlay,
+                const Gas_optics_state<TF>& state,
+                std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+                Array<TF,2>& toa_src) const;
+
+        // Longwave variant on a precomputed state for a subset of g-points per column. The g-points
+        // gpts have dimensions (n_sample, ncol), the outputs have one g-point per sample.
+        void gas_optics(
+                const Array<TF,2>& play,
+                const Array<TF,2>& plev,
+                const Array<TF,2>& tlay,
+                const Array<TF,1>& tsfc,
+                const Gas_optics_state<TF>& state,
+                const Array<int,2>& gpts,
+                std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+                Source_func_lw<TF>& sources,
+                const Array<TF,2>& tlev) const;
+
+        // Shortwave variant on a precomputed state for a subset of g-points per column.
+        void gas_optics(
+                const Array<TF,2>& play,
+                const Array<TF,2>& plev,
+                const Array<TF,2>& tlay,
+                const Gas_optics_state<TF>& state,
+                const Array<int,2>& gpts,
+                std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+                Array<TF,2>& toa_src) const;
+
     private:
+        Validation_policy validation_policy = Validation_policy::Full;
+
         Array<TF,2> totplnk;
         Array<TF,4> planck_frac;
         TF totplnk_delta;
@@ -214,6 +291,16 @@ class Gas_optics_rrtmgp : public Gas_optics<TF>
 
         int get_ngas() const { return this->gas_names.dim(1); }
 
+        // Check the input of gas_optics according to the validation policy,
+        // tlev and tsfc are skipped if they are empty.
+        void check_inputs(
+                const Array<TF,2>& play,
+                const Array<TF,2>& plev,
+                const Array<TF,2>& tlay,
+                const Array<TF,2>& tlev,
+                const Array<TF,1>& tsfc,
+                const Array<TF,2>& col_dry) const;
+
         void init_abs_coeffs(
                 const Gas_concs<TF>& available_gases,
                 const Array<std::string,1>& gas_names,
@@ -262,6 +349,57 @@ class Gas_optics_rrtmgp : public Gas_optics<TF>
                 Array<TF,6>& fmajor,
                 const Array<TF,2>& col_dry) const;
 
+        void compute_col_gas(
+                const int ncol, const int nlay,
+                const Gas_concs<TF>& gas_desc,
+                const Array<TF,2>& col_dry,
+                Array<TF,3>& col_gas) const;
+
+        // Flavor-dependent part of the interpolation on a precomputed state.
+        void interpolation_eta(
+                const int ncol, const int nlay,
+                const Gas_optics_state<TF>& state,
+                Array<int,4>& jeta,
+                Array<TF,6>& fmajor,
+                Array<TF,5>& fminor,
+                Array<TF,4>& col_mix) const;
+
+        void compute_taus(
+                const int ncol, const int nlay, const int ngpt, const int nband,
+                const Array<TF,2>& play,
+                const Array<TF,2>& tlay,
+                const Array<TF,2>& col_dry,
+                const Array<TF,3>& col_gas,
+                const Array<int,2>& jtemp, const Array<int,2>& jpress,
+                const Array<int,4>& jeta,
+                const Array<BOOL_TYPE,2>& tropo,
+                const Array<TF,6>& fmajor,
+                const Array<TF,5>& fminor,
+                const Array<TF,4>& col_mix,
+                std::unique_ptr<Optical_props_arry<TF>>& optical_props) const;
+
+        // Same as compute_taus, but only for the g-points gpts of each column.
+        void compute_taus_sampled(
+                const int ncol, const int nlay,
+                const Array<int,2>& gpts,
+                const Array<TF,2>& play,
+                const Array<TF,2>& tlay,
+                const Gas_optics_state<TF>& state,
+                const Array<int,4>& jeta,
+                const Array<TF,6>& fmajor,
+                const Array<TF,5>& fminor,
+                const Array<TF,4>& col_mix,
+                std::unique_ptr<Optical_props_arry<TF>>& optical_props) const;
+
+        void check_state(
+                const Array<TF,2>& play,
+                const Gas_optics_state<TF>& state) const;
+
+        void check_gpts(
+                const Array<TF,2>& play,
+                const Array<int,2>& gpts,
+                const Optical_props_arry<TF>& optical_props) const;
+
         void combine_and_reorder(
                 const Array<TF,3>& tau,
                 const Array<TF,3>& tau_rayleigh,
@@ -277,5 +415,19 @@ class Gas_optics_rrtmgp : public Gas_optics<TF>
                 const Array<TF,6>& fmajor,
                 Source_func_lw<TF>& sources,
                 const Array<TF,2>& tlev) const;
+
+        // Same as source, but only for the g-points gpts of each column.
+        void source_sampled(
+                const int ncol, const int nlay,
+                const Array<int,2>& gpts,
+                const Array<TF,2>& play,
+                const Array<TF,2>& tlay, const Array<TF,1>& tsfc,
+                const Gas_optics_state<TF>& state,
+                const Array<int,4>& jeta,
+                const Array<TF,6>& fmajor,
+                Source_func_lw<TF>& sources,
+                const Array<TF,2>& tlev) const;
+
+        int get_idx_h2o() const;
 };
 #endif
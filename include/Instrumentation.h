@@ -0,0 +1,153 @@
+/*
+ * This file is part of a C++ interface to the Radiative Transfer for Energetics (RTE)
+ * and Rapid Radiative Transfer Model for GCM applications Parallel (RRTMGP).
+ *
+ * The original code is found at https://github.com/earth-system-radiation/rte-rrtmgp.
+ *
+ * Contacts: Robert Pincus and Eli Mlawer
+ * email: rrtmgp@aer.com
+ *
+ * Copyright 2015-2020,  Atmospheric and Environmental Research and
+ * Regents of the University of Colorado.  All right reserved.
+ *
+ * This C++ interface can be downloaded from https://github.com/earth-system-radiation/rte-rrtmgp-cpp
+ *
+ * Contact: Chiel van Heerwaarden
+ * email: chiel.vanheerwaarden@wur.nl
+ *
+ * Copyright 2020, Wageningen University & Research.
+ *
+ * Use and duplication is permitted under the terms of the
+ * BSD 3-clause license, see http://opensource.org/licenses/BSD-3-Clause
+ *
+ */
+
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+// Forward declarations.
+template<typename, int> class Array;
+
+// Wall time, call counts and bytes touched of the stages of the radiation solver, kept per thread.
+// The instrumentation is switched on at runtime with set_enabled() and can be removed completely
+// at compile time by defining RTE_RRTMGP_NO_INSTRUMENTATION. The counters of a thread are folded
+// into a shared total when the thread exits.
+namespace Instrumentation
+{
+    enum class Stage
+    {
+        Input_subset,
+        Col_dry,
+        Vmr_expansion,
+        Interpolation,
+        Tau_absorption,
+        Rayleigh,
+        Reorder,
+        Planck_source,
+        Cloud_optics,
+        Delta_scale,
+        Add_to,
+        Rte_solver,
+        Flux_reduction,
+        Output_scatter,
+        n_stages
+    };
+
+    std::string get_stage_name(const Stage stage);
+
+    // Clear the counters of all threads.
+    void reset();
+
+    // Get the totals per stage and the breakdown per thread as JSON, the threads that exited
+    // are reported as thread -1. This function should not be called while other threads are recording.
+    std::string get_json();
+
+#ifdef RTE_RRTMGP_NO_INSTRUMENTATION
+    inline void set_enabled(const bool) {}
+    constexpr bool is_enabled() { return false; }
+    inline void record(const Stage, const double, const std::size_t) {}
+#else
+    // The switch is a plain bool, so a disabled timer costs a single load and branch.
+    // It should therefore not be changed while other threads are recording.
+    extern bool enabled;
+
+    void set_enabled(const bool switch_enabled);
+    inline bool is_enabled() { return enabled; }
+
+    // Add a call with its time in seconds and bytes touched to the counters of the calling thread.
+    void record(const Stage stage, const double time, const std::size_t bytes);
+#endif
+
+    // Get the total size in bytes of a number of arrays.
+    template<typename T, int N>
+    std::size_t get_bytes(const Array<T,N>& array) { return array.size()*sizeof(T); }
+
+    template<typename T, int N, typename... Arrays>
+    std::size_t get_bytes(const Array<T,N>& array, const Arrays&... arrays)
+    {
+        return get_bytes(array) + get_bytes(arrays...);
+    }
+
+    // Measure the time until the end of the scope and record it for the stage. The bytes
+    // are given as a function that is only called if the instrumentation is enabled.
+#ifdef RTE_RRTMGP_NO_INSTRUMENTATION
+    class Scoped_timer
+    {
+        public:
+            explicit Scoped_timer(const Stage) {}
+
+            template<class Bytes_function>
+            Scoped_timer(const Stage, Bytes_function&&) {}
+
+            void add_bytes(const std::size_t) {}
+    };
+#else
+    class Scoped_timer
+    {
+        public:
+            explicit Scoped_timer(const Stage stage) :
+                stage(stage), bytes(0), active(is_enabled())
+            {
+                if (active)
+                    start = std::chrono::steady_clock::now();
+            }
+
+            template<class Bytes_function>
+            Scoped_timer(const Stage stage, Bytes_function&& bytes_function) :
+                stage(stage), bytes(0), active(is_enabled())
+            {
+                if (active)
+                {
+                    bytes = bytes_function();
+                    start = std::chrono::steady_clock::now();
+                }
+            }
+
+            ~Scoped_timer()
+            {
+                if (active)
+                {
+                    const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+                    record(stage, time.count(), bytes);
+                }
+            }
+
+            Scoped_timer(const Scoped_timer&) = delete;
+            Scoped_timer& operator=(const Scoped_timer&) = delete;
+
+            void add_bytes(const std::size_t bytes_extra) { bytes += bytes_extra; }
+
+        private:
+            const Stage stage;
+            std::size_t bytes;
+            const bool active;
+            std::chrono::steady_clock::time_point start;
+    };
+#endif
+}
+#endif
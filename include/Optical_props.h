@@ -44,11 +44,17 @@ class Optical_props
 
         Optical_props(const Optical_props&) = default;
 
-        Array<int,1> get_gpoint_bands() const { return this->gpt2band; }
+        const Array<int,1>& get_gpoint_bands() const { return this->gpt2band; }
         int get_nband() const { return this->band2gpt.dim(2); }
         int get_ngpt() const { return this->band2gpt.max(); }
-        Array<int,2> get_band_lims_gpoint() const { return this->band2gpt; }
-        Array<TF,2> get_band_lims_wavenumber() const { return this->band_lims_wvn; }
+        const Array<int,2>& get_band_lims_gpoint() const { return this->band2gpt; }
+        const Array<TF,2>& get_band_lims_wavenumber() const { return this->band_lims_wvn; }
+
+        // Check whether the band limits of two spectral discretizations match.
+        BOOL_TYPE bands_are_equal(const Optical_props<TF>& rhs) const;
+
+        // Properties that are defined per band have a single g-point in each band.
+        BOOL_TYPE is_band_resolved() const { return this->get_ngpt() == this->get_nband(); }
 
     private:
         Array<int,2> band2gpt;     // (begin g-point, end g-point) = band2gpt(2,band)
@@ -161,6 +167,8 @@ class Optical_props_2str : public Optical_props_arry<TF>
         Array<TF,3> g;
 };
 
+// Add op_in to op_inout, op_in can be defined per g-point or per band (e.g. cloud optics).
 template<typename TF> void add_to(Optical_props_1scl<TF>& op_inout, const Optical_props_1scl<TF>& op_in);
 template<typename TF> void add_to(Optical_props_2str<TF>& op_inout, const Optical_props_2str<TF>& op_in);
+template<typename TF> void add_to(Optical_props_arry<TF>& op_inout, const Optical_props_arry<TF>& op_in);
 #endif
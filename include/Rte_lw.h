@@ -48,9 +48,36 @@ class Rte_lw
                 Array<TF,3>& gpt_flux_dn,
                 const int n_gauss_angles);
 
+        // Also return the Jacobian of the upward flux to the surface temperature,
+        // this requires sources that are constructed with the Jacobian switched on.
+        static void rte_lw(
+                const std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+                const BOOL_TYPE top_at_1,
+                const Source_func_lw<TF>& sources,
+                const Array<TF,2>& sfc_emis,
+                const Array<TF,2>& inc_flux,
+                Array<TF,3>& gpt_flux_up,
+                Array<TF,3>& gpt_flux_dn,
+                Array<TF,3>& gpt_flux_up_jac,
+                const int n_gauss_angles);
+
         static void expand_and_transpose(
                 const std::unique_ptr<Optical_props_arry<TF>>& ops,
                 const Array<TF,2> arr_in,
                 Array<TF,2>& arr_out);
+
+    private:
+        // The Jacobian pointers are both null if no Jacobian is requested.
+        static void solve(
+                const std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+                const BOOL_TYPE top_at_1,
+                const Source_func_lw<TF>& sources,
+                const Array<TF,2>& sfc_emis,
+                const Array<TF,2>& inc_flux,
+                Array<TF,3>& gpt_flux_up,
+                Array<TF,3>& gpt_flux_dn,
+                const Array<TF,2>* sfc_source_jac,
+                Array<TF,3>* gpt_flux_up_jac,
+                const int n_gauss_angles);
 };
 #endif
@@ -36,7 +36,8 @@ class Source_func_lw : public Optical_props<TF>
         Source_func_lw(
                 const int n_col,
                 const int n_lay,
-                const Optical_props<TF>& optical_props);
+                const Optical_props<TF>& optical_props,
+                const bool switch_jacobian=false);
 
         void set_subset(
                 const Source_func_lw<TF>& sources_sub,
@@ -46,6 +47,9 @@ class Source_func_lw : public Optical_props<TF>
                 const Source_func_lw<TF>& sources_sub,
                 const int col_s, const int col_e);
 
+        // The surface source Jacobian is only allocated on request.
+        bool has_sfc_source_jac() const { return sfc_source_jac.size() > 0; }
+
         Array<TF,2>& get_sfc_source()     { return sfc_source;     }
         Array<TF,2>& get_sfc_source_jac() { return sfc_source_jac; }
         Array<TF,3>& get_lay_source()     { return lay_source;     }
@@ -0,0 +1,184 @@
+/*
+ * This file is part of a C++ interface to the Radiative Transfer for Energetics (RTE)
+ * and Rapid Radiative Transfer Model for GCM applications Parallel (RRTMGP).
+ *
+ * The original code is found at https://github.com/earth-system-radiation/rte-rrtmgp.
+ *
+ * Contacts: Robert Pincus and Eli Mlawer
+ * email: rrtmgp@aer.com
+ *
+ * Copyright 2015-2020,  Atmospheric and Environmental Research and
+ * Regents of the University of Colorado.  All right reserved.
+ *
+ * This C++ interface can be downloaded from https://github.com/earth-system-radiation/rte-rrtmgp-cpp
+ *
+ * Contact: Chiel van Heerwaarden
+ * email: chiel.vanheerwaarden@wur.nl
+ *
+ * Copyright 2020, Wageningen University & Research.
+ *
+ * Use and duplication is permitted under the terms of the
+ * BSD 3-clause license, see http://opensource.org/licenses/BSD-3-Clause
+ *
+ */
+
+#ifndef RTE_RRTMGP_C_H
+#define RTE_RRTMGP_C_H
+
+/*
+ * C interface to the longwave and shortwave solvers for embedding in C and Fortran host models.
+ *
+ * A solver is an opaque handle with the gas and cloud optics of one coefficient file, that solves
+ * the columns in blocks of n_col_block columns. All fields are caller-owned contiguous arrays in
+ * the layout of a Fortran array (n_col, n_lay), thus with the column index running fastest. The
+ * level fields have n_lay+1 levels, the surface properties per band are (n_bnd, n_col).
+ * The inputs are read in place and the columns are not reordered, only the columns of the block
+ * that is solved are staged in scratch arrays. The cloud optics are skipped for blocks without
+ * liquid and ice. The Fortran module rte_rrtmgp_c in src_c/rte_rrtmgp_c.F90 declares the same
+ * interface with ISO_C_BINDING.
+ *
+ * The precision is part of the name of the functions that create a solver or take arrays: _f32
+ * for float and _f64 for double. The library only defines the functions of the precision it is
+ * built in (FLOAT_TYPE=single, double, or both for dual), thus a host that uses another precision
+ * fails to link. A solver can only be passed to the solve functions of its own precision.
+ *
+ * All functions return RTE_RRTMGP_SUCCESS or RTE_RRTMGP_FAILURE, no C++ exception crosses the
+ * interface. The message of the last failure of the calling thread is returned by
+ * rte_rrtmgp_get_last_error. A solver can be used by several threads at once.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RTE_RRTMGP_SUCCESS 0
+#define RTE_RRTMGP_FAILURE 1
+
+/* Checking of the inputs, see Validation_policy.h. */
+#define RTE_RRTMGP_VALIDATION_FULL 0
+#define RTE_RRTMGP_VALIDATION_FUSED 1
+#define RTE_RRTMGP_VALIDATION_OFF 2
+
+/* Shape of the volume mixing ratio of a gas. */
+#define RTE_RRTMGP_GAS_SCALAR 0  /* One value for all columns and layers. */
+#define RTE_RRTMGP_GAS_PROFILE 1 /* (n_lay), the same profile in all columns. */
+#define RTE_RRTMGP_GAS_FIELD 2   /* (n_col, n_lay). */
+
+typedef struct rte_rrtmgp_solver rte_rrtmgp_solver;
+
+const char* rte_rrtmgp_get_last_error(void);
+
+/*
+ * Create a solver from a longwave or shortwave coefficient file. The cloud coefficient file
+ * is optional and may be NULL. The gas names are the gases that are passed to the solve
+ * functions, in the same order.
+ */
+int rte_rrtmgp_solver_create_f32(
+        rte_rrtmgp_solver** solver,
+        const char* file_name_gas,
+        const char* file_name_cloud,
+        int n_gas, const char* const* gas_names);
+
+int rte_rrtmgp_solver_create_f64(
+        rte_rrtmgp_solver** solver,
+        const char* file_name_gas,
+        const char* file_name_cloud,
+        int n_gas, const char* const* gas_names);
+
+/* Same as rte_rrtmgp_solver_create, with the NetCDF files in memory. */
+int rte_rrtmgp_solver_create_from_buffer_f32(
+        rte_rrtmgp_solver** solver,
+        const void* buffer_gas, size_t size_gas,
+        const void* buffer_cloud, size_t size_cloud,
+        int n_gas, const char* const* gas_names);
+
+int rte_rrtmgp_solver_create_from_buffer_f64(
+        rte_rrtmgp_solver** solver,
+        const void* buffer_gas, size_t size_gas,
+        const void* buffer_cloud, size_t size_cloud,
+        int n_gas, const char* const* gas_names);
+
+void rte_rrtmgp_solver_destroy(rte_rrtmgp_solver* solver);
+
+int rte_rrtmgp_solver_is_longwave(const rte_rrtmgp_solver* solver, int* is_longwave);
+int rte_rrtmgp_solver_get_n_bnd(const rte_rrtmgp_solver* solver, int* n_bnd);
+int rte_rrtmgp_solver_get_n_gpt(const rte_rrtmgp_solver* solver, int* n_gpt);
+
+/* Number of columns that are solved at once, the default is 16. */
+int rte_rrtmgp_solver_set_n_col_block(rte_rrtmgp_solver* solver, int n_col_block);
+
+/*
+ * Checking of the gases, pressures and temperatures, one of the RTE_RRTMGP_VALIDATION values.
+ * The default is RTE_RRTMGP_VALIDATION_FULL, with RTE_RRTMGP_VALIDATION_OFF the caller
+ * guarantees that the inputs are within the range of the coefficients.
+ */
+int rte_rrtmgp_solver_set_validation(rte_rrtmgp_solver* solver, int validation);
+
+/*
+ * Solve the longwave fluxes. vmr holds one array per gas of the solver, with the shape given
+ * by the RTE_RRTMGP_GAS value in vmr_shape. If vmr_shape is NULL, all gases are fields.
+ * col_dry is computed from h2o if NULL. The clouds are skipped if lwp is NULL, otherwise
+ * iwp, rel and rei are required as well and the solver needs cloud coefficients.
+ */
+int rte_rrtmgp_solve_lw_f32(
+        const rte_rrtmgp_solver* solver,
+        int n_col, int n_lay,
+        const float* const* vmr, const int* vmr_shape,
+        const float* p_lay, const float* p_lev,
+        const float* t_lay, const float* t_lev,
+        const float* col_dry,
+        const float* t_sfc, const float* emis_sfc,
+        const float* lwp, const float* iwp,
+        const float* rel, const float* rei,
+        float* flux_up, float* flux_dn, float* flux_net);
+
+int rte_rrtmgp_solve_lw_f64(
+        const rte_rrtmgp_solver* solver,
+        int n_col, int n_lay,
+        const double* const* vmr, const int* vmr_shape,
+        const double* p_lay, const double* p_lev,
+        const double* t_lay, const double* t_lev,
+        const double* col_dry,
+        const double* t_sfc, const double* emis_sfc,
+        const double* lwp, const double* iwp,
+        const double* rel, const double* rei,
+        double* flux_up, double* flux_dn, double* flux_net);
+
+/*
+ * Solve the shortwave fluxes, with the same conventions as rte_rrtmgp_solve_lw.
+ * tsi_scaling scales the solar irradiance per column and is taken as 1 if NULL.
+ */
+int rte_rrtmgp_solve_sw_f32(
+        const rte_rrtmgp_solver* solver,
+        int n_col, int n_lay,
+        const float* const* vmr, const int* vmr_shape,
+        const float* p_lay, const float* p_lev,
+        const float* t_lay, const float* t_lev,
+        const float* col_dry,
+        const float* sfc_alb_dir, const float* sfc_alb_dif,
+        const float* mu0, const float* tsi_scaling,
+        const float* lwp, const float* iwp,
+        const float* rel, const float* rei,
+        float* flux_up, float* flux_dn,
+        float* flux_dn_dir, float* flux_net);
+
+int rte_rrtmgp_solve_sw_f64(
+        const rte_rrtmgp_solver* solver,
+        int n_col, int n_lay,
+        const double* const* vmr, const int* vmr_shape,
+        const double* p_lay, const double* p_lev,
+        const double* t_lay, const double* t_lev,
+        const double* col_dry,
+        const double* sfc_alb_dir, const double* sfc_alb_dif,
+        const double* mu0, const double* tsi_scaling,
+        const double* lwp, const double* iwp,
+        const double* rel, const double* rei,
+        double* flux_up, double* flux_dn,
+        double* flux_dn_dir, double* flux_net);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,109 @@
+/*
+ * This file is developed for the benchmarking of the
+ * C++ interface to the RTE+RRTMGP radiation code.
+ *
+ * It is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Minimal harness in the style of Google Benchmark. A benchmark function does its setup,
+// then runs the code to be timed in a while (state.keep_running()) loop, and reports the
+// bytes and floating point operations per iteration for the computation of GB/s and GFLOP/s.
+namespace Benchmark
+{
+    class State
+    {
+        public:
+            State(const int n_col, const int n_lay, const double min_time) :
+                n_col(n_col), n_lay(n_lay), min_time(min_time)
+            {}
+
+            bool keep_running()
+            {
+                const auto now = std::chrono::steady_clock::now();
+
+                if (n_iter == 0)
+                    time_start = now;
+                else
+                {
+                    elapsed = std::chrono::duration<double>(now - time_start).count();
+                    if (elapsed >= min_time)
+                        return false;
+                }
+
+                ++n_iter;
+                return true;
+            }
+
+            int get_n_col() const { return n_col; }
+            int get_n_lay() const { return n_lay; }
+
+            void set_bytes_per_iteration(const double bytes) { bytes_per_iter = bytes; }
+            void set_flops_per_iteration(const double flops) { flops_per_iter = flops; }
+
+            int get_n_iter() const { return n_iter; }
+            double get_time_per_iteration() const { return elapsed / n_iter; }
+            double get_bytes_per_iteration() const { return bytes_per_iter; }
+            double get_flops_per_iteration() const { return flops_per_iter; }
+
+        private:
+            const int n_col;
+            const int n_lay;
+            const double min_time;
+
+            int n_iter = 0;
+            double elapsed = 0.;
+            double bytes_per_iter = 0.;
+            double flops_per_iter = 0.;
+            std::chrono::steady_clock::time_point time_start;
+    };
+
+    struct Benchmark
+    {
+        std::string name;
+        std::function<void(State&)> function;
+    };
+
+    inline void print_header()
+    {
+        std::printf("%-56s %14s %12s %10s %10s\n", "Benchmark", "Time (us)", "Iterations", "GB/s", "GFLOP/s");
+        std::printf("%s\n", std::string(106, '-').c_str());
+    }
+
+    inline void run(const Benchmark& benchmark, const int n_col, const int n_lay, const double min_time)
+    {
+        State state(n_col, n_lay, min_time);
+        benchmark.function(state);
+
+        const double time = state.get_time_per_iteration();
+        const std::string name =
+                benchmark.name + "/ncol:" + std::to_string(n_col) + "/nlay:" + std::to_string(n_lay);
+
+        std::printf("%-56s %14.3f %12d %10.3f %10.3f\n",
+                name.c_str(),
+                time*1.e6,
+                state.get_n_iter(),
+                state.get_bytes_per_iteration() / time * 1.e-9,
+                state.get_flops_per_iteration() / time * 1.e-9);
+    }
+}
+#endif
@@ -20,16 +20,33 @@
 #ifndef NETCDF_INTERFACE_H
 #define NETCDF_INTERFACE_H
 
+#include <algorithm>
 #include <vector>
 #include <map>
 #include <iostream>
 #include <numeric>
+#include <type_traits>
 #include <netcdf.h>
 
 #include "Status.h"
+#include "Array.h"
 
 enum class Netcdf_mode { Create, Read, Write };
 
+// Storage layout and filters of a new variable. The chunk sizes are given in the order of the
+// dimensions, an empty vector keeps the default contiguous storage. A deflate level of 0 disables
+// compression. Quantization is lossy, it keeps the given number of significant digits of
+// floating point data before compression, and needs NetCDF 4.9 or newer. Double precision
+// data of variables that are stored as float is converted while it is written.
+struct Netcdf_storage
+{
+    std::vector<int> chunk_sizes;
+    int deflate_level = 0;
+    bool shuffle = false;
+    int quantize_digits = 0;
+    bool store_as_float = false;
+};
+
 class Netcdf_handle;
 class Netcdf_group;
 
@@ -37,7 +54,7 @@ template<typename T>
 class Netcdf_variable
 {
     public:
-        Netcdf_variable(Netcdf_handle&, const int, const std::vector<int>&);
+        Netcdf_variable(Netcdf_handle&, const int, const std::vector<int>&, const bool store_as_float=false);
         Netcdf_variable(const Netcdf_variable&) = default;
         void insert(const std::vector<T>&, const std::vector<int>);
         void insert(const std::vector<T>&, const std::vector<int>, const std::vector<int>);
@@ -51,6 +68,7 @@ class Netcdf_variable
         Netcdf_handle& nc_file;
         const int var_id;
         const std::vector<int> dim_sizes;
+        const bool store_as_float;
 };
 
 class Netcdf_handle
@@ -71,7 +89,8 @@ class Netcdf_handle
         template<typename T>
         Netcdf_variable<T> add_variable(
                 const std::string&,
-                const std::vector<std::string>&);
+                const std::vector<std::string>&,
+                const Netcdf_storage& = Netcdf_storage());
 
         template<typename T>
         T get_variable(
@@ -89,6 +108,21 @@ class Netcdf_handle
                 const std::vector<int>&,
                 const std::vector<int>&) const;
 
+        // Read a hyperslab directly into caller-provided storage.
+        template<typename T>
+        void get_variable(
+                T*,
+                const std::string&,
+                const std::vector<int>&,
+                const std::vector<int>&) const;
+
+        template<typename T, int N>
+        void get_variable(
+                Array<T,N>&,
+                const std::string&,
+                const std::vector<int>&,
+                const std::vector<int>&) const;
+
         template<typename T>
         void insert(
                 const std::vector<T>&,
@@ -103,6 +137,13 @@ class Netcdf_handle
                 const std::vector<int>&,
                 const std::vector<int>&);
 
+        template<typename T>
+        void insert_as_float(
+                const std::vector<T>&,
+                const int var_id,
+                const std::vector<int>&,
+                const std::vector<int>&);
+
         void add_attribute(
                 const std::string&,
                 const std::string&,
@@ -164,41 +205,41 @@ namespace
     // Wrapper for the `nc_get_vara_TYPE` functions
     template<typename TF>
     int nc_get_vara_wrapper(
-            int, int, const std::vector<size_t>&, const std::vector<size_t>&, std::vector<TF>&);
+            int, int, const std::vector<size_t>&, const std::vector<size_t>&, TF*);
 
     template<>
     int nc_get_vara_wrapper(
-            int ncid, int var_id, const std::vector<size_t>& start, const std::vector<size_t>& count, std::vector<double>& values)
+            int ncid, int var_id, const std::vector<size_t>& start, const std::vector<size_t>& count, double* values)
     {
-        return nc_get_vara_double(ncid, var_id, start.data(), count.data(), values.data());
+        return nc_get_vara_double(ncid, var_id, start.data(), count.data(), values);
     }
 
     template<>
     int nc_get_vara_wrapper(
-            int ncid, int var_id, const std::vector<size_t>& start, const std::vector<size_t>& count, std::vector<float>& values)
+            int ncid, int var_id, const std::vector<size_t>& start, const std::vector<size_t>& count, float* values)
     {
-        return nc_get_vara_float(ncid, var_id, start.data(), count.data(), values.data());
+        return nc_get_vara_float(ncid, var_id, start.data(), count.data(), values);
     }
 
     template<>
     int nc_get_vara_wrapper(
-            int ncid, int var_id, const std::vector<size_t>& start, const std::vector<size_t>& count, std::vector<int>& values)
+            int ncid, int var_id, const std::vector<size_t>& start, const std::vector<size_t>& count, int* values)
     {
-        return nc_get_vara_int(ncid, var_id, start.data(), count.data(), values.data());
+        return nc_get_vara_int(ncid, var_id, start.data(), count.data(), values);
     }
 
     template<>
     int nc_get_vara_wrapper(
-            int ncid, int var_id, const std::vector<size_t>& start, const std::vector<size_t>& count, std::vector<char>& values)
+            int ncid, int var_id, const std::vector<size_t>& start, const std::vector<size_t>& count, char* values)
     {
-        return nc_get_vara_text(ncid, var_id, start.data(), count.data(), values.data());
+        return nc_get_vara_text(ncid, var_id, start.data(), count.data(), values);
     }
 
     template<>
     int nc_get_vara_wrapper(
-            int ncid, int var_id, const std::vector<size_t>& start, const std::vector<size_t>& count, std::vector<signed char>& values)
+            int ncid, int var_id, const std::vector<size_t>& start, const std::vector<size_t>& count, signed char* values)
     {
-        return nc_get_vara_schar(ncid, var_id, start.data(), count.data(), values.data());
+        return nc_get_vara_schar(ncid, var_id, start.data(), count.data(), values);
     }
 
     // Wrapper for the `nc_put_vara_TYPE` functions
@@ -328,7 +369,8 @@ inline void Netcdf_handle::add_dimension(const std::string& dim_name, const int
 template<typename T>
 inline Netcdf_variable<T> Netcdf_handle::add_variable(
         const std::string& var_name,
-        const std::vector<std::string>& dim_names)
+        const std::vector<std::string>& dim_names,
+        const Netcdf_storage& storage)
 {
     int nc_check_code = 0;
 
@@ -344,9 +386,39 @@ inline Netcdf_variable<T> Netcdf_handle::add_variable(
     for (const std::string& dim_name : dim_names)
         dim_ids.push_back(dims.at(dim_name));
 
-    nc_check_code = nc_def_var(ncid, var_name.c_str(), netcdf_dtype<T>(), ndims, dim_ids.data(), &var_id);
+    const bool store_as_float = storage.store_as_float && std::is_same<T, double>::value;
+    const nc_type var_type = store_as_float ? netcdf_dtype<float>() : netcdf_dtype<T>();
+
+    nc_check_code = nc_def_var(ncid, var_name.c_str(), var_type, ndims, dim_ids.data(), &var_id);
     nc_check(nc_check_code);
 
+    if (!storage.chunk_sizes.empty())
+    {
+        if (storage.chunk_sizes.size() != dim_ids.size())
+            throw std::runtime_error("Chunk sizes of variable " + var_name + " do not match its dimensions");
+
+        const std::vector<size_t> chunk_sizes_size_t(storage.chunk_sizes.begin(), storage.chunk_sizes.end());
+        nc_check_code = nc_def_var_chunking(ncid, var_id, NC_CHUNKED, chunk_sizes_size_t.data());
+        nc_check(nc_check_code);
+    }
+
+    if (storage.quantize_digits > 0 && std::is_floating_point<T>::value)
+    {
+#ifdef NC_QUANTIZE_GRANULARBR
+        nc_check_code = nc_def_var_quantize(ncid, var_id, NC_QUANTIZE_GRANULARBR, storage.quantize_digits);
+        nc_check(nc_check_code);
+#else
+        Status::print_warning("Quantization of " + var_name + " is skipped, it requires NetCDF 4.9 or newer");
+#endif
+    }
+
+    if (storage.deflate_level > 0 || storage.shuffle)
+    {
+        nc_check_code = nc_def_var_deflate(
+                ncid, var_id, storage.shuffle, storage.deflate_level > 0, storage.deflate_level);
+        nc_check(nc_check_code);
+    }
+
     nc_check_code = nc_enddef(root_ncid);
     nc_check(nc_check_code);
 
@@ -375,7 +447,7 @@ inline Netcdf_variable<T> Netcdf_handle::add_variable(
             dim_sizes.push_back(dim_len);
     }
 
-    return Netcdf_variable<T>(*this, var_id, dim_sizes);
+    return Netcdf_variable<T>(*this, var_id, dim_sizes, store_as_float);
 }
 
 inline Netcdf_handle::Netcdf_handle() :
@@ -416,6 +488,45 @@ inline void Netcdf_handle::insert(
     nc_check(nc_check_code);
 }
 
+// Convert the values to float and write them in slabs along the slowest dimension, such that
+// the conversion buffer stays small, also if the values span the full variable.
+template<typename T>
+inline void Netcdf_handle::insert_as_float(
+        const std::vector<T>& values,
+        const int var_id,
+        const std::vector<int>& i_start,
+        const std::vector<int>& i_count)
+{
+    if (i_count.empty())
+    {
+        insert(static_cast<float>(values[0]), var_id, i_start, i_count);
+        return;
+    }
+
+    constexpr int max_buffer_size = 1 << 18;
+
+    const int slab_size = std::accumulate(i_count.begin()+1, i_count.end(), 1, std::multiplies<>());
+    const int n_per_write = std::max(std::min(max_buffer_size / std::max(slab_size, 1), i_count[0]), 1);
+
+    std::vector<float> buffer(n_per_write*slab_size);
+
+    for (int i=0; i<i_count[0]; i+=n_per_write)
+    {
+        const int n = std::min(n_per_write, i_count[0] - i);
+
+        std::vector<int> i_start_slab(i_start);
+        std::vector<int> i_count_slab(i_count);
+        i_start_slab[0] += i;
+        i_count_slab[0] = n;
+
+        std::transform(
+                values.begin() + size_t(i)*slab_size, values.begin() + size_t(i+n)*slab_size,
+                buffer.begin(), [](const T value) { return static_cast<float>(value); });
+
+        insert(buffer, var_id, i_start_slab, i_count_slab);
+    }
+}
+
 inline void Netcdf_handle::add_attribute(
         const std::string& name,
         const std::string& value,
@@ -598,7 +709,7 @@ inline TF Netcdf_handle::get_variable(
     TF value = 0;
     std::vector<TF> values(1);
 
-    nc_check_code = nc_get_vara_wrapper(ncid, var_id, {0}, {1}, values);
+    nc_check_code = nc_get_vara_wrapper(ncid, var_id, {0}, {1}, values.data());
     nc_check(nc_check_code);
 
     value = values[0];
@@ -636,7 +747,7 @@ inline std::vector<TF> Netcdf_handle::get_variable(
     // CvH check needs to be added if total count matches multiplication of all dimensions.
 
     std::vector<TF> values(total_count);
-    nc_check_code = nc_get_vara_wrapper(ncid, var_id, i_start_size_t, i_count_size_t, values);
+    nc_check_code = nc_get_vara_wrapper(ncid, var_id, i_start_size_t, i_count_size_t, values.data());
     nc_check(nc_check_code);
 
     return values;
@@ -648,6 +759,34 @@ inline void Netcdf_handle::get_variable(
         const std::string& name,
         const std::vector<int>& i_start,
         const std::vector<int>& i_count) const
+{
+    const size_t total_count = std::accumulate(i_count.begin(), i_count.end(), size_t(1), std::multiplies<>());
+    if (values.size() < total_count)
+        throw std::runtime_error("Netcdf variable: " + name + " does not fit in the vector");
+
+    get_variable(values.data(), name, i_start, i_count);
+}
+
+template<typename TF, int N>
+inline void Netcdf_handle::get_variable(
+        Array<TF,N>& values,
+        const std::string& name,
+        const std::vector<int>& i_start,
+        const std::vector<int>& i_count) const
+{
+    const int total_count = std::accumulate(i_count.begin(), i_count.end(), 1, std::multiplies<>());
+    if (total_count != values.size())
+        throw std::runtime_error("Netcdf variable: " + name + " does not match the size of the array");
+
+    get_variable(values.ptr(), name, i_start, i_count);
+}
+
+template<typename TF>
+inline void Netcdf_handle::get_variable(
+        TF* values,
+        const std::string& name,
+        const std::vector<int>& i_start,
+        const std::vector<int>& i_count) const
 {
     // std::string message = "Retrieving from NetCDF: " + name;
     // Status::print_message(message);
@@ -671,12 +810,11 @@ inline void Netcdf_handle::get_variable(
         zero_fill = true;
     }
 
-    // CvH: Add check if the vector is large enough.
     int total_count = std::accumulate(i_count.begin(), i_count.end(), 1, std::multiplies<>());
 
     if (zero_fill)
     {
-        std::fill(values.begin(), values.begin() + total_count, 0);
+        std::fill(values, values + total_count, 0);
     }
     else
     {
@@ -687,14 +825,15 @@ inline void Netcdf_handle::get_variable(
 
 // Variable does not communicate with NetCDF library directly.
 template<typename T>
-inline Netcdf_variable<T>::Netcdf_variable(Netcdf_handle& nc_file, const int var_id, const std::vector<int>& dim_sizes) :
-        nc_file(nc_file), var_id(var_id), dim_sizes(dim_sizes)
+inline Netcdf_variable<T>::Netcdf_variable(
+        Netcdf_handle& nc_file, const int var_id, const std::vector<int>& dim_sizes, const bool store_as_float) :
+        nc_file(nc_file), var_id(var_id), dim_sizes(dim_sizes), store_as_float(store_as_float)
 {}
 
 template<typename T>
 inline void Netcdf_variable<T>::insert(const std::vector<T>& values, const std::vector<int> i_start)
 {
-    nc_file.insert(values, var_id, i_start, dim_sizes);
+    insert(values, i_start, dim_sizes);
 }
 
 template<typename T>
@@ -703,7 +842,10 @@ inline void Netcdf_variable<T>::insert(
         const std::vector<int> i_start,
         const std::vector<int> i_count)
 {
-    nc_file.insert(values, var_id, i_start, i_count);
+    if (store_as_float)
+        nc_file.insert_as_float(values, var_id, i_start, i_count);
+    else
+        nc_file.insert(values, var_id, i_start, i_count);
 }
 
 template<typename T>
@@ -0,0 +1,236 @@
+/*
+ * This file is developed for the
+ * testing of the C++ interface to the RTE+RRTMGP radiation code.
+ *
+ * It is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETCDF_WRITER_H
+#define NETCDF_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Netcdf_interface.h"
+
+// Writer that owns a NetCDF file and writes the inserted data in a background thread, such
+// that the computations can continue during the I/O. The queue is bounded, an insert waits
+// if it is full. The NetCDF library is not thread safe, therefore all other NetCDF calls that
+// can run concurrently with the writer need to hold the library mutex.
+class Netcdf_writer
+{
+    public:
+        Netcdf_writer(
+                std::unique_ptr<Netcdf_file> nc_file,
+                const bool asynchronous,
+                const size_t max_queue_size=64);
+        ~Netcdf_writer();
+
+        Netcdf_writer(const Netcdf_writer&) = delete;
+        Netcdf_writer& operator=(const Netcdf_writer&) = delete;
+
+        template<typename T>
+        void insert(
+                Netcdf_variable<T>& variable,
+                std::vector<T>&& values,
+                const std::vector<int>& i_start,
+                const std::vector<int>& i_count);
+
+        // Wait until all inserted data is written and synchronize the file.
+        void flush();
+
+        static std::mutex& get_library_mutex()
+        {
+            static std::mutex library_mutex;
+            return library_mutex;
+        }
+
+    private:
+        void push(std::function<void()>&& task);
+        void run();
+        void rethrow_error();
+
+        std::unique_ptr<Netcdf_file> nc_file;
+        const bool asynchronous;
+        const size_t max_queue_size;
+
+        std::deque<std::function<void()>> queue;
+        std::mutex queue_mutex;
+        std::condition_variable queue_cv;
+        bool is_busy = false;
+        bool is_stopping = false;
+        std::exception_ptr error;
+        bool error_is_reported = false;
+
+        std::thread writer_thread;
+};
+
+inline Netcdf_writer::Netcdf_writer(
+        std::unique_ptr<Netcdf_file> nc_file,
+        const bool asynchronous,
+        const size_t max_queue_size) :
+    nc_file(std::move(nc_file)),
+    asynchronous(asynchronous),
+    max_queue_size(std::max(max_queue_size, size_t(1)))
+{
+    if (asynchronous)
+        writer_thread = std::thread(&Netcdf_writer::run, this);
+}
+
+inline Netcdf_writer::~Netcdf_writer()
+{
+    if (asynchronous)
+    {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            is_stopping = true;
+        }
+        queue_cv.notify_all();
+        writer_thread.join();
+
+        // The destructor cannot throw, so an error that was not raised by flush or insert is
+        // reported here, as the output file is incomplete.
+        if (error && !error_is_reported)
+        {
+            try
+            {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "ERROR: the asynchronous NetCDF output is incomplete: " << e.what() << std::endl;
+            }
+            catch (...)
+            {
+                std::cerr << "ERROR: the asynchronous NetCDF output is incomplete" << std::endl;
+            }
+        }
+    }
+
+    // The file is closed here, after the last write.
+    std::lock_guard<std::mutex> lock(get_library_mutex());
+    nc_file.reset();
+}
+
+template<typename T>
+inline void Netcdf_writer::insert(
+        Netcdf_variable<T>& variable,
+        std::vector<T>&& values,
+        const std::vector<int>& i_start,
+        const std::vector<int>& i_count)
+{
+    // The task takes ownership of the data, so the caller can reuse its memory.
+    auto values_ptr = std::make_shared<std::vector<T>>(std::move(values));
+    Netcdf_variable<T> variable_copy(variable);
+
+    push([variable_copy, values_ptr, i_start, i_count]() mutable
+            { variable_copy.insert(*values_ptr, i_start, i_count); });
+}
+
+inline void Netcdf_writer::flush()
+{
+    if (asynchronous)
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_cv.wait(lock, [&]{ return (queue.empty() && !is_busy) || error; });
+    }
+
+    rethrow_error();
+
+    std::lock_guard<std::mutex> lock(get_library_mutex());
+    nc_file->sync();
+}
+
+inline void Netcdf_writer::push(std::function<void()>&& task)
+{
+    if (!asynchronous)
+    {
+        std::lock_guard<std::mutex> lock(get_library_mutex());
+        task();
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_cv.wait(lock, [&]{ return queue.size() < max_queue_size || error; });
+        if (!error)
+            queue.push_back(std::move(task));
+    }
+    queue_cv.notify_all();
+
+    rethrow_error();
+}
+
+inline void Netcdf_writer::run()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [&]{ return !queue.empty() || is_stopping; });
+
+            if (queue.empty())
+                return;
+
+            task = std::move(queue.front());
+            queue.pop_front();
+            is_busy = true;
+        }
+        queue_cv.notify_all();
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(get_library_mutex());
+            task();
+        }
+        catch (...)
+        {
+            // Keep the first error and drop the remaining writes, the error is raised on the main thread.
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (!error)
+                error = std::current_exception();
+            queue.clear();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            is_busy = false;
+        }
+        queue_cv.notify_all();
+    }
+}
+
+inline void Netcdf_writer::rethrow_error()
+{
+    std::exception_ptr error_copy;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        error_copy = error;
+        if (error)
+            error_is_reported = true;
+    }
+
+    if (error_copy)
+        std::rethrow_exception(error_copy);
+}
+#endif
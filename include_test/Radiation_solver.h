@@ -24,6 +24,25 @@
 #include "Gas_concs.h"
 #include "Gas_optics_rrtmgp.h"
 #include "Cloud_optics.h"
+#include "Thread_pool.h"
+
+// Thresholds on the change of the inputs of a column since its last solve, beyond which the column
+// is solved again in the incremental mode. The gases and col_dry use a change relative to their
+// cached value, the other thresholds are absolute. The boundary threshold applies to the surface
+// emissivity and albedo, mu0 and the TSI scaling. The default of zero solves any changed column.
+template<typename TF>
+struct Resolve_thresholds
+{
+    TF temperature = TF(0.);
+    TF pressure = TF(0.);
+    TF vmr_relative = TF(0.);
+    TF water_path = TF(0.);
+    TF effective_radius = TF(0.);
+    TF boundary = TF(0.);
+};
+
+template<typename TF> class Column_cache;
+class Coefficient_file;
 
 template<typename TF>
 class Radiation_solver_longwave
@@ -32,13 +51,24 @@ class Radiation_solver_longwave
         Radiation_solver_longwave(
                 const Gas_concs<TF>& gas_concs,
                 const std::string& file_name_gas,
-                const std::string& file_name_cloud);
+                const std::string& file_name_cloud,
+                const bool switch_mixed_precision=false);
+
+        // Construct from opened coefficient files, without cloud optics if coef_cloud is nullptr.
+        Radiation_solver_longwave(
+                const Gas_concs<TF>& gas_concs,
+                const Coefficient_file& coef_gas,
+                const Coefficient_file* coef_cloud,
+                const bool switch_mixed_precision=false);
+
+        ~Radiation_solver_longwave();
 
         void solve(
                 const bool switch_fluxes,
                 const bool switch_cloud_optics,
                 const bool switch_output_optical,
                 const bool switch_output_bnd_fluxes,
+                const bool switch_output_jacobian,
                 const Gas_concs<TF>& gas_concs,
                 const Array<TF,2>& p_lay, const Array<TF,2>& p_lev,
                 const Array<TF,2>& t_lay, const Array<TF,2>& t_lev,
@@ -49,11 +79,40 @@ class Radiation_solver_longwave
                 Array<TF,3>& tau, Array<TF,3>& lay_source,
                 Array<TF,3>& lev_source_inc, Array<TF,3>& lev_source_dec, Array<TF,2>& sfc_source,
                 Array<TF,2>& lw_flux_up, Array<TF,2>& lw_flux_dn, Array<TF,2>& lw_flux_net,
-                Array<TF,3>& lw_bnd_flux_up, Array<TF,3>& lw_bnd_flux_dn, Array<TF,3>& lw_bnd_flux_net) const;
+                Array<TF,3>& lw_bnd_flux_up, Array<TF,3>& lw_bnd_flux_dn, Array<TF,3>& lw_bnd_flux_net,
+                Array<TF,2>& lw_flux_up_jac,
+                const int col_offset=0) const;
 
         int get_n_gpt() const { return this->kdist->get_ngpt(); };
         int get_n_bnd() const { return this->kdist->get_nband(); };
 
+        // Number of columns that are solved at once.
+        void set_n_col_block(const int n_col_block);
+        int get_n_col_block() const { return this->n_col_block; };
+
+        // Solve columns with bit-identical inputs once and copy their outputs to the duplicates.
+        void set_deduplicate_columns(const bool deduplicate_columns);
+        bool get_deduplicate_columns() const { return this->deduplicate_columns; };
+
+        // Checking of the inputs of the gas optics, the gases are checked by Gas_concs.
+        void set_validation_policy(const Validation_policy policy);
+        Validation_policy get_validation_policy() const { return this->kdist->get_validation_policy(); };
+
+        // Keep the inputs and outputs of each column and solve only the columns of which the inputs
+        // changed beyond the thresholds since their last solve. The state is kept per col_offset of
+        // solve, which assumes that every call at an offset passes the same columns. Callers that
+        // solve a domain in chunks pass the offset of each chunk. Concurrent calls are serialized.
+        void set_incremental(
+                const bool incremental,
+                const Resolve_thresholds<TF>& thresholds=Resolve_thresholds<TF>());
+        bool get_incremental() const { return this->column_cache != nullptr; };
+
+        // Fraction of the columns that was solved in the last call in incremental mode.
+        double get_recompute_fraction() const;
+
+        // Drop the state of the incremental mode, such that the next call solves all columns.
+        void reset_incremental();
+
         Array<int,2> get_band_lims_gpoint() const
         { return this->kdist->get_band_lims_gpoint(); }
 
@@ -63,6 +122,16 @@ class Radiation_solver_longwave
     private:
         std::unique_ptr<Gas_optics_rrtmgp<TF>> kdist;
         std::unique_ptr<Cloud_optics<TF>> cloud_optics;
+
+        int n_col_block = 16;
+        bool deduplicate_columns = false;
+        std::unique_ptr<Column_cache<TF>> column_cache;
+
+        // Gas optics in single precision for the mixed-precision mode.
+        bool switch_mixed_precision;
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+        std::unique_ptr<Gas_optics_rrtmgp<float>> kdist_sp;
+#endif
 };
 
 template<typename TF>
@@ -72,7 +141,17 @@ class Radiation_solver_shortwave
         Radiation_solver_shortwave(
                 const Gas_concs<TF>& gas_concs,
                 const std::string& file_name_gas,
-                const std::string& file_name_cloud);
+                const std::string& file_name_cloud,
+                const bool switch_mixed_precision=false);
+
+        // Construct from opened coefficient files, without cloud optics if coef_cloud is nullptr.
+        Radiation_solver_shortwave(
+                const Gas_concs<TF>& gas_concs,
+                const Coefficient_file& coef_gas,
+                const Coefficient_file* coef_cloud,
+                const bool switch_mixed_precision=false);
+
+        ~Radiation_solver_shortwave();
 
         void solve(
                 const bool switch_fluxes,
@@ -92,13 +171,41 @@ class Radiation_solver_shortwave
                 Array<TF,2>& sw_flux_up, Array<TF,2>& sw_flux_dn,
                 Array<TF,2>& sw_flux_dn_dir, Array<TF,2>& sw_flux_net,
                 Array<TF,3>& sw_bnd_flux_up, Array<TF,3>& sw_bnd_flux_dn,
-                Array<TF,3>& sw_bnd_flux_dn_dir, Array<TF,3>& sw_bnd_flux_net) const;
+                Array<TF,3>& sw_bnd_flux_dn_dir, Array<TF,3>& sw_bnd_flux_net,
+                const int col_offset=0) const;
 
         int get_n_gpt() const { return this->kdist->get_ngpt(); };
         int get_n_bnd() const { return this->kdist->get_nband(); };
 
         TF get_tsi() const { return this->kdist->get_tsi(); };
 
+        // Number of columns that are solved at once.
+        void set_n_col_block(const int n_col_block);
+        int get_n_col_block() const { return this->n_col_block; };
+
+        // Solve columns with bit-identical inputs once and copy their outputs to the duplicates.
+        void set_deduplicate_columns(const bool deduplicate_columns);
+        bool get_deduplicate_columns() const { return this->deduplicate_columns; };
+
+        // Checking of the inputs of the gas optics, the gases are checked by Gas_concs.
+        void set_validation_policy(const Validation_policy policy);
+        Validation_policy get_validation_policy() const { return this->kdist->get_validation_policy(); };
+
+        // Keep the inputs and outputs of each column and solve only the columns of which the inputs
+        // changed beyond the thresholds since their last solve. The state is kept per col_offset of
+        // solve, which assumes that every call at an offset passes the same columns. Callers that
+        // solve a domain in chunks pass the offset of each chunk. Concurrent calls are serialized.
+        void set_incremental(
+                const bool incremental,
+                const Resolve_thresholds<TF>& thresholds=Resolve_thresholds<TF>());
+        bool get_incremental() const { return this->column_cache != nullptr; };
+
+        // Fraction of the columns that was solved in the last call in incremental mode.
+        double get_recompute_fraction() const;
+
+        // Drop the state of the incremental mode, such that the next call solves all columns.
+        void reset_incremental();
+
         Array<int,2> get_band_lims_gpoint() const
         { return this->kdist->get_band_lims_gpoint(); }
 
@@ -106,7 +213,101 @@ class Radiation_solver_shortwave
         { return this->kdist->get_band_lims_wavenumber(); }
 
     private:
-        std::unique_ptr<Gas_optics<TF>> kdist;
+        std::unique_ptr<Gas_optics_rrtmgp<TF>> kdist;
         std::unique_ptr<Cloud_optics<TF>> cloud_optics;
+
+        int n_col_block = 16;
+        bool deduplicate_columns = false;
+        std::unique_ptr<Column_cache<TF>> column_cache;
+
+        // Gas optics in single precision for the mixed-precision mode.
+        bool switch_mixed_precision;
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+        std::unique_ptr<Gas_optics_rrtmgp<float>> kdist_sp;
+#endif
+};
+
+// Solves the longwave and shortwave fluxes block by block, such that the part of the
+// gas optics that depends only on p, T and the gases is computed once per block and
+// the inputs of a block are still in cache for the shortwave. The blocks are divided
+// over a thread pool that both spectra share.
+template<typename TF>
+class Radiation_solver_combined
+{
+    public:
+        Radiation_solver_combined(
+                const Gas_concs<TF>& gas_concs,
+                const std::string& file_name_gas_lw,
+                const std::string& file_name_cloud_lw,
+                const std::string& file_name_gas_sw,
+                const std::string& file_name_cloud_sw);
+
+        void solve(
+                const bool switch_cloud_optics,
+                const Gas_concs<TF>& gas_concs,
+                const Array<TF,2>& p_lay, const Array<TF,2>& p_lev,
+                const Array<TF,2>& t_lay, const Array<TF,2>& t_lev,
+                const Array<TF,2>& col_dry,
+                const Array<TF,1>& t_sfc, const Array<TF,2>& emis_sfc,
+                const Array<TF,2>& sfc_alb_dir, const Array<TF,2>& sfc_alb_dif,
+                const Array<TF,1>& tsi_scaling, const Array<TF,1>& mu0,
+                const Array<TF,2>& lwp, const Array<TF,2>& iwp,
+                const Array<TF,2>& rel, const Array<TF,2>& rei,
+                Array<TF,2>& lw_flux_up, Array<TF,2>& lw_flux_dn, Array<TF,2>& lw_flux_net,
+                Array<TF,2>& sw_flux_up, Array<TF,2>& sw_flux_dn,
+                Array<TF,2>& sw_flux_dn_dir, Array<TF,2>& sw_flux_net,
+                const unsigned long long step=0, const int col_offset=0) const;
+
+        // Monte Carlo spectral integration, each column solves a random subset of n_gpt_sample
+        // g-points that is drawn per step and column (offset by col_offset), 0 solves all g-points.
+        // The gas optics and sources are only computed for the drawn g-points.
+        void set_gpt_sampling(
+                const int n_gpt_sample_lw, const int n_gpt_sample_sw,
+                const unsigned long long seed=0);
+
+        int get_n_gpt_lw() const { return this->kdist_lw->get_ngpt(); };
+        int get_n_bnd_lw() const { return this->kdist_lw->get_nband(); };
+        int get_n_gpt_sw() const { return this->kdist_sw->get_ngpt(); };
+        int get_n_bnd_sw() const { return this->kdist_sw->get_nband(); };
+
+        TF get_tsi() const { return this->kdist_sw->get_tsi(); };
+
+        Array<TF,2> get_band_lims_wavenumber_lw() const
+        { return this->kdist_lw->get_band_lims_wavenumber(); }
+
+        Array<TF,2> get_band_lims_wavenumber_sw() const
+        { return this->kdist_sw->get_band_lims_wavenumber(); }
+
+        // True if the shortwave reuses the state of the longwave.
+        bool get_shares_state() const { return this->shares_state; };
+
+        // Number of columns that are solved at once.
+        void set_n_col_block(const int n_col_block);
+        int get_n_col_block() const { return this->n_col_block; };
+
+        // Number of threads that solve the blocks, including the calling thread.
+        void set_n_threads(const int n_threads);
+        int get_n_threads() const { return this->thread_pool ? this->thread_pool->get_n_threads() : 1; };
+
+        // Checking of the inputs of the gas optics, the gases are checked by Gas_concs.
+        void set_validation_policy(const Validation_policy policy);
+        Validation_policy get_validation_policy() const { return this->kdist_lw->get_validation_policy(); };
+
+    private:
+        std::unique_ptr<Gas_optics_rrtmgp<TF>> kdist_lw;
+        std::unique_ptr<Gas_optics_rrtmgp<TF>> kdist_sw;
+        std::unique_ptr<Cloud_optics<TF>> cloud_optics_lw;
+        std::unique_ptr<Cloud_optics<TF>> cloud_optics_sw;
+
+        bool shares_state;
+        int n_col_block = 16;
+
+        std::unique_ptr<Thread_pool> thread_pool;
+
+        int n_gpt_sample_lw = 0;
+        int n_gpt_sample_sw = 0;
+        unsigned long long sampling_seed = 0;
+        std::unique_ptr<Optical_props<TF>> sample_props_lw;
+        std::unique_ptr<Optical_props<TF>> sample_props_sw;
 };
 #endif
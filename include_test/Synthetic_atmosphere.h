@@ -0,0 +1,83 @@
+/*
+ * This file is developed for the
+ * testing of the C++ interface to the RTE+RRTMGP radiation code.
+ *
+ * It is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYNTHETIC_ATMOSPHERE_H
+#define SYNTHETIC_ATMOSPHERE_H
+
+#include <string>
+
+#include "Array.h"
+#include "Gas_concs.h"
+
+// Settings of the synthetic atmosphere. The water paths are the totals of a cloudy column
+// in g/m2, the fractions are the probabilities that a column is cloudy or in daylight.
+template<typename TF>
+struct Atmosphere_settings
+{
+    int n_col = 128;
+    int n_lay = 60;
+    int n_bnd_lw = 16;
+    int n_bnd_sw = 14;
+
+    TF cloud_fraction = TF(0.5);
+    TF lwp = TF(100.);
+    TF iwp = TF(20.);
+    TF day_fraction = TF(0.5);
+
+    unsigned int seed = 1;
+};
+
+// Synthetic, but physically valid, profiles that can be fed directly into the
+// radiation solvers. Each column is generated from its own random sequence,
+// thus a column does not change if the number of columns changes.
+template<typename TF>
+class Synthetic_atmosphere
+{
+    public:
+        explicit Synthetic_atmosphere(const Atmosphere_settings<TF>& settings);
+
+        // Write the atmosphere in the format of rte_rrtmgp_input.nc.
+        void save(const std::string& file_name) const;
+
+        const int n_col;
+        const int n_lay;
+        const int n_lev;
+
+        Array<TF,2> p_lay;
+        Array<TF,2> p_lev;
+        Array<TF,2> t_lay;
+        Array<TF,2> t_lev;
+        Array<TF,1> t_sfc;
+
+        Gas_concs<TF> gas_concs;
+
+        Array<TF,2> lwp;
+        Array<TF,2> iwp;
+        Array<TF,2> rel;
+        Array<TF,2> rei;
+
+        Array<TF,2> emis_sfc;
+        Array<TF,2> sfc_alb_dir;
+        Array<TF,2> sfc_alb_dif;
+
+        // Night columns have a grazing sun and zero solar irradiance, so the shortwave
+        // solver remains valid for all columns.
+        Array<TF,1> mu0;
+        Array<TF,1> tsi;
+};
+#endif
@@ -0,0 +1,153 @@
+/*
+ * This file is developed for the
+ * testing of the C++ interface to the RTE+RRTMGP radiation code.
+ *
+ * It is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Pool of threads that is created once and reused for every loop, such that the threads
+// are not started per solve. The calling thread takes part in the loop, thus a pool of
+// n_threads has n_threads-1 workers. Calls of parallel_for from several threads are serialized.
+class Thread_pool
+{
+    public:
+        explicit Thread_pool(const int n_threads)
+        {
+            if (n_threads < 1)
+                throw std::runtime_error("The number of threads needs to be at least 1");
+
+            for (int i=0; i<n_threads-1; ++i)
+                workers.emplace_back(&Thread_pool::run, this);
+        }
+
+        ~Thread_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            cv_start.notify_all();
+
+            for (std::thread& worker : workers)
+                worker.join();
+        }
+
+        Thread_pool(const Thread_pool&) = delete;
+        Thread_pool& operator=(const Thread_pool&) = delete;
+
+        int get_n_threads() const { return workers.size() + 1; }
+
+        // Run function(i) for i from 0 to n-1 and wait until all are done. The iterations
+        // are handed out one by one, the first exception is rethrown in the calling thread.
+        void parallel_for(const int n, const std::function<void(int)>& function_in)
+        {
+            std::lock_guard<std::mutex> call_lock(call_mutex);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                function = &function_in;
+                n_tasks = n;
+                next_task = 0;
+                n_busy = workers.size();
+                error = nullptr;
+                ++generation;
+            }
+            cv_start.notify_all();
+
+            run_tasks();
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv_done.wait(lock, [&]{ return n_busy == 0; });
+                function = nullptr;
+            }
+
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+    private:
+        void run()
+        {
+            unsigned long generation_done = 0;
+
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv_start.wait(lock, [&]{ return stop || (generation != generation_done); });
+                    if (stop)
+                        return;
+                    generation_done = generation;
+                }
+
+                run_tasks();
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    --n_busy;
+                }
+                cv_done.notify_one();
+            }
+        }
+
+        void run_tasks()
+        {
+            while (true)
+            {
+                const int i = next_task++;
+                if (i >= n_tasks)
+                    return;
+
+                try
+                {
+                    (*function)(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+        }
+
+        std::vector<std::thread> workers;
+
+        std::mutex call_mutex;
+        std::mutex mutex;
+        std::condition_variable cv_start;
+        std::condition_variable cv_done;
+
+        const std::function<void(int)>* function = nullptr;
+        int n_tasks = 0;
+        std::atomic<int> next_task{0};
+        int n_busy = 0;
+        unsigned long generation = 0;
+        bool stop = false;
+        std::exception_ptr error;
+};
+#endif
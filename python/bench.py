@@ -0,0 +1,132 @@
+# Benchmark of the Python bindings. Run 'generate_rte_rrtmgp_input --ncol=1024' first and
+# copy the coefficient files into this directory. The full solve through the bindings is
+# compared with the solve time that the C++ driver test_rte_rrtmgp reports for the same input,
+# and with the time to wrap all arguments as Array views. The solves are repeated with several
+# Python threads on column slices to show that the GIL is released during the solve.
+
+import argparse
+import os
+import re
+import subprocess
+import timeit
+from concurrent.futures import ThreadPoolExecutor
+
+import netCDF4 as nc
+import numpy as np
+import radiation
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--input', default='rte_rrtmgp_input.nc')
+parser.add_argument('--trials', type=int, default=10)
+parser.add_argument('--threads', type=int, nargs='+', default=[1, 2, 4])
+parser.add_argument('--driver', default='./test_rte_rrtmgp',
+                    help='C++ driver to compare with, it writes rte_rrtmgp_output.nc in this directory')
+args = parser.parse_args()
+
+
+def median_time(function, trials):
+    times = []
+    for i in range(trials):
+        start = timeit.default_timer()
+        function()
+        times.append(timeit.default_timer() - start)
+    return np.median(times)
+
+
+# Read the columns col_s to col_e of the input and create the outputs, all as contiguous arrays.
+def read_columns(col_s, col_e):
+    nc_file = nc.Dataset(args.input, 'r')
+    cols = slice(col_s, col_e)
+
+    data = {}
+    data['gas_concs'] = radiation.Gas_concs_wrapper()
+    for name, var in nc_file.variables.items():
+        if name.startswith('vmr_'):
+            vmr = var[...]
+            data['gas_concs'].set_vmr(name[4:], vmr[:, cols] if vmr.ndim == 2 else vmr)
+
+    def read(name, col_dim):
+        var = nc_file.variables[name]
+        index = [slice(None)]*var.ndim
+        index[col_dim] = cols
+        return np.ascontiguousarray(var[tuple(index)], dtype=np.float64)
+
+    for name in ['p_lay', 'p_lev', 't_lay', 't_lev']:
+        data[name] = read(name, 1)
+    for name in ['t_sfc', 'emis_sfc', 'sfc_alb_dir', 'sfc_alb_dif', 'mu0']:
+        data[name] = read(name, 0)
+
+    nc_file.close()
+
+    data['lw_fluxes'] = [np.zeros(data['p_lev'].shape) for i in range(3)]
+    data['sw_fluxes'] = [np.zeros(data['p_lev'].shape) for i in range(4)]
+
+    return data
+
+
+# Run the C++ driver on the same input and return the median of its longwave plus shortwave
+# solve time in seconds. The driver reads rte_rrtmgp_input.nc, so the input is linked if needed.
+def median_time_driver(trials):
+    if not os.path.exists('rte_rrtmgp_input.nc'):
+        os.symlink(args.input, 'rte_rrtmgp_input.nc')
+
+    times = []
+    for i in range(trials):
+        output = subprocess.run(
+                [args.driver], check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+        durations = re.findall(r'Duration (?:longwave|shortwave) solver: ([0-9.eE+-]+) \(ms\)', output)
+        if len(durations) != 2:
+            raise RuntimeError('The driver did not report the longwave and shortwave solve times')
+        times.append(1e-3*sum(float(d) for d in durations))
+    return np.median(times)
+
+
+def solve(d):
+    rad_lw.solve(
+            d['gas_concs'],
+            d['p_lay'], d['p_lev'], d['t_lay'], d['t_lev'],
+            d['t_sfc'], d['emis_sfc'],
+            *d['lw_fluxes'])
+    rad_sw.solve(
+            d['gas_concs'],
+            d['p_lay'], d['p_lev'], d['t_lay'], d['t_lev'],
+            d['sfc_alb_dir'], d['sfc_alb_dif'], d['mu0'],
+            *d['sw_fluxes'])
+
+
+with nc.Dataset(args.input, 'r') as nc_file:
+    n_col = nc_file.dimensions['col'].size
+
+data = read_columns(0, n_col)
+
+rad_lw = radiation.Radiation_solver_longwave_wrapper(
+        data['gas_concs'], 'coefficients_lw.nc', 'cloud_coefficients_lw.nc')
+rad_sw = radiation.Radiation_solver_shortwave_wrapper(
+        data['gas_concs'], 'coefficients_sw.nc', 'cloud_coefficients_sw.nc')
+
+all_arrays = [data[name] for name in ['p_lay', 'p_lev', 't_lay', 't_lev', 'emis_sfc', 'sfc_alb_dir', 'sfc_alb_dif']] \
+           + data['lw_fluxes'] + data['sw_fluxes']
+
+t_solve = median_time(lambda: solve(data), args.trials)
+t_wrap = median_time(lambda: radiation.wrap_arrays(*all_arrays), 100*args.trials)
+t_driver = median_time_driver(args.trials)
+
+print('Columns: {}, layers: {}'.format(n_col, data['p_lay'].shape[0]))
+print('Solve (LW+SW), Python: {:.3e} s'.format(t_solve))
+print('Solve (LW+SW), C++ driver: {:.3e} s, Python overhead: {:.2f}%'.format(
+    t_driver, 100*(t_solve - t_driver)/t_driver))
+print('Wrapping of {} arrays: {:.3e} s ({:.4f}% of the solve)'.format(
+    len(all_arrays), t_wrap, 100*t_wrap/t_solve))
+
+for n_threads in args.threads:
+    bounds = np.linspace(0, n_col, n_threads+1).astype(int)
+    slices = [read_columns(col_s, col_e) for col_s, col_e in zip(bounds[:-1], bounds[1:])]
+
+    with ThreadPoolExecutor(max_workers=n_threads) as executor:
+        def solve_threads():
+            list(executor.map(solve, slices))
+
+        t_threads = median_time(solve_threads, args.trials)
+
+    print('Threads: {}, solve: {:.3e} s, speedup: {:.2f}'.format(n_threads, t_threads, t_solve/t_threads))
@@ -1,10 +1,13 @@
 # distutils: language = c++
-import cython
+# cython: language_level = 3
+#
+# Python bindings of the longwave and shortwave radiation solvers. The NumPy arrays are
+# passed to the solvers as Array views without copying, so they need to be C-contiguous
+# arrays of float64. A NumPy array of shape (nlay, ncol) is an Array with dims {ncol, nlay}.
+# The GIL is released during the solve, so several Python threads can solve concurrently.
+import numpy as np
 from libcpp.string cimport string as std_string
 from libcpp cimport bool
-import numpy as np
-cimport numpy as np
-import numbers
 
 
 cdef extern from *:
@@ -13,210 +16,575 @@ cdef extern from *:
     ctypedef int d3 "3"
 
 
-cdef extern from "<array>" namespace "std":
-    cdef cppclass array[T, ND]:
-        array() except+
+cdef extern from "<array>" nogil:
+    cdef cppclass std_array "std::array"[T, ND]:
+        std_array() except+
         int& operator[](size_t)
 
 
-cdef extern from "../include/Array.h":
+cdef extern from "../include/Array.h" nogil:
     cdef cppclass Array[T, ND]:
         Array() except+
-        void set_dims(const array[int, ND]&) except +
-        T& operator()(const array[int, ND]&)
-        T* ptr()
+        Array(T*, const std_array[int, ND]&) except +
+        void set_view(T*, const std_array[int, ND]&) except +
+        int size()
+        bool is_view()
+
+
+cdef extern from "../include/Validation_policy.h" nogil:
+    cdef enum class Validation_policy:
+        Full
+        Fused
+        Off
+
+
+cdef Validation_policy to_validation_policy(name) except *:
+    if name == 'full':
+        return Validation_policy.Full
+    elif name == 'fused':
+        return Validation_policy.Fused
+    elif name == 'off':
+        return Validation_policy.Off
+    raise ValueError('The validation policy has to be full, fused or off')
 
 
-cdef extern from "../include/Gas_concs.h":
+cdef to_validation_name(Validation_policy policy):
+    if policy == Validation_policy.Full:
+        return 'full'
+    elif policy == Validation_policy.Fused:
+        return 'fused'
+    return 'off'
+
+
+cdef extern from "../include/Gas_concs.h" nogil:
     cdef cppclass Gas_concs[TF]:
         Gas_concs()
+        void set_validation_policy(const Validation_policy)
+        Validation_policy get_validation_policy()
         void set_vmr(const std_string&, const TF) except +
         void set_vmr(const std_string&, const Array[TF,d1]&) except +
         void set_vmr(const std_string&, const Array[TF,d2]&) except +
+        void set_vmr_view(const std_string&, const Array[TF,d2]&) except +
+
 
+cdef extern from "../include_test/Radiation_solver.h" nogil:
+    cdef cppclass Resolve_thresholds[TF]:
+        Resolve_thresholds()
+        TF temperature
+        TF pressure
+        TF vmr_relative
+        TF water_path
+        TF effective_radius
+        TF boundary
 
-cdef extern from "../include_test/Radiation_solver.h":
     cdef cppclass Radiation_solver_longwave[TF]:
-        Radiation_solver_longwave(const Gas_concs[TF]&, const std_string&) except +
+        Radiation_solver_longwave(
+                const Gas_concs[TF]&, const std_string&, const std_string&, const bool) except +
         void solve(
-                const bool sw_output_optical,
-                const bool sw_output_bnd_fluxes,
+                const bool switch_fluxes,
+                const bool switch_cloud_optics,
+                const bool switch_output_optical,
+                const bool switch_output_bnd_fluxes,
+                const bool switch_output_jacobian,
                 const Gas_concs[TF]& gas_concs,
                 const Array[TF,d2]& p_lay, const Array[TF,d2]& p_lev,
                 const Array[TF,d2]& t_lay, const Array[TF,d2]& t_lev,
                 const Array[TF,d2]& col_dry,
                 const Array[TF,d1]& t_sfc, const Array[TF,d2]& emis_sfc,
+                const Array[TF,d2]& lwp, const Array[TF,d2]& iwp,
+                const Array[TF,d2]& rel, const Array[TF,d2]& rei,
                 Array[TF,d3]& tau, Array[TF,d3]& lay_source,
                 Array[TF,d3]& lev_source_inc, Array[TF,d3]& lev_source_dec, Array[TF,d2]& sfc_source,
                 Array[TF,d2]& lw_flux_up, Array[TF,d2]& lw_flux_dn, Array[TF,d2]& lw_flux_net,
-                Array[TF,d3]& lw_bnd_flux_up, Array[TF,d3]& lw_bnd_flux_dn, Array[TF,d3]& lw_bnd_flux_net);
-
-# ctypedef fused float_t:
-#     cython.float
-#     cython.double
-
-cdef copy_raw(double* a_in, double* a_out, int n):
-    for i in range(n):
-        a_out[i] = a_in[i]
+                Array[TF,d3]& lw_bnd_flux_up, Array[TF,d3]& lw_bnd_flux_dn, Array[TF,d3]& lw_bnd_flux_net,
+                Array[TF,d2]& lw_flux_up_jac,
+                const int col_offset) except +
+        int get_n_gpt()
+        int get_n_bnd()
+        void set_n_col_block(const int) except +
+        int get_n_col_block()
+        void set_deduplicate_columns(const bool)
+        bool get_deduplicate_columns()
+        void set_validation_policy(const Validation_policy)
+        Validation_policy get_validation_policy()
+        void set_incremental(const bool, const Resolve_thresholds[TF]&) except +
+        bool get_incremental()
+        double get_recompute_fraction()
+        void reset_incremental()
+
+    cdef cppclass Radiation_solver_shortwave[TF]:
+        Radiation_solver_shortwave(
+                const Gas_concs[TF]&, const std_string&, const std_string&, const bool) except +
+        void solve(
+                const bool switch_fluxes,
+                const bool switch_cloud_optics,
+                const bool switch_output_optical,
+                const bool switch_output_bnd_fluxes,
+                const Gas_concs[TF]& gas_concs,
+                const Array[TF,d2]& p_lay, const Array[TF,d2]& p_lev,
+                const Array[TF,d2]& t_lay, const Array[TF,d2]& t_lev,
+                const Array[TF,d2]& col_dry,
+                const Array[TF,d2]& sfc_alb_dir, const Array[TF,d2]& sfc_alb_dif,
+                const Array[TF,d1]& tsi_scaling, const Array[TF,d1]& mu0,
+                const Array[TF,d2]& lwp, const Array[TF,d2]& iwp,
+                const Array[TF,d2]& rel, const Array[TF,d2]& rei,
+                Array[TF,d3]& tau, Array[TF,d3]& ssa, Array[TF,d3]& g,
+                Array[TF,d2]& toa_src,
+                Array[TF,d2]& sw_flux_up, Array[TF,d2]& sw_flux_dn,
+                Array[TF,d2]& sw_flux_dn_dir, Array[TF,d2]& sw_flux_net,
+                Array[TF,d3]& sw_bnd_flux_up, Array[TF,d3]& sw_bnd_flux_dn,
+                Array[TF,d3]& sw_bnd_flux_dn_dir, Array[TF,d3]& sw_bnd_flux_net,
+                const int col_offset) except +
+        int get_n_gpt()
+        int get_n_bnd()
+        double get_tsi()
+        void set_n_col_block(const int) except +
+        int get_n_col_block()
+        void set_deduplicate_columns(const bool)
+        bool get_deduplicate_columns()
+        void set_validation_policy(const Validation_policy)
+        Validation_policy get_validation_policy()
+        void set_incremental(const bool, const Resolve_thresholds[TF]&) except +
+        bool get_incremental()
+        double get_recompute_fraction()
+        void reset_incremental()
+
+
+# Wrap a NumPy array as an Array view, None and empty arrays give an empty Array. The view is set
+# in place, because an assignment would copy it into an Array that owns its data.
+cdef void view_1d(Array[double,d1]& out, double[::1] a) except *:
+    cdef std_array[int,d1] dims
+    if a is None or a.shape[0] == 0:
+        return
+    dims[0] = a.shape[0]
+    out.set_view(&a[0], dims)
+
+
+cdef void view_2d(Array[double,d2]& out, double[:, ::1] a) except *:
+    cdef std_array[int,d2] dims
+    if a is None or a.shape[0]*a.shape[1] == 0:
+        return
+    dims[0], dims[1] = a.shape[1], a.shape[0]
+    out.set_view(&a[0,0], dims)
+
+
+cdef void view_3d(Array[double,d3]& out, double[:, :, ::1] a) except *:
+    cdef std_array[int,d3] dims
+    if a is None or a.shape[0]*a.shape[1]*a.shape[2] == 0:
+        return
+    dims[0], dims[1], dims[2] = a.shape[2], a.shape[1], a.shape[0]
+    out.set_view(&a[0,0,0], dims)
+
+
+# Inputs are converted if needed, outputs are written in place and have to match exactly.
+def _as_input(a):
+    return None if a is None else np.ascontiguousarray(a, dtype=np.float64)
+
+
+def _check_shape(name, a, shape):
+    if a is not None and a.shape != shape:
+        raise ValueError('{} has shape {}, expected {}'.format(name, a.shape, shape))
+
+
+def wrap_arrays(*arrays):
+    """Create and discard Array views of 2D arrays, measures the overhead of the bindings."""
+    cdef Array[double,d2] a_cpp
+    for a in arrays:
+        view_2d(a_cpp, a)
 
 
 cdef class Gas_concs_wrapper:
     cdef Gas_concs[double] gas_concs_cpp
+    cdef dict vmr_arrays
 
-    def set_vmr(self, gas_name, gas_conc):
-        cdef std_string gas_name_cpp = gas_name
-
-        cdef double gas_conc_0d
-
-        cdef Array[double, d1] gas_conc_1d
-        cdef Array[double, d2] gas_conc_2d
-
-        cdef array[int, d1] dims_1d
-        cdef array[int, d1] index_1d
-
-        cdef array[int, d2] dims_2d
-        cdef array[int, d2] index_2d
-
-        cdef double* gas_conc_ptr
+    def __cinit__(self):
+        self.vmr_arrays = {}
 
-        if isinstance(gas_conc, np.ndarray):
+    @property
+    def validation(self):
+        """Checking of the gas concentrations in set_vmr: 'full', 'fused' or 'off'."""
+        return to_validation_name(self.gas_concs_cpp.get_validation_policy())
 
-            if len(gas_conc.shape) == 0:
-                gas_conc_0d = gas_conc
-                self.gas_concs_cpp.set_vmr(gas_name_cpp, gas_conc_0d)
+    @validation.setter
+    def validation(self, name):
+        self.gas_concs_cpp.set_validation_policy(to_validation_policy(name))
 
-            elif len(gas_conc.shape) == 1:
-                dims_1d[0] = gas_conc.shape[0]
-                gas_conc_1d.set_dims(dims_1d)
-
-                # Adjust for the Fortran indexing used in Array.
-                for ilev in range(gas_conc.shape[0]):
-                    index_1d[0] = ilev+1
-                    gas_conc_ptr = &gas_conc_1d(index_1d)
-                    gas_conc_ptr[0] = gas_conc[ilev]
-
-                self.gas_concs_cpp.set_vmr(gas_name_cpp, gas_conc_1d)
-
-            elif len(gas_conc.shape) == 2:
-                dims_2d[0] = gas_conc.shape[1]
-                dims_2d[1] = gas_conc.shape[0]
-
-                gas_conc_2d.set_dims(dims_2d)
-
-                # Adjust for the Fortran indexing used in Array.
-                for ilev in range(gas_conc.shape[0]):
-                    for icol in range(gas_conc.shape[1]):
-                        index_2d[0] = icol+1
-                        index_2d[1] = ilev+1
-                        gas_conc_ptr = &gas_conc_2d(index_2d)
-                        gas_conc_ptr[0] = gas_conc[ilev, icol]
-
-                self.gas_concs_cpp.set_vmr(gas_name_cpp, gas_conc_2d)
-
-            else:
-                raise RuntimeError('Illegal shape dimension')
-        
+    def set_vmr(self, gas_name, gas_conc):
+        """Set the volume mixing ratio as a scalar, a profile (nlay) or a field (nlay, ncol).
+        A C-contiguous float64 field is stored as a view without copying, so later changes of
+        the array are seen by the solvers. Other fields are converted once. Scalars and profiles
+        are expanded to a field, and the gas concentrations keep their own copy of these."""
+        cdef std_string gas_name_cpp = gas_name.encode() if isinstance(gas_name, str) else gas_name
+        cdef Array[double,d1] gas_conc_1d
+        cdef Array[double,d2] gas_conc_2d
+
+        a = np.ascontiguousarray(gas_conc, dtype=np.float64)
+
+        if a.ndim == 0:
+            self.gas_concs_cpp.set_vmr(gas_name_cpp, <double>a)
+            self.vmr_arrays.pop(gas_name_cpp, None)
+        elif a.ndim == 1:
+            view_1d(gas_conc_1d, a)
+            self.gas_concs_cpp.set_vmr(gas_name_cpp, gas_conc_1d)
+            self.vmr_arrays.pop(gas_name_cpp, None)
+        elif a.ndim == 2:
+            view_2d(gas_conc_2d, a)
+            self.gas_concs_cpp.set_vmr_view(gas_name_cpp, gas_conc_2d)
+            # Keep the array alive as long as the view is stored.
+            self.vmr_arrays[gas_name_cpp] = a
         else:
-            raise RuntimeError('Illegal input')
+            raise ValueError('Illegal shape dimension')
 
 
-cdef class Radiation_solver_wrapper:
+cdef class Radiation_solver_longwave_wrapper:
     cdef Radiation_solver_longwave[double]* rad
 
     def __cinit__(
-            self, Gas_concs_wrapper gas_concs, file_name):
-
-        cdef std_string file_name_cpp = file_name
-        self.rad = new Radiation_solver_longwave[double](gas_concs.gas_concs_cpp, file_name_cpp)
+            self, Gas_concs_wrapper gas_concs, file_name_gas, file_name_cloud,
+            switch_mixed_precision=False):
+        cdef std_string file_name_gas_cpp = file_name_gas.encode() if isinstance(file_name_gas, str) else file_name_gas
+        cdef std_string file_name_cloud_cpp = file_name_cloud.encode() if isinstance(file_name_cloud, str) else file_name_cloud
+        self.rad = new Radiation_solver_longwave[double](
+                gas_concs.gas_concs_cpp, file_name_gas_cpp, file_name_cloud_cpp, switch_mixed_precision)
 
     def __dealloc__(self):
         del self.rad
 
+    @property
+    def n_gpt(self):
+        return self.rad.get_n_gpt()
+
+    @property
+    def n_bnd(self):
+        return self.rad.get_n_bnd()
+
+    @property
+    def n_col_block(self):
+        return self.rad.get_n_col_block()
+
+    @n_col_block.setter
+    def n_col_block(self, int n_col_block):
+        self.rad.set_n_col_block(n_col_block)
+
+    @property
+    def deduplicate_columns(self):
+        return self.rad.get_deduplicate_columns()
+
+    @deduplicate_columns.setter
+    def deduplicate_columns(self, bint deduplicate_columns):
+        self.rad.set_deduplicate_columns(deduplicate_columns)
+
+    @property
+    def validation(self):
+        """Checking of the inputs of the gas optics: 'full', 'fused' (one pass) or 'off'."""
+        return to_validation_name(self.rad.get_validation_policy())
+
+    @validation.setter
+    def validation(self, name):
+        self.rad.set_validation_policy(to_validation_policy(name))
+
+    def set_incremental(
+            self, bint incremental, double temperature=0., double pressure=0., double vmr_relative=0.,
+            double water_path=0., double effective_radius=0., double boundary=0.):
+        cdef Resolve_thresholds[double] thresholds
+        thresholds.temperature = temperature
+        thresholds.pressure = pressure
+        thresholds.vmr_relative = vmr_relative
+        thresholds.water_path = water_path
+        thresholds.effective_radius = effective_radius
+        thresholds.boundary = boundary
+        self.rad.set_incremental(incremental, thresholds)
+
+    @property
+    def incremental(self):
+        return self.rad.get_incremental()
+
+    @property
+    def recompute_fraction(self):
+        return self.rad.get_recompute_fraction()
+
+    def reset_incremental(self):
+        self.rad.reset_incremental()
+
     def solve(
             self,
-            sw_output_optical,
-            sw_output_bnd_fluxes,
             Gas_concs_wrapper gas_concs,
-            np.ndarray[double, ndim=2, mode="c"] p_lay not None,
-            np.ndarray[double, ndim=2, mode="c"] p_lev not None,
-            np.ndarray[double, ndim=2, mode="c"] t_lay not None,
-            np.ndarray[double, ndim=2, mode="c"] t_lev not None,
-            np.ndarray[double, ndim=2, mode="c"] col_dry not None,
-            np.ndarray[double, ndim=1, mode="c"] t_sfc not None,
-            np.ndarray[double, ndim=2, mode="c"] emis_sfc not None,
-            np.ndarray[double, ndim=3, mode="c"] tau not None,
-            np.ndarray[double, ndim=3, mode="c"] lay_source not None,
-            np.ndarray[double, ndim=3, mode="c"] lev_source_inc not None,
-            np.ndarray[double, ndim=3, mode="c"] lev_source_dec not None,
-            np.ndarray[double, ndim=2, mode="c"] sfc_source not None,
-            np.ndarray[double, ndim=2, mode="c"] lw_flux_up not None,
-            np.ndarray[double, ndim=2, mode="c"] lw_flux_dn not None,
-            np.ndarray[double, ndim=2, mode="c"] lw_flux_net not None,
-            np.ndarray[double, ndim=3, mode="c"] lw_bnd_flux_up not None,
-            np.ndarray[double, ndim=3, mode="c"] lw_bnd_flux_dn not None,
-            np.ndarray[double, ndim=3, mode="c"] lw_bnd_flux_net not None):
-
-        ncol = p_lay.shape[1]
-        nlay = p_lay.shape[0]
+            p_lay, p_lev, t_lay, t_lev,
+            t_sfc, emis_sfc,
+            lw_flux_up, lw_flux_dn, lw_flux_net,
+            col_dry=None,
+            lwp=None, iwp=None, rel=None, rei=None,
+            tau=None, lay_source=None, lev_source_inc=None, lev_source_dec=None, sfc_source=None,
+            lw_bnd_flux_up=None, lw_bnd_flux_dn=None, lw_bnd_flux_net=None,
+            lw_flux_up_jac=None,
+            int col_offset=0):
+        """Solve the longwave fluxes into the provided output arrays. The clouds, optical
+        properties, band fluxes and Jacobian are switched on by providing their arrays. In the
+        incremental mode, col_offset keys the cached state of the passed columns."""
+        p_lay, p_lev, t_lay, t_lev, t_sfc, emis_sfc, col_dry, lwp, iwp, rel, rei = [
+                _as_input(a) for a in (p_lay, p_lev, t_lay, t_lev, t_sfc, emis_sfc, col_dry, lwp, iwp, rel, rei)]
+
+        nlay, ncol = p_lay.shape
         nlev = p_lev.shape[0]
-
-        nbnd = emis_sfc.shape[1]
+        ngpt = self.rad.get_n_gpt()
+        nbnd = self.rad.get_n_bnd()
+
+        for name, a, shape in [
+                ('p_lev', p_lev, (nlev, ncol)), ('t_lay', t_lay, (nlay, ncol)), ('t_lev', t_lev, (nlev, ncol)),
+                ('t_sfc', t_sfc, (ncol,)), ('emis_sfc', emis_sfc, (ncol, nbnd)), ('col_dry', col_dry, (nlay, ncol)),
+                ('lwp', lwp, (nlay, ncol)), ('iwp', iwp, (nlay, ncol)),
+                ('rel', rel, (nlay, ncol)), ('rei', rei, (nlay, ncol)),
+                ('lw_flux_up', lw_flux_up, (nlev, ncol)), ('lw_flux_dn', lw_flux_dn, (nlev, ncol)),
+                ('lw_flux_net', lw_flux_net, (nlev, ncol)),
+                ('tau', tau, (ngpt, nlay, ncol)), ('lay_source', lay_source, (ngpt, nlay, ncol)),
+                ('lev_source_inc', lev_source_inc, (ngpt, nlay, ncol)),
+                ('lev_source_dec', lev_source_dec, (ngpt, nlay, ncol)),
+                ('sfc_source', sfc_source, (ngpt, ncol)),
+                ('lw_bnd_flux_up', lw_bnd_flux_up, (nbnd, nlev, ncol)),
+                ('lw_bnd_flux_dn', lw_bnd_flux_dn, (nbnd, nlev, ncol)),
+                ('lw_bnd_flux_net', lw_bnd_flux_net, (nbnd, nlev, ncol)),
+                ('lw_flux_up_jac', lw_flux_up_jac, (nlev, ncol)) ]:
+            _check_shape(name, a, shape)
+
+        cdef bool switch_cloud_optics = lwp is not None
+        cdef bool switch_output_optical = tau is not None
+        cdef bool switch_output_bnd_fluxes = lw_bnd_flux_up is not None
+        cdef bool switch_output_jacobian = lw_flux_up_jac is not None
 
         cdef Array[double,d2] p_lay_cpp, p_lev_cpp, t_lay_cpp, t_lev_cpp, col_dry_cpp
-        cdef Array[double,d1] t_sfc_cpp,
+        cdef Array[double,d1] t_sfc_cpp
         cdef Array[double,d2] emis_sfc_cpp
+        cdef Array[double,d2] lwp_cpp, iwp_cpp, rel_cpp, rei_cpp
         cdef Array[double,d3] tau_cpp, lay_source_cpp, lev_source_inc_cpp, lev_source_dec_cpp
         cdef Array[double,d2] sfc_source_cpp
         cdef Array[double,d2] lw_flux_up_cpp, lw_flux_dn_cpp, lw_flux_net_cpp
         cdef Array[double,d3] lw_bnd_flux_up_cpp, lw_bnd_flux_dn_cpp, lw_bnd_flux_net_cpp
+        cdef Array[double,d2] lw_flux_up_jac_cpp
+
+        view_2d(p_lay_cpp, p_lay)
+        view_2d(p_lev_cpp, p_lev)
+        view_2d(t_lay_cpp, t_lay)
+        view_2d(t_lev_cpp, t_lev)
+        view_2d(col_dry_cpp, col_dry)
+        view_1d(t_sfc_cpp, t_sfc)
+        view_2d(emis_sfc_cpp, emis_sfc)
+        view_2d(lwp_cpp, lwp)
+        view_2d(iwp_cpp, iwp)
+        view_2d(rel_cpp, rel)
+        view_2d(rei_cpp, rei)
+        view_3d(tau_cpp, tau)
+        view_3d(lay_source_cpp, lay_source)
+        view_3d(lev_source_inc_cpp, lev_source_inc)
+        view_3d(lev_source_dec_cpp, lev_source_dec)
+        view_2d(sfc_source_cpp, sfc_source)
+        view_2d(lw_flux_up_cpp, lw_flux_up)
+        view_2d(lw_flux_dn_cpp, lw_flux_dn)
+        view_2d(lw_flux_net_cpp, lw_flux_net)
+        view_3d(lw_bnd_flux_up_cpp, lw_bnd_flux_up)
+        view_3d(lw_bnd_flux_dn_cpp, lw_bnd_flux_dn)
+        view_3d(lw_bnd_flux_net_cpp, lw_bnd_flux_net)
+        view_2d(lw_flux_up_jac_cpp, lw_flux_up_jac)
+
+        cdef Gas_concs[double]* gas_concs_cpp = &gas_concs.gas_concs_cpp
+
+        with nogil:
+            self.rad.solve(
+                    True,
+                    switch_cloud_optics,
+                    switch_output_optical,
+                    switch_output_bnd_fluxes,
+                    switch_output_jacobian,
+                    gas_concs_cpp[0],
+                    p_lay_cpp, p_lev_cpp,
+                    t_lay_cpp, t_lev_cpp,
+                    col_dry_cpp,
+                    t_sfc_cpp, emis_sfc_cpp,
+                    lwp_cpp, iwp_cpp,
+                    rel_cpp, rei_cpp,
+                    tau_cpp, lay_source_cpp,
+                    lev_source_inc_cpp, lev_source_dec_cpp, sfc_source_cpp,
+                    lw_flux_up_cpp, lw_flux_dn_cpp, lw_flux_net_cpp,
+                    lw_bnd_flux_up_cpp, lw_bnd_flux_dn_cpp, lw_bnd_flux_net_cpp,
+                    lw_flux_up_jac_cpp,
+                    col_offset)
+
+
+cdef class Radiation_solver_shortwave_wrapper:
+    cdef Radiation_solver_shortwave[double]* rad
 
-        cdef array[int,d2] d_ncol_nlay
-        d_ncol_nlay[0], d_ncol_nlay[1] = ncol, nlay
-
-        cdef array[int,d2] d_ncol_nlev
-        d_ncol_nlev[0], d_ncol_nlev[1] = ncol, nlev
-
-        cdef array[int,d1] d_ncol
-        d_ncol[0] = ncol
-
-        cdef array[int,d2] d_nbnd_ncol
-        d_nbnd_ncol[0], d_nbnd_ncol[1] = nbnd, ncol
-
-        p_lay_cpp.set_dims(d_ncol_nlay)
-        p_lev_cpp.set_dims(d_ncol_nlev)
-        t_lay_cpp.set_dims(d_ncol_nlay)
-        t_lev_cpp.set_dims(d_ncol_nlev)
-        if (col_dry.size > 0):
-            col_dry_cpp.set_dims(d_ncol_nlay)
-        t_sfc_cpp.set_dims(d_ncol)
-        emis_sfc_cpp.set_dims(d_nbnd_ncol)
-        lw_flux_up_cpp.set_dims(d_ncol_nlev)
-        lw_flux_dn_cpp.set_dims(d_ncol_nlev)
-        lw_flux_net_cpp.set_dims(d_ncol_nlev)
-
-        copy_raw(&p_lay[0,0], p_lay_cpp.ptr(), p_lay.size)
-        copy_raw(&p_lev[0,0], p_lev_cpp.ptr(), p_lev.size)
-        copy_raw(&t_lay[0,0], t_lay_cpp.ptr(), t_lay.size)
-        copy_raw(&t_lev[0,0], t_lev_cpp.ptr(), t_lev.size)
-        if (col_dry.size > 0):
-            copy_raw(&col_dry[0,0], col_dry_cpp.ptr(), col_dry.size)
-        copy_raw(&t_sfc[0], t_sfc_cpp.ptr(), t_sfc.size)
-        copy_raw(&emis_sfc[0,0], emis_sfc_cpp.ptr(), emis_sfc.size)
-
-        self.rad.solve(
-                sw_output_optical,
-                sw_output_bnd_fluxes,
-                gas_concs.gas_concs_cpp,
-                p_lay_cpp, p_lev_cpp,
-                t_lay_cpp, t_lev_cpp,
-                col_dry_cpp,
-                t_sfc_cpp, emis_sfc_cpp,
-                tau_cpp, lay_source_cpp,
-                lev_source_inc_cpp, lev_source_dec_cpp, sfc_source_cpp,
-                lw_flux_up_cpp, lw_flux_dn_cpp, lw_flux_net_cpp,
-                lw_bnd_flux_up_cpp, lw_bnd_flux_dn_cpp, lw_bnd_flux_net_cpp)
-
-        copy_raw(lw_flux_up_cpp .ptr(), &lw_flux_up [0,0], lw_flux_up .size)
-        copy_raw(lw_flux_dn_cpp .ptr(), &lw_flux_dn [0,0], lw_flux_dn .size)
-        copy_raw(lw_flux_net_cpp.ptr(), &lw_flux_net[0,0], lw_flux_net.size)
+    def __cinit__(
+            self, Gas_concs_wrapper gas_concs, file_name_gas, file_name_cloud,
+            switch_mixed_precision=False):
+        cdef std_string file_name_gas_cpp = file_name_gas.encode() if isinstance(file_name_gas, str) else file_name_gas
+        cdef std_string file_name_cloud_cpp = file_name_cloud.encode() if isinstance(file_name_cloud, str) else file_name_cloud
+        self.rad = new Radiation_solver_shortwave[double](
+                gas_concs.gas_concs_cpp, file_name_gas_cpp, file_name_cloud_cpp, switch_mixed_precision)
+
+    def __dealloc__(self):
+        del self.rad
+
+    @property
+    def n_gpt(self):
+        return self.rad.get_n_gpt()
+
+    @property
+    def n_bnd(self):
+        return self.rad.get_n_bnd()
+
+    @property
+    def tsi(self):
+        return self.rad.get_tsi()
+
+    @property
+    def n_col_block(self):
+        return self.rad.get_n_col_block()
+
+    @n_col_block.setter
+    def n_col_block(self, int n_col_block):
+        self.rad.set_n_col_block(n_col_block)
+
+    @property
+    def deduplicate_columns(self):
+        return self.rad.get_deduplicate_columns()
+
+    @deduplicate_columns.setter
+    def deduplicate_columns(self, bint deduplicate_columns):
+        self.rad.set_deduplicate_columns(deduplicate_columns)
+
+    @property
+    def validation(self):
+        """Checking of the inputs of the gas optics: 'full', 'fused' (one pass) or 'off'."""
+        return to_validation_name(self.rad.get_validation_policy())
+
+    @validation.setter
+    def validation(self, name):
+        self.rad.set_validation_policy(to_validation_policy(name))
+
+    def set_incremental(
+            self, bint incremental, double temperature=0., double pressure=0., double vmr_relative=0.,
+            double water_path=0., double effective_radius=0., double boundary=0.):
+        cdef Resolve_thresholds[double] thresholds
+        thresholds.temperature = temperature
+        thresholds.pressure = pressure
+        thresholds.vmr_relative = vmr_relative
+        thresholds.water_path = water_path
+        thresholds.effective_radius = effective_radius
+        thresholds.boundary = boundary
+        self.rad.set_incremental(incremental, thresholds)
+
+    @property
+    def incremental(self):
+        return self.rad.get_incremental()
+
+    @property
+    def recompute_fraction(self):
+        return self.rad.get_recompute_fraction()
+
+    def reset_incremental(self):
+        self.rad.reset_incremental()
 
+    def solve(
+            self,
+            Gas_concs_wrapper gas_concs,
+            p_lay, p_lev, t_lay, t_lev,
+            sfc_alb_dir, sfc_alb_dif, mu0,
+            sw_flux_up, sw_flux_dn, sw_flux_dn_dir, sw_flux_net,
+            tsi_scaling=None,
+            col_dry=None,
+            lwp=None, iwp=None, rel=None, rei=None,
+            tau=None, ssa=None, g=None, toa_src=None,
+            sw_bnd_flux_up=None, sw_bnd_flux_dn=None, sw_bnd_flux_dn_dir=None, sw_bnd_flux_net=None,
+            int col_offset=0):
+        """Solve the shortwave fluxes into the provided output arrays. The clouds, optical
+        properties and band fluxes are switched on by providing their arrays. In the
+        incremental mode, col_offset keys the cached state of the passed columns."""
+        nlay, ncol = p_lay.shape
+        nlev = p_lev.shape[0]
+        ngpt = self.rad.get_n_gpt()
+        nbnd = self.rad.get_n_bnd()
+
+        if tsi_scaling is None:
+            tsi_scaling = np.ones(ncol)
+
+        p_lay, p_lev, t_lay, t_lev, sfc_alb_dir, sfc_alb_dif, mu0, tsi_scaling, col_dry, lwp, iwp, rel, rei = [
+                _as_input(a) for a in (
+                    p_lay, p_lev, t_lay, t_lev, sfc_alb_dir, sfc_alb_dif, mu0, tsi_scaling, col_dry, lwp, iwp, rel, rei)]
+
+        for name, a, shape in [
+                ('p_lev', p_lev, (nlev, ncol)), ('t_lay', t_lay, (nlay, ncol)), ('t_lev', t_lev, (nlev, ncol)),
+                ('sfc_alb_dir', sfc_alb_dir, (ncol, nbnd)), ('sfc_alb_dif', sfc_alb_dif, (ncol, nbnd)),
+                ('mu0', mu0, (ncol,)), ('tsi_scaling', tsi_scaling, (ncol,)), ('col_dry', col_dry, (nlay, ncol)),
+                ('lwp', lwp, (nlay, ncol)), ('iwp', iwp, (nlay, ncol)),
+                ('rel', rel, (nlay, ncol)), ('rei', rei, (nlay, ncol)),
+                ('sw_flux_up', sw_flux_up, (nlev, ncol)), ('sw_flux_dn', sw_flux_dn, (nlev, ncol)),
+                ('sw_flux_dn_dir', sw_flux_dn_dir, (nlev, ncol)), ('sw_flux_net', sw_flux_net, (nlev, ncol)),
+                ('tau', tau, (ngpt, nlay, ncol)), ('ssa', ssa, (ngpt, nlay, ncol)),
+                ('g', g, (ngpt, nlay, ncol)), ('toa_src', toa_src, (ngpt, ncol)),
+                ('sw_bnd_flux_up', sw_bnd_flux_up, (nbnd, nlev, ncol)),
+                ('sw_bnd_flux_dn', sw_bnd_flux_dn, (nbnd, nlev, ncol)),
+                ('sw_bnd_flux_dn_dir', sw_bnd_flux_dn_dir, (nbnd, nlev, ncol)),
+                ('sw_bnd_flux_net', sw_bnd_flux_net, (nbnd, nlev, ncol)) ]:
+            _check_shape(name, a, shape)
+
+        cdef bool switch_cloud_optics = lwp is not None
+        cdef bool switch_output_optical = tau is not None
+        cdef bool switch_output_bnd_fluxes = sw_bnd_flux_up is not None
+
+        cdef Array[double,d2] p_lay_cpp, p_lev_cpp, t_lay_cpp, t_lev_cpp, col_dry_cpp
+        cdef Array[double,d2] sfc_alb_dir_cpp, sfc_alb_dif_cpp
+        cdef Array[double,d1] tsi_scaling_cpp, mu0_cpp
+        cdef Array[double,d2] lwp_cpp, iwp_cpp, rel_cpp, rei_cpp
+        cdef Array[double,d3] tau_cpp, ssa_cpp, g_cpp
+        cdef Array[double,d2] toa_src_cpp
+        cdef Array[double,d2] sw_flux_up_cpp, sw_flux_dn_cpp, sw_flux_dn_dir_cpp, sw_flux_net_cpp
+        cdef Array[double,d3] sw_bnd_flux_up_cpp, sw_bnd_flux_dn_cpp, sw_bnd_flux_dn_dir_cpp, sw_bnd_flux_net_cpp
+
+        view_2d(p_lay_cpp, p_lay)
+        view_2d(p_lev_cpp, p_lev)
+        view_2d(t_lay_cpp, t_lay)
+        view_2d(t_lev_cpp, t_lev)
+        view_2d(col_dry_cpp, col_dry)
+        view_2d(sfc_alb_dir_cpp, sfc_alb_dir)
+        view_2d(sfc_alb_dif_cpp, sfc_alb_dif)
+        view_1d(tsi_scaling_cpp, tsi_scaling)
+        view_1d(mu0_cpp, mu0)
+        view_2d(lwp_cpp, lwp)
+        view_2d(iwp_cpp, iwp)
+        view_2d(rel_cpp, rel)
+        view_2d(rei_cpp, rei)
+        view_3d(tau_cpp, tau)
+        view_3d(ssa_cpp, ssa)
+        view_3d(g_cpp, g)
+        view_2d(toa_src_cpp, toa_src)
+        view_2d(sw_flux_up_cpp, sw_flux_up)
+        view_2d(sw_flux_dn_cpp, sw_flux_dn)
+        view_2d(sw_flux_dn_dir_cpp, sw_flux_dn_dir)
+        view_2d(sw_flux_net_cpp, sw_flux_net)
+        view_3d(sw_bnd_flux_up_cpp, sw_bnd_flux_up)
+        view_3d(sw_bnd_flux_dn_cpp, sw_bnd_flux_dn)
+        view_3d(sw_bnd_flux_dn_dir_cpp, sw_bnd_flux_dn_dir)
+        view_3d(sw_bnd_flux_net_cpp, sw_bnd_flux_net)
+
+        cdef Gas_concs[double]* gas_concs_cpp = &gas_concs.gas_concs_cpp
+
+        with nogil:
+            self.rad.solve(
+                    True,
+                    switch_cloud_optics,
+                    switch_output_optical,
+                    switch_output_bnd_fluxes,
+                    gas_concs_cpp[0],
+                    p_lay_cpp, p_lev_cpp,
+                    t_lay_cpp, t_lev_cpp,
+                    col_dry_cpp,
+                    sfc_alb_dir_cpp, sfc_alb_dif_cpp,
+                    tsi_scaling_cpp, mu0_cpp,
+                    lwp_cpp, iwp_cpp,
+                    rel_cpp, rei_cpp,
+                    tau_cpp, ssa_cpp, g_cpp,
+                    toa_src_cpp,
+                    sw_flux_up_cpp, sw_flux_dn_cpp,
+                    sw_flux_dn_dir_cpp, sw_flux_net_cpp,
+                    sw_bnd_flux_up_cpp, sw_bnd_flux_dn_cpp,
+                    sw_bnd_flux_dn_dir_cpp, sw_bnd_flux_net_cpp,
+                    col_offset)
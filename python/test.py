@@ -8,77 +8,67 @@ import radiation
 # Read the input data.
 nc_file = nc.Dataset('rte_rrtmgp_input.nc', 'r')
 
-vmr_h2o = nc_file.variables['vmr_h2o'][:]
-vmr_co2 = nc_file.variables['vmr_co2'][:]
-vmr_o3  = nc_file.variables['vmr_o3' ][:]
-vmr_n2o = nc_file.variables['vmr_n2o'][:]
-# vmr_co  = nc_file.variables['vmr_co' ][:]
-vmr_ch4 = nc_file.variables['vmr_ch4'][:]
-vmr_o2  = nc_file.variables['vmr_o2' ][:]
-vmr_n2  = nc_file.variables['vmr_n2' ][:]
-
 gas_concs = radiation.Gas_concs_wrapper()
 
 # Load the gas concentrations.
-gas_concs.set_vmr(b'h2o', vmr_h2o)
-gas_concs.set_vmr(b'co2', vmr_co2)
-gas_concs.set_vmr(b'o3' , vmr_o3 )
-gas_concs.set_vmr(b'n2o', vmr_n2o)
-# gas_concs.set_vmr(b'co' , vmr_co )
-gas_concs.set_vmr(b'ch4', vmr_ch4)
-gas_concs.set_vmr(b'o2' , vmr_o2 )
-gas_concs.set_vmr(b'n2' , vmr_n2 )
+for name, var in nc_file.variables.items():
+    if name.startswith('vmr_'):
+        gas_concs.set_vmr(name[4:], var[...])
 
 
-# Load the thermodynamic variables.
-p_lay = nc_file.variables['lay'][:]
-p_lev = nc_file.variables['lev'][:]
-t_lay = nc_file.variables['t_lay'][:]
-t_lev = nc_file.variables['t_lev'][:]
+# Load the thermodynamic variables and the surface properties.
+def read(name):
+    return np.ascontiguousarray(nc_file.variables[name][:], dtype=np.float64)
 
-t_sfc = nc_file.variables['t_sfc'][:]
-emis_sfc = nc_file.variables['emis_sfc'][:]
+p_lay = read('p_lay')
+p_lev = read('p_lev')
+t_lay = read('t_lay')
+t_lev = read('t_lev')
 
-nc_file.close()
+t_sfc = read('t_sfc')
+emis_sfc = read('emis_sfc')
 
-col_dry = np.zeros((0,0))
+sfc_alb_dir = read('sfc_alb_dir')
+sfc_alb_dif = read('sfc_alb_dif')
+mu0 = read('mu0')
 
+nc_file.close()
 
-# Create the output arrays.
-tau = np.zeros((0,0,0))
-lay_source = np.zeros((0,0,0))
-lev_source_inc = np.zeros((0,0,0))
-lev_source_dec = np.zeros((0,0,0))
-sfc_source = np.zeros((0,0))
 
+# Create the output arrays, the solvers write into them without copying.
 lw_flux_up  = np.zeros(p_lev.shape)
 lw_flux_dn  = np.zeros(p_lev.shape)
 lw_flux_net = np.zeros(p_lev.shape)
-lw_bnd_flux_up  = np.zeros((0,0,0))
-lw_bnd_flux_dn  = np.zeros((0,0,0))
-lw_bnd_flux_net = np.zeros((0,0,0))
+
+sw_flux_up     = np.zeros(p_lev.shape)
+sw_flux_dn     = np.zeros(p_lev.shape)
+sw_flux_dn_dir = np.zeros(p_lev.shape)
+sw_flux_net    = np.zeros(p_lev.shape)
 
 
-# Initialize the solver.
-rad = radiation.Radiation_solver_wrapper(gas_concs, b'coefficients_lw.nc')
+# Initialize the solvers.
+rad_lw = radiation.Radiation_solver_longwave_wrapper(
+        gas_concs, 'coefficients_lw.nc', 'cloud_coefficients_lw.nc')
+rad_sw = radiation.Radiation_solver_shortwave_wrapper(
+        gas_concs, 'coefficients_sw.nc', 'cloud_coefficients_sw.nc')
 
 
 # Solve the radiation fluxes.
 start = timeit.default_timer()
 
-rad.solve(
-        False,
-        False,
+rad_lw.solve(
         gas_concs,
         p_lay, p_lev,
         t_lay, t_lev,
-        col_dry,
         t_sfc, emis_sfc,
-        tau, lay_source,
-        lev_source_inc, lev_source_dec,
-        sfc_source,
-        lw_flux_up, lw_flux_dn, lw_flux_net,
-        lw_bnd_flux_up, lw_bnd_flux_dn, lw_bnd_flux_net)
+        lw_flux_up, lw_flux_dn, lw_flux_net)
+
+rad_sw.solve(
+        gas_concs,
+        p_lay, p_lev,
+        t_lay, t_lev,
+        sfc_alb_dir, sfc_alb_dif, mu0,
+        sw_flux_up, sw_flux_dn, sw_flux_dn_dir, sw_flux_net)
 
 end = timeit.default_timer()
 print('Duration: {} s'.format(end-start))
@@ -88,6 +78,8 @@ print('Duration: {} s'.format(end-start))
 plt.figure()
 plt.plot(lw_flux_up[:,0], p_lev[:,0], label='lw_flux_up')
 plt.plot(lw_flux_dn[:,0], p_lev[:,0], label='lw_flux_dn')
+plt.plot(sw_flux_up[:,0], p_lev[:,0], label='sw_flux_up')
+plt.plot(sw_flux_dn[:,0], p_lev[:,0], label='sw_flux_dn')
 plt.legend(loc=0, frameon=False)
 plt.gca().invert_yaxis()
 plt.xlabel(r'flux (W m-2)')
@@ -2,6 +2,7 @@ import numpy as np
 import netCDF4 as nc
 import shutil
 import subprocess
+import sys
 
 
 expts = 18
@@ -10,7 +11,8 @@ expts = 18
 # Run the experiments.
 for expt in range(expts):
     shutil.copyfile('rte_rrtmgp_input_expt_{:02d}.nc'.format(expt), 'rte_rrtmgp_input.nc')
-    subprocess.run(['./test_rte_rrtmgp'])
+    # Pass extra arguments, such as --mixed-precision, to the solver.
+    subprocess.run(['./test_rte_rrtmgp'] + sys.argv[1:])
     shutil.move('rte_rrtmgp_output.nc', 'rte_rrtmgp_output_expt_{:02d}.nc'.format(expt))
     print(' ')
 
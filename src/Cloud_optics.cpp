@@ -22,7 +22,10 @@
  *
  */
 
+#include <limits>
+
 #include "Cloud_optics.h"
+#include "Instrumentation.h"
 
 template<typename TF>
 Cloud_optics<TF>::Cloud_optics(
@@ -116,6 +119,10 @@ void Cloud_optics<TF>::cloud_optics(
     const int nlay = clwp.dim(2);
     const int nbnd = this->get_nband();
 
+    Instrumentation::Scoped_timer timer(
+            Instrumentation::Stage::Cloud_optics,
+            [&]() { return Instrumentation::get_bytes(clwp, ciwp, reliq, reice, optical_props.get_tau()); });
+
     Optical_props_2str<TF> clouds_liq(ncol, nlay, optical_props);
     Optical_props_2str<TF> clouds_ice(ncol, nlay, optical_props);
 
@@ -123,11 +130,11 @@ void Cloud_optics<TF>::cloud_optics(
     constexpr TF mask_min_value = TF(0.);
     Array<BOOL_TYPE,2> liqmsk({ncol, nlay});
     for (int i=0; i<liqmsk.size(); ++i)
-        liqmsk.v()[i] = clwp.v()[i] > mask_min_value;
+        liqmsk.v()[i] = clwp.ptr()[i] > mask_min_value;
 
     Array<BOOL_TYPE,2> icemsk({ncol, nlay});
     for (int i=0; i<icemsk.size(); ++i)
-        icemsk.v()[i] = ciwp.v()[i] > mask_min_value;
+        icemsk.v()[i] = ciwp.ptr()[i] > mask_min_value;
 
     // Temporary arrays for storage.
     Array<TF,3> ltau    ({ncol, nlay, nbnd});
@@ -181,6 +188,10 @@ void Cloud_optics<TF>::cloud_optics(
     const int nlay = clwp.dim(2);
     const int nbnd = this->get_nband();
 
+    Instrumentation::Scoped_timer timer(
+            Instrumentation::Stage::Cloud_optics,
+            [&]() { return Instrumentation::get_bytes(clwp, ciwp, reliq, reice, optical_props.get_tau()); });
+
     Optical_props_1scl<TF> clouds_liq(ncol, nlay, optical_props);
     Optical_props_1scl<TF> clouds_ice(ncol, nlay, optical_props);
 
@@ -188,11 +199,11 @@ void Cloud_optics<TF>::cloud_optics(
     constexpr TF mask_min_value = static_cast<TF>(0.);
     Array<BOOL_TYPE,2> liqmsk({ncol, nlay});
     for (int i=0; i<liqmsk.size(); ++i)
-        liqmsk.v()[i] = clwp.v()[i] > mask_min_value;
+        liqmsk.v()[i] = clwp.ptr()[i] > mask_min_value;
 
     Array<BOOL_TYPE,2> icemsk({ncol, nlay});
     for (int i=0; i<icemsk.size(); ++i)
-        icemsk.v()[i] = ciwp.v()[i] > mask_min_value;
+        icemsk.v()[i] = ciwp.ptr()[i] > mask_min_value;
 
     // Temporary arrays for storage.
     Array<TF,3> ltau    ({ncol, nlay, nbnd});
@@ -230,7 +241,10 @@ void Cloud_optics<TF>::cloud_optics(
             }
 }
 
-#ifdef FLOAT_SINGLE_RRTMGP
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+template class Cloud_optics<float>;
+template class Cloud_optics<double>;
+#elif defined(FLOAT_SINGLE_RRTMGP)
 template class Cloud_optics<float>;
 #else
 template class Cloud_optics<double>;
@@ -0,0 +1,309 @@
+/*
+ * This file is part of a C++ interface to the Radiative Transfer for Energetics (RTE)
+ * and Rapid Radiative Transfer Model for GCM applications Parallel (RRTMGP).
+ *
+ * The original code is found at https://github.com/earth-system-radiation/rte-rrtmgp.
+ *
+ * Contacts: Robert Pincus and Eli Mlawer
+ * email: rrtmgp@aer.com
+ *
+ * Copyright 2015-2020,  Atmospheric and Environmental Research and
+ * Regents of the University of Colorado.  All right reserved.
+ *
+ * This C++ interface can be downloaded from https://github.com/earth-system-radiation/rte-rrtmgp-cpp
+ *
+ * Contact: Chiel van Heerwaarden
+ * email: chiel.vanheerwaarden@wur.nl
+ *
+ * Copyright 2020, Wageningen University & Research.
+ *
+ * Use and duplication is permitted under the terms of the
+ * BSD 3-clause license, see http://opensource.org/licenses/BSD-3-Clause
+ *
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <netcdf.h>
+#include <netcdf_mem.h>
+
+#include "Coefficient_file.h"
+
+namespace
+{
+    void nc_check(const int code, const std::string& name="")
+    {
+        if (code != NC_NOERR)
+            throw std::runtime_error(name.empty() ? nc_strerror(code) : name + ": " + nc_strerror(code));
+    }
+
+    int nc_get_var_wrapper(int ncid, int var_id, double* values) { return nc_get_var_double(ncid, var_id, values); }
+    int nc_get_var_wrapper(int ncid, int var_id, float* values) { return nc_get_var_float(ncid, var_id, values); }
+    int nc_get_var_wrapper(int ncid, int var_id, int* values) { return nc_get_var_int(ncid, var_id, values); }
+    int nc_get_var_wrapper(int ncid, int var_id, signed char* values) { return nc_get_var_schar(ncid, var_id, values); }
+}
+
+Coefficient_file::Coefficient_file(const std::string& file_name)
+{
+    nc_check(nc_open(file_name.c_str(), NC_NOWRITE, &ncid), file_name);
+}
+
+Coefficient_file::Coefficient_file(const void* buffer, const size_t size)
+{
+    nc_check(nc_open_mem("buffer", NC_NOWRITE, size, const_cast<void*>(buffer), &ncid));
+}
+
+Coefficient_file::~Coefficient_file()
+{
+    nc_close(ncid);
+}
+
+int Coefficient_file::get_dimension_size(const std::string& name) const
+{
+    int dim_id;
+    size_t size;
+    nc_check(nc_inq_dimid(ncid, name.c_str(), &dim_id), name);
+    nc_check(nc_inq_dimlen(ncid, dim_id, &size), name);
+    return static_cast<int>(size);
+}
+
+bool Coefficient_file::variable_exists(const std::string& name) const
+{
+    int var_id;
+    return nc_inq_varid(ncid, name.c_str(), &var_id) == NC_NOERR;
+}
+
+Array<std::string,1> Coefficient_file::get_strings(const std::string& name, const int n) const
+{
+    const int var_id = get_var_id(name);
+
+    const size_t total_size = get_var_size(var_id);
+    if (total_size % n != 0)
+        throw std::runtime_error(name + ": size does not match the coefficient dimensions");
+    const size_t string_len = total_size / n;
+
+    std::vector<char> chars(total_size);
+    nc_check(nc_get_var_text(ncid, var_id, chars.data()), name);
+
+    Array<std::string,1> strings({n});
+    for (int i=0; i<n; ++i)
+    {
+        std::string s(chars.begin() + i*string_len, chars.begin() + (i+1)*string_len);
+        s.erase(std::find(s.begin(), s.end(), '\0'), s.end());
+        s.erase(s.find_last_not_of(" \t") + 1);
+        s.erase(0, s.find_first_not_of(" \t"));
+        strings({i+1}) = s;
+    }
+    return strings;
+}
+
+int Coefficient_file::get_var_id(const std::string& name) const
+{
+    int var_id;
+    nc_check(nc_inq_varid(ncid, name.c_str(), &var_id), name);
+    return var_id;
+}
+
+size_t Coefficient_file::get_var_size(const int var_id) const
+{
+    int n_dims;
+    nc_check(nc_inq_varndims(ncid, var_id, &n_dims));
+    std::vector<int> dim_ids(n_dims);
+    nc_check(nc_inq_vardimid(ncid, var_id, dim_ids.data()));
+
+    size_t size = 1;
+    for (const int dim_id : dim_ids)
+    {
+        size_t len;
+        nc_check(nc_inq_dimlen(ncid, dim_id, &len));
+        size *= len;
+    }
+    return size;
+}
+
+namespace
+{
+    template<typename T>
+    void read_variable_checked(
+            const int ncid, const int var_id, const size_t var_size,
+            const std::string& name, T* values, const size_t size)
+    {
+        if (var_size != size)
+            throw std::runtime_error(name + ": size does not match the coefficient dimensions");
+        nc_check(nc_get_var_wrapper(ncid, var_id, values), name);
+    }
+}
+
+void Coefficient_file::read_variable(const std::string& name, double* values, const size_t size) const
+{
+    const int var_id = get_var_id(name);
+    read_variable_checked(ncid, var_id, get_var_size(var_id), name, values, size);
+}
+
+void Coefficient_file::read_variable(const std::string& name, float* values, const size_t size) const
+{
+    const int var_id = get_var_id(name);
+    read_variable_checked(ncid, var_id, get_var_size(var_id), name, values, size);
+}
+
+void Coefficient_file::read_variable(const std::string& name, int* values, const size_t size) const
+{
+    const int var_id = get_var_id(name);
+    read_variable_checked(ncid, var_id, get_var_size(var_id), name, values, size);
+}
+
+void Coefficient_file::read_variable(const std::string& name, signed char* values, const size_t size) const
+{
+    const int var_id = get_var_id(name);
+    read_variable_checked(ncid, var_id, get_var_size(var_id), name, values, size);
+}
+
+template<typename TF>
+std::unique_ptr<Gas_optics_rrtmgp<TF>> load_gas_optics(
+        const Coefficient_file& coef, const Gas_concs<TF>& gas_concs)
+{
+    const int n_temps = coef.get_dimension_size("temperature");
+    const int n_press = coef.get_dimension_size("pressure");
+    const int n_absorbers = coef.get_dimension_size("absorber");
+    const int n_minorabsorbers = coef.get_dimension_size("minor_absorber");
+    const int n_extabsorbers = coef.get_dimension_size("absorber_ext");
+    const int n_mixingfracs = coef.get_dimension_size("mixing_fraction");
+    const int n_layers = coef.get_dimension_size("atmos_layer");
+    const int n_bnds = coef.get_dimension_size("bnd");
+    const int n_gpts = coef.get_dimension_size("gpt");
+    const int n_pairs = coef.get_dimension_size("pair");
+    const int n_minor_lower = coef.get_dimension_size("minor_absorber_intervals_lower");
+    const int n_minor_upper = coef.get_dimension_size("minor_absorber_intervals_upper");
+    const int n_contributors_lower = coef.get_dimension_size("contributors_lower");
+    const int n_contributors_upper = coef.get_dimension_size("contributors_upper");
+
+    const Array<std::string,1> gas_names = coef.get_strings("gas_names", n_absorbers);
+    const Array<int,3> key_species = coef.get_array<int,3>("key_species", {2, n_layers, n_bnds});
+    const Array<TF,2> band_lims = coef.get_array<TF,2>("bnd_limits_wavenumber", {2, n_bnds});
+    const Array<int,2> band2gpt = coef.get_array<int,2>("bnd_limits_gpt", {2, n_bnds});
+    const Array<TF,1> press_ref = coef.get_array<TF,1>("press_ref", {n_press});
+    const Array<TF,1> temp_ref = coef.get_array<TF,1>("temp_ref", {n_temps});
+
+    const TF temp_ref_p = coef.get_scalar<TF>("absorption_coefficient_ref_P");
+    const TF temp_ref_t = coef.get_scalar<TF>("absorption_coefficient_ref_T");
+    const TF press_ref_trop = coef.get_scalar<TF>("press_ref_trop");
+
+    const Array<TF,3> kminor_lower = coef.get_array<TF,3>(
+            "kminor_lower", {n_contributors_lower, n_mixingfracs, n_temps});
+    const Array<TF,3> kminor_upper = coef.get_array<TF,3>(
+            "kminor_upper", {n_contributors_upper, n_mixingfracs, n_temps});
+
+    const Array<std::string,1> gas_minor = coef.get_strings("gas_minor", n_minorabsorbers);
+    const Array<std::string,1> identifier_minor = coef.get_strings("identifier_minor", n_minorabsorbers);
+    const Array<std::string,1> minor_gases_lower = coef.get_strings("minor_gases_lower", n_minor_lower);
+    const Array<std::string,1> minor_gases_upper = coef.get_strings("minor_gases_upper", n_minor_upper);
+
+    const Array<int,2> minor_limits_gpt_lower = coef.get_array<int,2>("minor_limits_gpt_lower", {n_pairs, n_minor_lower});
+    const Array<int,2> minor_limits_gpt_upper = coef.get_array<int,2>("minor_limits_gpt_upper", {n_pairs, n_minor_upper});
+
+    const Array<BOOL_TYPE,1> minor_scales_with_density_lower =
+            coef.get_array<BOOL_TYPE,1>("minor_scales_with_density_lower", {n_minor_lower});
+    const Array<BOOL_TYPE,1> minor_scales_with_density_upper =
+            coef.get_array<BOOL_TYPE,1>("minor_scales_with_density_upper", {n_minor_upper});
+    const Array<BOOL_TYPE,1> scale_by_complement_lower =
+            coef.get_array<BOOL_TYPE,1>("scale_by_complement_lower", {n_minor_lower});
+    const Array<BOOL_TYPE,1> scale_by_complement_upper =
+            coef.get_array<BOOL_TYPE,1>("scale_by_complement_upper", {n_minor_upper});
+
+    const Array<std::string,1> scaling_gas_lower = coef.get_strings("scaling_gas_lower", n_minor_lower);
+    const Array<std::string,1> scaling_gas_upper = coef.get_strings("scaling_gas_upper", n_minor_upper);
+
+    const Array<int,1> kminor_start_lower = coef.get_array<int,1>("kminor_start_lower", {n_minor_lower});
+    const Array<int,1> kminor_start_upper = coef.get_array<int,1>("kminor_start_upper", {n_minor_upper});
+
+    const Array<TF,3> vmr_ref = coef.get_array<TF,3>("vmr_ref", {n_layers, n_extabsorbers, n_temps});
+    const Array<TF,4> kmajor = coef.get_array<TF,4>("kmajor", {n_gpts, n_mixingfracs, n_press+1, n_temps});
+
+    // Keep the size at zero, if it does not exist.
+    Array<TF,3> rayl_lower;
+    Array<TF,3> rayl_upper;
+    if (coef.variable_exists("rayl_lower"))
+    {
+        rayl_lower = coef.get_array<TF,3>("rayl_lower", {n_gpts, n_mixingfracs, n_temps});
+        rayl_upper = coef.get_array<TF,3>("rayl_upper", {n_gpts, n_mixingfracs, n_temps});
+    }
+
+    if (coef.variable_exists("totplnk"))
+    {
+        const int n_internal_sourcetemps = coef.get_dimension_size("temperature_Planck");
+
+        const Array<TF,2> totplnk = coef.get_array<TF,2>("totplnk", {n_internal_sourcetemps, n_bnds});
+        const Array<TF,4> planck_frac = coef.get_array<TF,4>(
+                "plank_fraction", {n_gpts, n_mixingfracs, n_press+1, n_temps});
+
+        return std::make_unique<Gas_optics_rrtmgp<TF>>(
+                gas_concs, gas_names, key_species, band2gpt, band_lims,
+                press_ref, press_ref_trop, temp_ref, temp_ref_p, temp_ref_t,
+                vmr_ref, kmajor, kminor_lower, kminor_upper,
+                gas_minor, identifier_minor, minor_gases_lower, minor_gases_upper,
+                minor_limits_gpt_lower, minor_limits_gpt_upper,
+                minor_scales_with_density_lower, minor_scales_with_density_upper,
+                scaling_gas_lower, scaling_gas_upper,
+                scale_by_complement_lower, scale_by_complement_upper,
+                kminor_start_lower, kminor_start_upper,
+                totplnk, planck_frac, rayl_lower, rayl_upper);
+    }
+    else
+    {
+        const Array<TF,1> solar_src_quiet = coef.get_array<TF,1>("solar_source_quiet", {n_gpts});
+        const Array<TF,1> solar_src_facular = coef.get_array<TF,1>("solar_source_facular", {n_gpts});
+        const Array<TF,1> solar_src_sunspot = coef.get_array<TF,1>("solar_source_sunspot", {n_gpts});
+
+        const TF tsi = coef.get_scalar<TF>("tsi_default");
+        const TF mg_index = coef.get_scalar<TF>("mg_default");
+        const TF sb_index = coef.get_scalar<TF>("sb_default");
+
+        return std::make_unique<Gas_optics_rrtmgp<TF>>(
+                gas_concs, gas_names, key_species, band2gpt, band_lims,
+                press_ref, press_ref_trop, temp_ref, temp_ref_p, temp_ref_t,
+                vmr_ref, kmajor, kminor_lower, kminor_upper,
+                gas_minor, identifier_minor, minor_gases_lower, minor_gases_upper,
+                minor_limits_gpt_lower, minor_limits_gpt_upper,
+                minor_scales_with_density_lower, minor_scales_with_density_upper,
+                scaling_gas_lower, scaling_gas_upper,
+                scale_by_complement_lower, scale_by_complement_upper,
+                kminor_start_lower, kminor_start_upper,
+                solar_src_quiet, solar_src_facular, solar_src_sunspot,
+                tsi, mg_index, sb_index, rayl_lower, rayl_upper);
+    }
+}
+
+template<typename TF>
+std::unique_ptr<Cloud_optics<TF>> load_cloud_optics(const Coefficient_file& coef)
+{
+    const int n_band = coef.get_dimension_size("nband");
+    const int n_rghice = coef.get_dimension_size("nrghice");
+    const int n_size_liq = coef.get_dimension_size("nsize_liq");
+    const int n_size_ice = coef.get_dimension_size("nsize_ice");
+
+    return std::make_unique<Cloud_optics<TF>>(
+            coef.get_array<TF,2>("bnd_limits_wavenumber", {2, n_band}),
+            coef.get_scalar<TF>("radliq_lwr"), coef.get_scalar<TF>("radliq_upr"), coef.get_scalar<TF>("radliq_fac"),
+            coef.get_scalar<TF>("radice_lwr"), coef.get_scalar<TF>("radice_upr"), coef.get_scalar<TF>("radice_fac"),
+            coef.get_array<TF,2>("lut_extliq", {n_size_liq, n_band}),
+            coef.get_array<TF,2>("lut_ssaliq", {n_size_liq, n_band}),
+            coef.get_array<TF,2>("lut_asyliq", {n_size_liq, n_band}),
+            coef.get_array<TF,3>("lut_extice", {n_size_ice, n_band, n_rghice}),
+            coef.get_array<TF,3>("lut_ssaice", {n_size_ice, n_band, n_rghice}),
+            coef.get_array<TF,3>("lut_asyice", {n_size_ice, n_band, n_rghice}));
+}
+
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+template std::unique_ptr<Gas_optics_rrtmgp<float>> load_gas_optics(const Coefficient_file&, const Gas_concs<float>&);
+template std::unique_ptr<Gas_optics_rrtmgp<double>> load_gas_optics(const Coefficient_file&, const Gas_concs<double>&);
+template std::unique_ptr<Cloud_optics<float>> load_cloud_optics(const Coefficient_file&);
+template std::unique_ptr<Cloud_optics<double>> load_cloud_optics(const Coefficient_file&);
+#elif defined(FLOAT_SINGLE_RRTMGP)
+template std::unique_ptr<Gas_optics_rrtmgp<float>> load_gas_optics(const Coefficient_file&, const Gas_concs<float>&);
+template std::unique_ptr<Cloud_optics<float>> load_cloud_optics(const Coefficient_file&);
+#else
+template std::unique_ptr<Gas_optics_rrtmgp<double>> load_gas_optics(const Coefficient_file&, const Gas_concs<double>&);
+template std::unique_ptr<Cloud_optics<double>> load_cloud_optics(const Coefficient_file&);
+#endif
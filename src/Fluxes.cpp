@@ -25,6 +25,7 @@
 #include "Fluxes.h"
 #include "Array.h"
 #include "Optical_props.h"
+#include "Instrumentation.h"
 
 #include "rrtmgp_kernels.h"
 
@@ -35,6 +36,8 @@ namespace rrtmgp_kernel_launcher
             int ncol, int nlev, int ngpt,
             const Array<TF,3>& spectral_flux, Array<TF,2>& broadband_flux)
     {
+        Instrumentation::Scoped_timer timer(Instrumentation::Stage::Flux_reduction, [&]() { return Instrumentation::get_bytes(spectral_flux, broadband_flux); });
+
         rrtmgp_kernels::sum_broadband(
                 &ncol, &nlev, &ngpt,
                 const_cast<TF*>(spectral_flux.ptr()),
@@ -47,6 +50,8 @@ namespace rrtmgp_kernel_launcher
             const Array<TF,2>& broadband_flux_dn, const Array<TF,2>& broadband_flux_up,
             Array<TF,2>& broadband_flux_net)
     {
+        Instrumentation::Scoped_timer timer(Instrumentation::Stage::Flux_reduction, [&]() { return 3*Instrumentation::get_bytes(broadband_flux_net); });
+
         rrtmgp_kernels::net_broadband_precalc(
                 &ncol, &nlev,
                 const_cast<TF*>(broadband_flux_dn.ptr()),
@@ -61,6 +66,8 @@ namespace rrtmgp_kernel_launcher
             const Array<TF,3>& spectral_flux,
             Array<TF,3>& byband_flux)
     {
+        Instrumentation::Scoped_timer timer(Instrumentation::Stage::Flux_reduction, [&]() { return Instrumentation::get_bytes(spectral_flux, byband_flux); });
+
         rrtmgp_kernels::sum_byband(
                 &ncol, &nlev, &ngpt, &nbnd,
                 const_cast<int*>(band_lims.ptr()),
@@ -74,6 +81,8 @@ namespace rrtmgp_kernel_launcher
             const Array<TF,3>& byband_flux_dn, const Array<TF,3>& byband_flux_up,
             Array<TF,3>& byband_flux_net)
     {
+        Instrumentation::Scoped_timer timer(Instrumentation::Stage::Flux_reduction, [&]() { return 3*Instrumentation::get_bytes(byband_flux_net); });
+
         rrtmgp_kernels::net_byband_precalc(
                 &ncol, &nlev, &nband,
                 const_cast<TF*>(byband_flux_dn.ptr()),
@@ -128,6 +137,21 @@ void Fluxes_broadband<TF>::reduce(
             gpt_flux_dn_dir, this->flux_dn_dir);
 }
 
+// The Jacobian is only allocated when it is requested.
+template<typename TF>
+void Fluxes_broadband<TF>::reduce_jacobian(const Array<TF,3>& gpt_flux_up_jac)
+{
+    const int ncol = gpt_flux_up_jac.dim(1);
+    const int nlev = gpt_flux_up_jac.dim(2);
+    const int ngpt = gpt_flux_up_jac.dim(3);
+
+    if (this->flux_up_jac.size() == 0)
+        this->flux_up_jac.set_dims({ncol, nlev});
+
+    rrtmgp_kernel_launcher::sum_broadband(
+            ncol, nlev, ngpt, gpt_flux_up_jac, this->flux_up_jac);
+}
+
 template<typename TF>
 Fluxes_byband<TF>::Fluxes_byband(const int ncol, const int nlev, const int nbnd) :
     Fluxes_broadband<TF>(ncol, nlev),
@@ -195,7 +219,12 @@ void Fluxes_byband<TF>::reduce(
             gpt_flux_dn_dir, this->bnd_flux_dn_dir);
 }
 
-#ifdef FLOAT_SINGLE_RRTMGP
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+template class Fluxes_broadband<float>;
+template class Fluxes_byband<float>;
+template class Fluxes_broadband<double>;
+template class Fluxes_byband<double>;
+#elif defined(FLOAT_SINGLE_RRTMGP)
 template class Fluxes_broadband<float>;
 template class Fluxes_byband<float>;
 #else
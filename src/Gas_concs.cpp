@@ -22,21 +22,59 @@
  *
  */
 
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
 #include "Gas_concs.h"
 #include "Array.h"
 
 template<typename TF>
-Gas_concs<TF>::Gas_concs(const Gas_concs& gas_concs_ref, const int start, const int size)
+Gas_concs<TF>::Gas_concs(const Gas_concs& gas_concs_ref, const int start, const int size) :
+    parent(&gas_concs_ref.get_root()),
+    col_offset(gas_concs_ref.col_offset + start - 1),
+    ncol(size)
+{
+    // The columns of the reference are those of the view, or of its fields of gases. Without
+    // fields, all gases are scalars or profiles that are valid for any column.
+    int ncol_ref = gas_concs_ref.ncol;
+    if (!gas_concs_ref.is_view())
+        for (const Array<TF,2>& vmr : gas_concs_ref.gas_vmrs)
+            if (vmr.dim(1) > 1)
+                ncol_ref = (ncol_ref == 0) ? vmr.dim(1) : std::min(ncol_ref, vmr.dim(1));
+
+    if (start < 1 || size < 1 || (ncol_ref > 0 && start + size - 1 > ncol_ref))
+    {
+        std::string error("The view on columns " + std::to_string(start) + " to " + std::to_string(start + size - 1)
+                + " is out of the range of the " + std::to_string(ncol_ref) + " columns of the gas concentrations");
+        throw std::range_error(error);
+    }
+}
+
+// Copy the gases with the columns in the order given by col_order.
+template<typename TF>
+Gas_concs<TF>::Gas_concs(const Gas_concs& gas_concs_ref, const Array<int,1>& col_order)
 {
-    const int end = start + size - 1;
-    for (auto& g : gas_concs_ref.gas_concs_map)
+    const Gas_concs<TF>& root = gas_concs_ref.get_root();
+    const int col_offset_ref = gas_concs_ref.col_offset;
+
+    this->gas_ids = root.gas_ids;
+
+    for (const Array<TF,2>& vmr : root.gas_vmrs)
     {
-        if (g.second.dim(1) == 1)
-            this->gas_concs_map.emplace(g.first, g.second);
+        if (vmr.dim(1) == 1)
+            this->gas_vmrs.push_back(vmr);
         else
         {
-            Array<TF,2> gas_conc_subset = g.second.subset({{ {start, end}, {1, g.second.dim(2)} }});
-            this->gas_concs_map.emplace(g.first, gas_conc_subset);
+            const int n_col = col_order.dim(1);
+            const int n_lay = vmr.dim(2);
+
+            Array<TF,2> vmr_sorted({n_col, n_lay});
+            for (int ilay=1; ilay<=n_lay; ++ilay)
+                for (int icol=1; icol<=n_col; ++icol)
+                    vmr_sorted({icol, ilay}) = vmr({col_order({icol}) + col_offset_ref, ilay});
+
+            this->gas_vmrs.push_back(std::move(vmr_sorted));
         }
     }
 }
@@ -45,73 +83,156 @@ Gas_concs<TF>::Gas_concs(const Gas_concs& gas_concs_ref, const int start, const
 template<typename TF>
 void Gas_concs<TF>::set_vmr(const std::string& name, const TF data)
 {
-    // Check the data.
-    if ( (data < TF(0.)) || (data > TF(1.)) )
-    {
-        std::string error("Gas concentration " + name + " is out of range");
-        throw std::range_error(error);
-    }
-
     Array<TF,2> data_2d({1, 1});
     data_2d({1, 1}) = data;
 
-    if (this->exists(name))
-        gas_concs_map.at(name) = data_2d;
-    else
-        gas_concs_map.emplace(name, std::move(data_2d));
+    set_vmr(name, data_2d);
 }
 
 // Insert new gas into the map or update the value.
 template<typename TF>
 void Gas_concs<TF>::set_vmr(const std::string& name, const Array<TF,1>& data)
 {
-    // Check the data.
-    if (any_vals_outside(data, TF(0.), TF(1.)))
-    {
-        std::string error("Gas concentration " + name + " is out of range");
-        throw std::range_error(error);
-    }
+    Array<TF,2> data_2d(std::vector<TF>(data.ptr(), data.ptr() + data.size()), {1, data.dim(1)});
 
-    Array<TF,2> data_2d(data.v(), {1, data.dim(1)});
-
-    if (this->exists(name))
-        gas_concs_map.at(name) = data_2d;
-    else
-        gas_concs_map.emplace(name, std::move(data_2d));
+    set_vmr(name, data_2d);
 }
 
 // Insert new gas into the map or update the value.
 template<typename TF>
 void Gas_concs<TF>::set_vmr(const std::string& name, const Array<TF,2>& data_2d)
 {
+    // The copy of a view on external memory owns its data.
+    insert_vmr(name, Array<TF,2>(data_2d));
+}
+
+// Insert new gas into the map or update the value, a view is kept as a view.
+template<typename TF>
+void Gas_concs<TF>::set_vmr_view(const std::string& name, const Array<TF,2>& data_2d)
+{
+    insert_vmr(name, data_2d.is_view()
+            ? Array<TF,2>(const_cast<TF*>(data_2d.ptr()), data_2d.get_dims())
+            : Array<TF,2>(data_2d));
+}
+
+template<typename TF>
+void Gas_concs<TF>::insert_vmr(const std::string& name, Array<TF,2>&& data_2d)
+{
+    if (this->is_view())
+        throw std::runtime_error("Gas concentration " + name + " cannot be set in a view");
+
     // Check the data.
-    if (any_vals_outside(data_2d, TF(0.), TF(1.)))
+    if ((validation_policy != Validation_policy::Off) && any_vals_outside(data_2d, TF(0.), TF(1.)))
     {
         std::string error("Gas concentration " + name + " is out of range");
         throw std::range_error(error);
     }
 
-    if (this->exists(name))
-        gas_concs_map.at(name) = data_2d;
+    const int gas_id = this->get_gas_id(name);
+
+    if (gas_id != -1)
+        gas_vmrs[gas_id] = std::move(data_2d);
     else
-        gas_concs_map.emplace(name, data_2d);
+    {
+        gas_ids.emplace(name, gas_vmrs.size());
+        gas_vmrs.push_back(std::move(data_2d));
+    }
+}
+
+// Get the id of the gas from the map.
+template<typename TF>
+int Gas_concs<TF>::get_gas_id(const std::string& name) const
+{
+    const Gas_concs<TF>& root = this->get_root();
+
+    auto it = root.gas_ids.find(name);
+    return (it != root.gas_ids.end()) ? it->second : -1;
 }
 
 // Get gas from map.
 template<typename TF>
-const Array<TF,2>& Gas_concs<TF>::get_vmr(const std::string& name) const
+Array<TF,2> Gas_concs<TF>::get_vmr(const std::string& name) const
+{
+    const int gas_id = this->get_gas_id(name);
+
+    if (gas_id == -1)
+        throw std::runtime_error("Gas concentration " + name + " does not exist");
+
+    return this->get_vmr(gas_id);
+}
+
+// A view copies its columns of the fields of the root.
+template<typename TF>
+Array<TF,2> Gas_concs<TF>::get_vmr(const int gas_id) const
+{
+    const Array<TF,2>& vmr = this->get_root_vmr(gas_id);
+
+    if (!this->is_view() || vmr.dim(1) == 1)
+        return vmr;
+
+    return vmr.subset({{ {col_offset+1, col_offset+ncol}, {1, vmr.dim(2)} }});
+}
+
+template<typename TF>
+const Array<TF,2>& Gas_concs<TF>::get_root_vmr(const std::string& name) const
+{
+    const int gas_id = this->get_gas_id(name);
+
+    if (gas_id == -1)
+        throw std::runtime_error("Gas concentration " + name + " does not exist");
+
+    return this->get_root_vmr(gas_id);
+}
+
+template<typename TF>
+const Array<TF,2>& Gas_concs<TF>::get_root_vmr(const int gas_id) const
 {
-    return this->gas_concs_map.at(name);
+    return this->get_root().gas_vmrs[gas_id];
+}
+
+// Copy the gas and expand scalars and profiles to the full shape of data.
+template<typename TF>
+void Gas_concs<TF>::get_vmr(const std::string& name, Array<TF,2>& data) const
+{
+    const Array<TF,2>& vmr = this->get_root_vmr(name);
+
+    const int n_col = data.dim(1);
+    const int n_lay = data.dim(2);
+
+    if ( (vmr.dim(2) != 1 && vmr.dim(2) != n_lay)
+      || (vmr.dim(1) != 1 && vmr.dim(1) < n_col + col_offset)
+      || (is_view() && n_col != ncol) )
+        throw std::runtime_error("Gas concentration " + name + " does not match the shape of the output array");
+
+    for (int ilay=1; ilay<=n_lay; ++ilay)
+        for (int icol=1; icol<=n_col; ++icol)
+        {
+            const int icol_vmr = (vmr.dim(1) == 1) ? 1 : icol + col_offset;
+            const int ilay_vmr = (vmr.dim(2) == 1) ? 1 : ilay;
+            data({icol, ilay}) = vmr({icol_vmr, ilay_vmr});
+        }
 }
 
 // Check if gas exists in map.
 template<typename TF>
 BOOL_TYPE Gas_concs<TF>::exists(const std::string& name) const
 { 
-    return gas_concs_map.count(name) != 0;
+    return this->get_gas_id(name) != -1;
 }
 
-#ifdef FLOAT_SINGLE_RRTMGP
+template<typename TF>
+std::vector<std::string> Gas_concs<TF>::get_gas_names() const
+{
+    std::vector<std::string> gas_names;
+    for (auto& g : this->get_root().gas_ids)
+        gas_names.push_back(g.first);
+    return gas_names;
+}
+
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+template class Gas_concs<float>;
+template class Gas_concs<double>;
+#elif defined(FLOAT_SINGLE_RRTMGP)
 template class Gas_concs<float>;
 #else
 template class Gas_concs<double>;
@@ -22,13 +22,16 @@
  *
  */
 
+#include <limits>
 #include <numeric>
+#include <string>
 #include <cmath>
 #include <boost/algorithm/string.hpp>
 
 #include "Gas_concs.h"
 #include "Gas_optics_rrtmgp.h"
 #include "Array.h"
+#include "Instrumentation.h"
 #include "Optical_props.h"
 #include "Source_functions.h"
 
@@ -765,6 +768,121 @@ void Gas_optics_rrtmgp<TF>::get_col_dry(
         }
 }
 
+// Check the input of the gas optics.
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::check_inputs(
+        const Array<TF,2>& play,
+        const Array<TF,2>& plev,
+        const Array<TF,2>& tlay,
+        const Array<TF,2>& tlev,
+        const Array<TF,1>& tsfc,
+        const Array<TF,2>& col_dry) const
+{
+    if (validation_policy == Validation_policy::Off)
+        return;
+
+    if (validation_policy == Validation_policy::Full)
+    {
+        if (any_vals_outside(play, this->press_ref_min, this->press_ref_max))
+            throw std::range_error("play is out of range");
+        if (any_vals_outside(plev, this->press_ref_min, this->press_ref_max))
+            throw std::range_error("plev is out of range");
+
+        if (any_vals_outside(tlay, this->temp_ref_min, this->temp_ref_max))
+            throw std::range_error("tlay is out of range");
+        if (any_vals_outside(tlev, this->temp_ref_min, this->temp_ref_max))
+            throw std::range_error("tlev is out of range");
+        if (any_vals_outside(tsfc, this->temp_ref_min, this->temp_ref_max))
+            throw std::range_error("tsfc is out of range");
+
+        if (any_vals_less_than(col_dry, TF(0.)))
+            throw std::range_error("col_dry is out of range");
+
+        return;
+    }
+
+    // Fused check, all arrays are visited in one sweep over the layers.
+    const int ncol = play.dim(1);
+    const int nlay = play.dim(2);
+
+    const bool has_tlev = tlev.size() > 0;
+    const bool has_tsfc = tsfc.size() > 0;
+    const bool has_col_dry = col_dry.size() > 0;
+
+    const TF p_min = this->press_ref_min;
+    const TF p_max = this->press_ref_max;
+    const TF t_min = this->temp_ref_min;
+    const TF t_max = this->temp_ref_max;
+
+    auto outside = [](const TF val, const TF lower, const TF upper) { return (val < lower) || (val > upper); };
+
+    auto throw_error = [](const std::string& name, const int icol, const int ilay, const TF val)
+    {
+        std::string error = name + " is out of range at column " + std::to_string(icol);
+        if (ilay > 0)
+            error += ", vertical index " + std::to_string(ilay);
+        error += " with value " + std::to_string(val);
+        throw std::range_error(error);
+    };
+
+    const TF* play_p = play.ptr();
+    const TF* plev_p = plev.ptr();
+    const TF* tlay_p = tlay.ptr();
+    const TF* tlev_p = has_tlev ? tlev.ptr() : nullptr;
+    const TF* col_dry_p = has_col_dry ? col_dry.ptr() : nullptr;
+
+    for (int ilay=1; ilay<=nlay+1; ++ilay)
+    {
+        // Find the failing column only if the level contains an error, to keep the loop branch free.
+        bool error = false;
+        const int ilev_offset = (ilay-1)*ncol;
+
+        for (int icol=0; icol<ncol; ++icol)
+        {
+            const int idx = icol + ilev_offset;
+            error |= outside(plev_p[idx], p_min, p_max);
+            if (has_tlev)
+                error |= outside(tlev_p[idx], t_min, t_max);
+        }
+
+        if (ilay <= nlay)
+        {
+            for (int icol=0; icol<ncol; ++icol)
+            {
+                const int idx = icol + ilev_offset;
+                error |= outside(play_p[idx], p_min, p_max);
+                error |= outside(tlay_p[idx], t_min, t_max);
+                if (has_col_dry)
+                    error |= col_dry_p[idx] < TF(0.);
+            }
+        }
+
+        if (!error)
+            continue;
+
+        for (int icol=1; icol<=ncol; ++icol)
+        {
+            if (ilay <= nlay && outside(play({icol, ilay}), p_min, p_max))
+                throw_error("play", icol, ilay, play({icol, ilay}));
+            if (outside(plev({icol, ilay}), p_min, p_max))
+                throw_error("plev", icol, ilay, plev({icol, ilay}));
+            if (ilay <= nlay && outside(tlay({icol, ilay}), t_min, t_max))
+                throw_error("tlay", icol, ilay, tlay({icol, ilay}));
+            if (has_tlev && outside(tlev({icol, ilay}), t_min, t_max))
+                throw_error("tlev", icol, ilay, tlev({icol, ilay}));
+            if (ilay <= nlay && has_col_dry && col_dry({icol, ilay}) < TF(0.))
+                throw_error("col_dry", icol, ilay, col_dry({icol, ilay}));
+        }
+    }
+
+    if (has_tsfc)
+    {
+        for (int icol=1; icol<=ncol; ++icol)
+            if (outside(tsfc({icol}), t_min, t_max))
+                throw_error("tsfc", icol, 0, tsfc({icol}));
+    }
+}
+
 // Gas optics solver longwave variant.
 template<typename TF>
 void Gas_optics_rrtmgp<TF>::gas_optics(
@@ -784,21 +902,7 @@ void Gas_optics_rrtmgp<TF>::gas_optics(
     const int nband = this->get_nband();
 
     // Check if any of the values is out of range.
-    if (any_vals_outside(play, this->press_ref_min, this->press_ref_max))
-        throw std::range_error("play is out of range");
-    if (any_vals_outside(plev, this->press_ref_min, this->press_ref_max))
-        throw std::range_error("plev is out of range");
-
-    if (any_vals_outside(tlay, this->temp_ref_min, this->temp_ref_max))
-        throw std::range_error("tlay is out of range");
-    if (any_vals_outside(tlev, this->temp_ref_min, this->temp_ref_max))
-        throw std::range_error("tlev is out of range");
-    if (any_vals_outside(tsfc, this->temp_ref_min, this->temp_ref_max))
-        throw std::range_error("tsfc is out of range");
-
-    if (any_vals_less_than(col_dry, TF(0.)))
-        throw std::range_error("col_dry is out of range");
-    // End of checks.
+    check_inputs(play, plev, tlay, tlev, tsfc, col_dry);
 
     Array<int,2> jtemp({play.dim(1), play.dim(2)});
     Array<int,2> jpress({play.dim(1), play.dim(2)});
@@ -839,17 +943,7 @@ void Gas_optics_rrtmgp<TF>::gas_optics(
     const int nband = this->get_nband();
 
     // Check if any of the values is out of range.
-    if (any_vals_outside(play, this->press_ref_min, this->press_ref_max))
-        throw std::range_error("play is out of range");
-    if (any_vals_outside(plev, this->press_ref_min, this->press_ref_max))
-        throw std::range_error("plev is out of range");
-
-    if (any_vals_outside(tlay, this->temp_ref_min, this->temp_ref_max))
-        throw std::range_error("tlay is out of range");
-
-    if (any_vals_less_than(col_dry, TF(0.)))
-        throw std::range_error("col_dry is out of range");
-    // End of checks.
+    check_inputs(play, plev, tlay, Array<TF,2>(), Array<TF,1>(), col_dry);
 
     Array<int,2> jtemp({play.dim(1), play.dim(2)});
     Array<int,2> jpress({play.dim(1), play.dim(2)});
@@ -871,6 +965,327 @@ void Gas_optics_rrtmgp<TF>::gas_optics(
             toa_src({icol, igpt}) = this->solar_source({igpt});
 }
 
+// Compute the part of the interpolation that does not depend on the flavors.
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::compute_state(
+        const Array<TF,2>& play,
+        const Array<TF,2>& plev,
+        const Array<TF,2>& tlay,
+        const Gas_concs<TF>& gas_desc,
+        const Array<TF,2>& col_dry,
+        Gas_optics_state<TF>& state) const
+{
+    const int ncol = play.dim(1);
+    const int nlay = play.dim(2);
+    const int npres = this->get_npres();
+    const int ntemp = this->get_ntemp();
+
+    using Instrumentation::Stage;
+
+    if (col_dry.size() == 0)
+    {
+        Instrumentation::Scoped_timer timer(Stage::Col_dry, [&]() { return Instrumentation::get_bytes(play, plev); });
+
+        Array<TF,2> h2o({ncol, nlay});
+        gas_desc.get_vmr("h2o", h2o);
+        state.col_dry.set_dims({ncol, nlay});
+        get_col_dry(state.col_dry, h2o, plev);
+    }
+    else
+        state.col_dry = col_dry;
+
+    state.col_gas.set_dims({ncol, nlay, this->get_ngas()+1});
+    state.col_gas.set_offsets({0, 0, -1});
+    compute_col_gas(ncol, nlay, gas_desc, state.col_dry, state.col_gas);
+
+    state.jtemp.set_dims({ncol, nlay});
+    state.jpress.set_dims({ncol, nlay});
+    state.tropo.set_dims({ncol, nlay});
+    state.ftemp.set_dims({ncol, nlay});
+    state.fpress.set_dims({ncol, nlay});
+
+    Instrumentation::Scoped_timer timer(
+            Stage::Interpolation,
+            [&]() { return Instrumentation::get_bytes(play, tlay, state.jtemp, state.jpress, state.tropo, state.ftemp, state.fpress); });
+
+    // Same as the pressure and temperature part of the interpolation kernel.
+    for (int ilay=1; ilay<=nlay; ++ilay)
+        for (int icol=1; icol<=ncol; ++icol)
+        {
+            const int jtemp = static_cast<int>(
+                    (tlay({icol, ilay}) - (this->temp_ref_min - this->temp_ref_delta)) / this->temp_ref_delta);
+            state.jtemp({icol, ilay}) = std::min(ntemp-1, std::max(1, jtemp));
+            state.ftemp({icol, ilay}) =
+                    (tlay({icol, ilay}) - this->temp_ref({state.jtemp({icol, ilay})})) / this->temp_ref_delta;
+
+            const TF play_log = std::log(play({icol, ilay}));
+            const TF locpress = TF(1.) + (play_log - this->press_ref_log({1})) / this->press_ref_log_delta;
+            state.jpress({icol, ilay}) = std::min(npres-1, std::max(1, static_cast<int>(locpress)));
+            state.fpress({icol, ilay}) = locpress - TF(state.jpress({icol, ilay}));
+
+            state.tropo({icol, ilay}) = play_log > this->press_ref_trop_log;
+        }
+}
+
+// The state depends on the reference grid and on the order of the gases.
+template<typename TF>
+bool Gas_optics_rrtmgp<TF>::can_share_state(const Gas_optics_rrtmgp<TF>& other) const
+{
+    return (this->press_ref.v() == other.press_ref.v())
+        && (this->temp_ref.v() == other.temp_ref.v())
+        && (this->press_ref_trop_log == other.press_ref_trop_log)
+        && (this->gas_names.v() == other.gas_names.v());
+}
+
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::check_state(
+        const Array<TF,2>& play,
+        const Gas_optics_state<TF>& state) const
+{
+    if ( (state.col_gas.dim(1) != play.dim(1))
+      || (state.col_gas.dim(2) != play.dim(2))
+      || (state.col_gas.dim(3) != this->get_ngas()+1) )
+        throw std::runtime_error("Gas optics state does not match the input or the gases");
+}
+
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::interpolation_eta(
+        const int ncol, const int nlay,
+        const Gas_optics_state<TF>& state,
+        Array<int,4>& jeta,
+        Array<TF,6>& fmajor,
+        Array<TF,5>& fminor,
+        Array<TF,4>& col_mix) const
+{
+    const int nflav = this->get_nflav();
+    const int neta = this->get_neta();
+
+    const TF col_mix_min = TF(2.) * std::numeric_limits<TF>::min();
+
+    using Instrumentation::Stage;
+    Instrumentation::Scoped_timer timer(
+            Stage::Interpolation,
+            [&]() { return Instrumentation::get_bytes(state.col_gas, jeta, fmajor, fminor, col_mix); });
+
+    // Same as the flavor part of the interpolation kernel.
+    for (int ilay=1; ilay<=nlay; ++ilay)
+        for (int icol=1; icol<=ncol; ++icol)
+        {
+            const int itropo = state.tropo({icol, ilay}) ? 1 : 2;
+            const int jtemp = state.jtemp({icol, ilay});
+            const TF ftemp = state.ftemp({icol, ilay});
+            const TF fpress = state.fpress({icol, ilay});
+
+            for (int iflav=1; iflav<=nflav; ++iflav)
+            {
+                const int igas1 = this->flavor({1, iflav});
+                const int igas2 = this->flavor({2, iflav});
+                const TF col_gas1 = state.col_gas({icol, ilay, igas1});
+                const TF col_gas2 = state.col_gas({icol, ilay, igas2});
+
+                for (int itemp=1; itemp<=2; ++itemp)
+                {
+                    const TF ratio_eta_half =
+                            this->vmr_ref({itropo, igas1, jtemp+itemp-1})
+                          / this->vmr_ref({itropo, igas2, jtemp+itemp-1});
+
+                    const TF col_mix_t = col_gas1 + ratio_eta_half * col_gas2;
+                    col_mix({itemp, iflav, icol, ilay}) = col_mix_t;
+
+                    const TF eta = (col_mix_t > col_mix_min) ? col_gas1 / col_mix_t : TF(0.5);
+                    const TF loceta = eta * TF(neta-1);
+                    jeta({itemp, iflav, icol, ilay}) = std::min(static_cast<int>(loceta)+1, neta-1);
+
+                    const TF feta = std::fmod(loceta, TF(1.));
+                    const TF ftemp_term = TF(2-itemp) + TF(2*itemp-3) * ftemp;
+
+                    const TF fminor_1 = (TF(1.)-feta) * ftemp_term;
+                    const TF fminor_2 = feta * ftemp_term;
+                    fminor({1, itemp, iflav, icol, ilay}) = fminor_1;
+                    fminor({2, itemp, iflav, icol, ilay}) = fminor_2;
+
+                    fmajor({1, 1, itemp, iflav, icol, ilay}) = (TF(1.)-fpress) * fminor_1;
+                    fmajor({2, 1, itemp, iflav, icol, ilay}) = (TF(1.)-fpress) * fminor_2;
+                    fmajor({1, 2, itemp, iflav, icol, ilay}) = fpress * fminor_1;
+                    fmajor({2, 2, itemp, iflav, icol, ilay}) = fpress * fminor_2;
+                }
+            }
+        }
+}
+
+// Gas optics solver longwave variant on a precomputed state.
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::gas_optics(
+        const Array<TF,2>& play,
+        const Array<TF,2>& plev,
+        const Array<TF,2>& tlay,
+        const Array<TF,1>& tsfc,
+        const Gas_optics_state<TF>& state,
+        std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+        Source_func_lw<TF>& sources,
+        const Array<TF,2>& tlev) const
+{
+    const int ncol = play.dim(1);
+    const int nlay = play.dim(2);
+    const int ngpt = this->get_ngpt();
+    const int nband = this->get_nband();
+
+    check_state(play, state);
+    check_inputs(play, plev, tlay, tlev, tsfc, state.col_dry);
+
+    Array<int,4> jeta({2, this->get_nflav(), ncol, nlay});
+    Array<TF,6> fmajor({2, 2, 2, this->get_nflav(), ncol, nlay});
+    Array<TF,5> fminor({2, 2, this->get_nflav(), ncol, nlay});
+    Array<TF,4> col_mix({2, this->get_nflav(), ncol, nlay});
+
+    interpolation_eta(ncol, nlay, state, jeta, fmajor, fminor, col_mix);
+
+    compute_taus(
+            ncol, nlay, ngpt, nband,
+            play, tlay, state.col_dry, state.col_gas,
+            state.jtemp, state.jpress, jeta, state.tropo,
+            fmajor, fminor, col_mix,
+            optical_props);
+
+    source(
+            ncol, nlay, nband, ngpt,
+            play, plev, tlay, tsfc,
+            state.jtemp, state.jpress, jeta, state.tropo, fmajor,
+            sources, tlev);
+}
+
+// Gas optics solver shortwave variant on a precomputed state.
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::gas_optics(
+        const Array<TF,2>& play,
+        const Array<TF,2>& plev,
+        const Array<TF,2>& tlay,
+        const Gas_optics_state<TF>& state,
+        std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+        Array<TF,2>& toa_src) const
+{
+    const int ncol = play.dim(1);
+    const int nlay = play.dim(2);
+    const int ngpt = this->get_ngpt();
+    const int nband = this->get_nband();
+
+    check_state(play, state);
+    check_inputs(play, plev, tlay, Array<TF,2>(), Array<TF,1>(), state.col_dry);
+
+    Array<int,4> jeta({2, this->get_nflav(), ncol, nlay});
+    Array<TF,6> fmajor({2, 2, 2, this->get_nflav(), ncol, nlay});
+    Array<TF,5> fminor({2, 2, this->get_nflav(), ncol, nlay});
+    Array<TF,4> col_mix({2, this->get_nflav(), ncol, nlay});
+
+    interpolation_eta(ncol, nlay, state, jeta, fmajor, fminor, col_mix);
+
+    compute_taus(
+            ncol, nlay, ngpt, nband,
+            play, tlay, state.col_dry, state.col_gas,
+            state.jtemp, state.jpress, jeta, state.tropo,
+            fmajor, fminor, col_mix,
+            optical_props);
+
+    // External source function is constant.
+    for (int igpt=1; igpt<=ngpt; ++igpt)
+        for (int icol=1; icol<=ncol; ++icol)
+            toa_src({icol, igpt}) = this->solar_source({igpt});
+}
+
+// Gas optics solver longwave variant on a precomputed state for sampled g-points.
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::gas_optics(
+        const Array<TF,2>& play,
+        const Array<TF,2>& plev,
+        const Array<TF,2>& tlay,
+        const Array<TF,1>& tsfc,
+        const Gas_optics_state<TF>& state,
+        const Array<int,2>& gpts,
+        std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+        Source_func_lw<TF>& sources,
+        const Array<TF,2>& tlev) const
+{
+    const int ncol = play.dim(1);
+    const int nlay = play.dim(2);
+
+    check_state(play, state);
+    check_gpts(play, gpts, *optical_props);
+    check_inputs(play, plev, tlay, tlev, tsfc, state.col_dry);
+
+    Array<int,4> jeta({2, this->get_nflav(), ncol, nlay});
+    Array<TF,6> fmajor({2, 2, 2, this->get_nflav(), ncol, nlay});
+    Array<TF,5> fminor({2, 2, this->get_nflav(), ncol, nlay});
+    Array<TF,4> col_mix({2, this->get_nflav(), ncol, nlay});
+
+    interpolation_eta(ncol, nlay, state, jeta, fmajor, fminor, col_mix);
+
+    compute_taus_sampled(
+            ncol, nlay, gpts,
+            play, tlay, state,
+            jeta, fmajor, fminor, col_mix,
+            optical_props);
+
+    source_sampled(
+            ncol, nlay, gpts,
+            play, tlay, tsfc, state,
+            jeta, fmajor,
+            sources, tlev);
+}
+
+// Gas optics solver shortwave variant on a precomputed state for sampled g-points.
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::gas_optics(
+        const Array<TF,2>& play,
+        const Array<TF,2>& plev,
+        const Array<TF,2>& tlay,
+        const Gas_optics_state<TF>& state,
+        const Array<int,2>& gpts,
+        std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+        Array<TF,2>& toa_src) const
+{
+    const int ncol = play.dim(1);
+    const int nlay = play.dim(2);
+    const int n_sample = gpts.dim(1);
+
+    check_state(play, state);
+    check_gpts(play, gpts, *optical_props);
+    check_inputs(play, plev, tlay, Array<TF,2>(), Array<TF,1>(), state.col_dry);
+
+    Array<int,4> jeta({2, this->get_nflav(), ncol, nlay});
+    Array<TF,6> fmajor({2, 2, 2, this->get_nflav(), ncol, nlay});
+    Array<TF,5> fminor({2, 2, this->get_nflav(), ncol, nlay});
+    Array<TF,4> col_mix({2, this->get_nflav(), ncol, nlay});
+
+    interpolation_eta(ncol, nlay, state, jeta, fmajor, fminor, col_mix);
+
+    compute_taus_sampled(
+            ncol, nlay, gpts,
+            play, tlay, state,
+            jeta, fmajor, fminor, col_mix,
+            optical_props);
+
+    // External source function is constant.
+    for (int isample=1; isample<=n_sample; ++isample)
+        for (int icol=1; icol<=ncol; ++icol)
+            toa_src({icol, isample}) = this->solar_source({gpts({isample, icol})});
+}
+
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::check_gpts(
+        const Array<TF,2>& play,
+        const Array<int,2>& gpts,
+        const Optical_props_arry<TF>& optical_props) const
+{
+    if ( (gpts.dim(1) != optical_props.get_ngpt())
+      || (gpts.dim(2) != play.dim(1)) )
+        throw std::runtime_error("Sampled g-points do not match the input or the optical properties");
+
+    const int ngpt = this->get_ngpt();
+    for (int i=0; i<gpts.size(); ++i)
+        if (gpts.ptr()[i] < 1 || gpts.ptr()[i] > ngpt)
+            throw std::runtime_error("Sampled g-point is out of range");
+}
+
 namespace rrtmgp_kernel_launcher
 {
     template<typename TF> void zero_array(
@@ -956,7 +1371,7 @@ namespace rrtmgp_kernel_launcher
             const Array<BOOL_TYPE,2>& tropo,
             const Array<TF,4>& col_mix, const Array<TF,6>& fmajor,
             const Array<TF,5>& fminor, const Array<TF,2>& play,
-            const Array<TF,2>& tlay, Array<TF,3>& col_gas,
+            const Array<TF,2>& tlay, const Array<TF,3>& col_gas,
             const Array<int,4>& jeta, const Array<int,2>& jtemp,
             const Array<int,2>& jpress, Array<TF,3>& tau)
     {
@@ -1069,150 +1484,235 @@ namespace rrtmgp_kernel_launcher
                 sfc_src.ptr(), lay_src.ptr(), lev_src_inc.ptr(), lev_src_dec.ptr(),
                 sfc_src_jac.ptr());
     }
+
+    template<typename TF>
+    void compute_Planck_source(
+            int ncol, int nlay, int nbnd, int ngpt,
+            int nflav, int neta, int npres, int ntemp, int nPlanckTemp,
+            const Array<TF,2>& tlay, const Array<TF,2>& tlev, const Array<TF,1>& tsfc, int sfc_lay,
+            const Array<TF,6>& fmajor, const Array<int,4>& jeta, const Array<BOOL_TYPE,2>& tropo, const Array<int,2>& jtemp, const Array<int,2>& jpress,
+            const Array<int,1>& gpoint_bands, const Array<int,2>& band_lims_gpt, const Array<TF,4>& pfracin, TF temp_ref_min,
+            TF totplnk_delta, const Array<TF,2>& totplnk, const Array<int,2>& gpoint_flavor,
+            Array<TF,2>& sfc_src, Array<TF,3>& lay_src, Array<TF,3>& lev_src_inc, Array<TF,3>& lev_src_dec)
+    {
+        rrtmgp_kernels::compute_Planck_source_nojac(
+                &ncol, &nlay, &nbnd, &ngpt,
+                &nflav, &neta, &npres, &ntemp, &nPlanckTemp,
+                const_cast<TF*>(tlay.ptr()),
+                const_cast<TF*>(tlev.ptr()),
+                const_cast<TF*>(tsfc.ptr()),
+                &sfc_lay,
+                const_cast<TF*>(fmajor.ptr()),
+                const_cast<int*>(jeta.ptr()),
+                const_cast<BOOL_TYPE*>(tropo.ptr()),
+                const_cast<int*>(jtemp.ptr()),
+                const_cast<int*>(jpress.ptr()),
+                const_cast<int*>(gpoint_bands.ptr()), const_cast<int*>(band_lims_gpt.ptr()), const_cast<TF*>(pfracin.ptr()), &temp_ref_min,
+                &totplnk_delta, const_cast<TF*>(totplnk.ptr()), const_cast<int*>(gpoint_flavor.ptr()),
+                sfc_src.ptr(), lay_src.ptr(), lev_src_inc.ptr(), lev_src_dec.ptr());
+    }
 }
 
 template<typename TF>
-void Gas_optics_rrtmgp<TF>::compute_gas_taus(
-        const int ncol, const int nlay, const int ngpt, const int nband,
-        const Array<TF,2>& play,
-        const Array<TF,2>& plev,
-        const Array<TF,2>& tlay,
+void Gas_optics_rrtmgp<TF>::compute_col_gas(
+        const int ncol, const int nlay,
         const Gas_concs<TF>& gas_desc,
-        std::unique_ptr<Optical_props_arry<TF>>& optical_props,
-        Array<int,2>& jtemp, Array<int,2>& jpress,
-        Array<int,4>& jeta,
-        Array<BOOL_TYPE,2>& tropo,
-        Array<TF,6>& fmajor,
-        const Array<TF,2>& col_dry) const
+        const Array<TF,2>& col_dry,
+        Array<TF,3>& col_gas) const
 {
-    Array<TF,3> tau({ngpt, nlay, ncol});
-    Array<TF,3> tau_rayleigh({ngpt, nlay, ncol});
-    Array<TF,3> vmr({ncol, nlay, this->get_ngas()});
-    Array<TF,3> col_gas({ncol, nlay, this->get_ngas()+1});
-    col_gas.set_offsets({0, 0, -1});
-    Array<TF,4> col_mix({2, this->get_nflav(), ncol, nlay});
-    Array<TF,5> fminor({2, 2, this->get_nflav(), ncol, nlay});
-
-    // CvH add all the checking...
     const int ngas = this->get_ngas();
-    const int nflav = this->get_nflav();
-    const int neta = this->get_neta();
-    const int npres = this->get_npres();
-    const int ntemp = this->get_ntemp();
 
-    const int nminorlower = this->minor_scales_with_density_lower.dim(1);
-    const int nminorklower = this->kminor_lower.dim(1);
-    const int nminorupper = this->minor_scales_with_density_upper.dim(1);
-    const int nminorkupper = this->kminor_upper.dim(1);
+    using Instrumentation::Stage;
+    Instrumentation::Scoped_timer timer(Stage::Vmr_expansion, [&]() { return Instrumentation::get_bytes(col_gas, col_dry); });
+
+    // CvH: Assume that col_dry is provided.
+    for (int ilay=1; ilay<=nlay; ++ilay)
+        for (int icol=1; icol<=ncol; ++icol)
+            col_gas({icol, ilay, 0}) = col_dry({icol, ilay});
+
+    // Compute the gas columns directly from the stored vmr, such that well-mixed
+    // and profile-only gases are never expanded to the full (ncol, nlay) shape.
+    // If gas_desc is a view, its columns start after col_offset in the stored vmr.
+    const int col_offset = gas_desc.get_col_offset();
 
     for (int igas=1; igas<=ngas; ++igas)
     {
-        const Array<TF,2>& vmr_2d = gas_desc.get_vmr(this->gas_names({igas}));
+        const int gas_id = gas_desc.get_gas_id(this->gas_names({igas}));
+        if (gas_id == -1)
+            throw std::runtime_error("Gas concentration " + this->gas_names({igas}) + " does not exist");
 
-        // Fill array with constant value.
+        const Array<TF,2>& vmr_2d = gas_desc.get_root_vmr(gas_id);
+
+        // Constant value.
         if (vmr_2d.dim(1) == 1 && vmr_2d.dim(2) == 1)
         {
             const TF vmr_c = vmr_2d({1, 1});
             for (int ilay=1; ilay<=nlay; ++ilay)
                 for (int icol=1; icol<=ncol; ++icol)
-                    vmr({icol, ilay, igas}) = vmr_c;
+                    col_gas({icol, ilay, igas}) = vmr_c * col_dry({icol, ilay});
         }
-        // Fill array with constant profile.
+        // Constant profile.
         else if (vmr_2d.dim(1) == 1)
         {
             for (int ilay=1; ilay<=nlay; ++ilay)
             {
                 const TF vmr_lay = vmr_2d({1, ilay});
                 for (int icol=1; icol<=ncol; ++icol)
-                    vmr({icol, ilay, igas}) = vmr_lay;
+                    col_gas({icol, ilay, igas}) = vmr_lay * col_dry({icol, ilay});
             }
         }
-        // Fill array with full 2d data.
+        // Full 2d data.
         else
         {
             for (int ilay=1; ilay<=nlay; ++ilay)
                 for (int icol=1; icol<=ncol; ++icol)
-                    vmr({icol, ilay, igas}) = vmr_2d({icol, ilay});
+                    col_gas({icol, ilay, igas}) = vmr_2d({icol+col_offset, ilay}) * col_dry({icol, ilay});
         }
     }
+}
 
-    // CvH: Assume that col_dry is provided.
-    for (int ilay=1; ilay<=nlay; ++ilay)
-        for (int icol=1; icol<=ncol; ++icol)
-            col_gas({icol, ilay, 0}) = col_dry({icol, ilay});
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::compute_gas_taus(
+        const int ncol, const int nlay, const int ngpt, const int nband,
+        const Array<TF,2>& play,
+        const Array<TF,2>& plev,
+        const Array<TF,2>& tlay,
+        const Gas_concs<TF>& gas_desc,
+        std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+        Array<int,2>& jtemp, Array<int,2>& jpress,
+        Array<int,4>& jeta,
+        Array<BOOL_TYPE,2>& tropo,
+        Array<TF,6>& fmajor,
+        const Array<TF,2>& col_dry) const
+{
+    Array<TF,3> col_gas({ncol, nlay, this->get_ngas()+1});
+    col_gas.set_offsets({0, 0, -1});
+    Array<TF,4> col_mix({2, this->get_nflav(), ncol, nlay});
+    Array<TF,5> fminor({2, 2, this->get_nflav(), ncol, nlay});
 
-    for (int igas=1; igas<=ngas; ++igas)
-        for (int ilay=1; ilay<=nlay; ++ilay)
-            for (int icol=1; icol<=ncol; ++icol)
-                col_gas({icol, ilay, igas}) = vmr({icol, ilay, igas}) * col_dry({icol, ilay});
+    // CvH add all the checking...
+    const int ngas = this->get_ngas();
+    const int nflav = this->get_nflav();
+    const int neta = this->get_neta();
+    const int npres = this->get_npres();
+    const int ntemp = this->get_ntemp();
+
+    using Instrumentation::Stage;
+
+    compute_col_gas(ncol, nlay, gas_desc, col_dry, col_gas);
 
     // Call the fortran kernels
+    {
+        Instrumentation::Scoped_timer timer(
+                Stage::Interpolation,
+                [&]() { return Instrumentation::get_bytes(play, tlay, col_gas, jtemp, fmajor, fminor, col_mix, tropo, jeta, jpress); });
+
+        rrtmgp_kernel_launcher::interpolation(
+                ncol, nlay,
+                ngas, nflav, neta, npres, ntemp,
+                this->flavor,
+                this->press_ref_log,
+                this->temp_ref,
+                this->press_ref_log_delta,
+                this->temp_ref_min,
+                this->temp_ref_delta,
+                this->press_ref_trop_log,
+                this->vmr_ref,
+                play,
+                tlay,
+                col_gas,
+                jtemp,
+                fmajor, fminor,
+                col_mix,
+                tropo,
+                jeta, jpress);
+    }
+
+    compute_taus(
+            ncol, nlay, ngpt, nband,
+            play, tlay, col_dry, col_gas,
+            jtemp, jpress, jeta, tropo,
+            fmajor, fminor, col_mix,
+            optical_props);
+}
+
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::compute_taus(
+        const int ncol, const int nlay, const int ngpt, const int nband,
+        const Array<TF,2>& play,
+        const Array<TF,2>& tlay,
+        const Array<TF,2>& col_dry,
+        const Array<TF,3>& col_gas,
+        const Array<int,2>& jtemp, const Array<int,2>& jpress,
+        const Array<int,4>& jeta,
+        const Array<BOOL_TYPE,2>& tropo,
+        const Array<TF,6>& fmajor,
+        const Array<TF,5>& fminor,
+        const Array<TF,4>& col_mix,
+        std::unique_ptr<Optical_props_arry<TF>>& optical_props) const
+{
+    Array<TF,3> tau({ngpt, nlay, ncol});
+    Array<TF,3> tau_rayleigh({ngpt, nlay, ncol});
+
+    const int ngas = this->get_ngas();
+    const int nflav = this->get_nflav();
+    const int neta = this->get_neta();
+    const int npres = this->get_npres();
+    const int ntemp = this->get_ntemp();
+
+    const int nminorlower = this->minor_scales_with_density_lower.dim(1);
+    const int nminorklower = this->kminor_lower.dim(1);
+    const int nminorupper = this->minor_scales_with_density_upper.dim(1);
+    const int nminorkupper = this->kminor_upper.dim(1);
+
+    using Instrumentation::Stage;
+
     rrtmgp_kernel_launcher::zero_array(ngpt, nlay, ncol, tau);
 
-    rrtmgp_kernel_launcher::interpolation(
-            ncol, nlay,
-            ngas, nflav, neta, npres, ntemp,
-            this->flavor,
-            this->press_ref_log,
-            this->temp_ref,
-            this->press_ref_log_delta,
-            this->temp_ref_min,
-            this->temp_ref_delta,
-            this->press_ref_trop_log,
-            this->vmr_ref,
-            play,
-            tlay,
-            col_gas,
-            jtemp,
-            fmajor, fminor,
-            col_mix,
-            tropo,
-            jeta, jpress);
-
-    int idx_h2o = -1;
-    for (int i=1; i<=this->gas_names.dim(1); ++i)
-        if (gas_names({i}) == "h2o")
-        {
-            idx_h2o = i;
-            break;
-        }
+    const int idx_h2o = get_idx_h2o();
 
-    if (idx_h2o == -1)
-        throw std::runtime_error("idx_h2o cannot be found");
+    {
+        Instrumentation::Scoped_timer timer(
+                Stage::Tau_absorption,
+                [&]() { return Instrumentation::get_bytes(tau, col_gas, col_mix, fmajor, fminor, jeta, jtemp, jpress); });
 
-    rrtmgp_kernel_launcher::compute_tau_absorption(
-            ncol, nlay, nband, ngpt,
-            ngas, nflav, neta, npres, ntemp,
-            nminorlower, nminorklower,
-            nminorupper, nminorkupper,
-            idx_h2o,
-            this->gpoint_flavor,
-            this->get_band_lims_gpoint(),
-            this->kmajor,
-            this->kminor_lower,
-            this->kminor_upper,
-            this->minor_limits_gpt_lower,
-            this->minor_limits_gpt_upper,
-            this->minor_scales_with_density_lower,
-            this->minor_scales_with_density_upper,
-            this->scale_by_complement_lower,
-            this->scale_by_complement_upper,
-            this->idx_minor_lower,
-            this->idx_minor_upper,
-            this->idx_minor_scaling_lower,
-            this->idx_minor_scaling_upper,
-            this->kminor_start_lower,
-            this->kminor_start_upper,
-            tropo,
-            col_mix, fmajor, fminor,
-            play, tlay, col_gas,
-            jeta, jtemp, jpress,
-            tau);
+        rrtmgp_kernel_launcher::compute_tau_absorption(
+                ncol, nlay, nband, ngpt,
+                ngas, nflav, neta, npres, ntemp,
+                nminorlower, nminorklower,
+                nminorupper, nminorkupper,
+                idx_h2o,
+                this->gpoint_flavor,
+                this->get_band_lims_gpoint(),
+                this->kmajor,
+                this->kminor_lower,
+                this->kminor_upper,
+                this->minor_limits_gpt_lower,
+                this->minor_limits_gpt_upper,
+                this->minor_scales_with_density_lower,
+                this->minor_scales_with_density_upper,
+                this->scale_by_complement_lower,
+                this->scale_by_complement_upper,
+                this->idx_minor_lower,
+                this->idx_minor_upper,
+                this->idx_minor_scaling_lower,
+                this->idx_minor_scaling_upper,
+                this->kminor_start_lower,
+                this->kminor_start_upper,
+                tropo,
+                col_mix, fmajor, fminor,
+                play, tlay, col_gas,
+                jeta, jtemp, jpress,
+                tau);
+    }
 
     bool has_rayleigh = (this->krayl.size() > 0);
 
     if (has_rayleigh)
     {
+        Instrumentation::Scoped_timer timer(
+                Stage::Rayleigh, [&]() { return Instrumentation::get_bytes(tau_rayleigh, col_dry, col_gas, fminor, jeta, jtemp); });
+
         rrtmgp_kernel_launcher::compute_tau_rayleigh(
                 ncol, nlay, nband, ngpt,
                 ngas, nflav, neta, npres, ntemp,
@@ -1238,6 +1738,10 @@ void Gas_optics_rrtmgp<TF>::combine_and_reorder(
     int nlay = tau.dim(2);
     int ngpt = tau.dim(1);
 
+    Instrumentation::Scoped_timer timer(
+            Instrumentation::Stage::Reorder,
+            [&]() { return (has_rayleigh ? 5 : 2) * Instrumentation::get_bytes(tau); });
+
     if (!has_rayleigh)
     {
         // CvH for 2 stream and n-stream zero the g and ssa
@@ -1286,26 +1790,57 @@ void Gas_optics_rrtmgp<TF>::source(
     Array<TF,3> lev_source_inc_t({ngpt, nlay, ncol});
     Array<TF,3> lev_source_dec_t({ngpt, nlay, ncol});
     Array<TF,2> sfc_source_t({ngpt, ncol});
-    Array<TF,2> sfc_source_jac({ngpt, ncol});
+
+    Array<TF,2> sfc_source_jac;
+    if (sources.has_sfc_source_jac())
+        sfc_source_jac.set_dims({ngpt, ncol});
+
+    using Instrumentation::Stage;
 
     int sfc_lay = play({1, 1}) > play({1, nlay}) ? 1 : nlay;
-    rrtmgp_kernel_launcher::compute_Planck_source(
-            ncol, nlay, nbnd, ngpt,
-            nflav, neta, npres, ntemp, nPlanckTemp,
-            tlay, tlev, tsfc, sfc_lay,
-            fmajor, jeta, tropo, jtemp, jpress,
-            gpoint_bands, band_lims_gpoint, this->planck_frac, this->temp_ref_min,
-            this->totplnk_delta, this->totplnk, this->gpoint_flavor,
-            sfc_source_t, lay_source_t, lev_source_inc_t, lev_source_dec_t,
-            sfc_source_jac);
+
+    {
+        Instrumentation::Scoped_timer timer(
+                Stage::Planck_source,
+                [&]() { return Instrumentation::get_bytes(
+                        tlay, tlev, fmajor, jeta, tropo, jtemp, jpress,
+                        sfc_source_t, lay_source_t, lev_source_inc_t, lev_source_dec_t, sfc_source_jac); });
+
+        if (sources.has_sfc_source_jac())
+            rrtmgp_kernel_launcher::compute_Planck_source(
+                    ncol, nlay, nbnd, ngpt,
+                    nflav, neta, npres, ntemp, nPlanckTemp,
+                    tlay, tlev, tsfc, sfc_lay,
+                    fmajor, jeta, tropo, jtemp, jpress,
+                    gpoint_bands, band_lims_gpoint, this->planck_frac, this->temp_ref_min,
+                    this->totplnk_delta, this->totplnk, this->gpoint_flavor,
+                    sfc_source_t, lay_source_t, lev_source_inc_t, lev_source_dec_t,
+                    sfc_source_jac);
+        else
+            rrtmgp_kernel_launcher::compute_Planck_source(
+                    ncol, nlay, nbnd, ngpt,
+                    nflav, neta, npres, ntemp, nPlanckTemp,
+                    tlay, tlev, tsfc, sfc_lay,
+                    fmajor, jeta, tropo, jtemp, jpress,
+                    gpoint_bands, band_lims_gpoint, this->planck_frac, this->temp_ref_min,
+                    this->totplnk_delta, this->totplnk, this->gpoint_flavor,
+                    sfc_source_t, lay_source_t, lev_source_inc_t, lev_source_dec_t);
+    }
+
+    Instrumentation::Scoped_timer timer(
+            Stage::Reorder,
+            [&]() { return 2 * Instrumentation::get_bytes(
+                    sfc_source_t, lay_source_t, lev_source_inc_t, lev_source_dec_t); });
 
     // CvH this transpose is super slow.
     for (int j=1; j<=sfc_source_t.dim(2); ++j)
         for (int i=1; i<=sfc_source_t.dim(1); ++i)
-        {
-            sources.get_sfc_source    ()({j, i}) = sfc_source_t  ({i, j});
-            sources.get_sfc_source_jac()({j, i}) = sfc_source_jac({i, j});
-        }
+            sources.get_sfc_source()({j, i}) = sfc_source_t({i, j});
+
+    if (sources.has_sfc_source_jac())
+        for (int j=1; j<=sfc_source_jac.dim(2); ++j)
+            for (int i=1; i<=sfc_source_jac.dim(1); ++i)
+                sources.get_sfc_source_jac()({j, i}) = sfc_source_jac({i, j});
 
     rrtmgp_kernel_launcher::reorder123x321(lay_source_t, sources.get_lay_source());
     rrtmgp_kernel_launcher::reorder123x321(lev_source_inc_t, sources.get_lev_source_inc());
@@ -1315,6 +1850,239 @@ void Gas_optics_rrtmgp<TF>::source(
     // reorder123x321_test(sources.get_lev_source_dec().ptr(), lev_source_dec_t.ptr(), ngpt, nlay, ncol);
 }
 
+template<typename TF>
+int Gas_optics_rrtmgp<TF>::get_idx_h2o() const
+{
+    const int idx_h2o = find_index(this->gas_names, "h2o");
+    if (idx_h2o == -1)
+        throw std::runtime_error("idx_h2o cannot be found");
+    return idx_h2o;
+}
+
+// Interpolations of the absorption coefficients and Planck fractions of a single g-point, as
+// interpolate3D_byflav, interpolate2D_byflav and interpolate1D of the kernels.
+namespace
+{
+    template<typename TF>
+    inline TF interpolate3D(
+            const TF scaling_1, const TF scaling_2,
+            const Array<TF,6>& fmajor, const Array<int,4>& jeta,
+            const Array<TF,4>& k,
+            const int igpt, const int iflav, const int icol, const int ilay,
+            const int jtemp, const int jpress)
+    {
+        const TF scaling[2] = {scaling_1, scaling_2};
+
+        TF res = TF(0.);
+        for (int itemp=1; itemp<=2; ++itemp)
+        {
+            const int jeta_t = jeta({itemp, iflav, icol, ilay});
+            const int jtemp_t = jtemp + itemp - 1;
+
+            res += scaling[itemp-1] * (
+                      fmajor({1, 1, itemp, iflav, icol, ilay}) * k({igpt, jeta_t  , jpress-1, jtemp_t})
+                    + fmajor({2, 1, itemp, iflav, icol, ilay}) * k({igpt, jeta_t+1, jpress-1, jtemp_t})
+                    + fmajor({1, 2, itemp, iflav, icol, ilay}) * k({igpt, jeta_t  , jpress  , jtemp_t})
+                    + fmajor({2, 2, itemp, iflav, icol, ilay}) * k({igpt, jeta_t+1, jpress  , jtemp_t}) );
+        }
+
+        return res;
+    }
+
+    // The coefficient k(ieta, itemp) is looked up by the caller.
+    template<typename TF, class Coefficient>
+    inline TF interpolate2D(
+            const Array<TF,5>& fminor, const Array<int,4>& jeta,
+            const int iflav, const int icol, const int ilay,
+            const int jtemp, const Coefficient& k)
+    {
+        const int jeta_1 = jeta({1, iflav, icol, ilay});
+        const int jeta_2 = jeta({2, iflav, icol, ilay});
+
+        return fminor({1, 1, iflav, icol, ilay}) * k(jeta_1  , jtemp  )
+             + fminor({2, 1, iflav, icol, ilay}) * k(jeta_1+1, jtemp  )
+             + fminor({1, 2, iflav, icol, ilay}) * k(jeta_2  , jtemp+1)
+             + fminor({2, 2, iflav, icol, ilay}) * k(jeta_2+1, jtemp+1);
+    }
+
+    template<typename TF>
+    inline TF interpolate1D(
+            const TF val, const TF offset, const TF delta,
+            const Array<TF,2>& table, const int ibnd)
+    {
+        const TF val0 = (val - offset) / delta;
+        const TF frac = val0 - TF(static_cast<int>(val0));
+        const int index = std::min(table.dim(1)-1, std::max(1, static_cast<int>(val0)+1));
+
+        return table({index, ibnd}) + frac * (table({index+1, ibnd}) - table({index, ibnd}));
+    }
+}
+
+// Absorption and Rayleigh optical depths of the sampled g-points, in the order of the kernels.
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::compute_taus_sampled(
+        const int ncol, const int nlay,
+        const Array<int,2>& gpts,
+        const Array<TF,2>& play,
+        const Array<TF,2>& tlay,
+        const Gas_optics_state<TF>& state,
+        const Array<int,4>& jeta,
+        const Array<TF,6>& fmajor,
+        const Array<TF,5>& fminor,
+        const Array<TF,4>& col_mix,
+        std::unique_ptr<Optical_props_arry<TF>>& optical_props) const
+{
+    const int n_sample = gpts.dim(1);
+    const int idx_h2o = get_idx_h2o();
+    const bool has_rayleigh = (this->krayl.size() > 0);
+
+    const TF pa_to_hpa = TF(0.01);
+    const TF tau_min = TF(2.) * std::numeric_limits<TF>::min();
+
+    Array<TF,3>& tau = optical_props->get_tau();
+
+    using Instrumentation::Stage;
+    Instrumentation::Scoped_timer timer(
+            Stage::Tau_absorption,
+            [&]() { return Instrumentation::get_bytes(tau, state.col_gas, col_mix, fmajor, fminor, jeta); });
+
+    for (int isample=1; isample<=n_sample; ++isample)
+        for (int ilay=1; ilay<=nlay; ++ilay)
+            for (int icol=1; icol<=ncol; ++icol)
+            {
+                const int igpt = gpts({isample, icol});
+                const bool is_lower = state.tropo({icol, ilay});
+                const int itropo = is_lower ? 1 : 2;
+                const int iflav = this->gpoint_flavor({itropo, igpt});
+                const int jtemp = state.jtemp({icol, ilay});
+
+                // Major species.
+                TF tau_abs = interpolate3D(
+                        col_mix({1, iflav, icol, ilay}), col_mix({2, iflav, icol, ilay}),
+                        fmajor, jeta, this->kmajor,
+                        igpt, iflav, icol, ilay,
+                        jtemp, state.jpress({icol, ilay})+itropo);
+
+                // Minor species of the lower or upper atmosphere that absorb in this g-point.
+                const Array<TF,3>& kminor = is_lower ? this->kminor_lower : this->kminor_upper;
+                const Array<int,2>& minor_limits_gpt = is_lower ? this->minor_limits_gpt_lower : this->minor_limits_gpt_upper;
+                const Array<BOOL_TYPE,1>& minor_scales_with_density =
+                        is_lower ? this->minor_scales_with_density_lower : this->minor_scales_with_density_upper;
+                const Array<BOOL_TYPE,1>& scale_by_complement =
+                        is_lower ? this->scale_by_complement_lower : this->scale_by_complement_upper;
+                const Array<int,1>& idx_minor = is_lower ? this->idx_minor_lower : this->idx_minor_upper;
+                const Array<int,1>& idx_minor_scaling = is_lower ? this->idx_minor_scaling_lower : this->idx_minor_scaling_upper;
+                const Array<int,1>& kminor_start = is_lower ? this->kminor_start_lower : this->kminor_start_upper;
+
+                for (int imnr=1; imnr<=minor_scales_with_density.dim(1); ++imnr)
+                {
+                    const int gpt_s = minor_limits_gpt({1, imnr});
+                    if (igpt < gpt_s || igpt > minor_limits_gpt({2, imnr}))
+                        continue;
+
+                    TF scaling = state.col_gas({icol, ilay, idx_minor({imnr})});
+                    if (minor_scales_with_density({imnr}))
+                    {
+                        // The density scaling needs the pressure in hPa.
+                        scaling *= pa_to_hpa * play({icol, ilay}) / tlay({icol, ilay});
+
+                        const int idx_scaling = idx_minor_scaling({imnr});
+                        if (idx_scaling > 0)
+                        {
+                            const TF vmr_fact = TF(1.) / state.col_gas({icol, ilay, 0});
+                            const TF dry_fact = TF(1.) / (TF(1.) + state.col_gas({icol, ilay, idx_h2o}) * vmr_fact);
+                            const TF vmr_scaling = state.col_gas({icol, ilay, idx_scaling}) * vmr_fact * dry_fact;
+                            scaling *= scale_by_complement({imnr}) ? TF(1.) - vmr_scaling : vmr_scaling;
+                        }
+                    }
+
+                    const int ik = kminor_start({imnr}) + igpt - gpt_s;
+                    tau_abs += scaling * interpolate2D(
+                            fminor, jeta, iflav, icol, ilay, jtemp,
+                            [&](const int ieta, const int itemp) { return kminor({ik, ieta, itemp}); });
+                }
+
+                if (!has_rayleigh)
+                {
+                    tau({icol, ilay, isample}) = tau_abs;
+                    continue;
+                }
+
+                const TF k_rayl = interpolate2D(
+                        fminor, jeta, iflav, icol, ilay, jtemp,
+                        [&](const int ieta, const int itemp) { return this->krayl({igpt, ieta, itemp, itropo}); });
+                const TF tau_rayl = k_rayl * (state.col_gas({icol, ilay, idx_h2o}) + state.col_dry({icol, ilay}));
+                const TF tau_tot = tau_abs + tau_rayl;
+
+                tau({icol, ilay, isample}) = tau_tot;
+                optical_props->get_ssa()({icol, ilay, isample}) = (tau_tot > tau_min) ? tau_rayl / tau_tot : TF(0.);
+                optical_props->get_g  ()({icol, ilay, isample}) = TF(0.);
+            }
+}
+
+// Planck sources of the sampled g-points.
+template<typename TF>
+void Gas_optics_rrtmgp<TF>::source_sampled(
+        const int ncol, const int nlay,
+        const Array<int,2>& gpts,
+        const Array<TF,2>& play,
+        const Array<TF,2>& tlay, const Array<TF,1>& tsfc,
+        const Gas_optics_state<TF>& state,
+        const Array<int,4>& jeta,
+        const Array<TF,6>& fmajor,
+        Source_func_lw<TF>& sources,
+        const Array<TF,2>& tlev) const
+{
+    const int n_sample = gpts.dim(1);
+    const Array<int,1>& gpoint_bands = this->get_gpoint_bands();
+    const int sfc_lay = play({1, 1}) > play({1, nlay}) ? 1 : nlay;
+
+    // Temperature increment of the surface source Jacobian, as in the kernel.
+    const TF delta_tsfc = TF(1.);
+
+    auto planck_function = [&](const TF temperature, const int ibnd)
+    {
+        return interpolate1D(temperature, this->temp_ref_min, this->totplnk_delta, this->totplnk, ibnd);
+    };
+
+    using Instrumentation::Stage;
+    Instrumentation::Scoped_timer timer(
+            Stage::Planck_source,
+            [&]() { return Instrumentation::get_bytes(
+                    tlay, tlev, fmajor, jeta,
+                    sources.get_sfc_source(), sources.get_lay_source(), sources.get_lev_source_inc(), sources.get_lev_source_dec()); });
+
+    for (int isample=1; isample<=n_sample; ++isample)
+        for (int ilay=1; ilay<=nlay; ++ilay)
+            for (int icol=1; icol<=ncol; ++icol)
+            {
+                const int igpt = gpts({isample, icol});
+                const int ibnd = gpoint_bands({igpt});
+                const int itropo = state.tropo({icol, ilay}) ? 1 : 2;
+                const int iflav = this->gpoint_flavor({itropo, igpt});
+
+                const TF pfrac = interpolate3D(
+                        TF(1.), TF(1.),
+                        fmajor, jeta, this->planck_frac,
+                        igpt, iflav, icol, ilay,
+                        state.jtemp({icol, ilay}), state.jpress({icol, ilay})+itropo);
+
+                sources.get_lay_source    ()({icol, ilay, isample}) = pfrac * planck_function(tlay({icol, ilay  }), ibnd);
+                sources.get_lev_source_dec()({icol, ilay, isample}) = pfrac * planck_function(tlev({icol, ilay  }), ibnd);
+                sources.get_lev_source_inc()({icol, ilay, isample}) = pfrac * planck_function(tlev({icol, ilay+1}), ibnd);
+
+                if (ilay == sfc_lay)
+                {
+                    const TF planck_sfc = planck_function(tsfc({icol}), ibnd);
+                    sources.get_sfc_source()({icol, isample}) = pfrac * planck_sfc;
+
+                    if (sources.has_sfc_source_jac())
+                        sources.get_sfc_source_jac()({icol, isample}) =
+                                pfrac * (planck_function(tsfc({icol}) + delta_tsfc, ibnd) - planck_sfc);
+                }
+            }
+}
+
 template<typename TF>
 TF Gas_optics_rrtmgp<TF>::get_tsi() const
 {
@@ -1327,7 +2095,10 @@ TF Gas_optics_rrtmgp<TF>::get_tsi() const
     return tsi;
 }
 
-#ifdef FLOAT_SINGLE_RRTMGP
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+template class Gas_optics_rrtmgp<float>;
+template class Gas_optics_rrtmgp<double>;
+#elif defined(FLOAT_SINGLE_RRTMGP)
 template class Gas_optics_rrtmgp<float>;
 #else
 template class Gas_optics_rrtmgp<double>;
@@ -0,0 +1,212 @@
+/*
+ * This file is part of a C++ interface to the Radiative Transfer for Energetics (RTE)
+ * and Rapid Radiative Transfer Model for GCM applications Parallel (RRTMGP).
+ *
+ * The original code is found at https://github.com/earth-system-radiation/rte-rrtmgp.
+ *
+ * Contacts: Robert Pincus and Eli Mlawer
+ * email: rrtmgp@aer.com
+ *
+ * Copyright 2015-2020,  Atmospheric and Environmental Research and
+ * Regents of the University of Colorado.  All right reserved.
+ *
+ * This C++ interface can be downloaded from https://github.com/earth-system-radiation/rte-rrtmgp-cpp
+ *
+ * Contact: Chiel van Heerwaarden
+ * email: chiel.vanheerwaarden@wur.nl
+ *
+ * Copyright 2020, Wageningen University & Research.
+ *
+ * Use and duplication is permitted under the terms of the
+ * BSD 3-clause license, see http://opensource.org/licenses/BSD-3-Clause
+ *
+ */
+
+
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "Instrumentation.h"
+
+namespace
+{
+    using Instrumentation::Stage;
+
+    constexpr int n_stages = static_cast<int>(Stage::n_stages);
+
+    struct Counter
+    {
+        double time = 0.;
+        long long calls = 0;
+        std::size_t bytes = 0;
+    };
+
+    struct Thread_counters
+    {
+        int thread_id;
+        std::array<Counter, n_stages> counters;
+    };
+
+    void add_counter(Counter& total, const Counter& counter)
+    {
+        total.time += counter.time;
+        total.calls += counter.calls;
+        total.bytes += counter.bytes;
+    }
+
+    // The registry holds the counters of the running threads. When a thread exits, its counters
+    // are added to the counters of the exited threads and removed from the registry.
+    std::mutex registry_mutex;
+    std::vector<std::unique_ptr<Thread_counters>> registry;
+    Thread_counters exited_counters{-1, {}};
+    int n_threads_registered = 0;
+
+#ifndef RTE_RRTMGP_NO_INSTRUMENTATION
+    struct Thread_registration
+    {
+        Thread_counters* thread_counters = nullptr;
+
+        ~Thread_registration()
+        {
+            if (thread_counters == nullptr)
+                return;
+
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            for (int istage=0; istage<n_stages; ++istage)
+                add_counter(exited_counters.counters[istage], thread_counters->counters[istage]);
+
+            registry.erase(std::find_if(
+                    registry.begin(), registry.end(),
+                    [&](const std::unique_ptr<Thread_counters>& tc) { return tc.get() == thread_counters; }));
+        }
+    };
+
+    Thread_counters& get_thread_counters()
+    {
+        thread_local Thread_registration registration;
+
+        if (registration.thread_counters == nullptr)
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            registry.push_back(std::make_unique<Thread_counters>());
+            registration.thread_counters = registry.back().get();
+            registration.thread_counters->thread_id = n_threads_registered++;
+        }
+
+        return *registration.thread_counters;
+    }
+#endif
+
+    void write_counter(std::ostringstream& ss, const Counter& counter)
+    {
+        ss << "\"calls\": " << counter.calls
+           << ", \"time\": " << counter.time
+           << ", \"bytes\": " << counter.bytes;
+    }
+}
+
+namespace Instrumentation
+{
+#ifndef RTE_RRTMGP_NO_INSTRUMENTATION
+    bool enabled = false;
+
+    void set_enabled(const bool switch_enabled)
+    {
+        enabled = switch_enabled;
+    }
+
+    void record(const Stage stage, const double time, const std::size_t bytes)
+    {
+        Counter& counter = get_thread_counters().counters[static_cast<int>(stage)];
+        counter.time += time;
+        counter.bytes += bytes;
+        ++counter.calls;
+    }
+#endif
+
+    std::string get_stage_name(const Stage stage)
+    {
+        switch (stage)
+        {
+            case Stage::Input_subset:   return "input_subset";
+            case Stage::Col_dry:        return "col_dry";
+            case Stage::Vmr_expansion:  return "vmr_expansion";
+            case Stage::Interpolation:  return "interpolation";
+            case Stage::Tau_absorption: return "tau_absorption";
+            case Stage::Rayleigh:       return "rayleigh";
+            case Stage::Reorder:        return "reorder";
+            case Stage::Planck_source:  return "planck_source";
+            case Stage::Cloud_optics:   return "cloud_optics";
+            case Stage::Delta_scale:    return "delta_scale";
+            case Stage::Add_to:         return "add_to";
+            case Stage::Rte_solver:     return "rte_solver";
+            case Stage::Flux_reduction: return "flux_reduction";
+            case Stage::Output_scatter: return "output_scatter";
+            default:                    return "unknown";
+        }
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (std::unique_ptr<Thread_counters>& thread_counters : registry)
+            thread_counters->counters.fill(Counter());
+        exited_counters.counters.fill(Counter());
+    }
+
+    // The stages are always written in the same order, such that the output of two runs can be diffed.
+    std::string get_json()
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+
+        std::ostringstream ss;
+        ss << std::setprecision(9);
+
+        ss << "{\n";
+        ss << "    \"enabled\": " << (is_enabled() ? "true" : "false") << ",\n";
+        ss << "    \"n_threads\": " << n_threads_registered << ",\n";
+        ss << "    \"stages\": [\n";
+
+        // The exited threads are listed last.
+        std::vector<const Thread_counters*> thread_list;
+        for (const std::unique_ptr<Thread_counters>& thread_counters : registry)
+            thread_list.push_back(thread_counters.get());
+        thread_list.push_back(&exited_counters);
+
+        for (int istage=0; istage<n_stages; ++istage)
+        {
+            Counter total;
+            for (const Thread_counters* thread_counters : thread_list)
+                add_counter(total, thread_counters->counters[istage]);
+
+            ss << "        {\"name\": \"" << get_stage_name(static_cast<Stage>(istage)) << "\", ";
+            write_counter(ss, total);
+            ss << ", \"threads\": [";
+
+            bool first = true;
+            for (const Thread_counters* thread_counters : thread_list)
+            {
+                const Counter& counter = thread_counters->counters[istage];
+                if (counter.calls == 0)
+                    continue;
+
+                ss << (first ? "" : ", ") << "{\"thread\": " << thread_counters->thread_id << ", ";
+                write_counter(ss, counter);
+                ss << "}";
+                first = false;
+            }
+
+            ss << "]}" << (istage < n_stages-1 ? "," : "") << "\n";
+        }
+
+        ss << "    ]\n";
+        ss << "}\n";
+
+        return ss.str();
+    }
+}
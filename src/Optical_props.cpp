@@ -22,8 +22,12 @@
  *
  */
 
+#include <cmath>
+#include <limits>
+
 #include "Optical_props.h"
 #include "Array.h"
+#include "Instrumentation.h"
 #include "rrtmgp_kernels.h"
 
 // Optical properties per gpoint.
@@ -71,6 +75,25 @@ Optical_props<TF>::Optical_props(
     }
 }
 
+template<typename TF>
+BOOL_TYPE Optical_props<TF>::bands_are_equal(const Optical_props<TF>& rhs) const
+{
+    if (this->get_nband() != rhs.get_nband())
+        return false;
+
+    const Array<TF,2>& rhs_band_lims_wvn = rhs.get_band_lims_wavenumber();
+    constexpr TF eps_wvn = TF(5.)*std::numeric_limits<TF>::epsilon();
+
+    for (int i=0; i<this->band_lims_wvn.size(); ++i)
+    {
+        const TF wvn = this->band_lims_wvn.v()[i];
+        if (std::abs(wvn - rhs_band_lims_wvn.v()[i]) > eps_wvn*std::abs(wvn))
+            return false;
+    }
+
+    return true;
+}
+
 template<typename TF>
 Optical_props_1scl<TF>::Optical_props_1scl(
         const int ncol,
@@ -209,6 +232,10 @@ void Optical_props_2str<TF>::delta_scale(const Array<TF,3>& forward_frac)
     const int nlay = this->get_nlay();
     const int ngpt = this->get_ngpt();
 
+    Instrumentation::Scoped_timer timer(
+            Instrumentation::Stage::Delta_scale,
+            [&]() { return 2*Instrumentation::get_bytes(this->get_tau(), this->get_ssa(), this->get_g()); });
+
     rrtmgp_kernel_launcher::delta_scale_2str_k(
             ncol, nlay, ngpt,
             this->get_tau(), this->get_ssa(), this->get_g());
@@ -221,6 +248,13 @@ void add_to(Optical_props_1scl<TF>& op_inout, const Optical_props_1scl<TF>& op_i
     const int nlay = op_inout.get_nlay();
     const int ngpt = op_inout.get_ngpt();
 
+    if (!op_inout.bands_are_equal(op_in))
+        throw std::runtime_error("Cannot add optical properties with different band limits");
+
+    Instrumentation::Scoped_timer timer(
+            Instrumentation::Stage::Add_to,
+            [&]() { return 2*Instrumentation::get_bytes(op_inout.get_tau()) + Instrumentation::get_bytes(op_in.get_tau()); });
+
     if (ngpt == op_in.get_ngpt())
     {
         rrtmgp_kernel_launcher::increment_1scalar_by_1scalar(
@@ -229,7 +263,7 @@ void add_to(Optical_props_1scl<TF>& op_inout, const Optical_props_1scl<TF>& op_i
     }
     else
     {
-        if (op_in.get_ngpt() != op_inout.get_nband())
+        if (!op_in.is_band_resolved())
             throw std::runtime_error("Cannot add optical properties with incompatible band - gpoint combination");
 
         rrtmgp_kernel_launcher::inc_1scalar_by_1scalar_bybnd(
@@ -246,6 +280,14 @@ void add_to(Optical_props_2str<TF>& op_inout, const Optical_props_2str<TF>& op_i
     const int nlay = op_inout.get_nlay();
     const int ngpt = op_inout.get_ngpt();
 
+    if (!op_inout.bands_are_equal(op_in))
+        throw std::runtime_error("Cannot add optical properties with different band limits");
+
+    Instrumentation::Scoped_timer timer(
+            Instrumentation::Stage::Add_to,
+            [&]() { return 2*Instrumentation::get_bytes(op_inout.get_tau(), op_inout.get_ssa(), op_inout.get_g())
+                    + Instrumentation::get_bytes(op_in.get_tau(), op_in.get_ssa(), op_in.get_g()); });
+
     if (ngpt == op_in.get_ngpt())
     {
         rrtmgp_kernel_launcher::increment_2stream_by_2stream(
@@ -255,7 +297,7 @@ void add_to(Optical_props_2str<TF>& op_inout, const Optical_props_2str<TF>& op_i
     }
     else
     {
-        if (op_in.get_ngpt() != op_inout.get_nband())
+        if (!op_in.is_band_resolved())
             throw std::runtime_error("Cannot add optical properties with incompatible band - gpoint combination");
 
         rrtmgp_kernel_launcher::inc_2stream_by_2stream_bybnd(
@@ -266,16 +308,48 @@ void add_to(Optical_props_2str<TF>& op_inout, const Optical_props_2str<TF>& op_i
     }
 }
 
-#ifdef FLOAT_SINGLE_RRTMGP
+template<typename TF>
+void add_to(Optical_props_arry<TF>& op_inout, const Optical_props_arry<TF>& op_in)
+{
+    if (auto op_inout_2str = dynamic_cast<Optical_props_2str<TF>*>(&op_inout))
+    {
+        if (auto op_in_2str = dynamic_cast<const Optical_props_2str<TF>*>(&op_in))
+            return add_to(*op_inout_2str, *op_in_2str);
+    }
+    else if (auto op_inout_1scl = dynamic_cast<Optical_props_1scl<TF>*>(&op_inout))
+    {
+        if (auto op_in_1scl = dynamic_cast<const Optical_props_1scl<TF>*>(&op_in))
+            return add_to(*op_inout_1scl, *op_in_1scl);
+    }
+
+    throw std::runtime_error("Cannot add optical properties of different types");
+}
+
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+template class Optical_props<float>;
+template class Optical_props_1scl<float>;
+template class Optical_props_2str<float>;
+template void add_to(Optical_props_2str<float>&, const Optical_props_2str<float>&);
+template void add_to(Optical_props_1scl<float>&, const Optical_props_1scl<float>&);
+template void add_to(Optical_props_arry<float>&, const Optical_props_arry<float>&);
+template class Optical_props<double>;
+template class Optical_props_1scl<double>;
+template class Optical_props_2str<double>;
+template void add_to(Optical_props_2str<double>&, const Optical_props_2str<double>&);
+template void add_to(Optical_props_1scl<double>&, const Optical_props_1scl<double>&);
+template void add_to(Optical_props_arry<double>&, const Optical_props_arry<double>&);
+#elif defined(FLOAT_SINGLE_RRTMGP)
 template class Optical_props<float>;
 template class Optical_props_1scl<float>;
 template class Optical_props_2str<float>;
 template void add_to(Optical_props_2str<float>&, const Optical_props_2str<float>&);
 template void add_to(Optical_props_1scl<float>&, const Optical_props_1scl<float>&);
+template void add_to(Optical_props_arry<float>&, const Optical_props_arry<float>&);
 #else
 template class Optical_props<double>;
 template class Optical_props_1scl<double>;
 template class Optical_props_2str<double>;
 template void add_to(Optical_props_2str<double>&, const Optical_props_2str<double>&);
 template void add_to(Optical_props_1scl<double>&, const Optical_props_1scl<double>&);
+template void add_to(Optical_props_arry<double>&, const Optical_props_arry<double>&);
 #endif
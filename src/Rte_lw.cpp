@@ -22,9 +22,12 @@
  *
  */
 
+#include <stdexcept>
+
 #include "Rte_lw.h"
 #include "Array.h"
 #include "Optical_props.h"
+#include "Instrumentation.h"
 #include "Source_functions.h"
 #include "Fluxes.h"
 
@@ -63,7 +66,7 @@ namespace rrtmgp_kernel_launcher
             const Array<TF,3>& lev_source_inc, const Array<TF,3>& lev_source_dec,
             const Array<TF,2>& sfc_emis_gpt, const Array<TF,2>& sfc_source,
             Array<TF,3>& gpt_flux_up, Array<TF,3>& gpt_flux_dn,
-            Array<TF,2>& sfc_source_jac, Array<TF,3>& gpt_flux_up_jac)
+            const Array<TF,2>& sfc_source_jac, Array<TF,3>& gpt_flux_up_jac)
 {
     rrtmgp_kernels::lw_solver_noscat_GaussQuad(
                 &ncol, &nlay, &ngpt, &top_at_1, &n_quad_angs,
@@ -77,9 +80,49 @@ namespace rrtmgp_kernel_launcher
                 const_cast<TF*>(sfc_source.ptr()),
                 gpt_flux_up.ptr(),
                 gpt_flux_dn.ptr(),
-                sfc_source_jac.ptr(),
+                const_cast<TF*>(sfc_source_jac.ptr()),
                 gpt_flux_up_jac.ptr());
     }
+
+    template<typename TF>
+    void lw_solver_noscat_GaussQuad(
+            int ncol, int nlay, int ngpt, BOOL_TYPE top_at_1, int n_quad_angs,
+            const Array<TF,2>& gauss_Ds_subset,
+            const Array<TF,2>& gauss_wts_subset,
+            const Array<TF,3>& tau,
+            const Array<TF,3>& lay_source,
+            const Array<TF,3>& lev_source_inc, const Array<TF,3>& lev_source_dec,
+            const Array<TF,2>& sfc_emis_gpt, const Array<TF,2>& sfc_source,
+            Array<TF,3>& gpt_flux_up, Array<TF,3>& gpt_flux_dn)
+    {
+        rrtmgp_kernels::lw_solver_noscat_GaussQuad_nojac(
+                &ncol, &nlay, &ngpt, &top_at_1, &n_quad_angs,
+                const_cast<TF*>(gauss_Ds_subset.ptr()),
+                const_cast<TF*>(gauss_wts_subset.ptr()),
+                const_cast<TF*>(tau.ptr()),
+                const_cast<TF*>(lay_source.ptr()),
+                const_cast<TF*>(lev_source_inc.ptr()),
+                const_cast<TF*>(lev_source_dec.ptr()),
+                const_cast<TF*>(sfc_emis_gpt.ptr()),
+                const_cast<TF*>(sfc_source.ptr()),
+                gpt_flux_up.ptr(),
+                gpt_flux_dn.ptr());
+    }
+}
+
+template<typename TF>
+void Rte_lw<TF>::rte_lw(
+        const std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+        const BOOL_TYPE top_at_1,
+        const Source_func_lw<TF>& sources,
+        const Array<TF,2>& sfc_emis,
+        const Array<TF,2>& inc_flux,
+        Array<TF,3>& gpt_flux_up,
+        Array<TF,3>& gpt_flux_dn,
+        const int n_gauss_angles)
+{
+    solve(optical_props, top_at_1, sources, sfc_emis, inc_flux,
+          gpt_flux_up, gpt_flux_dn, nullptr, nullptr, n_gauss_angles);
 }
 
 template<typename TF>
@@ -91,6 +134,27 @@ void Rte_lw<TF>::rte_lw(
         const Array<TF,2>& inc_flux,
         Array<TF,3>& gpt_flux_up,
         Array<TF,3>& gpt_flux_dn,
+        Array<TF,3>& gpt_flux_up_jac,
+        const int n_gauss_angles)
+{
+    if (!sources.has_sfc_source_jac())
+        throw std::runtime_error("The Jacobian requires sources with a surface source Jacobian");
+
+    solve(optical_props, top_at_1, sources, sfc_emis, inc_flux,
+          gpt_flux_up, gpt_flux_dn, &sources.get_sfc_source_jac(), &gpt_flux_up_jac, n_gauss_angles);
+}
+
+template<typename TF>
+void Rte_lw<TF>::solve(
+        const std::unique_ptr<Optical_props_arry<TF>>& optical_props,
+        const BOOL_TYPE top_at_1,
+        const Source_func_lw<TF>& sources,
+        const Array<TF,2>& sfc_emis,
+        const Array<TF,2>& inc_flux,
+        Array<TF,3>& gpt_flux_up,
+        Array<TF,3>& gpt_flux_dn,
+        const Array<TF,2>* sfc_source_jac,
+        Array<TF,3>* gpt_flux_up_jac,
         const int n_gauss_angles)
 {
     const int max_gauss_pts = 4;
@@ -112,6 +176,14 @@ void Rte_lw<TF>::rte_lw(
     const int nlay = optical_props->get_nlay();
     const int ngpt = optical_props->get_ngpt();
 
+    Instrumentation::Scoped_timer timer(
+            Instrumentation::Stage::Rte_solver,
+            [&]() { return Instrumentation::get_bytes(
+                    optical_props->get_tau(),
+                    sources.get_lay_source(), sources.get_lev_source_inc(), sources.get_lev_source_dec(),
+                    gpt_flux_up, gpt_flux_dn)
+                    + (gpt_flux_up_jac ? Instrumentation::get_bytes(*gpt_flux_up_jac) : 0); });
+
     Array<TF,2> sfc_emis_gpt({ncol, ngpt});
 
     expand_and_transpose(optical_props, sfc_emis, sfc_emis_gpt);
@@ -130,19 +202,26 @@ void Rte_lw<TF>::rte_lw(
     Array<TF,2> gauss_wts_subset = gauss_wts.subset(
             {{ {1, n_quad_angs}, {n_quad_angs, n_quad_angs} }});
 
-    // For now, just pass the arrays around.
-    Array<TF,2> sfc_src_jac(sources.get_sfc_source().get_dims());
-    Array<TF,3> gpt_flux_up_jac(gpt_flux_up.get_dims());
-
-    rrtmgp_kernel_launcher::lw_solver_noscat_GaussQuad(
-            ncol, nlay, ngpt, top_at_1, n_quad_angs,
-            gauss_Ds_subset, gauss_wts_subset,
-            optical_props->get_tau(),
-            sources.get_lay_source(),
-            sources.get_lev_source_inc(), sources.get_lev_source_dec(),
-            sfc_emis_gpt, sources.get_sfc_source(),
-            gpt_flux_up, gpt_flux_dn,
-            sfc_src_jac, gpt_flux_up_jac);
+    // Without a Jacobian the solver variant is used that neither reads nor computes it.
+    if (gpt_flux_up_jac)
+        rrtmgp_kernel_launcher::lw_solver_noscat_GaussQuad(
+                ncol, nlay, ngpt, top_at_1, n_quad_angs,
+                gauss_Ds_subset, gauss_wts_subset,
+                optical_props->get_tau(),
+                sources.get_lay_source(),
+                sources.get_lev_source_inc(), sources.get_lev_source_dec(),
+                sfc_emis_gpt, sources.get_sfc_source(),
+                gpt_flux_up, gpt_flux_dn,
+                *sfc_source_jac, *gpt_flux_up_jac);
+    else
+        rrtmgp_kernel_launcher::lw_solver_noscat_GaussQuad(
+                ncol, nlay, ngpt, top_at_1, n_quad_angs,
+                gauss_Ds_subset, gauss_wts_subset,
+                optical_props->get_tau(),
+                sources.get_lay_source(),
+                sources.get_lev_source_inc(), sources.get_lev_source_dec(),
+                sfc_emis_gpt, sources.get_sfc_source(),
+                gpt_flux_up, gpt_flux_dn);
 
     // CvH: In the fortran code this call is here, I removed it for performance and flexibility.
     // fluxes->reduce(gpt_flux_up, gpt_flux_dn, optical_props, top_at_1);
@@ -164,7 +243,10 @@ void Rte_lw<TF>::expand_and_transpose(
                 arr_out({icol, igpt}) = arr_in({iband, icol});
 }
 
-#ifdef FLOAT_SINGLE_RRTMGP
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+template class Rte_lw<float>;
+template class Rte_lw<double>;
+#elif defined(FLOAT_SINGLE_RRTMGP)
 template class Rte_lw<float>;
 #else
 template class Rte_lw<double>;
@@ -25,6 +25,7 @@
 #include "Rte_sw.h"
 #include "Array.h"
 #include "Optical_props.h"
+#include "Instrumentation.h"
 #include "Fluxes.h"
 
 #include "rrtmgp_kernels.h"
@@ -105,6 +106,12 @@ void Rte_sw<TF>::rte_sw(
     const int nlay = optical_props->get_nlay();
     const int ngpt = optical_props->get_ngpt();
 
+    Instrumentation::Scoped_timer timer(
+            Instrumentation::Stage::Rte_solver,
+            [&]() { return Instrumentation::get_bytes(
+                    optical_props->get_tau(), optical_props->get_ssa(), optical_props->get_g(),
+                    gpt_flux_up, gpt_flux_dn, gpt_flux_dir); });
+
     Array<TF,2> sfc_alb_dir_gpt({ncol, ngpt});
     Array<TF,2> sfc_alb_dif_gpt({ncol, ngpt});
 
@@ -149,7 +156,10 @@ void Rte_sw<TF>::expand_and_transpose(
                 arr_out({icol, igpt}) = arr_in({iband, icol});
 }
 
-#ifdef FLOAT_SINGLE_RRTMGP
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+template class Rte_sw<float>;
+template class Rte_sw<double>;
+#elif defined(FLOAT_SINGLE_RRTMGP)
 template class Rte_sw<float>;
 #else
 template class Rte_sw<double>;
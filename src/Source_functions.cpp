@@ -30,10 +30,11 @@ template<typename TF>
 Source_func_lw<TF>::Source_func_lw(
         const int n_col,
         const int n_lay,
-        const Optical_props<TF>& optical_props) :
+        const Optical_props<TF>& optical_props,
+        const bool switch_jacobian) :
     Optical_props<TF>(optical_props),
     sfc_source({n_col, optical_props.get_ngpt()}),
-    sfc_source_jac({n_col, optical_props.get_ngpt()}),
+    sfc_source_jac(switch_jacobian ? Array<TF,2>({n_col, optical_props.get_ngpt()}) : Array<TF,2>()),
     lay_source({n_col, n_lay, optical_props.get_ngpt()}),
     lev_source_inc({n_col, n_lay, optical_props.get_ngpt()}),
     lev_source_dec({n_col, n_lay, optical_props.get_ngpt()})
@@ -48,6 +49,11 @@ void Source_func_lw<TF>::set_subset(
         for (int icol=col_s; icol<=col_e; ++icol)
             sfc_source({icol, igpt}) = sources_sub.get_sfc_source()({icol-col_s+1, igpt});
 
+    if (has_sfc_source_jac() && sources_sub.has_sfc_source_jac())
+        for (int igpt=1; igpt<=lay_source.dim(3); ++igpt)
+            for (int icol=col_s; icol<=col_e; ++icol)
+                sfc_source_jac({icol, igpt}) = sources_sub.get_sfc_source_jac()({icol-col_s+1, igpt});
+
     for (int igpt=1; igpt<=lay_source.dim(3); ++igpt)
         for (int ilay=1; ilay<=lay_source.dim(2); ++ilay)
             for (int icol=col_s; icol<=col_e; ++icol)
@@ -67,6 +73,11 @@ void Source_func_lw<TF>::get_subset(
         for (int icol=col_s; icol<=col_e; ++icol)
             sfc_source({icol-col_s+1, igpt}) = sources_sub.get_sfc_source()({icol, igpt});
 
+    if (has_sfc_source_jac() && sources_sub.has_sfc_source_jac())
+        for (int igpt=1; igpt<=lay_source.dim(3); ++igpt)
+            for (int icol=col_s; icol<=col_e; ++icol)
+                sfc_source_jac({icol-col_s+1, igpt}) = sources_sub.get_sfc_source_jac()({icol, igpt});
+
     for (int igpt=1; igpt<=lay_source.dim(3); ++igpt)
         for (int ilay=1; ilay<=lay_source.dim(2); ++ilay)
             for (int icol=col_s; icol<=col_e; ++icol)
@@ -77,7 +88,10 @@ void Source_func_lw<TF>::get_subset(
             }
 }
 
-#ifdef FLOAT_SINGLE_RRTMGP
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+template class Source_func_lw<float>;
+template class Source_func_lw<double>;
+#elif defined(FLOAT_SINGLE_RRTMGP)
 template class Source_func_lw<float>;
 #else
 template class Source_func_lw<double>;
@@ -0,0 +1,697 @@
+/*
+ * This file is part of a C++ interface to the Radiative Transfer for Energetics (RTE)
+ * and Rapid Radiative Transfer Model for GCM applications Parallel (RRTMGP).
+ *
+ * The original code is found at https://github.com/earth-system-radiation/rte-rrtmgp.
+ *
+ * Contacts: Robert Pincus and Eli Mlawer
+ * email: rrtmgp@aer.com
+ *
+ * Copyright 2015-2020,  Atmospheric and Environmental Research and
+ * Regents of the University of Colorado.  All right reserved.
+ *
+ * This C++ interface can be downloaded from https://github.com/earth-system-radiation/rte-rrtmgp-cpp
+ *
+ * Contact: Chiel van Heerwaarden
+ * email: chiel.vanheerwaarden@wur.nl
+ *
+ * Copyright 2020, Wageningen University & Research.
+ *
+ * Use and duplication is permitted under the terms of the
+ * BSD 3-clause license, see http://opensource.org/licenses/BSD-3-Clause
+ *
+ */
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rte_rrtmgp_c.h"
+#include "Array.h"
+#include "Coefficient_file.h"
+#include "Gas_concs.h"
+#include "Gas_optics_rrtmgp.h"
+#include "Cloud_optics.h"
+#include "Optical_props.h"
+#include "Source_functions.h"
+#include "Fluxes.h"
+#include "Rte_lw.h"
+#include "Rte_sw.h"
+
+// The precision independent part of the handle, the solvers of each precision derive from it.
+struct rte_rrtmgp_solver
+{
+    virtual ~rte_rrtmgp_solver() = default;
+
+    virtual bool is_longwave() const = 0;
+    virtual int get_n_bnd() const = 0;
+    virtual int get_n_gpt() const = 0;
+    virtual void set_validation_policy(const Validation_policy policy) = 0;
+
+    std::vector<std::string> gas_names;
+    Validation_policy validation_policy = Validation_policy::Full;
+    int n_col_block = 16;
+};
+
+namespace
+{
+    thread_local std::string last_error;
+
+    // Run the function and turn all exceptions into a status code.
+    template<class Function>
+    int call_safe(Function&& function)
+    {
+        try
+        {
+            function();
+            return RTE_RRTMGP_SUCCESS;
+        }
+        catch (const std::exception& e)
+        {
+            last_error = e.what();
+        }
+        catch (...)
+        {
+            last_error = "Unknown error";
+        }
+        return RTE_RRTMGP_FAILURE;
+    }
+
+    void check_pointers(std::initializer_list<const void*> pointers)
+    {
+        for (const void* p : pointers)
+            if (p == nullptr)
+                throw std::runtime_error("A required argument is NULL");
+    }
+
+    template<typename TF>
+    struct Block_solver : public rte_rrtmgp_solver
+    {
+        bool is_longwave() const { return kdist->source_is_internal(); }
+        int get_n_bnd() const { return kdist->get_nband(); }
+        int get_n_gpt() const { return kdist->get_ngpt(); }
+
+        void set_validation_policy(const Validation_policy policy)
+        {
+            validation_policy = policy;
+            kdist->set_validation_policy(policy);
+        }
+
+        std::unique_ptr<Gas_optics_rrtmgp<TF>> kdist;
+        std::unique_ptr<Cloud_optics<TF>> cloud_optics;
+    };
+
+    template<typename TF>
+    rte_rrtmgp_solver* create_solver(
+            const Coefficient_file& coef_gas, const Coefficient_file* coef_cloud,
+            const int n_gas, const char* const* gas_names)
+    {
+        if (n_gas < 1 || gas_names == nullptr)
+            throw std::runtime_error("At least one gas is required");
+
+        auto solver = std::make_unique<Block_solver<TF>>();
+
+        // The gas optics only need the names of the available gases.
+        Gas_concs<TF> available_gases;
+        for (int i=0; i<n_gas; ++i)
+        {
+            check_pointers({gas_names[i]});
+            solver->gas_names.emplace_back(gas_names[i]);
+            available_gases.set_vmr(solver->gas_names.back(), TF(0.));
+        }
+
+        solver->kdist = load_gas_optics<TF>(coef_gas, available_gases);
+        if (coef_cloud)
+            solver->cloud_optics = load_cloud_optics<TF>(*coef_cloud);
+
+        return solver.release();
+    }
+
+    template<typename TF>
+    int solver_create(
+            rte_rrtmgp_solver** solver,
+            const char* file_name_gas, const char* file_name_cloud,
+            const int n_gas, const char* const* gas_names)
+    {
+        return call_safe([&]()
+        {
+            check_pointers({solver, file_name_gas});
+            *solver = nullptr;
+
+            Coefficient_file coef_gas(file_name_gas);
+            std::unique_ptr<Coefficient_file> coef_cloud;
+            if (file_name_cloud)
+                coef_cloud = std::make_unique<Coefficient_file>(file_name_cloud);
+
+            *solver = create_solver<TF>(coef_gas, coef_cloud.get(), n_gas, gas_names);
+        });
+    }
+
+    template<typename TF>
+    int solver_create_from_buffer(
+            rte_rrtmgp_solver** solver,
+            const void* buffer_gas, const size_t size_gas,
+            const void* buffer_cloud, const size_t size_cloud,
+            const int n_gas, const char* const* gas_names)
+    {
+        return call_safe([&]()
+        {
+            check_pointers({solver, buffer_gas});
+            *solver = nullptr;
+
+            Coefficient_file coef_gas(buffer_gas, size_gas);
+            std::unique_ptr<Coefficient_file> coef_cloud;
+            if (buffer_cloud)
+                coef_cloud = std::make_unique<Coefficient_file>(buffer_cloud, size_cloud);
+
+            *solver = create_solver<TF>(coef_gas, coef_cloud.get(), n_gas, gas_names);
+        });
+    }
+
+    // The solve functions of one precision only accept a solver of the same precision.
+    template<typename TF>
+    const Block_solver<TF>& get_solver(const rte_rrtmgp_solver* solver)
+    {
+        check_pointers({solver});
+        const Block_solver<TF>* block_solver = dynamic_cast<const Block_solver<TF>*>(solver);
+        if (!block_solver)
+            throw std::runtime_error("The solver is created in another precision than the solve function");
+        return *block_solver;
+    }
+
+    // Array view on caller-owned memory, the inputs are only read.
+    template<typename TF, int N>
+    Array<TF,N> make_view(const TF* data, const std::array<int,N>& dims)
+    {
+        return Array<TF,N>(const_cast<TF*>(data), dims);
+    }
+
+    template<typename TF, int N>
+    Array<TF,N> make_optional_view(const TF* data, const std::array<int,N>& dims)
+    {
+        return data ? make_view<TF,N>(data, dims) : Array<TF,N>();
+    }
+
+    // Inputs that the longwave and shortwave solves share, all are views on the caller's memory.
+    template<typename TF>
+    struct Column_input
+    {
+        Column_input(
+                const Block_solver<TF>& solver,
+                const int n_col, const int n_lay,
+                const TF* const* vmr, const int* vmr_shape,
+                const TF* p_lay, const TF* p_lev, const TF* t_lay, const TF* t_lev,
+                const TF* col_dry,
+                const TF* lwp, const TF* iwp, const TF* rel, const TF* rei) :
+            n_col(n_col), n_lay(n_lay), n_lev(n_lay+1),
+            is_cloudy(lwp != nullptr)
+        {
+            if (n_col < 1 || n_lay < 1)
+                throw std::runtime_error("The number of columns and layers has to be at least 1");
+
+            check_pointers({vmr, p_lay, p_lev, t_lay, t_lev});
+
+            gas_concs.set_validation_policy(solver.validation_policy);
+            for (size_t i=0; i<solver.gas_names.size(); ++i)
+            {
+                check_pointers({vmr[i]});
+                const int shape = vmr_shape ? vmr_shape[i] : RTE_RRTMGP_GAS_FIELD;
+
+                if (shape == RTE_RRTMGP_GAS_SCALAR)
+                    gas_concs.set_vmr(solver.gas_names[i], vmr[i][0]);
+                else if (shape == RTE_RRTMGP_GAS_PROFILE)
+                    gas_concs.set_vmr_view(solver.gas_names[i], make_view<TF,2>(vmr[i], {1, n_lay}));
+                else if (shape == RTE_RRTMGP_GAS_FIELD)
+                    gas_concs.set_vmr_view(solver.gas_names[i], make_view<TF,2>(vmr[i], {n_col, n_lay}));
+                else
+                    throw std::runtime_error("Illegal shape of gas " + solver.gas_names[i]);
+            }
+
+            this->p_lay = make_view<TF,2>(p_lay, {n_col, n_lay});
+            this->p_lev = make_view<TF,2>(p_lev, {n_col, n_lev});
+            this->t_lay = make_view<TF,2>(t_lay, {n_col, n_lay});
+            this->t_lev = make_view<TF,2>(t_lev, {n_col, n_lev});
+            this->col_dry = make_optional_view<TF,2>(col_dry, {n_col, n_lay});
+
+            if (is_cloudy)
+            {
+                if (!solver.cloud_optics)
+                    throw std::runtime_error("Clouds require a solver with cloud coefficients");
+                check_pointers({iwp, rel, rei});
+                this->lwp = make_view<TF,2>(lwp, {n_col, n_lay});
+                this->iwp = make_view<TF,2>(iwp, {n_col, n_lay});
+                this->rel = make_view<TF,2>(rel, {n_col, n_lay});
+                this->rei = make_view<TF,2>(rei, {n_col, n_lay});
+            }
+
+            top_at_1 = this->p_lay({1, 1}) < this->p_lay({1, n_lay});
+        }
+
+        // The col_dry of the block, computed from h2o if it is not provided.
+        Array<TF,2> get_col_dry(const Gas_concs<TF>& gas_concs_subset, const int col_s, const int col_e) const
+        {
+            if (col_dry.size() > 0)
+                return col_dry.subset({{ {col_s, col_e}, {1, n_lay} }});
+
+            Array<TF,2> col_dry_subset({col_e-col_s+1, n_lay});
+            Array<TF,2> h2o_subset({col_e-col_s+1, n_lay});
+            gas_concs_subset.get_vmr("h2o", h2o_subset);
+            Gas_optics_rrtmgp<TF>::get_col_dry(
+                    col_dry_subset, h2o_subset, p_lev.subset({{ {col_s, col_e}, {1, n_lev} }}));
+            return col_dry_subset;
+        }
+
+        // The cloud optics are skipped for a block without liquid and ice, the columns keep their order.
+        bool block_is_cloudy(const int col_s, const int col_e) const
+        {
+            if (!is_cloudy)
+                return false;
+
+            for (int ilay=1; ilay<=n_lay; ++ilay)
+                for (int icol=col_s; icol<=col_e; ++icol)
+                    if (lwp({icol, ilay}) > TF(0.) || iwp({icol, ilay}) > TF(0.))
+                        return true;
+
+            return false;
+        }
+
+        const int n_col;
+        const int n_lay;
+        const int n_lev;
+        const bool is_cloudy;
+
+        Gas_concs<TF> gas_concs;
+        Array<TF,2> p_lay, p_lev, t_lay, t_lev, col_dry;
+        Array<TF,2> lwp, iwp, rel, rei;
+        BOOL_TYPE top_at_1;
+    };
+
+    template<typename TF>
+    void copy_block(Array<TF,2>& out, const Array<TF,2>& block, const int col_s)
+    {
+        for (int ilev=1; ilev<=block.dim(2); ++ilev)
+            for (int icol=1; icol<=block.dim(1); ++icol)
+                out({icol+col_s-1, ilev}) = block({icol, ilev});
+    }
+
+    template<typename TF>
+    void solve_lw(
+            const Block_solver<TF>& solver, const Column_input<TF>& in,
+            const Array<TF,1>& t_sfc, const Array<TF,2>& emis_sfc,
+            Array<TF,2>& flux_up, Array<TF,2>& flux_dn, Array<TF,2>& flux_net)
+    {
+        if (!solver.is_longwave())
+            throw std::runtime_error("The solver does not have longwave coefficients");
+
+        const int n_lay = in.n_lay;
+        const int n_lev = in.n_lev;
+        const int n_bnd = solver.get_n_bnd();
+        const int n_gpt = solver.get_n_gpt();
+
+        for (int col_s=1; col_s<=in.n_col; col_s+=solver.n_col_block)
+        {
+            const int col_e = std::min(col_s + solver.n_col_block - 1, in.n_col);
+            const int n_col_in = col_e - col_s + 1;
+
+            Gas_concs<TF> gas_concs_subset(in.gas_concs, col_s, n_col_in);
+
+            std::unique_ptr<Optical_props_arry<TF>> optical_props =
+                    std::make_unique<Optical_props_1scl<TF>>(n_col_in, n_lay, *solver.kdist);
+            Source_func_lw<TF> sources(n_col_in, n_lay, *solver.kdist);
+
+            solver.kdist->gas_optics(
+                    in.p_lay.subset({{ {col_s, col_e}, {1, n_lay} }}),
+                    in.p_lev.subset({{ {col_s, col_e}, {1, n_lev} }}),
+                    in.t_lay.subset({{ {col_s, col_e}, {1, n_lay} }}),
+                    t_sfc.subset({{ {col_s, col_e} }}),
+                    gas_concs_subset,
+                    optical_props,
+                    sources,
+                    in.get_col_dry(gas_concs_subset, col_s, col_e),
+                    in.t_lev.subset({{ {col_s, col_e}, {1, n_lev} }}) );
+
+            if (in.block_is_cloudy(col_s, col_e))
+            {
+                Optical_props_1scl<TF> cloud_optical_props(n_col_in, n_lay, *solver.cloud_optics);
+                solver.cloud_optics->cloud_optics(
+                        in.lwp.subset({{ {col_s, col_e}, {1, n_lay} }}),
+                        in.iwp.subset({{ {col_s, col_e}, {1, n_lay} }}),
+                        in.rel.subset({{ {col_s, col_e}, {1, n_lay} }}),
+                        in.rei.subset({{ {col_s, col_e}, {1, n_lay} }}),
+                        cloud_optical_props);
+                add_to(*optical_props, cloud_optical_props);
+            }
+
+            Array<TF,3> gpt_flux_up({n_col_in, n_lev, n_gpt});
+            Array<TF,3> gpt_flux_dn({n_col_in, n_lev, n_gpt});
+
+            constexpr int n_ang = 1;
+            Rte_lw<TF>::rte_lw(
+                    optical_props,
+                    in.top_at_1,
+                    sources,
+                    emis_sfc.subset({{ {1, n_bnd}, {col_s, col_e} }}),
+                    Array<TF,2>(), // Add an empty array, no inc_flux.
+                    gpt_flux_up, gpt_flux_dn,
+                    n_ang);
+
+            Fluxes_broadband<TF> fluxes(n_col_in, n_lev);
+            fluxes.reduce(gpt_flux_up, gpt_flux_dn, optical_props, in.top_at_1);
+
+            copy_block(flux_up , fluxes.get_flux_up (), col_s);
+            copy_block(flux_dn , fluxes.get_flux_dn (), col_s);
+            copy_block(flux_net, fluxes.get_flux_net(), col_s);
+        }
+    }
+
+    template<typename TF>
+    void solve_sw(
+            const Block_solver<TF>& solver, const Column_input<TF>& in,
+            const Array<TF,2>& sfc_alb_dir, const Array<TF,2>& sfc_alb_dif,
+            const Array<TF,1>& mu0, const Array<TF,1>& tsi_scaling,
+            Array<TF,2>& flux_up, Array<TF,2>& flux_dn, Array<TF,2>& flux_dn_dir, Array<TF,2>& flux_net)
+    {
+        if (solver.is_longwave())
+            throw std::runtime_error("The solver does not have shortwave coefficients");
+
+        const int n_lay = in.n_lay;
+        const int n_lev = in.n_lev;
+        const int n_bnd = solver.get_n_bnd();
+        const int n_gpt = solver.get_n_gpt();
+
+        for (int col_s=1; col_s<=in.n_col; col_s+=solver.n_col_block)
+        {
+            const int col_e = std::min(col_s + solver.n_col_block - 1, in.n_col);
+            const int n_col_in = col_e - col_s + 1;
+
+            Gas_concs<TF> gas_concs_subset(in.gas_concs, col_s, n_col_in);
+
+            std::unique_ptr<Optical_props_arry<TF>> optical_props =
+                    std::make_unique<Optical_props_2str<TF>>(n_col_in, n_lay, *solver.kdist);
+            Array<TF,2> toa_src({n_col_in, n_gpt});
+
+            solver.kdist->gas_optics(
+                    in.p_lay.subset({{ {col_s, col_e}, {1, n_lay} }}),
+                    in.p_lev.subset({{ {col_s, col_e}, {1, n_lev} }}),
+                    in.t_lay.subset({{ {col_s, col_e}, {1, n_lay} }}),
+                    gas_concs_subset,
+                    optical_props,
+                    toa_src,
+                    in.get_col_dry(gas_concs_subset, col_s, col_e));
+
+            if (tsi_scaling.size() > 0)
+                for (int igpt=1; igpt<=n_gpt; ++igpt)
+                    for (int icol=1; icol<=n_col_in; ++icol)
+                        toa_src({icol, igpt}) *= tsi_scaling({icol+col_s-1});
+
+            if (in.block_is_cloudy(col_s, col_e))
+            {
+                Optical_props_2str<TF> cloud_optical_props(n_col_in, n_lay, *solver.cloud_optics);
+                solver.cloud_optics->cloud_optics(
+                        in.lwp.subset({{ {col_s, col_e}, {1, n_lay} }}),
+                        in.iwp.subset({{ {col_s, col_e}, {1, n_lay} }}),
+                        in.rel.subset({{ {col_s, col_e}, {1, n_lay} }}),
+                        in.rei.subset({{ {col_s, col_e}, {1, n_lay} }}),
+                        cloud_optical_props);
+                cloud_optical_props.delta_scale();
+                add_to(*optical_props, cloud_optical_props);
+            }
+
+            Array<TF,3> gpt_flux_up    ({n_col_in, n_lev, n_gpt});
+            Array<TF,3> gpt_flux_dn    ({n_col_in, n_lev, n_gpt});
+            Array<TF,3> gpt_flux_dn_dir({n_col_in, n_lev, n_gpt});
+
+            Rte_sw<TF>::rte_sw(
+                    optical_props,
+                    in.top_at_1,
+                    mu0.subset({{ {col_s, col_e} }}),
+                    toa_src,
+                    sfc_alb_dir.subset({{ {1, n_bnd}, {col_s, col_e} }}),
+                    sfc_alb_dif.subset({{ {1, n_bnd}, {col_s, col_e} }}),
+                    Array<TF,2>(), // Add an empty array, no inc_flux.
+                    gpt_flux_up, gpt_flux_dn, gpt_flux_dn_dir);
+
+            Fluxes_broadband<TF> fluxes(n_col_in, n_lev);
+            fluxes.reduce(gpt_flux_up, gpt_flux_dn, gpt_flux_dn_dir, optical_props, in.top_at_1);
+
+            copy_block(flux_up    , fluxes.get_flux_up    (), col_s);
+            copy_block(flux_dn    , fluxes.get_flux_dn    (), col_s);
+            copy_block(flux_dn_dir, fluxes.get_flux_dn_dir(), col_s);
+            copy_block(flux_net   , fluxes.get_flux_net   (), col_s);
+        }
+    }
+
+    template<typename TF>
+    int solve_lw(
+            const rte_rrtmgp_solver* solver,
+            const int n_col, const int n_lay,
+            const TF* const* vmr, const int* vmr_shape,
+            const TF* p_lay, const TF* p_lev, const TF* t_lay, const TF* t_lev,
+            const TF* col_dry,
+            const TF* t_sfc, const TF* emis_sfc,
+            const TF* lwp, const TF* iwp, const TF* rel, const TF* rei,
+            TF* flux_up, TF* flux_dn, TF* flux_net)
+    {
+        return call_safe([&]()
+        {
+            const Block_solver<TF>& block_solver = get_solver<TF>(solver);
+            check_pointers({t_sfc, emis_sfc, flux_up, flux_dn, flux_net});
+
+            const Column_input<TF> in(
+                    block_solver, n_col, n_lay, vmr, vmr_shape,
+                    p_lay, p_lev, t_lay, t_lev, col_dry, lwp, iwp, rel, rei);
+
+            const int n_bnd = block_solver.get_n_bnd();
+
+            Array<TF,2> flux_up_v (flux_up , {n_col, in.n_lev});
+            Array<TF,2> flux_dn_v (flux_dn , {n_col, in.n_lev});
+            Array<TF,2> flux_net_v(flux_net, {n_col, in.n_lev});
+
+            solve_lw<TF>(
+                    block_solver, in,
+                    make_view<TF,1>(t_sfc, {n_col}), make_view<TF,2>(emis_sfc, {n_bnd, n_col}),
+                    flux_up_v, flux_dn_v, flux_net_v);
+        });
+    }
+
+    template<typename TF>
+    int solve_sw(
+            const rte_rrtmgp_solver* solver,
+            const int n_col, const int n_lay,
+            const TF* const* vmr, const int* vmr_shape,
+            const TF* p_lay, const TF* p_lev, const TF* t_lay, const TF* t_lev,
+            const TF* col_dry,
+            const TF* sfc_alb_dir, const TF* sfc_alb_dif,
+            const TF* mu0, const TF* tsi_scaling,
+            const TF* lwp, const TF* iwp, const TF* rel, const TF* rei,
+            TF* flux_up, TF* flux_dn, TF* flux_dn_dir, TF* flux_net)
+    {
+        return call_safe([&]()
+        {
+            const Block_solver<TF>& block_solver = get_solver<TF>(solver);
+            check_pointers({sfc_alb_dir, sfc_alb_dif, mu0, flux_up, flux_dn, flux_dn_dir, flux_net});
+
+            const Column_input<TF> in(
+                    block_solver, n_col, n_lay, vmr, vmr_shape,
+                    p_lay, p_lev, t_lay, t_lev, col_dry, lwp, iwp, rel, rei);
+
+            const int n_bnd = block_solver.get_n_bnd();
+
+            Array<TF,2> flux_up_v    (flux_up    , {n_col, in.n_lev});
+            Array<TF,2> flux_dn_v    (flux_dn    , {n_col, in.n_lev});
+            Array<TF,2> flux_dn_dir_v(flux_dn_dir, {n_col, in.n_lev});
+            Array<TF,2> flux_net_v   (flux_net   , {n_col, in.n_lev});
+
+            solve_sw<TF>(
+                    block_solver, in,
+                    make_view<TF,2>(sfc_alb_dir, {n_bnd, n_col}), make_view<TF,2>(sfc_alb_dif, {n_bnd, n_col}),
+                    make_view<TF,1>(mu0, {n_col}), make_optional_view<TF,1>(tsi_scaling, {n_col}),
+                    flux_up_v, flux_dn_v, flux_dn_dir_v, flux_net_v);
+        });
+    }
+}
+
+extern "C"
+{
+    const char* rte_rrtmgp_get_last_error(void)
+    {
+        return last_error.c_str();
+    }
+
+    void rte_rrtmgp_solver_destroy(rte_rrtmgp_solver* solver)
+    {
+        delete solver;
+    }
+
+    int rte_rrtmgp_solver_is_longwave(const rte_rrtmgp_solver* solver, int* is_longwave)
+    {
+        return call_safe([&]()
+        {
+            check_pointers({solver, is_longwave});
+            *is_longwave = solver->is_longwave();
+        });
+    }
+
+    int rte_rrtmgp_solver_get_n_bnd(const rte_rrtmgp_solver* solver, int* n_bnd)
+    {
+        return call_safe([&]()
+        {
+            check_pointers({solver, n_bnd});
+            *n_bnd = solver->get_n_bnd();
+        });
+    }
+
+    int rte_rrtmgp_solver_get_n_gpt(const rte_rrtmgp_solver* solver, int* n_gpt)
+    {
+        return call_safe([&]()
+        {
+            check_pointers({solver, n_gpt});
+            *n_gpt = solver->get_n_gpt();
+        });
+    }
+
+    int rte_rrtmgp_solver_set_n_col_block(rte_rrtmgp_solver* solver, int n_col_block)
+    {
+        return call_safe([&]()
+        {
+            check_pointers({solver});
+            if (n_col_block < 1)
+                throw std::runtime_error("The column block size needs to be at least 1");
+            solver->n_col_block = n_col_block;
+        });
+    }
+
+    int rte_rrtmgp_solver_set_validation(rte_rrtmgp_solver* solver, int validation)
+    {
+        return call_safe([&]()
+        {
+            check_pointers({solver});
+            if (validation == RTE_RRTMGP_VALIDATION_FULL)
+                solver->set_validation_policy(Validation_policy::Full);
+            else if (validation == RTE_RRTMGP_VALIDATION_FUSED)
+                solver->set_validation_policy(Validation_policy::Fused);
+            else if (validation == RTE_RRTMGP_VALIDATION_OFF)
+                solver->set_validation_policy(Validation_policy::Off);
+            else
+                throw std::runtime_error("Illegal validation policy");
+        });
+    }
+
+// Only the entry points of the precisions of the build are defined, such that a host that
+// uses another precision fails to link instead of passing arrays of the wrong type.
+#if defined(RTE_RRTMGP_DUAL_PRECISION) || defined(FLOAT_SINGLE_RRTMGP)
+    int rte_rrtmgp_solver_create_f32(
+            rte_rrtmgp_solver** solver,
+            const char* file_name_gas, const char* file_name_cloud,
+            int n_gas, const char* const* gas_names)
+    {
+        return solver_create<float>(solver, file_name_gas, file_name_cloud, n_gas, gas_names);
+    }
+
+    int rte_rrtmgp_solver_create_from_buffer_f32(
+            rte_rrtmgp_solver** solver,
+            const void* buffer_gas, size_t size_gas,
+            const void* buffer_cloud, size_t size_cloud,
+            int n_gas, const char* const* gas_names)
+    {
+        return solver_create_from_buffer<float>(
+                solver, buffer_gas, size_gas, buffer_cloud, size_cloud, n_gas, gas_names);
+    }
+
+    int rte_rrtmgp_solve_lw_f32(
+            const rte_rrtmgp_solver* solver,
+            int n_col, int n_lay,
+            const float* const* vmr, const int* vmr_shape,
+            const float* p_lay, const float* p_lev,
+            const float* t_lay, const float* t_lev,
+            const float* col_dry,
+            const float* t_sfc, const float* emis_sfc,
+            const float* lwp, const float* iwp,
+            const float* rel, const float* rei,
+            float* flux_up, float* flux_dn, float* flux_net)
+    {
+        return solve_lw<float>(
+                solver, n_col, n_lay, vmr, vmr_shape, p_lay, p_lev, t_lay, t_lev, col_dry,
+                t_sfc, emis_sfc, lwp, iwp, rel, rei, flux_up, flux_dn, flux_net);
+    }
+
+    int rte_rrtmgp_solve_sw_f32(
+            const rte_rrtmgp_solver* solver,
+            int n_col, int n_lay,
+            const float* const* vmr, const int* vmr_shape,
+            const float* p_lay, const float* p_lev,
+            const float* t_lay, const float* t_lev,
+            const float* col_dry,
+            const float* sfc_alb_dir, const float* sfc_alb_dif,
+            const float* mu0, const float* tsi_scaling,
+            const float* lwp, const float* iwp,
+            const float* rel, const float* rei,
+            float* flux_up, float* flux_dn,
+            float* flux_dn_dir, float* flux_net)
+    {
+        return solve_sw<float>(
+                solver, n_col, n_lay, vmr, vmr_shape, p_lay, p_lev, t_lay, t_lev, col_dry,
+                sfc_alb_dir, sfc_alb_dif, mu0, tsi_scaling, lwp, iwp, rel, rei,
+                flux_up, flux_dn, flux_dn_dir, flux_net);
+    }
+#endif
+
+#if defined(RTE_RRTMGP_DUAL_PRECISION) || !defined(FLOAT_SINGLE_RRTMGP)
+    int rte_rrtmgp_solver_create_f64(
+            rte_rrtmgp_solver** solver,
+            const char* file_name_gas, const char* file_name_cloud,
+            int n_gas, const char* const* gas_names)
+    {
+        return solver_create<double>(solver, file_name_gas, file_name_cloud, n_gas, gas_names);
+    }
+
+    int rte_rrtmgp_solver_create_from_buffer_f64(
+            rte_rrtmgp_solver** solver,
+            const void* buffer_gas, size_t size_gas,
+            const void* buffer_cloud, size_t size_cloud,
+            int n_gas, const char* const* gas_names)
+    {
+        return solver_create_from_buffer<double>(
+                solver, buffer_gas, size_gas, buffer_cloud, size_cloud, n_gas, gas_names);
+    }
+
+    int rte_rrtmgp_solve_lw_f64(
+            const rte_rrtmgp_solver* solver,
+            int n_col, int n_lay,
+            const double* const* vmr, const int* vmr_shape,
+            const double* p_lay, const double* p_lev,
+            const double* t_lay, const double* t_lev,
+            const double* col_dry,
+            const double* t_sfc, const double* emis_sfc,
+            const double* lwp, const double* iwp,
+            const double* rel, const double* rei,
+            double* flux_up, double* flux_dn, double* flux_net)
+    {
+        return solve_lw<double>(
+                solver, n_col, n_lay, vmr, vmr_shape, p_lay, p_lev, t_lay, t_lev, col_dry,
+                t_sfc, emis_sfc, lwp, iwp, rel, rei, flux_up, flux_dn, flux_net);
+    }
+
+    int rte_rrtmgp_solve_sw_f64(
+            const rte_rrtmgp_solver* solver,
+            int n_col, int n_lay,
+            const double* const* vmr, const int* vmr_shape,
+            const double* p_lay, const double* p_lev,
+            const double* t_lay, const double* t_lev,
+            const double* col_dry,
+            const double* sfc_alb_dir, const double* sfc_alb_dif,
+            const double* mu0, const double* tsi_scaling,
+            const double* lwp, const double* iwp,
+            const double* rel, const double* rei,
+            double* flux_up, double* flux_dn,
+            double* flux_dn_dir, double* flux_net)
+    {
+        return solve_sw<double>(
+                solver, n_col, n_lay, vmr, vmr_shape, p_lay, p_lev, t_lay, t_lev, col_dry,
+                sfc_alb_dir, sfc_alb_dif, mu0, tsi_scaling, lwp, iwp, rel, rei,
+                flux_up, flux_dn, flux_dn_dir, flux_net);
+    }
+#endif
+}
@@ -0,0 +1,43 @@
+#
+# This file is part of a C++ interface to the Radiative Transfer for Energetics (RTE)
+#
+# Append SUFFIX to all global symbols that are defined in the static library LIBRARY,
+# such that the kernels of both precisions can be linked into one executable.
+# Usage: cmake -DLIBRARY=... -DSUFFIX=... -DNM=... -DOBJCOPY=... -P suffix_symbols.cmake
+if(NOT OBJCOPY)
+    message(FATAL_ERROR "A dual-precision build requires objcopy to rename the kernel symbols.")
+endif()
+
+execute_process(
+    COMMAND ${NM} --defined-only --extern-only --format=posix ${LIBRARY}
+    OUTPUT_VARIABLE nm_output
+    RESULT_VARIABLE nm_result)
+
+if(NOT nm_result EQUAL 0)
+    message(FATAL_ERROR "Listing the symbols of ${LIBRARY} failed.")
+endif()
+
+string(REPLACE "\n" ";" nm_lines "${nm_output}")
+
+set(symbols "")
+foreach(line ${nm_lines})
+    if(line MATCHES "^([^ ]+) [BDGRSTVW] ")
+        list(APPEND symbols ${CMAKE_MATCH_1})
+    endif()
+endforeach()
+list(REMOVE_DUPLICATES symbols)
+
+set(symbol_map "")
+foreach(symbol ${symbols})
+    set(symbol_map "${symbol_map}${symbol} ${symbol}${SUFFIX}\n")
+endforeach()
+
+file(WRITE ${LIBRARY}.symbols "${symbol_map}")
+
+execute_process(
+    COMMAND ${OBJCOPY} --redefine-syms=${LIBRARY}.symbols ${LIBRARY}
+    RESULT_VARIABLE objcopy_result)
+
+if(NOT objcopy_result EQUAL 0)
+    message(FATAL_ERROR "Renaming the symbols of ${LIBRARY} failed.")
+endif()
@@ -17,321 +17,583 @@
  * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
 #include <numeric>
+#include <type_traits>
+#include <unordered_map>
 
 #include "Radiation_solver.h"
 #include "Status.h"
-#include "Netcdf_interface.h"
 
 #include "Array.h"
+#include "Coefficient_file.h"
 #include "Gas_concs.h"
 #include "Gas_optics_rrtmgp.h"
 #include "Optical_props.h"
 #include "Source_functions.h"
 #include "Fluxes.h"
+#include "Instrumentation.h"
 #include "Rte_lw.h"
 #include "Rte_sw.h"
 
 namespace
 {
-    std::vector<std::string> get_variable_string(
-            const std::string& var_name,
-            std::vector<int> i_count,
-            Netcdf_handle& input_nc,
-            const int string_len,
-            bool trim=true)
+    // Sort the columns such that the cloud-free columns come first, while keeping the
+    // original order within the clear and the cloudy group. Returns the number of clear columns.
+    template<typename TF>
+    int classify_columns(
+            const Array<TF,2>& lwp, const Array<TF,2>& iwp,
+            Array<int,1>& col_order)
     {
-        // Multiply all elements in i_count.
-        int total_count = std::accumulate(i_count.begin(), i_count.end(), 1, std::multiplies<>());
+        const int n_col = lwp.dim(1);
+        const int n_lay = lwp.dim(2);
+
+        Array<BOOL_TYPE,1> is_cloudy({n_col});
+        for (int ilay=1; ilay<=n_lay; ++ilay)
+            for (int icol=1; icol<=n_col; ++icol)
+            {
+                if ( (lwp({icol, ilay}) > TF(0.)) || (iwp({icol, ilay}) > TF(0.)) )
+                    is_cloudy({icol}) = true;
+            }
 
-        // Add the string length as the rightmost dimension.
-        i_count.push_back(string_len);
+        int n_col_clear = 0;
+        for (int icol=1; icol<=n_col; ++icol)
+            if (!is_cloudy({icol}))
+                col_order({++n_col_clear}) = icol;
+
+        int n_col_sorted = n_col_clear;
+        for (int icol=1; icol<=n_col; ++icol)
+            if (is_cloudy({icol}))
+                col_order({++n_col_sorted}) = icol;
+
+        return n_col_clear;
+    }
 
-        // Read the entire char array;
-        std::vector<char> var_char;
-        var_char = input_nc.get_variable<char>(var_name, i_count);
+    // Copy an array into another precision.
+    template<typename TF_out, typename TF_in, int N>
+    Array<TF_out,N> convert_array(const Array<TF_in,N>& array)
+    {
+        return Array<TF_out,N>(
+                std::vector<TF_out>(array.ptr(), array.ptr() + array.size()), array.get_dims());
+    }
 
-        std::vector<std::string> var;
+    // Copy the contents of an array into an allocated array of another precision.
+    template<typename TF_out, typename TF_in, int N>
+    void copy_array(Array<TF_out,N>& array_out, const Array<TF_in,N>& array_in)
+    {
+        std::copy(array_in.ptr(), array_in.ptr() + array_in.size(), array_out.ptr());
+    }
 
-        for (int n=0; n<total_count; ++n)
+    // Copy the gases into another precision, of a view only its own columns are copied.
+    template<typename TF_out, typename TF_in>
+    Gas_concs<TF_out> convert_gas_concs(const Gas_concs<TF_in>& gas_concs)
+    {
+        Gas_concs<TF_out> gas_concs_out;
+        for (const std::string& name : gas_concs.get_gas_names())
         {
-            std::string s(var_char.begin()+n*string_len, var_char.begin()+(n+1)*string_len);
-            if (trim)
-                boost::trim(s);
-            var.push_back(s);
+            const Array<TF_in,2>& vmr = gas_concs.get_root_vmr(name);
+
+            if (gas_concs.is_view() && vmr.dim(1) > 1)
+            {
+                const int col_s = gas_concs.get_col_offset() + 1;
+                const int col_e = gas_concs.get_col_offset() + gas_concs.get_ncol();
+                gas_concs_out.set_vmr(
+                        name, convert_array<TF_out>(vmr.subset({{ {col_s, col_e}, {1, vmr.dim(2)} }})));
+            }
+            else
+                gas_concs_out.set_vmr(name, convert_array<TF_out>(vmr));
         }
+        return gas_concs_out;
+    }
+
+    // Copy an array with the columns in the order of col_order, col_dim is the column dimension.
+    // The copy has as many columns as col_order, which may skip columns.
+    template<typename TF, int N>
+    Array<TF,N> reorder_columns(
+            const Array<TF,N>& array, const Array<int,1>& col_order, const int col_dim=1)
+    {
+        // Optional input arrays may be empty.
+        if (array.size() == 0)
+            return array;
+
+        std::array<int,N> dims = array.get_dims();
+
+        int n_inner = 1;
+        for (int i=0; i<col_dim-1; ++i)
+            n_inner *= dims[i];
+
+        const int n_col_in = dims[col_dim-1];
+        const int n_col_out = col_order.dim(1);
+        const int n_outer = array.size() / (n_inner*n_col_in);
 
-        return var;
+        dims[col_dim-1] = n_col_out;
+
+        Array<TF,N> array_sorted(dims);
+        for (int io=0; io<n_outer; ++io)
+            for (int icol=0; icol<n_col_out; ++icol)
+            {
+                const int ijk_in  = (col_order({icol+1})-1)*n_inner + io*n_inner*n_col_in;
+                const int ijk_out = icol*n_inner + io*n_inner*n_col_out;
+                for (int ii=0; ii<n_inner; ++ii)
+                    array_sorted.ptr()[ijk_out + ii] = array.ptr()[ijk_in + ii];
+            }
+
+        return array_sorted;
+    }
+
+    // SplitMix64 finalizer, scrambles the bits of a 64-bit key.
+    inline uint64_t splitmix64(uint64_t z)
+    {
+        z += 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
     }
 
+    // Hashes and compares the columns of a set of input fields, to find bit-identical columns.
     template<typename TF>
-    Gas_optics_rrtmgp<TF> load_and_init_gas_optics(
-            const Gas_concs<TF>& gas_concs,
-            const std::string& coef_file)
+    class Column_matcher
+    {
+        public:
+            // Add a field with its columns in dimension col_dim, the columns of a view start after
+            // col_offset. Empty fields and fields with a single value for all columns are skipped.
+            template<int N>
+            void add(const Array<TF,N>& array, const int col_dim=1, const int col_offset=0)
+            {
+                if (array.size() == 0 || array.dim(col_dim) == 1)
+                    return;
+
+                int n_inner = 1;
+                for (int i=1; i<col_dim; ++i)
+                    n_inner *= array.dim(i);
+
+                const int n_col = array.dim(col_dim);
+                const int n_outer = array.size() / (n_inner*n_col);
+
+                fields.push_back({array.ptr(), n_inner, n_col, n_outer, col_offset});
+            }
+
+            // Add the gases that vary over the columns.
+            void add(const Gas_concs<TF>& gas_concs)
+            {
+                for (const std::string& name : gas_concs.get_gas_names())
+                    add(gas_concs.get_root_vmr(name), 1, gas_concs.get_col_offset());
+            }
+
+            uint64_t hash(const int icol) const
+            {
+                uint64_t h = 0;
+                for (const Field& field : fields)
+                    for (int io=0; io<field.n_outer; ++io)
+                    {
+                        const TF* data = field.get_column(icol, io);
+                        for (int ii=0; ii<field.n_inner; ++ii)
+                        {
+                            uint64_t bits = 0;
+                            std::memcpy(&bits, &data[ii], sizeof(TF));
+                            h = splitmix64(h ^ bits);
+                        }
+                    }
+                return h;
+            }
+
+            bool equal(const int icol_a, const int icol_b) const
+            {
+                for (const Field& field : fields)
+                    for (int io=0; io<field.n_outer; ++io)
+                    {
+                        if (std::memcmp(
+                                    field.get_column(icol_a, io), field.get_column(icol_b, io),
+                                    field.n_inner*sizeof(TF)) != 0)
+                            return false;
+                    }
+                return true;
+            }
+
+        private:
+            struct Field
+            {
+                const TF* data;
+                int n_inner;
+                int n_col;
+                int n_outer;
+                int col_offset;
+
+                const TF* get_column(const int icol, const int io) const
+                {
+                    return data + (icol-1+col_offset)*n_inner + io*n_inner*n_col;
+                }
+            };
+
+            std::vector<Field> fields;
+    };
+
+    // Map each column onto the first column with bit-identical inputs, the hash collisions are
+    // resolved by comparing the columns. Returns the number of unique columns.
+    template<typename TF>
+    int find_unique_columns(const Column_matcher<TF>& matcher, Array<int,1>& col_rep)
+    {
+        const int n_col = col_rep.dim(1);
+
+        std::unordered_map<uint64_t, std::vector<int>> unique_cols;
+        int n_col_unique = 0;
+
+        for (int icol=1; icol<=n_col; ++icol)
+        {
+            std::vector<int>& candidates = unique_cols[matcher.hash(icol)];
+            auto it = std::find_if(
+                    candidates.begin(), candidates.end(),
+                    [&](const int jcol) { return matcher.equal(icol, jcol); });
+
+            if (it == candidates.end())
+            {
+                candidates.push_back(icol);
+                col_rep({icol}) = icol;
+                ++n_col_unique;
+            }
+            else
+                col_rep({icol}) = *it;
+        }
+
+        return n_col_unique;
+    }
+
+    // Keep the columns of col_order that are selected, in the same order.
+    // Returns the number of selected clear columns.
+    template<typename Func>
+    int select_columns(Array<int,1>& col_order, const int n_col_clear, Func&& is_selected)
     {
-        // READ THE COEFFICIENTS FOR THE OPTICAL SOLVER.
-        Netcdf_file coef_nc(coef_file, Netcdf_mode::Read);
-
-        // Read k-distribution information.
-        int n_temps = coef_nc.get_dimension_size("temperature");
-        int n_press = coef_nc.get_dimension_size("pressure");
-        int n_absorbers = coef_nc.get_dimension_size("absorber");
-
-        // CvH: I hardcode the value to 32 now, because coef files
-        // CvH: changed dimension name inconsistently.
-        // int n_char = coef_nc.get_dimension_size("string_len");
-        constexpr int n_char = 32;
-
-        int n_minorabsorbers = coef_nc.get_dimension_size("minor_absorber");
-        int n_extabsorbers = coef_nc.get_dimension_size("absorber_ext");
-        int n_mixingfracs = coef_nc.get_dimension_size("mixing_fraction");
-        int n_layers = coef_nc.get_dimension_size("atmos_layer");
-        int n_bnds = coef_nc.get_dimension_size("bnd");
-        int n_gpts = coef_nc.get_dimension_size("gpt");
-        int n_pairs = coef_nc.get_dimension_size("pair");
-        int n_minor_absorber_intervals_lower = coef_nc.get_dimension_size("minor_absorber_intervals_lower");
-        int n_minor_absorber_intervals_upper = coef_nc.get_dimension_size("minor_absorber_intervals_upper");
-        int n_contributors_lower = coef_nc.get_dimension_size("contributors_lower");
-        int n_contributors_upper = coef_nc.get_dimension_size("contributors_upper");
-
-        // Read gas names.
-        Array<std::string,1> gas_names(
-                get_variable_string("gas_names", {n_absorbers}, coef_nc, n_char, true), {n_absorbers});
-
-        Array<int,3> key_species(
-                coef_nc.get_variable<int>("key_species", {n_bnds, n_layers, 2}),
-                {2, n_layers, n_bnds});
-        Array<TF,2> band_lims(coef_nc.get_variable<TF>("bnd_limits_wavenumber", {n_bnds, 2}), {2, n_bnds});
-        Array<int,2> band2gpt(coef_nc.get_variable<int>("bnd_limits_gpt", {n_bnds, 2}), {2, n_bnds});
-        Array<TF,1> press_ref(coef_nc.get_variable<TF>("press_ref", {n_press}), {n_press});
-        Array<TF,1> temp_ref(coef_nc.get_variable<TF>("temp_ref", {n_temps}), {n_temps});
-
-        TF temp_ref_p = coef_nc.get_variable<TF>("absorption_coefficient_ref_P");
-        TF temp_ref_t = coef_nc.get_variable<TF>("absorption_coefficient_ref_T");
-        TF press_ref_trop = coef_nc.get_variable<TF>("press_ref_trop");
-
-        Array<TF,3> kminor_lower(
-                coef_nc.get_variable<TF>("kminor_lower", {n_temps, n_mixingfracs, n_contributors_lower}),
-                {n_contributors_lower, n_mixingfracs, n_temps});
-        Array<TF,3> kminor_upper(
-                coef_nc.get_variable<TF>("kminor_upper", {n_temps, n_mixingfracs, n_contributors_upper}),
-                {n_contributors_upper, n_mixingfracs, n_temps});
-
-        Array<std::string,1> gas_minor(get_variable_string("gas_minor", {n_minorabsorbers}, coef_nc, n_char),
-                                       {n_minorabsorbers});
-
-        Array<std::string,1> identifier_minor(
-                get_variable_string("identifier_minor", {n_minorabsorbers}, coef_nc, n_char), {n_minorabsorbers});
-
-        Array<std::string,1> minor_gases_lower(
-                get_variable_string("minor_gases_lower", {n_minor_absorber_intervals_lower}, coef_nc, n_char),
-                {n_minor_absorber_intervals_lower});
-        Array<std::string,1> minor_gases_upper(
-                get_variable_string("minor_gases_upper", {n_minor_absorber_intervals_upper}, coef_nc, n_char),
-                {n_minor_absorber_intervals_upper});
-
-        Array<int,2> minor_limits_gpt_lower(
-                coef_nc.get_variable<int>("minor_limits_gpt_lower", {n_minor_absorber_intervals_lower, n_pairs}),
-                {n_pairs, n_minor_absorber_intervals_lower});
-        Array<int,2> minor_limits_gpt_upper(
-                coef_nc.get_variable<int>("minor_limits_gpt_upper", {n_minor_absorber_intervals_upper, n_pairs}),
-                {n_pairs, n_minor_absorber_intervals_upper});
-
-        Array<BOOL_TYPE,1> minor_scales_with_density_lower(
-                coef_nc.get_variable<BOOL_TYPE>("minor_scales_with_density_lower", {n_minor_absorber_intervals_lower}),
-                {n_minor_absorber_intervals_lower});
-        Array<BOOL_TYPE,1> minor_scales_with_density_upper(
-                coef_nc.get_variable<BOOL_TYPE>("minor_scales_with_density_upper", {n_minor_absorber_intervals_upper}),
-                {n_minor_absorber_intervals_upper});
-
-        Array<BOOL_TYPE,1> scale_by_complement_lower(
-                coef_nc.get_variable<BOOL_TYPE>("scale_by_complement_lower", {n_minor_absorber_intervals_lower}),
-                {n_minor_absorber_intervals_lower});
-        Array<BOOL_TYPE,1> scale_by_complement_upper(
-                coef_nc.get_variable<BOOL_TYPE>("scale_by_complement_upper", {n_minor_absorber_intervals_upper}),
-                {n_minor_absorber_intervals_upper});
-
-        Array<std::string,1> scaling_gas_lower(
-                get_variable_string("scaling_gas_lower", {n_minor_absorber_intervals_lower}, coef_nc, n_char),
-                {n_minor_absorber_intervals_lower});
-        Array<std::string,1> scaling_gas_upper(
-                get_variable_string("scaling_gas_upper", {n_minor_absorber_intervals_upper}, coef_nc, n_char),
-                {n_minor_absorber_intervals_upper});
-
-        Array<int,1> kminor_start_lower(
-                coef_nc.get_variable<int>("kminor_start_lower", {n_minor_absorber_intervals_lower}),
-                {n_minor_absorber_intervals_lower});
-        Array<int,1> kminor_start_upper(
-                coef_nc.get_variable<int>("kminor_start_upper", {n_minor_absorber_intervals_upper}),
-                {n_minor_absorber_intervals_upper});
-
-        Array<TF,3> vmr_ref(
-                coef_nc.get_variable<TF>("vmr_ref", {n_temps, n_extabsorbers, n_layers}),
-                {n_layers, n_extabsorbers, n_temps});
-
-        Array<TF,4> kmajor(
-                coef_nc.get_variable<TF>("kmajor", {n_temps, n_press+1, n_mixingfracs, n_gpts}),
-                {n_gpts, n_mixingfracs, n_press+1, n_temps});
-
-        // Keep the size at zero, if it does not exist.
-        Array<TF,3> rayl_lower;
-        Array<TF,3> rayl_upper;
-
-        if (coef_nc.variable_exists("rayl_lower"))
-        {
-            rayl_lower.set_dims({n_gpts, n_mixingfracs, n_temps});
-            rayl_upper.set_dims({n_gpts, n_mixingfracs, n_temps});
-            rayl_lower = coef_nc.get_variable<TF>("rayl_lower", {n_temps, n_mixingfracs, n_gpts});
-            rayl_upper = coef_nc.get_variable<TF>("rayl_upper", {n_temps, n_mixingfracs, n_gpts});
-        }
-
-        // Is it really LW if so read these variables as well.
-        if (coef_nc.variable_exists("totplnk"))
-        {
-            int n_internal_sourcetemps = coef_nc.get_dimension_size("temperature_Planck");
-
-            Array<TF,2> totplnk(
-                    coef_nc.get_variable<TF>( "totplnk", {n_bnds, n_internal_sourcetemps}),
-                    {n_internal_sourcetemps, n_bnds});
-            Array<TF,4> planck_frac(
-                    coef_nc.get_variable<TF>("plank_fraction", {n_temps, n_press+1, n_mixingfracs, n_gpts}),
-                    {n_gpts, n_mixingfracs, n_press+1, n_temps});
-
-            // Construct the k-distribution.
-            return Gas_optics_rrtmgp<TF>(
-                    gas_concs,
-                    gas_names,
-                    key_species,
-                    band2gpt,
-                    band_lims,
-                    press_ref,
-                    press_ref_trop,
-                    temp_ref,
-                    temp_ref_p,
-                    temp_ref_t,
-                    vmr_ref,
-                    kmajor,
-                    kminor_lower,
-                    kminor_upper,
-                    gas_minor,
-                    identifier_minor,
-                    minor_gases_lower,
-                    minor_gases_upper,
-                    minor_limits_gpt_lower,
-                    minor_limits_gpt_upper,
-                    minor_scales_with_density_lower,
-                    minor_scales_with_density_upper,
-                    scaling_gas_lower,
-                    scaling_gas_upper,
-                    scale_by_complement_lower,
-                    scale_by_complement_upper,
-                    kminor_start_lower,
-                    kminor_start_upper,
-                    totplnk,
-                    planck_frac,
-                    rayl_lower,
-                    rayl_upper);
+        std::vector<int> col_order_selected;
+
+        int n_col_selected_clear = 0;
+        for (int i=1; i<=col_order.dim(1); ++i)
+        {
+            const int icol = col_order({i});
+            if (is_selected(icol))
+            {
+                col_order_selected.push_back(icol);
+                if (i <= n_col_clear)
+                    ++n_col_selected_clear;
+            }
         }
-        else
+
+        const int n_col_selected = col_order_selected.size();
+        col_order = Array<int,1>(std::move(col_order_selected), {n_col_selected});
+        return n_col_selected_clear;
+    }
+
+    // A group of identical columns is solved again if any of its columns changed. The unchanged
+    // columns keep their own cached outputs. Returns the number of changed columns.
+    int propagate_changed_columns(Array<int,1>& col_rep, Array<BOOL_TYPE,1>& is_changed)
+    {
+        const int n_col = col_rep.dim(1);
+
+        for (int icol=1; icol<=n_col; ++icol)
+            if (is_changed({icol}))
+                is_changed({col_rep({icol})}) = true;
+
+        int n_col_changed = 0;
+        for (int icol=1; icol<=n_col; ++icol)
         {
-            Array<TF,1> solar_src_quiet(
-                    coef_nc.get_variable<TF>("solar_source_quiet", {n_gpts}), {n_gpts});
-            Array<TF,1> solar_src_facular(
-                    coef_nc.get_variable<TF>("solar_source_facular", {n_gpts}), {n_gpts});
-            Array<TF,1> solar_src_sunspot(
-                    coef_nc.get_variable<TF>("solar_source_sunspot", {n_gpts}), {n_gpts});
-
-            TF tsi = coef_nc.get_variable<TF>("tsi_default");
-            TF mg_index = coef_nc.get_variable<TF>("mg_default");
-            TF sb_index = coef_nc.get_variable<TF>("sb_default");
-
-            return Gas_optics_rrtmgp<TF>(
-                    gas_concs,
-                    gas_names,
-                    key_species,
-                    band2gpt,
-                    band_lims,
-                    press_ref,
-                    press_ref_trop,
-                    temp_ref,
-                    temp_ref_p,
-                    temp_ref_t,
-                    vmr_ref,
-                    kmajor,
-                    kminor_lower,
-                    kminor_upper,
-                    gas_minor,
-                    identifier_minor,
-                    minor_gases_lower,
-                    minor_gases_upper,
-                    minor_limits_gpt_lower,
-                    minor_limits_gpt_upper,
-                    minor_scales_with_density_lower,
-                    minor_scales_with_density_upper,
-                    scaling_gas_lower,
-                    scaling_gas_upper,
-                    scale_by_complement_lower,
-                    scale_by_complement_upper,
-                    kminor_start_lower,
-                    kminor_start_upper,
-                    solar_src_quiet,
-                    solar_src_facular,
-                    solar_src_sunspot,
-                    tsi,
-                    mg_index,
-                    sb_index,
-                    rayl_lower,
-                    rayl_upper);
-        }
-        // End reading of k-distribution.
+            is_changed({icol}) = is_changed({col_rep({icol})});
+            if (is_changed({icol}))
+                ++n_col_changed;
+            else
+                col_rep({icol}) = icol;
+        }
+
+        return n_col_changed;
+    }
+
+    // Copy the outputs of the solved columns to their duplicates, the columns are in dimension 1.
+    template<typename TF, int N>
+    void broadcast_columns(Array<TF,N>& array, const Array<int,1>& col_rep)
+    {
+        // Outputs that are not requested may be empty.
+        if (array.size() == 0)
+            return;
+
+        const int n_col = array.dim(1);
+        const int n_outer = array.size() / n_col;
+
+        for (int io=0; io<n_outer; ++io)
+            for (int icol=1; icol<=n_col; ++icol)
+            {
+                const int icol_rep = col_rep({icol});
+                if (icol_rep != icol)
+                    array.ptr()[icol-1 + io*n_col] = array.ptr()[icol_rep-1 + io*n_col];
+            }
     }
+}
+
+// Inputs and outputs of the last solve of each column for the incremental mode. The cached inputs
+// of a column are those of its last solve, such that slow drifts eventually trigger a new solve.
+// The state is kept per column offset, a call compares its columns with the last call that had the
+// same offset, so the callers have to pass the same columns at the same offset on every call.
+template<typename TF>
+class Column_cache
+{
+    public:
+        explicit Column_cache(const Resolve_thresholds<TF>& thresholds) : thresholds(thresholds) {}
+
+        const Resolve_thresholds<TF>& get_thresholds() const { return thresholds; }
+        std::mutex& get_mutex() { return mutex; }
+
+        double get_recompute_fraction() const { return recompute_fraction; }
+        void set_recompute_fraction(const double fraction) { recompute_fraction = fraction; }
+
+        // Start a call with n_col columns at col_offset in the domain, the inputs and outputs of
+        // the call are added after this.
+        void start(const int n_col, const int col_offset)
+        {
+            this->n_col = n_col;
+            this->domain = &domains[col_offset];
+            inputs.clear();
+            outputs.clear();
+        }
+
+        // Drop the cached state of all offsets, such that the next calls solve all columns.
+        void reset()
+        {
+            domains.clear();
+            domain = nullptr;
+            recompute_fraction = 1.;
+        }
+
+        // Add an input with its columns in dimension col_dim, the columns of a view start after
+        // col_offset. A change is significant if it exceeds the threshold, which is relative to
+        // the cached value if is_relative. Fields with one column are used for all columns.
+        template<int N>
+        void add_input(
+                const Array<TF,N>& array, const TF threshold, const bool is_relative=false,
+                const int col_dim=1, const int col_offset=0)
+        {
+            // Optional inputs may be empty.
+            if (array.size() == 0)
+                return;
+
+            int n_inner = 1;
+            for (int i=1; i<col_dim; ++i)
+                n_inner *= array.dim(i);
+
+            const int n_col_array = array.dim(col_dim);
+            const int n_outer = array.size() / (n_inner*n_col_array);
+
+            inputs.push_back({array.ptr(), n_inner, n_col_array, n_outer, col_offset, threshold, is_relative});
+        }
+
+        void add_input(const Gas_concs<TF>& gas_concs, const TF threshold)
+        {
+            for (const std::string& name : gas_concs.get_gas_names())
+                add_input(gas_concs.get_root_vmr(name), threshold, true, 1, gas_concs.get_col_offset());
+        }
+
+        // Add an output with its columns in dimension 1.
+        template<int N>
+        void add_output(Array<TF,N>& array)
+        {
+            if (array.dim(1) != n_col)
+                throw std::runtime_error("The outputs of the incremental mode need one entry per column");
+
+            outputs.push_back({array.ptr(), int(array.size()) / n_col});
+        }
+
+        // Flag the columns of which an input changed beyond its threshold. All columns are flagged
+        // if there is no cache yet, or if the inputs or outputs differ in shape from the cached ones.
+        void find_changed_columns(Array<BOOL_TYPE,1>& is_changed) const
+        {
+            const bool is_valid = (get_layout() == domain->cached_layout);
+
+            for (int icol=1; icol<=n_col; ++icol)
+                is_changed({icol}) = !is_valid;
 
+            if (!is_valid)
+                return;
+
+            for (size_t i=0; i<inputs.size(); ++i)
+            {
+                const Input& input = inputs[i];
+                const int n_inner = input.n_inner;
+
+                for (int io=0; io<input.n_outer; ++io)
+                    for (int icol=1; icol<=n_col; ++icol)
+                    {
+                        if (is_changed({icol}))
+                            continue;
+
+                        const TF* data = input.get_column(icol, io);
+                        const TF* data_cached = domain->cached_inputs[i].data() + ((icol-1) + io*n_col)*n_inner;
+
+                        for (int ii=0; ii<n_inner; ++ii)
+                        {
+                            const TF limit = input.is_relative ?
+                                    input.threshold*std::abs(data_cached[ii]) : input.threshold;
+
+                            // A NaN counts as a change.
+                            if (!(std::abs(data[ii] - data_cached[ii]) <= limit))
+                            {
+                                is_changed({icol}) = true;
+                                break;
+                            }
+                        }
+                    }
+            }
+        }
+
+        // Copy the cached outputs into the columns that are not solved.
+        void restore_outputs(const Array<BOOL_TYPE,1>& is_changed) const
+        {
+            for (size_t i=0; i<outputs.size(); ++i)
+                for (int io=0; io<outputs[i].n_outer; ++io)
+                    for (int icol=1; icol<=n_col; ++icol)
+                        if (!is_changed({icol}))
+                            outputs[i].data[(icol-1) + io*n_col] = domain->cached_outputs[i][(icol-1) + io*n_col];
+        }
+
+        // Store the inputs and outputs of the solved columns.
+        void store(const Array<BOOL_TYPE,1>& is_changed)
+        {
+            std::vector<int> layout = get_layout();
+            std::vector<int>& cached_layout = domain->cached_layout;
+            std::vector<std::vector<TF>>& cached_inputs = domain->cached_inputs;
+            std::vector<std::vector<TF>>& cached_outputs = domain->cached_outputs;
+
+            if (layout != cached_layout)
+            {
+                cached_inputs.resize(inputs.size());
+                for (size_t i=0; i<inputs.size(); ++i)
+                    cached_inputs[i].assign(inputs[i].n_inner*n_col*inputs[i].n_outer, TF(0.));
+
+                cached_outputs.resize(outputs.size());
+                for (size_t i=0; i<outputs.size(); ++i)
+                    cached_outputs[i].assign(n_col*outputs[i].n_outer, TF(0.));
+
+                cached_layout = std::move(layout);
+            }
+
+            for (size_t i=0; i<inputs.size(); ++i)
+            {
+                const Input& input = inputs[i];
+                for (int io=0; io<input.n_outer; ++io)
+                    for (int icol=1; icol<=n_col; ++icol)
+                        if (is_changed({icol}))
+                            std::copy(
+                                    input.get_column(icol, io), input.get_column(icol, io) + input.n_inner,
+                                    cached_inputs[i].data() + ((icol-1) + io*n_col)*input.n_inner);
+            }
+
+            for (size_t i=0; i<outputs.size(); ++i)
+                for (int io=0; io<outputs[i].n_outer; ++io)
+                    for (int icol=1; icol<=n_col; ++icol)
+                        if (is_changed({icol}))
+                            cached_outputs[i][(icol-1) + io*n_col] = outputs[i].data[(icol-1) + io*n_col];
+        }
+
+    private:
+        struct Input
+        {
+            const TF* data;
+            int n_inner;
+            int n_col;
+            int n_outer;
+            int col_offset;
+            TF threshold;
+            bool is_relative;
+
+            const TF* get_column(const int icol, const int io) const
+            {
+                const int jcol = (n_col == 1) ? 0 : icol-1+col_offset;
+                return data + jcol*n_inner + io*n_inner*n_col;
+            }
+        };
+
+        struct Output
+        {
+            TF* data;
+            int n_outer;
+        };
+
+        struct Domain
+        {
+            std::vector<int> cached_layout;
+            std::vector<std::vector<TF>> cached_inputs;
+            std::vector<std::vector<TF>> cached_outputs;
+        };
+
+        std::vector<int> get_layout() const
+        {
+            std::vector<int> layout{n_col, int(inputs.size()), int(outputs.size())};
+            for (const Input& input : inputs)
+            {
+                layout.push_back(input.n_inner);
+                layout.push_back(input.n_outer);
+            }
+            for (const Output& output : outputs)
+                layout.push_back(output.n_outer);
+            return layout;
+        }
+
+        const Resolve_thresholds<TF> thresholds;
+        std::mutex mutex;
+        double recompute_fraction = 1.;
+
+        int n_col = 0;
+        std::vector<Input> inputs;
+        std::vector<Output> outputs;
+
+        std::unordered_map<int, Domain> domains;
+        Domain* domain = nullptr;
+};
+
+// Monte Carlo spectral integration.
+namespace
+{
+    // Counter-based random number, each (seed, step, column, counter) gives an independent number
+    // without any generator state, such that the samples do not depend on the blocks or threads.
+    inline uint64_t counter_based_random(
+            const uint64_t seed, const uint64_t step, const uint64_t col, const uint64_t counter)
+    {
+        return splitmix64(splitmix64(splitmix64(splitmix64(seed) ^ step) ^ col) ^ counter);
+    }
+
+    // Draw n_sample distinct g-points per column with a partial Fisher-Yates shuffle.
+    Array<int,2> sample_gpts(
+            const int n_gpt, const int n_sample, const int n_col, const int col_offset,
+            const uint64_t seed, const uint64_t step)
+    {
+        Array<int,2> gpts({n_sample, n_col});
+        std::vector<int> gpt_order(n_gpt);
+
+        for (int icol=1; icol<=n_col; ++icol)
+        {
+            std::iota(gpt_order.begin(), gpt_order.end(), 1);
+            for (int isample=0; isample<n_sample; ++isample)
+            {
+                const uint64_t r = counter_based_random(seed, step, icol+col_offset, isample);
+                const int j = isample + static_cast<int>(r % uint64_t(n_gpt-isample));
+                std::swap(gpt_order[isample], gpt_order[j]);
+                gpts({isample+1, icol}) = gpt_order[isample];
+            }
+        }
+
+        return gpts;
+    }
+
+    // Each sample gets its own band, such that the surface properties can differ per column and sample.
     template<typename TF>
-    Cloud_optics<TF> load_and_init_cloud_optics(
-            const std::string& coef_file)
+    std::unique_ptr<Optical_props<TF>> make_sample_props(const int n_sample)
     {
-        // READ THE COEFFICIENTS FOR THE OPTICAL SOLVER.
-        Netcdf_file coef_nc(coef_file, Netcdf_mode::Read);
-
-        // Read look-up table coefficient dimensions
-        int n_band     = coef_nc.get_dimension_size("nband");
-        int n_rghice   = coef_nc.get_dimension_size("nrghice");
-        int n_size_liq = coef_nc.get_dimension_size("nsize_liq");
-        int n_size_ice = coef_nc.get_dimension_size("nsize_ice");
-
-        Array<TF,2> band_lims_wvn(coef_nc.get_variable<TF>("bnd_limits_wavenumber", {n_band, 2}), {2, n_band});
-
-        // Read look-up table constants.
-        TF radliq_lwr = coef_nc.get_variable<TF>("radliq_lwr");
-        TF radliq_upr = coef_nc.get_variable<TF>("radliq_upr");
-        TF radliq_fac = coef_nc.get_variable<TF>("radliq_fac");
-
-        TF radice_lwr = coef_nc.get_variable<TF>("radice_lwr");
-        TF radice_upr = coef_nc.get_variable<TF>("radice_upr");
-        TF radice_fac = coef_nc.get_variable<TF>("radice_fac");
-
-        Array<TF,2> lut_extliq(
-                coef_nc.get_variable<TF>("lut_extliq", {n_band, n_size_liq}), {n_size_liq, n_band});
-        Array<TF,2> lut_ssaliq(
-                coef_nc.get_variable<TF>("lut_ssaliq", {n_band, n_size_liq}), {n_size_liq, n_band});
-        Array<TF,2> lut_asyliq(
-                coef_nc.get_variable<TF>("lut_asyliq", {n_band, n_size_liq}), {n_size_liq, n_band});
-
-        Array<TF,3> lut_extice(
-                coef_nc.get_variable<TF>("lut_extice", {n_rghice, n_band, n_size_ice}), {n_size_ice, n_band, n_rghice});
-        Array<TF,3> lut_ssaice(
-                coef_nc.get_variable<TF>("lut_ssaice", {n_rghice, n_band, n_size_ice}), {n_size_ice, n_band, n_rghice});
-        Array<TF,3> lut_asyice(
-                coef_nc.get_variable<TF>("lut_asyice", {n_rghice, n_band, n_size_ice}), {n_size_ice, n_band, n_rghice});
-
-        return Cloud_optics<TF>(
-                band_lims_wvn,
-                radliq_lwr, radliq_upr, radliq_fac,
-                radice_lwr, radice_upr, radice_fac,
-                lut_extliq, lut_ssaliq, lut_asyliq,
-                lut_extice, lut_ssaice, lut_asyice);
+        Array<TF,2> band_lims_wvn({2, n_sample});
+        for (int isample=1; isample<=n_sample; ++isample)
+        {
+            band_lims_wvn({1, isample}) = TF(isample);
+            band_lims_wvn({2, isample}) = TF(isample+1);
+        }
+        return std::make_unique<Optical_props<TF>>(band_lims_wvn);
     }
 }
 
@@ -339,18 +601,681 @@ template<typename TF>
 Radiation_solver_longwave<TF>::Radiation_solver_longwave(
         const Gas_concs<TF>& gas_concs,
         const std::string& file_name_gas,
-        const std::string& file_name_cloud)
+        const std::string& file_name_cloud,
+        const bool switch_mixed_precision) :
+    Radiation_solver_longwave(gas_concs, Coefficient_file(file_name_gas), nullptr, switch_mixed_precision)
+{
+    this->cloud_optics = load_cloud_optics<TF>(Coefficient_file(file_name_cloud));
+}
+
+template<typename TF>
+Radiation_solver_longwave<TF>::Radiation_solver_longwave(
+        const Gas_concs<TF>& gas_concs,
+        const Coefficient_file& coef_gas,
+        const Coefficient_file* coef_cloud,
+        const bool switch_mixed_precision) :
+    switch_mixed_precision(switch_mixed_precision)
+{
+    // Construct the gas optics classes for the solver, the cloud optics are optional.
+    this->kdist = load_gas_optics<TF>(coef_gas, gas_concs);
+
+    if (coef_cloud)
+        this->cloud_optics = load_cloud_optics<TF>(*coef_cloud);
+
+    // In mixed precision, the gas optics are computed in single precision and the solver in TF.
+    if (switch_mixed_precision)
+    {
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+        if (!std::is_same<TF, double>::value)
+            throw std::runtime_error("Mixed precision requires a double precision solver");
+
+        this->kdist_sp = load_gas_optics<float>(coef_gas, convert_gas_concs<float>(gas_concs));
+#else
+        throw std::runtime_error("Mixed precision requires a build with FLOAT_TYPE=dual");
+#endif
+    }
+}
+
+template<typename TF>
+void Radiation_solver_longwave<TF>::set_n_col_block(const int n_col_block)
+{
+    if (n_col_block < 1)
+        throw std::runtime_error("The column block size needs to be at least 1");
+    this->n_col_block = n_col_block;
+}
+
+template<typename TF>
+Radiation_solver_longwave<TF>::~Radiation_solver_longwave() = default;
+
+template<typename TF>
+void Radiation_solver_longwave<TF>::set_deduplicate_columns(const bool deduplicate_columns)
+{
+    this->deduplicate_columns = deduplicate_columns;
+}
+
+template<typename TF>
+void Radiation_solver_longwave<TF>::set_validation_policy(const Validation_policy policy)
+{
+    this->kdist->set_validation_policy(policy);
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+    if (this->kdist_sp)
+        this->kdist_sp->set_validation_policy(policy);
+#endif
+}
+
+template<typename TF>
+void Radiation_solver_longwave<TF>::set_incremental(
+        const bool incremental, const Resolve_thresholds<TF>& thresholds)
+{
+    if (thresholds.temperature < 0 || thresholds.pressure < 0 || thresholds.vmr_relative < 0 ||
+            thresholds.water_path < 0 || thresholds.effective_radius < 0 || thresholds.boundary < 0)
+        throw std::runtime_error("The thresholds of the incremental mode cannot be negative");
+
+    this->column_cache = incremental ? std::make_unique<Column_cache<TF>>(thresholds) : nullptr;
+}
+
+template<typename TF>
+double Radiation_solver_longwave<TF>::get_recompute_fraction() const
+{
+    if (!this->column_cache)
+        return 1.;
+
+    std::lock_guard<std::mutex> lock(this->column_cache->get_mutex());
+    return this->column_cache->get_recompute_fraction();
+}
+
+template<typename TF>
+void Radiation_solver_longwave<TF>::reset_incremental()
+{
+    if (!this->column_cache)
+        return;
+
+    std::lock_guard<std::mutex> lock(this->column_cache->get_mutex());
+    this->column_cache->reset();
+}
+
+template<typename TF>
+void Radiation_solver_longwave<TF>::solve(
+        const bool switch_fluxes,
+        const bool switch_cloud_optics,
+        const bool switch_output_optical,
+        const bool switch_output_bnd_fluxes,
+        const bool switch_output_jacobian,
+        const Gas_concs<TF>& gas_concs,
+        const Array<TF,2>& p_lay, const Array<TF,2>& p_lev,
+        const Array<TF,2>& t_lay, const Array<TF,2>& t_lev,
+        const Array<TF,2>& col_dry,
+        const Array<TF,1>& t_sfc, const Array<TF,2>& emis_sfc,
+        const Array<TF,2>& lwp, const Array<TF,2>& iwp,
+        const Array<TF,2>& rel, const Array<TF,2>& rei,
+        Array<TF,3>& tau, Array<TF,3>& lay_source,
+        Array<TF,3>& lev_source_inc, Array<TF,3>& lev_source_dec, Array<TF,2>& sfc_source,
+        Array<TF,2>& lw_flux_up, Array<TF,2>& lw_flux_dn, Array<TF,2>& lw_flux_net,
+        Array<TF,3>& lw_bnd_flux_up, Array<TF,3>& lw_bnd_flux_dn, Array<TF,3>& lw_bnd_flux_net,
+        Array<TF,2>& lw_flux_up_jac,
+        const int col_offset) const
+{
+    const int n_col = p_lay.dim(1);
+    const int n_lay = p_lay.dim(2);
+    const int n_lev = p_lev.dim(2);
+    const int n_gpt = this->kdist->get_ngpt();
+    const int n_bnd = this->kdist->get_nband();
+
+    using Instrumentation::Stage;
+
+    const BOOL_TYPE top_at_1 = p_lay({1, 1}) < p_lay({1, n_lay});
+
+    const int n_col_block = this->n_col_block;
+
+    if (switch_cloud_optics && !this->cloud_optics)
+        throw std::runtime_error("The cloud optics require a solver with cloud coefficients");
+
+    // Regroup the columns such that each block is either fully clear or cloudy, the clear
+    // blocks can then skip the cloud optics. The outputs are written back in the original order.
+    Array<int,1> col_order({n_col});
+    std::iota(col_order.v().begin(), col_order.v().end(), 1);
+
+    int n_col_clear = n_col;
+    if (switch_cloud_optics)
+        n_col_clear = classify_columns(lwp, iwp, col_order);
+
+    // Solve only the first of each set of columns with identical inputs, the others get a copy.
+    Array<int,1> col_rep({n_col});
+    std::iota(col_rep.v().begin(), col_rep.v().end(), 1);
+    int n_col_unique = n_col;
+
+    if (this->deduplicate_columns)
+    {
+        Instrumentation::Scoped_timer timer(Stage::Input_subset);
+
+        Column_matcher<TF> matcher;
+        matcher.add(gas_concs);
+        matcher.add(p_lay); matcher.add(p_lev);
+        matcher.add(t_lay); matcher.add(t_lev);
+        matcher.add(col_dry);
+        matcher.add(t_sfc); matcher.add(emis_sfc, 2);
+        if (switch_cloud_optics)
+        {
+            matcher.add(lwp); matcher.add(iwp);
+            matcher.add(rel); matcher.add(rei);
+        }
+
+        n_col_unique = find_unique_columns(matcher, col_rep);
+        if (n_col_unique < n_col)
+            n_col_clear = select_columns(
+                    col_order, n_col_clear, [&](const int icol) { return col_rep({icol}) == icol; });
+    }
+
+    // In incremental mode, only the columns of which the inputs changed beyond the thresholds
+    // are solved, the other columns get the outputs of their last solve.
+    std::unique_lock<std::mutex> cache_lock;
+    Array<BOOL_TYPE,1> is_changed;
+
+    if (column_cache)
+    {
+        Instrumentation::Scoped_timer timer(Stage::Input_subset);
+
+        cache_lock = std::unique_lock<std::mutex>(column_cache->get_mutex());
+        const Resolve_thresholds<TF>& thresholds = column_cache->get_thresholds();
+
+        column_cache->start(n_col, col_offset);
+        column_cache->add_input(gas_concs, thresholds.vmr_relative);
+        column_cache->add_input(col_dry, thresholds.vmr_relative, true);
+        column_cache->add_input(p_lay, thresholds.pressure);
+        column_cache->add_input(p_lev, thresholds.pressure);
+        column_cache->add_input(t_lay, thresholds.temperature);
+        column_cache->add_input(t_lev, thresholds.temperature);
+        column_cache->add_input(t_sfc, thresholds.temperature);
+        column_cache->add_input(emis_sfc, thresholds.boundary, false, 2);
+        if (switch_cloud_optics)
+        {
+            column_cache->add_input(lwp, thresholds.water_path);
+            column_cache->add_input(iwp, thresholds.water_path);
+            column_cache->add_input(rel, thresholds.effective_radius);
+            column_cache->add_input(rei, thresholds.effective_radius);
+        }
+
+        if (switch_output_optical)
+        {
+            column_cache->add_output(tau);
+            column_cache->add_output(lay_source);
+            column_cache->add_output(lev_source_inc);
+            column_cache->add_output(lev_source_dec);
+            column_cache->add_output(sfc_source);
+        }
+        if (switch_fluxes)
+        {
+            column_cache->add_output(lw_flux_up);
+            column_cache->add_output(lw_flux_dn);
+            column_cache->add_output(lw_flux_net);
+            if (switch_output_jacobian)
+                column_cache->add_output(lw_flux_up_jac);
+            if (switch_output_bnd_fluxes)
+            {
+                column_cache->add_output(lw_bnd_flux_up);
+                column_cache->add_output(lw_bnd_flux_dn);
+                column_cache->add_output(lw_bnd_flux_net);
+            }
+        }
+
+        is_changed.set_dims({n_col});
+        column_cache->find_changed_columns(is_changed);
+
+        const int n_col_changed = propagate_changed_columns(col_rep, is_changed);
+        column_cache->set_recompute_fraction(double(n_col_changed) / n_col);
+
+        n_col_clear = select_columns(
+                col_order, n_col_clear, [&](const int icol) { return bool(is_changed({icol})); });
+
+        column_cache->restore_outputs(is_changed);
+    }
+
+    const int n_col_solve = col_order.dim(1);
+
+    const bool do_reorder =
+            (n_col_solve < n_col) || !std::is_sorted(col_order.v().begin(), col_order.v().end());
+
+    Gas_concs<TF> gas_concs_copy;
+    Array<TF,2> p_lay_copy, p_lev_copy, t_lay_copy, t_lev_copy, col_dry_copy;
+    Array<TF,1> t_sfc_copy;
+    Array<TF,2> emis_sfc_copy;
+    Array<TF,2> lwp_copy, iwp_copy, rel_copy, rei_copy;
+
+    if (do_reorder)
+    {
+        Instrumentation::Scoped_timer timer(Stage::Input_subset);
+
+        gas_concs_copy = Gas_concs<TF>(gas_concs, col_order);
+        p_lay_copy = reorder_columns(p_lay, col_order);
+        p_lev_copy = reorder_columns(p_lev, col_order);
+        t_lay_copy = reorder_columns(t_lay, col_order);
+        t_lev_copy = reorder_columns(t_lev, col_order);
+        col_dry_copy = reorder_columns(col_dry, col_order);
+        t_sfc_copy = reorder_columns(t_sfc, col_order);
+        emis_sfc_copy = reorder_columns(emis_sfc, col_order, 2);
+        lwp_copy = reorder_columns(lwp, col_order);
+        iwp_copy = reorder_columns(iwp, col_order);
+        rel_copy = reorder_columns(rel, col_order);
+        rei_copy = reorder_columns(rei, col_order);
+    }
+
+    const Gas_concs<TF>& gas_concs_sorted = do_reorder ? gas_concs_copy : gas_concs;
+    const Array<TF,2>& p_lay_sorted = do_reorder ? p_lay_copy : p_lay;
+    const Array<TF,2>& p_lev_sorted = do_reorder ? p_lev_copy : p_lev;
+    const Array<TF,2>& t_lay_sorted = do_reorder ? t_lay_copy : t_lay;
+    const Array<TF,2>& t_lev_sorted = do_reorder ? t_lev_copy : t_lev;
+    const Array<TF,2>& col_dry_sorted = do_reorder ? col_dry_copy : col_dry;
+    const Array<TF,1>& t_sfc_sorted = do_reorder ? t_sfc_copy : t_sfc;
+    const Array<TF,2>& emis_sfc_sorted = do_reorder ? emis_sfc_copy : emis_sfc;
+    const Array<TF,2>& lwp_sorted = do_reorder ? lwp_copy : lwp;
+    const Array<TF,2>& iwp_sorted = do_reorder ? iwp_copy : iwp;
+    const Array<TF,2>& rel_sorted = do_reorder ? rel_copy : rel;
+    const Array<TF,2>& rei_sorted = do_reorder ? rei_copy : rei;
+
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+    Gas_concs<float> gas_concs_sorted_sp;
+    if (switch_mixed_precision)
+        gas_concs_sorted_sp = convert_gas_concs<float>(gas_concs_sorted);
+#endif
+
+    // Create the containers for the full blocks, the residual blocks are made on the fly.
+    std::unique_ptr<Optical_props_arry<TF>> optical_props_subset =
+            std::make_unique<Optical_props_1scl<TF>>(n_col_block, n_lay, *kdist);
+    std::unique_ptr<Source_func_lw<TF>> sources_subset =
+            std::make_unique<Source_func_lw<TF>>(n_col_block, n_lay, *kdist, switch_output_jacobian);
+
+    std::unique_ptr<Optical_props_1scl<TF>> cloud_optical_props_subset;
+    if (switch_cloud_optics)
+        cloud_optical_props_subset = std::make_unique<Optical_props_1scl<TF>>(n_col_block, n_lay, *cloud_optics);
+
+    // Lambda function for solving optical properties subset.
+    auto call_kernels = [&](
+            const int col_s_in, const int col_e_in,
+            const bool is_cloudy,
+            std::unique_ptr<Optical_props_arry<TF>>& optical_props_subset_in,
+            std::unique_ptr<Optical_props_1scl<TF>>& cloud_optical_props_subset_in,
+            Source_func_lw<TF>& sources_subset_in,
+            const Array<TF,2>& emis_sfc_subset_in,
+            Fluxes_broadband<TF>& fluxes,
+            Fluxes_broadband<TF>& bnd_fluxes)
+    {
+        const int n_col_in = col_e_in - col_s_in + 1;
+        Gas_concs<TF> gas_concs_subset(gas_concs_sorted, col_s_in, n_col_in);
+
+        auto p_lev_subset = p_lev_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lev} }});
+
+        Array<TF,2> col_dry_subset({n_col_in, n_lay});
+        if (col_dry_sorted.size() == 0)
+        {
+            Instrumentation::Scoped_timer timer(Stage::Col_dry, [&]() { return Instrumentation::get_bytes(col_dry_subset, p_lev_subset); });
+
+            Array<TF,2> h2o_subset({n_col_in, n_lay});
+            gas_concs_subset.get_vmr("h2o", h2o_subset);
+            Gas_optics_rrtmgp<TF>::get_col_dry(col_dry_subset, h2o_subset, p_lev_subset);
+        }
+        else
+            col_dry_subset = std::move(col_dry_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}));
+
+        if (switch_mixed_precision)
+        {
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+            // Compute the gas optics in single precision and convert them for the solver.
+            Gas_concs<float> gas_concs_subset_sp(gas_concs_sorted_sp, col_s_in, n_col_in);
+
+            std::unique_ptr<Optical_props_arry<float>> optical_props_sp =
+                    std::make_unique<Optical_props_1scl<float>>(n_col_in, n_lay, *kdist_sp);
+            Source_func_lw<float> sources_sp(n_col_in, n_lay, *kdist_sp, switch_output_jacobian);
+
+            kdist_sp->gas_optics(
+                    convert_array<float>(p_lay_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }})),
+                    convert_array<float>(p_lev_subset),
+                    convert_array<float>(t_lay_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }})),
+                    convert_array<float>(t_sfc_sorted.subset({{ {col_s_in, col_e_in} }})),
+                    gas_concs_subset_sp,
+                    optical_props_sp,
+                    sources_sp,
+                    convert_array<float>(col_dry_subset),
+                    convert_array<float>(t_lev_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lev} }})) );
+
+            copy_array(optical_props_subset_in->get_tau(), optical_props_sp->get_tau());
+            copy_array(sources_subset_in.get_sfc_source(), sources_sp.get_sfc_source());
+            copy_array(sources_subset_in.get_lay_source(), sources_sp.get_lay_source());
+            copy_array(sources_subset_in.get_lev_source_inc(), sources_sp.get_lev_source_inc());
+            copy_array(sources_subset_in.get_lev_source_dec(), sources_sp.get_lev_source_dec());
+
+            if (switch_output_jacobian)
+                copy_array(sources_subset_in.get_sfc_source_jac(), sources_sp.get_sfc_source_jac());
+#endif
+        }
+        else
+        {
+            kdist->gas_optics(
+                    p_lay_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
+                    p_lev_subset,
+                    t_lay_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
+                    t_sfc_sorted.subset({{ {col_s_in, col_e_in} }}),
+                    gas_concs_subset,
+                    optical_props_subset_in,
+                    sources_subset_in,
+                    col_dry_subset,
+                    t_lev_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lev} }}) );
+        }
+
+        if (is_cloudy)
+        {
+            cloud_optics->cloud_optics(
+                    lwp_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
+                    iwp_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
+                    rel_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
+                    rei_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
+                    *cloud_optical_props_subset_in);
+
+            // cloud->delta_scale();
+
+            // Add the band-resolved cloud optical props to the gas optical properties.
+            add_to(*optical_props_subset_in, *cloud_optical_props_subset_in);
+        }
+
+        // Store the optical properties, if desired.
+        if (switch_output_optical)
+        {
+            Instrumentation::Scoped_timer timer(Stage::Output_scatter);
+
+            for (int igpt=1; igpt<=n_gpt; ++igpt)
+                for (int ilay=1; ilay<=n_lay; ++ilay)
+                    for (int icol=1; icol<=n_col_in; ++icol)
+                    {
+                        const int icol_out = col_order({icol+col_s_in-1});
+                        tau           ({icol_out, ilay, igpt}) = optical_props_subset_in->get_tau()    ({icol, ilay, igpt});
+                        lay_source    ({icol_out, ilay, igpt}) = sources_subset_in.get_lay_source()    ({icol, ilay, igpt});
+                        lev_source_inc({icol_out, ilay, igpt}) = sources_subset_in.get_lev_source_inc()({icol, ilay, igpt});
+                        lev_source_dec({icol_out, ilay, igpt}) = sources_subset_in.get_lev_source_dec()({icol, ilay, igpt});
+                    }
+
+            for (int igpt=1; igpt<=n_gpt; ++igpt)
+                for (int icol=1; icol<=n_col_in; ++icol)
+                    sfc_source({col_order({icol+col_s_in-1}), igpt}) = sources_subset_in.get_sfc_source()({icol, igpt});
+        }
+
+        if (!switch_fluxes)
+            return;
+
+        Array<TF,3> gpt_flux_up({n_col_in, n_lev, n_gpt});
+        Array<TF,3> gpt_flux_dn({n_col_in, n_lev, n_gpt});
+        Array<TF,3> gpt_flux_up_jac;
+
+        constexpr int n_ang = 1;
+
+        if (switch_output_jacobian)
+        {
+            gpt_flux_up_jac.set_dims({n_col_in, n_lev, n_gpt});
+
+            Rte_lw<TF>::rte_lw(
+                    optical_props_subset_in,
+                    top_at_1,
+                    sources_subset_in,
+                    emis_sfc_subset_in,
+                    Array<TF,2>(), // Add an empty array, no inc_flux.
+                    gpt_flux_up, gpt_flux_dn, gpt_flux_up_jac,
+                    n_ang);
+        }
+        else
+        {
+            Rte_lw<TF>::rte_lw(
+                    optical_props_subset_in,
+                    top_at_1,
+                    sources_subset_in,
+                    emis_sfc_subset_in,
+                    Array<TF,2>(), // Add an empty array, no inc_flux.
+                    gpt_flux_up, gpt_flux_dn,
+                    n_ang);
+        }
+
+        fluxes.reduce(gpt_flux_up, gpt_flux_dn, optical_props_subset_in, top_at_1);
+
+        // Copy the data to the output.
+        {
+            Instrumentation::Scoped_timer timer(Stage::Output_scatter, [&]() { return 6*Instrumentation::get_bytes(fluxes.get_flux_up()); });
+
+            for (int ilev=1; ilev<=n_lev; ++ilev)
+                for (int icol=1; icol<=n_col_in; ++icol)
+                {
+                    const int icol_out = col_order({icol+col_s_in-1});
+                    lw_flux_up ({icol_out, ilev}) = fluxes.get_flux_up ()({icol, ilev});
+                    lw_flux_dn ({icol_out, ilev}) = fluxes.get_flux_dn ()({icol, ilev});
+                    lw_flux_net({icol_out, ilev}) = fluxes.get_flux_net()({icol, ilev});
+                }
+        }
+
+        // The Jacobian dF_up/dT_sfc allows for updating the upward flux for changes in surface temperature.
+        if (switch_output_jacobian)
+        {
+            fluxes.reduce_jacobian(gpt_flux_up_jac);
+
+            Instrumentation::Scoped_timer timer(Stage::Output_scatter, [&]() { return 2*Instrumentation::get_bytes(fluxes.get_flux_up_jac()); });
+
+            for (int ilev=1; ilev<=n_lev; ++ilev)
+                for (int icol=1; icol<=n_col_in; ++icol)
+                    lw_flux_up_jac({col_order({icol+col_s_in-1}), ilev}) = fluxes.get_flux_up_jac()({icol, ilev});
+        }
+
+        if (switch_output_bnd_fluxes)
+        {
+            bnd_fluxes.reduce(gpt_flux_up, gpt_flux_dn, optical_props_subset_in, top_at_1);
+
+            Instrumentation::Scoped_timer timer(Stage::Output_scatter);
+
+            for (int ibnd=1; ibnd<=n_bnd; ++ibnd)
+                for (int ilev=1; ilev<=n_lev; ++ilev)
+                    for (int icol=1; icol<=n_col_in; ++icol)
+                    {
+                        const int icol_out = col_order({icol+col_s_in-1});
+                        lw_bnd_flux_up ({icol_out, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_up ()({icol, ilev, ibnd});
+                        lw_bnd_flux_dn ({icol_out, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_dn ()({icol, ilev, ibnd});
+                        lw_bnd_flux_net({icol_out, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_net()({icol, ilev, ibnd});
+                    }
+        }
+    };
+
+    // Lambda function for solving a range of sorted columns in blocks.
+    auto solve_range = [&](const int col_s_range, const int col_e_range, const bool is_cloudy)
+    {
+        const int n_col_range = col_e_range - col_s_range + 1;
+        const int n_blocks = n_col_range / n_col_block;
+        const int n_col_block_residual = n_col_range % n_col_block;
+
+        for (int b=1; b<=n_blocks; ++b)
+        {
+            const int col_s = col_s_range + (b-1) * n_col_block;
+            const int col_e = col_s_range +  b    * n_col_block - 1;
+
+            Array<TF,2> emis_sfc_subset = emis_sfc_sorted.subset({{ {1, n_bnd}, {col_s, col_e} }});
+
+            std::unique_ptr<Fluxes_broadband<TF>> fluxes_subset =
+                    std::make_unique<Fluxes_broadband<TF>>(n_col_block, n_lev);
+            std::unique_ptr<Fluxes_broadband<TF>> bnd_fluxes_subset =
+                    std::make_unique<Fluxes_byband<TF>>(n_col_block, n_lev, n_bnd);
+
+            call_kernels(
+                    col_s, col_e,
+                    is_cloudy,
+                    optical_props_subset,
+                    cloud_optical_props_subset,
+                    *sources_subset,
+                    emis_sfc_subset,
+                    *fluxes_subset,
+                    *bnd_fluxes_subset);
+        }
+
+        if (n_col_block_residual > 0)
+        {
+            const int col_s = col_e_range - n_col_block_residual + 1;
+            const int col_e = col_e_range;
+
+            std::unique_ptr<Optical_props_arry<TF>> optical_props_residual =
+                    std::make_unique<Optical_props_1scl<TF>>(n_col_block_residual, n_lay, *kdist);
+            std::unique_ptr<Source_func_lw<TF>> sources_residual =
+                    std::make_unique<Source_func_lw<TF>>(n_col_block_residual, n_lay, *kdist, switch_output_jacobian);
+
+            std::unique_ptr<Optical_props_1scl<TF>> cloud_optical_props_residual;
+            if (is_cloudy)
+                cloud_optical_props_residual = std::make_unique<Optical_props_1scl<TF>>(n_col_block_residual, n_lay, *cloud_optics);
+
+            Array<TF,2> emis_sfc_residual = emis_sfc_sorted.subset({{ {1, n_bnd}, {col_s, col_e} }});
+            std::unique_ptr<Fluxes_broadband<TF>> fluxes_residual =
+                    std::make_unique<Fluxes_broadband<TF>>(n_col_block_residual, n_lev);
+            std::unique_ptr<Fluxes_broadband<TF>> bnd_fluxes_residual =
+                    std::make_unique<Fluxes_byband<TF>>(n_col_block_residual, n_lev, n_bnd);
+
+            call_kernels(
+                    col_s, col_e,
+                    is_cloudy,
+                    optical_props_residual,
+                    cloud_optical_props_residual,
+                    *sources_residual,
+                    emis_sfc_residual,
+                    *fluxes_residual,
+                    *bnd_fluxes_residual);
+        }
+    };
+
+    solve_range(1, n_col_clear, false);
+    solve_range(n_col_clear+1, n_col_solve, true);
+
+    if (n_col_unique < n_col)
+    {
+        Instrumentation::Scoped_timer timer(Stage::Output_scatter);
+
+        if (switch_output_optical)
+        {
+            broadcast_columns(tau, col_rep);
+            broadcast_columns(lay_source, col_rep);
+            broadcast_columns(lev_source_inc, col_rep);
+            broadcast_columns(lev_source_dec, col_rep);
+            broadcast_columns(sfc_source, col_rep);
+        }
+
+        if (switch_fluxes)
+        {
+            broadcast_columns(lw_flux_up, col_rep);
+            broadcast_columns(lw_flux_dn, col_rep);
+            broadcast_columns(lw_flux_net, col_rep);
+
+            if (switch_output_jacobian)
+                broadcast_columns(lw_flux_up_jac, col_rep);
+
+            if (switch_output_bnd_fluxes)
+            {
+                broadcast_columns(lw_bnd_flux_up, col_rep);
+                broadcast_columns(lw_bnd_flux_dn, col_rep);
+                broadcast_columns(lw_bnd_flux_net, col_rep);
+            }
+        }
+    }
+
+    if (column_cache)
+        column_cache->store(is_changed);
+}
+
+template<typename TF>
+Radiation_solver_shortwave<TF>::Radiation_solver_shortwave(
+        const Gas_concs<TF>& gas_concs,
+        const std::string& file_name_gas,
+        const std::string& file_name_cloud,
+        const bool switch_mixed_precision) :
+    Radiation_solver_shortwave(gas_concs, Coefficient_file(file_name_gas), nullptr, switch_mixed_precision)
+{
+    this->cloud_optics = load_cloud_optics<TF>(Coefficient_file(file_name_cloud));
+}
+
+template<typename TF>
+Radiation_solver_shortwave<TF>::Radiation_solver_shortwave(
+        const Gas_concs<TF>& gas_concs,
+        const Coefficient_file& coef_gas,
+        const Coefficient_file* coef_cloud,
+        const bool switch_mixed_precision) :
+    switch_mixed_precision(switch_mixed_precision)
+{
+    // Construct the gas optics classes for the solver, the cloud optics are optional.
+    this->kdist = load_gas_optics<TF>(coef_gas, gas_concs);
+
+    if (coef_cloud)
+        this->cloud_optics = load_cloud_optics<TF>(*coef_cloud);
+
+    // In mixed precision, the gas optics are computed in single precision and the solver in TF.
+    if (switch_mixed_precision)
+    {
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+        if (!std::is_same<TF, double>::value)
+            throw std::runtime_error("Mixed precision requires a double precision solver");
+
+        this->kdist_sp = load_gas_optics<float>(coef_gas, convert_gas_concs<float>(gas_concs));
+#else
+        throw std::runtime_error("Mixed precision requires a build with FLOAT_TYPE=dual");
+#endif
+    }
+}
+
+template<typename TF>
+void Radiation_solver_shortwave<TF>::set_n_col_block(const int n_col_block)
+{
+    if (n_col_block < 1)
+        throw std::runtime_error("The column block size needs to be at least 1");
+    this->n_col_block = n_col_block;
+}
+
+template<typename TF>
+Radiation_solver_shortwave<TF>::~Radiation_solver_shortwave() = default;
+
+template<typename TF>
+void Radiation_solver_shortwave<TF>::set_deduplicate_columns(const bool deduplicate_columns)
+{
+    this->deduplicate_columns = deduplicate_columns;
+}
+
+template<typename TF>
+void Radiation_solver_shortwave<TF>::set_validation_policy(const Validation_policy policy)
+{
+    this->kdist->set_validation_policy(policy);
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+    if (this->kdist_sp)
+        this->kdist_sp->set_validation_policy(policy);
+#endif
+}
+
+template<typename TF>
+void Radiation_solver_shortwave<TF>::set_incremental(
+        const bool incremental, const Resolve_thresholds<TF>& thresholds)
+{
+    if (thresholds.temperature < 0 || thresholds.pressure < 0 || thresholds.vmr_relative < 0 ||
+            thresholds.water_path < 0 || thresholds.effective_radius < 0 || thresholds.boundary < 0)
+        throw std::runtime_error("The thresholds of the incremental mode cannot be negative");
+
+    this->column_cache = incremental ? std::make_unique<Column_cache<TF>>(thresholds) : nullptr;
+}
+
+template<typename TF>
+double Radiation_solver_shortwave<TF>::get_recompute_fraction() const
+{
+    if (!this->column_cache)
+        return 1.;
+
+    std::lock_guard<std::mutex> lock(this->column_cache->get_mutex());
+    return this->column_cache->get_recompute_fraction();
+}
+
+template<typename TF>
+void Radiation_solver_shortwave<TF>::reset_incremental()
 {
-    // Construct the gas optics classes for the solver.
-    this->kdist = std::make_unique<Gas_optics_rrtmgp<TF>>(
-            load_and_init_gas_optics<TF>(gas_concs, file_name_gas));
+    if (!this->column_cache)
+        return;
 
-    this->cloud_optics = std::make_unique<Cloud_optics<TF>>(
-            load_and_init_cloud_optics<TF>(file_name_cloud));
+    std::lock_guard<std::mutex> lock(this->column_cache->get_mutex());
+    this->column_cache->reset();
 }
 
 template<typename TF>
-void Radiation_solver_longwave<TF>::solve(
+void Radiation_solver_shortwave<TF>::solve(
         const bool switch_fluxes,
         const bool switch_cloud_optics,
         const bool switch_output_optical,
@@ -359,13 +1284,17 @@ void Radiation_solver_longwave<TF>::solve(
         const Array<TF,2>& p_lay, const Array<TF,2>& p_lev,
         const Array<TF,2>& t_lay, const Array<TF,2>& t_lev,
         const Array<TF,2>& col_dry,
-        const Array<TF,1>& t_sfc, const Array<TF,2>& emis_sfc,
+        const Array<TF,2>& sfc_alb_dir, const Array<TF,2>& sfc_alb_dif,
+        const Array<TF,1>& tsi_scaling, const Array<TF,1>& mu0,
         const Array<TF,2>& lwp, const Array<TF,2>& iwp,
         const Array<TF,2>& rel, const Array<TF,2>& rei,
-        Array<TF,3>& tau, Array<TF,3>& lay_source,
-        Array<TF,3>& lev_source_inc, Array<TF,3>& lev_source_dec, Array<TF,2>& sfc_source,
-        Array<TF,2>& lw_flux_up, Array<TF,2>& lw_flux_dn, Array<TF,2>& lw_flux_net,
-        Array<TF,3>& lw_bnd_flux_up, Array<TF,3>& lw_bnd_flux_dn, Array<TF,3>& lw_bnd_flux_net) const
+        Array<TF,3>& tau, Array<TF,3>& ssa, Array<TF,3>& g,
+        Array<TF,2>& toa_src,
+        Array<TF,2>& sw_flux_up, Array<TF,2>& sw_flux_dn,
+        Array<TF,2>& sw_flux_dn_dir, Array<TF,2>& sw_flux_net,
+        Array<TF,3>& sw_bnd_flux_up, Array<TF,3>& sw_bnd_flux_dn,
+        Array<TF,3>& sw_bnd_flux_dn_dir, Array<TF,3>& sw_bnd_flux_net,
+        const int col_offset) const
 {
     const int n_col = p_lay.dim(1);
     const int n_lay = p_lay.dim(2);
@@ -373,421 +1302,795 @@ void Radiation_solver_longwave<TF>::solve(
     const int n_gpt = this->kdist->get_ngpt();
     const int n_bnd = this->kdist->get_nband();
 
+    using Instrumentation::Stage;
+
     const BOOL_TYPE top_at_1 = p_lay({1, 1}) < p_lay({1, n_lay});
 
-    constexpr int n_col_block = 16;
+    const int n_col_block = this->n_col_block;
 
-    // Read the sources and create containers for the substeps.
-    int n_blocks = n_col / n_col_block;
-    int n_col_block_residual = n_col % n_col_block;
+    if (switch_cloud_optics && !this->cloud_optics)
+        throw std::runtime_error("The cloud optics require a solver with cloud coefficients");
 
-    std::unique_ptr<Optical_props_arry<TF>> optical_props_subset;
-    std::unique_ptr<Optical_props_arry<TF>> optical_props_residual;
+    // Regroup the columns such that each block is either fully clear or cloudy, the clear
+    // blocks can then skip the cloud optics. The outputs are written back in the original order.
+    Array<int,1> col_order({n_col});
+    std::iota(col_order.v().begin(), col_order.v().end(), 1);
 
-    optical_props_subset = std::make_unique<Optical_props_1scl<TF>>(n_col_block, n_lay, *kdist);
+    int n_col_clear = n_col;
+    if (switch_cloud_optics)
+        n_col_clear = classify_columns(lwp, iwp, col_order);
+
+    // Solve only the first of each set of columns with identical inputs, the others get a copy.
+    Array<int,1> col_rep({n_col});
+    std::iota(col_rep.v().begin(), col_rep.v().end(), 1);
+    int n_col_unique = n_col;
+
+    if (this->deduplicate_columns)
+    {
+        Instrumentation::Scoped_timer timer(Stage::Input_subset);
+
+        Column_matcher<TF> matcher;
+        matcher.add(gas_concs);
+        matcher.add(p_lay); matcher.add(p_lev);
+        matcher.add(t_lay);
+        matcher.add(col_dry);
+        matcher.add(sfc_alb_dir, 2); matcher.add(sfc_alb_dif, 2);
+        matcher.add(tsi_scaling); matcher.add(mu0);
+        if (switch_cloud_optics)
+        {
+            matcher.add(lwp); matcher.add(iwp);
+            matcher.add(rel); matcher.add(rei);
+        }
 
-    std::unique_ptr<Source_func_lw<TF>> sources_subset;
-    std::unique_ptr<Source_func_lw<TF>> sources_residual;
+        n_col_unique = find_unique_columns(matcher, col_rep);
+        if (n_col_unique < n_col)
+            n_col_clear = select_columns(
+                    col_order, n_col_clear, [&](const int icol) { return col_rep({icol}) == icol; });
+    }
 
-    sources_subset = std::make_unique<Source_func_lw<TF>>(n_col_block, n_lay, *kdist);
+    // In incremental mode, only the columns of which the inputs changed beyond the thresholds
+    // are solved, the other columns get the outputs of their last solve.
+    std::unique_lock<std::mutex> cache_lock;
+    Array<BOOL_TYPE,1> is_changed;
 
-    if (n_col_block_residual > 0)
+    if (column_cache)
     {
-        optical_props_residual = std::make_unique<Optical_props_1scl<TF>>(n_col_block_residual, n_lay, *kdist);
-        sources_residual = std::make_unique<Source_func_lw<TF>>(n_col_block_residual, n_lay, *kdist);
+        Instrumentation::Scoped_timer timer(Stage::Input_subset);
+
+        cache_lock = std::unique_lock<std::mutex>(column_cache->get_mutex());
+        const Resolve_thresholds<TF>& thresholds = column_cache->get_thresholds();
+
+        column_cache->start(n_col, col_offset);
+        column_cache->add_input(gas_concs, thresholds.vmr_relative);
+        column_cache->add_input(col_dry, thresholds.vmr_relative, true);
+        column_cache->add_input(p_lay, thresholds.pressure);
+        column_cache->add_input(p_lev, thresholds.pressure);
+        column_cache->add_input(t_lay, thresholds.temperature);
+        column_cache->add_input(sfc_alb_dir, thresholds.boundary, false, 2);
+        column_cache->add_input(sfc_alb_dif, thresholds.boundary, false, 2);
+        column_cache->add_input(tsi_scaling, thresholds.boundary);
+        column_cache->add_input(mu0, thresholds.boundary);
+        if (switch_cloud_optics)
+        {
+            column_cache->add_input(lwp, thresholds.water_path);
+            column_cache->add_input(iwp, thresholds.water_path);
+            column_cache->add_input(rel, thresholds.effective_radius);
+            column_cache->add_input(rei, thresholds.effective_radius);
+        }
+
+        if (switch_output_optical)
+        {
+            column_cache->add_output(tau);
+            column_cache->add_output(ssa);
+            column_cache->add_output(g);
+            column_cache->add_output(toa_src);
+        }
+        if (switch_fluxes)
+        {
+            column_cache->add_output(sw_flux_up);
+            column_cache->add_output(sw_flux_dn);
+            column_cache->add_output(sw_flux_dn_dir);
+            column_cache->add_output(sw_flux_net);
+            if (switch_output_bnd_fluxes)
+            {
+                column_cache->add_output(sw_bnd_flux_up);
+                column_cache->add_output(sw_bnd_flux_dn);
+                column_cache->add_output(sw_bnd_flux_dn_dir);
+                column_cache->add_output(sw_bnd_flux_net);
+            }
+        }
+
+        is_changed.set_dims({n_col});
+        column_cache->find_changed_columns(is_changed);
+
+        const int n_col_changed = propagate_changed_columns(col_rep, is_changed);
+        column_cache->set_recompute_fraction(double(n_col_changed) / n_col);
+
+        n_col_clear = select_columns(
+                col_order, n_col_clear, [&](const int icol) { return bool(is_changed({icol})); });
+
+        column_cache->restore_outputs(is_changed);
     }
 
-    std::unique_ptr<Optical_props_1scl<TF>> cloud_optical_props_subset;
-    std::unique_ptr<Optical_props_1scl<TF>> cloud_optical_props_residual;
+    const int n_col_solve = col_order.dim(1);
 
-    if (switch_cloud_optics)
+    const bool do_reorder =
+            (n_col_solve < n_col) || !std::is_sorted(col_order.v().begin(), col_order.v().end());
+
+    Gas_concs<TF> gas_concs_copy;
+    Array<TF,2> p_lay_copy, p_lev_copy, t_lay_copy, col_dry_copy;
+    Array<TF,2> sfc_alb_dir_copy, sfc_alb_dif_copy;
+    Array<TF,1> tsi_scaling_copy, mu0_copy;
+    Array<TF,2> lwp_copy, iwp_copy, rel_copy, rei_copy;
+
+    if (do_reorder)
     {
-        cloud_optical_props_subset = std::make_unique<Optical_props_1scl<TF>>(n_col_block, n_lay, *cloud_optics);
-        if (n_col_block_residual > 0)
-            cloud_optical_props_residual = std::make_unique<Optical_props_1scl<TF>>(n_col_block_residual, n_lay, *cloud_optics);
+        Instrumentation::Scoped_timer timer(Stage::Input_subset);
+
+        gas_concs_copy = Gas_concs<TF>(gas_concs, col_order);
+        p_lay_copy = reorder_columns(p_lay, col_order);
+        p_lev_copy = reorder_columns(p_lev, col_order);
+        t_lay_copy = reorder_columns(t_lay, col_order);
+        col_dry_copy = reorder_columns(col_dry, col_order);
+        sfc_alb_dir_copy = reorder_columns(sfc_alb_dir, col_order, 2);
+        sfc_alb_dif_copy = reorder_columns(sfc_alb_dif, col_order, 2);
+        tsi_scaling_copy = reorder_columns(tsi_scaling, col_order);
+        mu0_copy = reorder_columns(mu0, col_order);
+        lwp_copy = reorder_columns(lwp, col_order);
+        iwp_copy = reorder_columns(iwp, col_order);
+        rel_copy = reorder_columns(rel, col_order);
+        rei_copy = reorder_columns(rei, col_order);
     }
 
+    const Gas_concs<TF>& gas_concs_sorted = do_reorder ? gas_concs_copy : gas_concs;
+    const Array<TF,2>& p_lay_sorted = do_reorder ? p_lay_copy : p_lay;
+    const Array<TF,2>& p_lev_sorted = do_reorder ? p_lev_copy : p_lev;
+    const Array<TF,2>& t_lay_sorted = do_reorder ? t_lay_copy : t_lay;
+    const Array<TF,2>& col_dry_sorted = do_reorder ? col_dry_copy : col_dry;
+    const Array<TF,2>& sfc_alb_dir_sorted = do_reorder ? sfc_alb_dir_copy : sfc_alb_dir;
+    const Array<TF,2>& sfc_alb_dif_sorted = do_reorder ? sfc_alb_dif_copy : sfc_alb_dif;
+    const Array<TF,1>& tsi_scaling_sorted = do_reorder ? tsi_scaling_copy : tsi_scaling;
+    const Array<TF,1>& mu0_sorted = do_reorder ? mu0_copy : mu0;
+    const Array<TF,2>& lwp_sorted = do_reorder ? lwp_copy : lwp;
+    const Array<TF,2>& iwp_sorted = do_reorder ? iwp_copy : iwp;
+    const Array<TF,2>& rel_sorted = do_reorder ? rel_copy : rel;
+    const Array<TF,2>& rei_sorted = do_reorder ? rei_copy : rei;
+
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+    Gas_concs<float> gas_concs_sorted_sp;
+    if (switch_mixed_precision)
+        gas_concs_sorted_sp = convert_gas_concs<float>(gas_concs_sorted);
+#endif
+
+    // Create the containers for the full blocks, the residual blocks are made on the fly.
+    std::unique_ptr<Optical_props_arry<TF>> optical_props_subset =
+            std::make_unique<Optical_props_2str<TF>>(n_col_block, n_lay, *kdist);
+
+    std::unique_ptr<Optical_props_2str<TF>> cloud_optical_props_subset;
+    if (switch_cloud_optics)
+        cloud_optical_props_subset = std::make_unique<Optical_props_2str<TF>>(n_col_block, n_lay, *cloud_optics);
+
     // Lambda function for solving optical properties subset.
     auto call_kernels = [&](
             const int col_s_in, const int col_e_in,
+            const bool is_cloudy,
             std::unique_ptr<Optical_props_arry<TF>>& optical_props_subset_in,
-            std::unique_ptr<Optical_props_1scl<TF>>& cloud_optical_props_subset_in,
-            Source_func_lw<TF>& sources_subset_in,
-            const Array<TF,2>& emis_sfc_subset_in,
+            std::unique_ptr<Optical_props_2str<TF>>& cloud_optical_props_subset_in,
             Fluxes_broadband<TF>& fluxes,
             Fluxes_broadband<TF>& bnd_fluxes)
     {
         const int n_col_in = col_e_in - col_s_in + 1;
-        Gas_concs<TF> gas_concs_subset(gas_concs, col_s_in, n_col_in);
+        Gas_concs<TF> gas_concs_subset(gas_concs_sorted, col_s_in, n_col_in);
 
-        auto p_lev_subset = p_lev.subset({{ {col_s_in, col_e_in}, {1, n_lev} }});
+        auto p_lev_subset = p_lev_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lev} }});
 
         Array<TF,2> col_dry_subset({n_col_in, n_lay});
-        if (col_dry.size() == 0)
-            Gas_optics_rrtmgp<TF>::get_col_dry(col_dry_subset, gas_concs_subset.get_vmr("h2o"), p_lev_subset);
+        if (col_dry_sorted.size() == 0)
+        {
+            Instrumentation::Scoped_timer timer(Stage::Col_dry, [&]() { return Instrumentation::get_bytes(col_dry_subset, p_lev_subset); });
+
+            Array<TF,2> h2o_subset({n_col_in, n_lay});
+            gas_concs_subset.get_vmr("h2o", h2o_subset);
+            Gas_optics_rrtmgp<TF>::get_col_dry(col_dry_subset, h2o_subset, p_lev_subset);
+        }
         else
-            col_dry_subset = std::move(col_dry.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}));
-
-        kdist->gas_optics(
-                p_lay.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
-                p_lev_subset,
-                t_lay.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
-                t_sfc.subset({{ {col_s_in, col_e_in} }}),
-                gas_concs_subset,
-                optical_props_subset_in,
-                sources_subset_in,
-                col_dry_subset,
-                t_lev.subset({{ {col_s_in, col_e_in}, {1, n_lev} }}) );
+            col_dry_subset = std::move(col_dry_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}));
 
-        if (switch_cloud_optics)
+        Array<TF,2> toa_src_subset({n_col_in, n_gpt});
+
+        if (switch_mixed_precision)
+        {
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+            // Compute the gas optics in single precision and convert them for the solver.
+            Gas_concs<float> gas_concs_subset_sp(gas_concs_sorted_sp, col_s_in, n_col_in);
+
+            std::unique_ptr<Optical_props_arry<float>> optical_props_sp =
+                    std::make_unique<Optical_props_2str<float>>(n_col_in, n_lay, *kdist_sp);
+            Array<float,2> toa_src_subset_sp({n_col_in, n_gpt});
+
+            kdist_sp->gas_optics(
+                    convert_array<float>(p_lay_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }})),
+                    convert_array<float>(p_lev_subset),
+                    convert_array<float>(t_lay_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }})),
+                    gas_concs_subset_sp,
+                    optical_props_sp,
+                    toa_src_subset_sp,
+                    convert_array<float>(col_dry_subset));
+
+            copy_array(optical_props_subset_in->get_tau(), optical_props_sp->get_tau());
+            copy_array(optical_props_subset_in->get_ssa(), optical_props_sp->get_ssa());
+            copy_array(optical_props_subset_in->get_g  (), optical_props_sp->get_g  ());
+            copy_array(toa_src_subset, toa_src_subset_sp);
+#endif
+        }
+        else
+        {
+            kdist->gas_optics(
+                    p_lay_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
+                    p_lev_subset,
+                    t_lay_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
+                    gas_concs_subset,
+                    optical_props_subset_in,
+                    toa_src_subset,
+                    col_dry_subset);
+        }
+
+        auto tsi_scaling_subset = tsi_scaling_sorted.subset({{ {col_s_in, col_e_in} }});
+
+        for (int igpt=1; igpt<=n_gpt; ++igpt)
+            for (int icol=1; icol<=n_col_in; ++icol)
+                toa_src_subset({icol, igpt}) *= tsi_scaling_subset({icol});
+
+        if (is_cloudy)
         {
             cloud_optics->cloud_optics(
-                    lwp.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
-                    iwp.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
-                    rel.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
-                    rei.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
+                    lwp_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
+                    iwp_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
+                    rel_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
+                    rei_sorted.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
                     *cloud_optical_props_subset_in);
 
-            // cloud->delta_scale();
+            cloud_optical_props_subset_in->delta_scale();
 
-            // Add the cloud optical props to the gas optical properties.
-            add_to(
-                    dynamic_cast<Optical_props_1scl<TF>&>(*optical_props_subset_in),
-                    dynamic_cast<Optical_props_1scl<TF>&>(*cloud_optical_props_subset_in));
+            // Add the band-resolved cloud optical props to the gas optical properties.
+            add_to(*optical_props_subset_in, *cloud_optical_props_subset_in);
         }
 
         // Store the optical properties, if desired.
         if (switch_output_optical)
         {
+            Instrumentation::Scoped_timer timer(Stage::Output_scatter);
+
             for (int igpt=1; igpt<=n_gpt; ++igpt)
                 for (int ilay=1; ilay<=n_lay; ++ilay)
                     for (int icol=1; icol<=n_col_in; ++icol)
                     {
-                        tau           ({icol+col_s_in-1, ilay, igpt}) = optical_props_subset_in->get_tau()    ({icol, ilay, igpt});
-                        lay_source    ({icol+col_s_in-1, ilay, igpt}) = sources_subset_in.get_lay_source()    ({icol, ilay, igpt});
-                        lev_source_inc({icol+col_s_in-1, ilay, igpt}) = sources_subset_in.get_lev_source_inc()({icol, ilay, igpt});
-                        lev_source_dec({icol+col_s_in-1, ilay, igpt}) = sources_subset_in.get_lev_source_dec()({icol, ilay, igpt});
+                        const int icol_out = col_order({icol+col_s_in-1});
+                        tau({icol_out, ilay, igpt}) = optical_props_subset_in->get_tau()({icol, ilay, igpt});
+                        ssa({icol_out, ilay, igpt}) = optical_props_subset_in->get_ssa()({icol, ilay, igpt});
+                        g  ({icol_out, ilay, igpt}) = optical_props_subset_in->get_g  ()({icol, ilay, igpt});
                     }
 
             for (int igpt=1; igpt<=n_gpt; ++igpt)
                 for (int icol=1; icol<=n_col_in; ++icol)
-                    sfc_source({icol+col_s_in-1, igpt}) = sources_subset_in.get_sfc_source()({icol, igpt});
+                    toa_src({col_order({icol+col_s_in-1}), igpt}) = toa_src_subset({icol, igpt});
         }
 
         if (!switch_fluxes)
             return;
 
-        Array<TF,3> gpt_flux_up({n_col_in, n_lev, n_gpt});
-        Array<TF,3> gpt_flux_dn({n_col_in, n_lev, n_gpt});
-
-        constexpr int n_ang = 1;
+        Array<TF,3> gpt_flux_up    ({n_col_in, n_lev, n_gpt});
+        Array<TF,3> gpt_flux_dn    ({n_col_in, n_lev, n_gpt});
+        Array<TF,3> gpt_flux_dn_dir({n_col_in, n_lev, n_gpt});
 
-        Rte_lw<TF>::rte_lw(
+        Rte_sw<TF>::rte_sw(
                 optical_props_subset_in,
                 top_at_1,
-                sources_subset_in,
-                emis_sfc_subset_in,
+                mu0_sorted.subset({{ {col_s_in, col_e_in} }}),
+                toa_src_subset,
+                sfc_alb_dir_sorted.subset({{ {1, n_bnd}, {col_s_in, col_e_in} }}),
+                sfc_alb_dif_sorted.subset({{ {1, n_bnd}, {col_s_in, col_e_in} }}),
                 Array<TF,2>(), // Add an empty array, no inc_flux.
-                gpt_flux_up, gpt_flux_dn,
-                n_ang);
+                gpt_flux_up,
+                gpt_flux_dn,
+                gpt_flux_dn_dir);
 
-        fluxes.reduce(gpt_flux_up, gpt_flux_dn, optical_props_subset_in, top_at_1);
+        fluxes.reduce(gpt_flux_up, gpt_flux_dn, gpt_flux_dn_dir, optical_props_subset_in, top_at_1);
 
         // Copy the data to the output.
-        for (int ilev=1; ilev<=n_lev; ++ilev)
-            for (int icol=1; icol<=n_col_in; ++icol)
-            {
-                lw_flux_up ({icol+col_s_in-1, ilev}) = fluxes.get_flux_up ()({icol, ilev});
-                lw_flux_dn ({icol+col_s_in-1, ilev}) = fluxes.get_flux_dn ()({icol, ilev});
-                lw_flux_net({icol+col_s_in-1, ilev}) = fluxes.get_flux_net()({icol, ilev});
-            }
+        {
+            Instrumentation::Scoped_timer timer(Stage::Output_scatter, [&]() { return 8*Instrumentation::get_bytes(fluxes.get_flux_up()); });
+
+            for (int ilev=1; ilev<=n_lev; ++ilev)
+                for (int icol=1; icol<=n_col_in; ++icol)
+                {
+                    const int icol_out = col_order({icol+col_s_in-1});
+                    sw_flux_up     ({icol_out, ilev}) = fluxes.get_flux_up    ()({icol, ilev});
+                    sw_flux_dn     ({icol_out, ilev}) = fluxes.get_flux_dn    ()({icol, ilev});
+                    sw_flux_dn_dir ({icol_out, ilev}) = fluxes.get_flux_dn_dir()({icol, ilev});
+                    sw_flux_net    ({icol_out, ilev}) = fluxes.get_flux_net   ()({icol, ilev});
+                }
+        }
 
         if (switch_output_bnd_fluxes)
         {
-            bnd_fluxes.reduce(gpt_flux_up, gpt_flux_dn, optical_props_subset_in, top_at_1);
+            bnd_fluxes.reduce(gpt_flux_up, gpt_flux_dn, gpt_flux_dn_dir, optical_props_subset_in, top_at_1);
+
+            Instrumentation::Scoped_timer timer(Stage::Output_scatter);
 
             for (int ibnd=1; ibnd<=n_bnd; ++ibnd)
                 for (int ilev=1; ilev<=n_lev; ++ilev)
                     for (int icol=1; icol<=n_col_in; ++icol)
                     {
-                        lw_bnd_flux_up ({icol+col_s_in-1, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_up ()({icol, ilev, ibnd});
-                        lw_bnd_flux_dn ({icol+col_s_in-1, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_dn ()({icol, ilev, ibnd});
-                        lw_bnd_flux_net({icol+col_s_in-1, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_net()({icol, ilev, ibnd});
+                        const int icol_out = col_order({icol+col_s_in-1});
+                        sw_bnd_flux_up     ({icol_out, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_up     ()({icol, ilev, ibnd});
+                        sw_bnd_flux_dn     ({icol_out, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_dn     ()({icol, ilev, ibnd});
+                        sw_bnd_flux_dn_dir ({icol_out, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_dn_dir ()({icol, ilev, ibnd});
+                        sw_bnd_flux_net    ({icol_out, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_net    ()({icol, ilev, ibnd});
                     }
         }
     };
 
-    for (int b=1; b<=n_blocks; ++b)
+    // Lambda function for solving a range of sorted columns in blocks.
+    auto solve_range = [&](const int col_s_range, const int col_e_range, const bool is_cloudy)
     {
-        const int col_s = (b-1) * n_col_block + 1;
-        const int col_e =  b    * n_col_block;
-
-        Array<TF,2> emis_sfc_subset = emis_sfc.subset({{ {1, n_bnd}, {col_s, col_e} }});
-
-        std::unique_ptr<Fluxes_broadband<TF>> fluxes_subset =
-                std::make_unique<Fluxes_broadband<TF>>(n_col_block, n_lev);
-        std::unique_ptr<Fluxes_broadband<TF>> bnd_fluxes_subset =
-                std::make_unique<Fluxes_byband<TF>>(n_col_block, n_lev, n_bnd);
-
-        call_kernels(
-                col_s, col_e,
-                optical_props_subset,
-                cloud_optical_props_subset,
-                *sources_subset,
-                emis_sfc_subset,
-                *fluxes_subset,
-                *bnd_fluxes_subset);
-    }
+        const int n_col_range = col_e_range - col_s_range + 1;
+        const int n_blocks = n_col_range / n_col_block;
+        const int n_col_block_residual = n_col_range % n_col_block;
+
+        for (int b=1; b<=n_blocks; ++b)
+        {
+            const int col_s = col_s_range + (b-1) * n_col_block;
+            const int col_e = col_s_range +  b    * n_col_block - 1;
+
+            std::unique_ptr<Fluxes_broadband<TF>> fluxes_subset =
+                    std::make_unique<Fluxes_broadband<TF>>(n_col_block, n_lev);
+            std::unique_ptr<Fluxes_broadband<TF>> bnd_fluxes_subset =
+                    std::make_unique<Fluxes_byband<TF>>(n_col_block, n_lev, n_bnd);
+
+            call_kernels(
+                    col_s, col_e,
+                    is_cloudy,
+                    optical_props_subset,
+                    cloud_optical_props_subset,
+                    *fluxes_subset,
+                    *bnd_fluxes_subset);
+        }
+
+        if (n_col_block_residual > 0)
+        {
+            const int col_s = col_e_range - n_col_block_residual + 1;
+            const int col_e = col_e_range;
+
+            std::unique_ptr<Optical_props_arry<TF>> optical_props_residual =
+                    std::make_unique<Optical_props_2str<TF>>(n_col_block_residual, n_lay, *kdist);
+
+            std::unique_ptr<Optical_props_2str<TF>> cloud_optical_props_residual;
+            if (is_cloudy)
+                cloud_optical_props_residual = std::make_unique<Optical_props_2str<TF>>(n_col_block_residual, n_lay, *cloud_optics);
+
+            std::unique_ptr<Fluxes_broadband<TF>> fluxes_residual =
+                    std::make_unique<Fluxes_broadband<TF>>(n_col_block_residual, n_lev);
+            std::unique_ptr<Fluxes_broadband<TF>> bnd_fluxes_residual =
+                    std::make_unique<Fluxes_byband<TF>>(n_col_block_residual, n_lev, n_bnd);
+
+            call_kernels(
+                    col_s, col_e,
+                    is_cloudy,
+                    optical_props_residual,
+                    cloud_optical_props_residual,
+                    *fluxes_residual,
+                    *bnd_fluxes_residual);
+        }
+    };
+
+    solve_range(1, n_col_clear, false);
+    solve_range(n_col_clear+1, n_col_solve, true);
 
-    if (n_col_block_residual > 0)
+    if (n_col_unique < n_col)
     {
-        const int col_s = n_col - n_col_block_residual + 1;
-        const int col_e = n_col;
-
-        Array<TF,2> emis_sfc_residual = emis_sfc.subset({{ {1, n_bnd}, {col_s, col_e} }});
-        std::unique_ptr<Fluxes_broadband<TF>> fluxes_residual =
-                std::make_unique<Fluxes_broadband<TF>>(n_col_block_residual, n_lev);
-        std::unique_ptr<Fluxes_broadband<TF>> bnd_fluxes_residual =
-                std::make_unique<Fluxes_byband<TF>>(n_col_block_residual, n_lev, n_bnd);
-
-        call_kernels(
-                col_s, col_e,
-                optical_props_residual,
-                cloud_optical_props_residual,
-                *sources_residual,
-                emis_sfc_residual,
-                *fluxes_residual,
-                *bnd_fluxes_residual);
+        Instrumentation::Scoped_timer timer(Stage::Output_scatter);
+
+        if (switch_output_optical)
+        {
+            broadcast_columns(tau, col_rep);
+            broadcast_columns(ssa, col_rep);
+            broadcast_columns(g, col_rep);
+            broadcast_columns(toa_src, col_rep);
+        }
+
+        if (switch_fluxes)
+        {
+            broadcast_columns(sw_flux_up, col_rep);
+            broadcast_columns(sw_flux_dn, col_rep);
+            broadcast_columns(sw_flux_dn_dir, col_rep);
+            broadcast_columns(sw_flux_net, col_rep);
+
+            if (switch_output_bnd_fluxes)
+            {
+                broadcast_columns(sw_bnd_flux_up, col_rep);
+                broadcast_columns(sw_bnd_flux_dn, col_rep);
+                broadcast_columns(sw_bnd_flux_dn_dir, col_rep);
+                broadcast_columns(sw_bnd_flux_net, col_rep);
+            }
+        }
     }
+
+    if (column_cache)
+        column_cache->store(is_changed);
 }
 
 template<typename TF>
-Radiation_solver_shortwave<TF>::Radiation_solver_shortwave(
+Radiation_solver_combined<TF>::Radiation_solver_combined(
         const Gas_concs<TF>& gas_concs,
-        const std::string& file_name_gas,
-        const std::string& file_name_cloud)
+        const std::string& file_name_gas_lw,
+        const std::string& file_name_cloud_lw,
+        const std::string& file_name_gas_sw,
+        const std::string& file_name_cloud_sw)
 {
     // Construct the gas optics classes for the solver.
-    this->kdist = std::make_unique<Gas_optics_rrtmgp<TF>>(
-            load_and_init_gas_optics<TF>(gas_concs, file_name_gas));
+    this->kdist_lw = load_gas_optics<TF>(Coefficient_file(file_name_gas_lw), gas_concs);
+    this->kdist_sw = load_gas_optics<TF>(Coefficient_file(file_name_gas_sw), gas_concs);
+
+    this->cloud_optics_lw = load_cloud_optics<TF>(Coefficient_file(file_name_cloud_lw));
+    this->cloud_optics_sw = load_cloud_optics<TF>(Coefficient_file(file_name_cloud_sw));
 
-    this->cloud_optics = std::make_unique<Cloud_optics<TF>>(
-            load_and_init_cloud_optics<TF>(file_name_cloud));
+    // The RRTMGP coefficients of both spectra have the same reference grid, but check it to be safe.
+    this->shares_state = this->kdist_sw->can_share_state(*this->kdist_lw);
 }
 
 template<typename TF>
-void Radiation_solver_shortwave<TF>::solve(
-        const bool switch_fluxes,
+void Radiation_solver_combined<TF>::set_n_col_block(const int n_col_block)
+{
+    if (n_col_block < 1)
+        throw std::runtime_error("The column block size needs to be at least 1");
+    this->n_col_block = n_col_block;
+}
+
+template<typename TF>
+void Radiation_solver_combined<TF>::set_validation_policy(const Validation_policy policy)
+{
+    this->kdist_lw->set_validation_policy(policy);
+    this->kdist_sw->set_validation_policy(policy);
+}
+
+template<typename TF>
+void Radiation_solver_combined<TF>::set_gpt_sampling(
+        const int n_gpt_sample_lw, const int n_gpt_sample_sw, const unsigned long long seed)
+{
+    if (n_gpt_sample_lw < 0 || n_gpt_sample_lw > this->kdist_lw->get_ngpt())
+        throw std::runtime_error("The number of longwave samples needs to be between 0 and the number of g-points");
+    if (n_gpt_sample_sw < 0 || n_gpt_sample_sw > this->kdist_sw->get_ngpt())
+        throw std::runtime_error("The number of shortwave samples needs to be between 0 and the number of g-points");
+
+    this->n_gpt_sample_lw = n_gpt_sample_lw;
+    this->n_gpt_sample_sw = n_gpt_sample_sw;
+    this->sampling_seed = seed;
+
+    this->sample_props_lw = (n_gpt_sample_lw > 0) ? make_sample_props<TF>(n_gpt_sample_lw) : nullptr;
+    this->sample_props_sw = (n_gpt_sample_sw > 0) ? make_sample_props<TF>(n_gpt_sample_sw) : nullptr;
+}
+
+template<typename TF>
+void Radiation_solver_combined<TF>::set_n_threads(const int n_threads)
+{
+    if (n_threads < 1)
+        throw std::runtime_error("The number of threads needs to be at least 1");
+
+    if (n_threads == 1)
+        this->thread_pool.reset();
+    else
+        this->thread_pool = std::make_unique<Thread_pool>(n_threads);
+}
+
+template<typename TF>
+void Radiation_solver_combined<TF>::solve(
         const bool switch_cloud_optics,
-        const bool switch_output_optical,
-        const bool switch_output_bnd_fluxes,
         const Gas_concs<TF>& gas_concs,
         const Array<TF,2>& p_lay, const Array<TF,2>& p_lev,
         const Array<TF,2>& t_lay, const Array<TF,2>& t_lev,
         const Array<TF,2>& col_dry,
+        const Array<TF,1>& t_sfc, const Array<TF,2>& emis_sfc,
         const Array<TF,2>& sfc_alb_dir, const Array<TF,2>& sfc_alb_dif,
         const Array<TF,1>& tsi_scaling, const Array<TF,1>& mu0,
         const Array<TF,2>& lwp, const Array<TF,2>& iwp,
         const Array<TF,2>& rel, const Array<TF,2>& rei,
-        Array<TF,3>& tau, Array<TF,3>& ssa, Array<TF,3>& g,
-        Array<TF,2>& toa_src,
+        Array<TF,2>& lw_flux_up, Array<TF,2>& lw_flux_dn, Array<TF,2>& lw_flux_net,
         Array<TF,2>& sw_flux_up, Array<TF,2>& sw_flux_dn,
         Array<TF,2>& sw_flux_dn_dir, Array<TF,2>& sw_flux_net,
-        Array<TF,3>& sw_bnd_flux_up, Array<TF,3>& sw_bnd_flux_dn,
-        Array<TF,3>& sw_bnd_flux_dn_dir, Array<TF,3>& sw_bnd_flux_net) const
+        const unsigned long long step, const int col_offset) const
 {
     const int n_col = p_lay.dim(1);
     const int n_lay = p_lay.dim(2);
     const int n_lev = p_lev.dim(2);
-    const int n_gpt = this->kdist->get_ngpt();
-    const int n_bnd = this->kdist->get_nband();
+    const int n_gpt_lw = this->kdist_lw->get_ngpt();
+    const int n_gpt_sw = this->kdist_sw->get_ngpt();
+    const int n_bnd_lw = this->kdist_lw->get_nband();
+    const int n_bnd_sw = this->kdist_sw->get_nband();
+
+    using Instrumentation::Stage;
 
     const BOOL_TYPE top_at_1 = p_lay({1, 1}) < p_lay({1, n_lay});
 
-    constexpr int n_col_block = 16;
+    auto solve_block = [&](const int col_s, const int col_e)
+    {
+        const int n_col_in = col_e - col_s + 1;
 
-    // Read the sources and create containers for the substeps.
-    int n_blocks = n_col / n_col_block;
-    int n_col_block_residual = n_col % n_col_block;
+        Gas_concs<TF> gas_concs_subset(gas_concs, col_s, n_col_in);
 
-    std::unique_ptr<Optical_props_arry<TF>> optical_props_subset;
-    std::unique_ptr<Optical_props_arry<TF>> optical_props_residual;
+        const Array<TF,2> p_lay_subset = p_lay.subset({{ {col_s, col_e}, {1, n_lay} }});
+        const Array<TF,2> p_lev_subset = p_lev.subset({{ {col_s, col_e}, {1, n_lev} }});
+        const Array<TF,2> t_lay_subset = t_lay.subset({{ {col_s, col_e}, {1, n_lay} }});
+        const Array<TF,2> t_lev_subset = t_lev.subset({{ {col_s, col_e}, {1, n_lev} }});
 
-    optical_props_subset = std::make_unique<Optical_props_2str<TF>>(n_col_block, n_lay, *kdist);
-    if (n_col_block_residual > 0)
-        optical_props_residual = std::make_unique<Optical_props_2str<TF>>(n_col_block_residual, n_lay, *kdist);
+        const Array<TF,2> col_dry_subset = (col_dry.size() > 0)
+                ? col_dry.subset({{ {col_s, col_e}, {1, n_lay} }}) : Array<TF,2>();
 
-    std::unique_ptr<Optical_props_2str<TF>> cloud_optical_props_subset;
-    std::unique_ptr<Optical_props_2str<TF>> cloud_optical_props_residual;
+        // The shortwave computes its own state only if the reference grid or gases differ.
+        Gas_optics_state<TF> state_lw;
+        kdist_lw->compute_state(p_lay_subset, p_lev_subset, t_lay_subset, gas_concs_subset, col_dry_subset, state_lw);
 
-    if (switch_cloud_optics)
-    {
-        cloud_optical_props_subset = std::make_unique<Optical_props_2str<TF>>(n_col_block, n_lay, *cloud_optics);
-        if (n_col_block_residual > 0)
-            cloud_optical_props_residual = std::make_unique<Optical_props_2str<TF>>(n_col_block_residual, n_lay, *cloud_optics);
-    }
+        Gas_optics_state<TF> state_sw_own;
+        if (!shares_state)
+            kdist_sw->compute_state(p_lay_subset, p_lev_subset, t_lay_subset, gas_concs_subset, state_lw.col_dry, state_sw_own);
 
-    // Lambda function for solving optical properties subset.
-    auto call_kernels = [&](
-            const int col_s_in, const int col_e_in,
-            std::unique_ptr<Optical_props_arry<TF>>& optical_props_subset_in,
-            std::unique_ptr<Optical_props_2str<TF>>& cloud_optical_props_subset_in,
-            Fluxes_broadband<TF>& fluxes,
-            Fluxes_broadband<TF>& bnd_fluxes)
-    {
-        const int n_col_in = col_e_in - col_s_in + 1;
-        Gas_concs<TF> gas_concs_subset(gas_concs, col_s_in, n_col_in);
+        const Gas_optics_state<TF>& state_sw = shares_state ? state_lw : state_sw_own;
 
-        auto p_lev_subset = p_lev.subset({{ {col_s_in, col_e_in}, {1, n_lev} }});
+        Array<TF,2> lwp_subset, iwp_subset, rel_subset, rei_subset;
+        if (switch_cloud_optics)
+        {
+            lwp_subset = lwp.subset({{ {col_s, col_e}, {1, n_lay} }});
+            iwp_subset = iwp.subset({{ {col_s, col_e}, {1, n_lay} }});
+            rel_subset = rel.subset({{ {col_s, col_e}, {1, n_lay} }});
+            rei_subset = rei.subset({{ {col_s, col_e}, {1, n_lay} }});
+        }
 
-        Array<TF,2> col_dry_subset({n_col_in, n_lay});
-        if (col_dry.size() == 0)
-            Gas_optics_rrtmgp<TF>::get_col_dry(col_dry_subset, gas_concs_subset.get_vmr("h2o"), p_lev_subset);
-        else
-            col_dry_subset = std::move(col_dry.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}));
+        // Longwave.
+        {
+            // In Monte Carlo mode, gas optics and sources are only computed for the sampled g-points.
+            // The sources are weighted by n_gpt / n_sample, such that the sum over the samples is an
+            // unbiased estimate of the flux.
+            const int n_gpt_solve = sample_props_lw ? n_gpt_sample_lw : n_gpt_lw;
+            const Optical_props<TF>& props_solve = sample_props_lw ? *sample_props_lw : *kdist_lw;
 
-        Array<TF,2> toa_src_subset({n_col_in, n_gpt});
+            std::unique_ptr<Optical_props_arry<TF>> optical_props =
+                    std::make_unique<Optical_props_1scl<TF>>(n_col_in, n_lay, props_solve);
+            Source_func_lw<TF> sources(n_col_in, n_lay, props_solve);
 
-        kdist->gas_optics(
-                p_lay.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
-                p_lev_subset,
-                t_lay.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
-                gas_concs_subset,
-                optical_props_subset_in,
-                toa_src_subset,
-                col_dry_subset);
+            Array<TF,2> emis_sfc_subset = emis_sfc.subset({{ {1, n_bnd_lw}, {col_s, col_e} }});
 
-        auto tsi_scaling_subset = tsi_scaling.subset({{ {col_s_in, col_e_in} }});
+            std::unique_ptr<Optical_props_1scl<TF>> cloud_optical_props;
+            if (switch_cloud_optics)
+            {
+                cloud_optical_props = std::make_unique<Optical_props_1scl<TF>>(n_col_in, n_lay, *cloud_optics_lw);
+                cloud_optics_lw->cloud_optics(lwp_subset, iwp_subset, rel_subset, rei_subset, *cloud_optical_props);
+            }
 
-        for (int igpt=1; igpt<=n_gpt; ++igpt)
-            for (int icol=1; icol<=n_col_in; ++icol)
-                toa_src_subset({icol, igpt}) *= tsi_scaling_subset({icol});
+            if (sample_props_lw)
+            {
+                const Array<int,2> gpts = sample_gpts(
+                        n_gpt_lw, n_gpt_sample_lw, n_col_in, col_offset+col_s-1, sampling_seed, step);
+                const Array<int,1>& gpt2band = kdist_lw->get_gpoint_bands();
+                const TF weight = TF(n_gpt_lw) / n_gpt_sample_lw;
+
+                kdist_lw->gas_optics(
+                        p_lay_subset, p_lev_subset, t_lay_subset,
+                        t_sfc.subset({{ {col_s, col_e} }}),
+                        state_lw, gpts,
+                        optical_props, sources,
+                        t_lev_subset);
+
+                for (Array<TF,3>* source : {&sources.get_lay_source(), &sources.get_lev_source_inc(), &sources.get_lev_source_dec()})
+                    for (int i=0; i<source->size(); ++i)
+                        source->ptr()[i] *= weight;
+                for (int i=0; i<sources.get_sfc_source().size(); ++i)
+                    sources.get_sfc_source().ptr()[i] *= weight;
+
+                // The clouds and surface are band properties, each sample takes those of its band.
+                Optical_props_1scl<TF> cloud_optical_props_sample(n_col_in, n_lay, *sample_props_lw);
+                Array<TF,2> emis_sfc_sample({n_gpt_sample_lw, n_col_in});
+
+                for (int isample=1; isample<=n_gpt_sample_lw; ++isample)
+                {
+                    if (switch_cloud_optics)
+                        for (int ilay=1; ilay<=n_lay; ++ilay)
+                            for (int icol=1; icol<=n_col_in; ++icol)
+                            {
+                                const int ibnd = gpt2band({gpts({isample, icol})});
+                                cloud_optical_props_sample.get_tau()({icol, ilay, isample}) = cloud_optical_props->get_tau()({icol, ilay, ibnd});
+                            }
 
-        if (switch_cloud_optics)
-        {
-            Array<int,2> cld_mask_liq({n_col_in, n_lay});
-            Array<int,2> cld_mask_ice({n_col_in, n_lay});
+                    for (int icol=1; icol<=n_col_in; ++icol)
+                        emis_sfc_sample({isample, icol}) = emis_sfc_subset({gpt2band({gpts({isample, icol})}), icol});
+                }
 
-            cloud_optics->cloud_optics(
-                    lwp.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
-                    iwp.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
-                    rel.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
-                    rei.subset({{ {col_s_in, col_e_in}, {1, n_lay} }}),
-                    *cloud_optical_props_subset_in);
+                if (switch_cloud_optics)
+                    add_to(*optical_props, cloud_optical_props_sample);
 
-            cloud_optical_props_subset_in->delta_scale();
+                emis_sfc_subset = std::move(emis_sfc_sample);
+            }
+            else
+            {
+                kdist_lw->gas_optics(
+                        p_lay_subset, p_lev_subset, t_lay_subset,
+                        t_sfc.subset({{ {col_s, col_e} }}),
+                        state_lw,
+                        optical_props, sources,
+                        t_lev_subset);
+
+                if (switch_cloud_optics)
+                    add_to(*optical_props, *cloud_optical_props);
+            }
 
-            // Add the cloud optical props to the gas optical properties.
-            add_to(
-                    dynamic_cast<Optical_props_2str<TF>&>(*optical_props_subset_in),
-                    dynamic_cast<Optical_props_2str<TF>&>(*cloud_optical_props_subset_in));
-        }
+            Array<TF,3> gpt_flux_up({n_col_in, n_lev, n_gpt_solve});
+            Array<TF,3> gpt_flux_dn({n_col_in, n_lev, n_gpt_solve});
 
-        // Store the optical properties, if desired.
-        if (switch_output_optical)
-        {
-            for (int igpt=1; igpt<=n_gpt; ++igpt)
-                for (int ilay=1; ilay<=n_lay; ++ilay)
-                    for (int icol=1; icol<=n_col_in; ++icol)
-                    {
-                        tau({icol+col_s_in-1, ilay, igpt}) = optical_props_subset_in->get_tau()({icol, ilay, igpt});
-                        ssa({icol+col_s_in-1, ilay, igpt}) = optical_props_subset_in->get_ssa()({icol, ilay, igpt});
-                        g  ({icol+col_s_in-1, ilay, igpt}) = optical_props_subset_in->get_g  ()({icol, ilay, igpt});
-                    }
+            constexpr int n_ang = 1;
+            Rte_lw<TF>::rte_lw(
+                    optical_props,
+                    top_at_1,
+                    sources,
+                    emis_sfc_subset,
+                    Array<TF,2>(), // Add an empty array, no inc_flux.
+                    gpt_flux_up, gpt_flux_dn,
+                    n_ang);
 
-            for (int igpt=1; igpt<=n_gpt; ++igpt)
+            Fluxes_broadband<TF> fluxes(n_col_in, n_lev);
+            fluxes.reduce(gpt_flux_up, gpt_flux_dn, optical_props, top_at_1);
+
+            Instrumentation::Scoped_timer timer(Stage::Output_scatter, [&]() { return 6*Instrumentation::get_bytes(fluxes.get_flux_up()); });
+
+            for (int ilev=1; ilev<=n_lev; ++ilev)
                 for (int icol=1; icol<=n_col_in; ++icol)
-                    toa_src({icol+col_s_in-1, igpt}) = toa_src_subset({icol, igpt});
+                {
+                    const int icol_out = icol+col_s-1;
+                    lw_flux_up ({icol_out, ilev}) = fluxes.get_flux_up ()({icol, ilev});
+                    lw_flux_dn ({icol_out, ilev}) = fluxes.get_flux_dn ()({icol, ilev});
+                    lw_flux_net({icol_out, ilev}) = fluxes.get_flux_net()({icol, ilev});
+                }
         }
 
-        if (!switch_fluxes)
-            return;
-
-        Array<TF,3> gpt_flux_up    ({n_col_in, n_lev, n_gpt});
-        Array<TF,3> gpt_flux_dn    ({n_col_in, n_lev, n_gpt});
-        Array<TF,3> gpt_flux_dn_dir({n_col_in, n_lev, n_gpt});
+        // Shortwave.
+        {
+            // In Monte Carlo mode, the incoming flux is weighted by n_gpt / n_sample.
+            const int n_gpt_solve = sample_props_sw ? n_gpt_sample_sw : n_gpt_sw;
+            const Optical_props<TF>& props_solve = sample_props_sw ? *sample_props_sw : *kdist_sw;
 
-        Rte_sw<TF>::rte_sw(
-                optical_props_subset_in,
-                top_at_1,
-                mu0.subset({{ {col_s_in, col_e_in} }}),
-                toa_src_subset,
-                sfc_alb_dir.subset({{ {1, n_bnd}, {col_s_in, col_e_in} }}),
-                sfc_alb_dif.subset({{ {1, n_bnd}, {col_s_in, col_e_in} }}),
-                Array<TF,2>(), // Add an empty array, no inc_flux.
-                gpt_flux_up,
-                gpt_flux_dn,
-                gpt_flux_dn_dir);
+            std::unique_ptr<Optical_props_arry<TF>> optical_props =
+                    std::make_unique<Optical_props_2str<TF>>(n_col_in, n_lay, props_solve);
+            Array<TF,2> toa_src({n_col_in, n_gpt_solve});
 
-        fluxes.reduce(gpt_flux_up, gpt_flux_dn, gpt_flux_dn_dir, optical_props_subset_in, top_at_1);
+            Array<TF,2> sfc_alb_dir_subset = sfc_alb_dir.subset({{ {1, n_bnd_sw}, {col_s, col_e} }});
+            Array<TF,2> sfc_alb_dif_subset = sfc_alb_dif.subset({{ {1, n_bnd_sw}, {col_s, col_e} }});
 
-        // Copy the data to the output.
-        for (int ilev=1; ilev<=n_lev; ++ilev)
-            for (int icol=1; icol<=n_col_in; ++icol)
+            std::unique_ptr<Optical_props_2str<TF>> cloud_optical_props;
+            if (switch_cloud_optics)
             {
-                sw_flux_up     ({icol+col_s_in-1, ilev}) = fluxes.get_flux_up    ()({icol, ilev});
-                sw_flux_dn     ({icol+col_s_in-1, ilev}) = fluxes.get_flux_dn    ()({icol, ilev});
-                sw_flux_dn_dir ({icol+col_s_in-1, ilev}) = fluxes.get_flux_dn_dir()({icol, ilev});
-                sw_flux_net    ({icol+col_s_in-1, ilev}) = fluxes.get_flux_net   ()({icol, ilev});
+                cloud_optical_props = std::make_unique<Optical_props_2str<TF>>(n_col_in, n_lay, *cloud_optics_sw);
+                cloud_optics_sw->cloud_optics(lwp_subset, iwp_subset, rel_subset, rei_subset, *cloud_optical_props);
+                cloud_optical_props->delta_scale();
             }
 
-        if (switch_output_bnd_fluxes)
-        {
-            bnd_fluxes.reduce(gpt_flux_up, gpt_flux_dn, gpt_flux_dn_dir, optical_props_subset_in, top_at_1);
+            if (sample_props_sw)
+            {
+                const Array<int,2> gpts = sample_gpts(
+                        n_gpt_sw, n_gpt_sample_sw, n_col_in, col_offset+col_s-1, sampling_seed, step);
+                const Array<int,1>& gpt2band = kdist_sw->get_gpoint_bands();
+                const TF weight = TF(n_gpt_sw) / n_gpt_sample_sw;
+
+                kdist_sw->gas_optics(
+                        p_lay_subset, p_lev_subset, t_lay_subset,
+                        state_sw, gpts,
+                        optical_props, toa_src);
+
+                Optical_props_2str<TF> cloud_optical_props_sample(n_col_in, n_lay, *sample_props_sw);
+                Array<TF,2> sfc_alb_dir_sample({n_gpt_sample_sw, n_col_in});
+                Array<TF,2> sfc_alb_dif_sample({n_gpt_sample_sw, n_col_in});
+
+                for (int isample=1; isample<=n_gpt_sample_sw; ++isample)
+                {
+                    if (switch_cloud_optics)
+                        for (int ilay=1; ilay<=n_lay; ++ilay)
+                            for (int icol=1; icol<=n_col_in; ++icol)
+                            {
+                                const int ibnd = gpt2band({gpts({isample, icol})});
+                                cloud_optical_props_sample.get_tau()({icol, ilay, isample}) = cloud_optical_props->get_tau()({icol, ilay, ibnd});
+                                cloud_optical_props_sample.get_ssa()({icol, ilay, isample}) = cloud_optical_props->get_ssa()({icol, ilay, ibnd});
+                                cloud_optical_props_sample.get_g  ()({icol, ilay, isample}) = cloud_optical_props->get_g  ()({icol, ilay, ibnd});
+                            }
 
-            for (int ibnd=1; ibnd<=n_bnd; ++ibnd)
-                for (int ilev=1; ilev<=n_lev; ++ilev)
                     for (int icol=1; icol<=n_col_in; ++icol)
                     {
-                        sw_bnd_flux_up     ({icol+col_s_in-1, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_up     ()({icol, ilev, ibnd});
-                        sw_bnd_flux_dn     ({icol+col_s_in-1, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_dn     ()({icol, ilev, ibnd});
-                        sw_bnd_flux_dn_dir ({icol+col_s_in-1, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_dn_dir ()({icol, ilev, ibnd});
-                        sw_bnd_flux_net    ({icol+col_s_in-1, ilev, ibnd}) = bnd_fluxes.get_bnd_flux_net    ()({icol, ilev, ibnd});
+                        const int ibnd = gpt2band({gpts({isample, icol})});
+                        toa_src({icol, isample}) *= weight * tsi_scaling({icol+col_s-1});
+                        sfc_alb_dir_sample({isample, icol}) = sfc_alb_dir_subset({ibnd, icol});
+                        sfc_alb_dif_sample({isample, icol}) = sfc_alb_dif_subset({ibnd, icol});
                     }
+                }
+
+                if (switch_cloud_optics)
+                    add_to(*optical_props, cloud_optical_props_sample);
+
+                sfc_alb_dir_subset = std::move(sfc_alb_dir_sample);
+                sfc_alb_dif_subset = std::move(sfc_alb_dif_sample);
+            }
+            else
+            {
+                kdist_sw->gas_optics(
+                        p_lay_subset, p_lev_subset, t_lay_subset,
+                        state_sw,
+                        optical_props, toa_src);
+
+                for (int igpt=1; igpt<=n_gpt_sw; ++igpt)
+                    for (int icol=1; icol<=n_col_in; ++icol)
+                        toa_src({icol, igpt}) *= tsi_scaling({icol+col_s-1});
+
+                if (switch_cloud_optics)
+                    add_to(*optical_props, *cloud_optical_props);
+            }
+
+            Array<TF,3> gpt_flux_up    ({n_col_in, n_lev, n_gpt_solve});
+            Array<TF,3> gpt_flux_dn    ({n_col_in, n_lev, n_gpt_solve});
+            Array<TF,3> gpt_flux_dn_dir({n_col_in, n_lev, n_gpt_solve});
+
+            Rte_sw<TF>::rte_sw(
+                    optical_props,
+                    top_at_1,
+                    mu0.subset({{ {col_s, col_e} }}),
+                    toa_src,
+                    sfc_alb_dir_subset,
+                    sfc_alb_dif_subset,
+                    Array<TF,2>(), // Add an empty array, no inc_flux.
+                    gpt_flux_up,
+                    gpt_flux_dn,
+                    gpt_flux_dn_dir);
+
+            Fluxes_broadband<TF> fluxes(n_col_in, n_lev);
+            fluxes.reduce(gpt_flux_up, gpt_flux_dn, gpt_flux_dn_dir, optical_props, top_at_1);
+
+            Instrumentation::Scoped_timer timer(Stage::Output_scatter, [&]() { return 8*Instrumentation::get_bytes(fluxes.get_flux_up()); });
+
+            for (int ilev=1; ilev<=n_lev; ++ilev)
+                for (int icol=1; icol<=n_col_in; ++icol)
+                {
+                    const int icol_out = icol+col_s-1;
+                    sw_flux_up    ({icol_out, ilev}) = fluxes.get_flux_up    ()({icol, ilev});
+                    sw_flux_dn    ({icol_out, ilev}) = fluxes.get_flux_dn    ()({icol, ilev});
+                    sw_flux_dn_dir({icol_out, ilev}) = fluxes.get_flux_dn_dir()({icol, ilev});
+                    sw_flux_net   ({icol_out, ilev}) = fluxes.get_flux_net   ()({icol, ilev});
+                }
         }
     };
 
-    for (int b=1; b<=n_blocks; ++b)
-    {
-        const int col_s = (b-1) * n_col_block + 1;
-        const int col_e =  b    * n_col_block;
-
-        std::unique_ptr<Fluxes_broadband<TF>> fluxes_subset =
-                std::make_unique<Fluxes_broadband<TF>>(n_col_block, n_lev);
-        std::unique_ptr<Fluxes_broadband<TF>> bnd_fluxes_subset =
-                std::make_unique<Fluxes_byband<TF>>(n_col_block, n_lev, n_bnd);
-
-        call_kernels(
-                col_s, col_e,
-                optical_props_subset,
-                cloud_optical_props_subset,
-                *fluxes_subset,
-                *bnd_fluxes_subset);
-    }
+    // Each block writes only its own columns of the outputs, thus the blocks are independent.
+    const int n_blocks = (n_col + n_col_block - 1) / n_col_block;
 
-    if (n_col_block_residual > 0)
+    auto solve_block_id = [&](const int iblock)
     {
-        const int col_s = n_col - n_col_block_residual + 1;
-        const int col_e = n_col;
-
-        std::unique_ptr<Fluxes_broadband<TF>> fluxes_residual =
-                std::make_unique<Fluxes_broadband<TF>>(n_col_block_residual, n_lev);
-        std::unique_ptr<Fluxes_broadband<TF>> bnd_fluxes_residual =
-                std::make_unique<Fluxes_byband<TF>>(n_col_block_residual, n_lev, n_bnd);
-
-        call_kernels(
-                col_s, col_e,
-                optical_props_residual,
-                cloud_optical_props_residual,
-                *fluxes_residual,
-                *bnd_fluxes_residual);
-    }
+        const int col_s = 1 + iblock*n_col_block;
+        solve_block(col_s, std::min(col_s+n_col_block-1, n_col));
+    };
+
+    if (thread_pool)
+        thread_pool->parallel_for(n_blocks, solve_block_id);
+    else
+        for (int iblock=0; iblock<n_blocks; ++iblock)
+            solve_block_id(iblock);
 }
 
-#ifdef FLOAT_SINGLE_RRTMGP
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+template class Radiation_solver_longwave<float>;
+template class Radiation_solver_shortwave<float>;
+template class Radiation_solver_combined<float>;
+template class Radiation_solver_longwave<double>;
+template class Radiation_solver_shortwave<double>;
+template class Radiation_solver_combined<double>;
+#elif defined(FLOAT_SINGLE_RRTMGP)
 template class Radiation_solver_longwave<float>;
 template class Radiation_solver_shortwave<float>;
+template class Radiation_solver_combined<float>;
 #else
 template class Radiation_solver_longwave<double>;
 template class Radiation_solver_shortwave<double>;
+template class Radiation_solver_combined<double>;
 #endif
@@ -0,0 +1,232 @@
+/*
+ * This file is developed for the
+ * testing of the C++ interface to the RTE+RRTMGP radiation code.
+ *
+ * It is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Synthetic_atmosphere.h"
+#include "Netcdf_interface.h"
+
+namespace
+{
+    // Well-mixed gases with present-day volume mixing ratios.
+    template<typename TF>
+    const std::vector<std::pair<std::string, TF>> well_mixed_gases = {
+        {"co2", TF(4.1e-4)}, {"n2o", TF(3.3e-7)}, {"co", TF(1.2e-7)},
+        {"ch4", TF(1.9e-6)}, {"o2", TF(0.209)}, {"n2", TF(0.781)} };
+
+    // The highest level stays well below the top of the k-distribution.
+    template<typename TF> constexpr TF p_top = TF(100.);
+    template<typename TF> constexpr TF p_tropopause = TF(1.e4);
+
+    // Temperature of a moist adiabat approximated by a constant lapse rate of 6.5 K/km,
+    // an isothermal tropopause and a stratosphere that warms towards 270 K at the top.
+    template<typename TF>
+    TF temperature(const TF p, const TF p_sfc, const TF t_sfc)
+    {
+        constexpr TF lapse_rate_exponent = TF(287.04*0.0065/9.81);
+        const TF t_tropopause = std::max(t_sfc * std::pow(p_tropopause<TF>/p_sfc, lapse_rate_exponent), TF(200.));
+
+        if (p >= p_tropopause<TF>)
+            return std::max(t_sfc * std::pow(p/p_sfc, lapse_rate_exponent), t_tropopause);
+        else
+            return t_tropopause + (TF(270.) - t_tropopause)
+                * std::log(p_tropopause<TF>/p) / std::log(p_tropopause<TF>/p_top<TF>);
+    }
+
+    // Saturation vapor pressure over water from the Tetens formula.
+    template<typename TF>
+    TF esat(const TF t)
+    {
+        return TF(611.2) * std::exp(TF(17.67) * (t - TF(273.15)) / (t - TF(29.65)));
+    }
+}
+
+template<typename TF>
+Synthetic_atmosphere<TF>::Synthetic_atmosphere(const Atmosphere_settings<TF>& settings) :
+    n_col(settings.n_col), n_lay(settings.n_lay), n_lev(settings.n_lay+1),
+    p_lay({n_col, n_lay}), p_lev({n_col, n_lev}),
+    t_lay({n_col, n_lay}), t_lev({n_col, n_lev}),
+    t_sfc({n_col}),
+    lwp({n_col, n_lay}), iwp({n_col, n_lay}),
+    rel({n_col, n_lay}), rei({n_col, n_lay}),
+    emis_sfc({settings.n_bnd_lw, n_col}),
+    sfc_alb_dir({settings.n_bnd_sw, n_col}), sfc_alb_dif({settings.n_bnd_sw, n_col}),
+    mu0({n_col}), tsi({n_col})
+{
+    if (n_col < 1 || n_lay < 1)
+        throw std::runtime_error("The synthetic atmosphere needs at least one column and one layer");
+
+    if (settings.cloud_fraction < TF(0.) || settings.cloud_fraction > TF(1.)
+            || settings.day_fraction < TF(0.) || settings.day_fraction > TF(1.))
+        throw std::runtime_error("The cloud and day fractions need to be between 0 and 1");
+
+    if (settings.lwp < TF(0.) || settings.iwp < TF(0.))
+        throw std::runtime_error("The water paths cannot be negative");
+
+    Array<TF,2> h2o({n_col, n_lay});
+    Array<TF,2> o3 ({n_col, n_lay});
+
+    for (int icol=1; icol<=n_col; ++icol)
+    {
+        std::seed_seq seed{settings.seed, static_cast<unsigned int>(icol)};
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<TF> uniform(TF(0.), TF(1.));
+
+        // Surface state, ranging from the subtropics to the mid-latitudes.
+        const TF p_sfc = TF(1.013e5) - TF(4.e3)*uniform(generator);
+        const TF t_sfc_col = TF(275.) + TF(27.)*uniform(generator);
+        const TF rh_sfc = TF(0.6) + TF(0.3)*uniform(generator);
+
+        // The levels are equidistant in log pressure.
+        for (int ilev=1; ilev<=n_lev; ++ilev)
+        {
+            const TF p = p_sfc * std::pow(p_top<TF>/p_sfc, TF(ilev-1)/n_lay);
+            p_lev({icol, ilev}) = p;
+            t_lev({icol, ilev}) = temperature(p, p_sfc, t_sfc_col);
+        }
+
+        for (int ilay=1; ilay<=n_lay; ++ilay)
+        {
+            const TF p = std::sqrt(p_lev({icol, ilay}) * p_lev({icol, ilay+1}));
+            const TF t = temperature(p, p_sfc, t_sfc_col);
+            p_lay({icol, ilay}) = p;
+            t_lay({icol, ilay}) = t;
+
+            // Relative humidity decreasing with height and a dry stratosphere.
+            const TF rh = rh_sfc * std::max((p/p_sfc - TF(0.1)) / TF(0.9), TF(0.));
+            const TF e = std::min(rh*esat(t), TF(0.5)*p);
+            h2o({icol, ilay}) = std::max(e / (p - e), TF(4.e-6));
+
+            // Ozone with a maximum of 8 ppmv at 10 hPa.
+            const TF log_p = std::log(p/TF(1.e3)) / TF(1.2);
+            o3({icol, ilay}) = TF(8.e-6)*std::exp(TF(-0.5)*log_p*log_p) + TF(2.e-8);
+        }
+
+        t_sfc({icol}) = t_sfc_col;
+
+        // Ocean or land surface.
+        const TF albedo = TF(0.06) + TF(0.24)*uniform(generator);
+        for (int ibnd=1; ibnd<=emis_sfc.dim(1); ++ibnd)
+            emis_sfc({ibnd, icol}) = TF(0.98);
+        for (int ibnd=1; ibnd<=sfc_alb_dir.dim(1); ++ibnd)
+        {
+            sfc_alb_dir({ibnd, icol}) = albedo;
+            sfc_alb_dif({ibnd, icol}) = albedo;
+        }
+
+        // Single cloud layer with the liquid and ice paths spread evenly over the
+        // layers that are warm or cold enough, with mixed phase in between.
+        const bool is_cloudy = uniform(generator) < settings.cloud_fraction;
+        const TF p_base = p_sfc - TF(5.e3) - TF(1.e4)*uniform(generator);
+        const TF p_cloud_top = TF(2.e4) + (p_base - TF(3.e4))*uniform(generator);
+
+        int n_liq = 0;
+        int n_ice = 0;
+        for (int ilay=1; ilay<=n_lay; ++ilay)
+        {
+            lwp({icol, ilay}) = TF(0.);
+            iwp({icol, ilay}) = TF(0.);
+
+            if (is_cloudy && p_lay({icol, ilay}) <= p_base && p_lay({icol, ilay}) >= p_cloud_top)
+            {
+                if (t_lay({icol, ilay}) > TF(263.)) { lwp({icol, ilay}) = TF(1.); ++n_liq; }
+                if (t_lay({icol, ilay}) < TF(273.)) { iwp({icol, ilay}) = TF(1.); ++n_ice; }
+            }
+        }
+
+        const TF rel_col = TF(6.) + TF(8.)*uniform(generator);
+        const TF rei_col = TF(30.) + TF(60.)*uniform(generator);
+
+        for (int ilay=1; ilay<=n_lay; ++ilay)
+        {
+            if (n_liq > 0)
+                lwp({icol, ilay}) *= settings.lwp / n_liq;
+            if (n_ice > 0)
+                iwp({icol, ilay}) *= settings.iwp / n_ice;
+
+            rel({icol, ilay}) = (lwp({icol, ilay}) > TF(0.)) ? rel_col : TF(0.);
+            rei({icol, ilay}) = (iwp({icol, ilay}) > TF(0.)) ? rei_col : TF(0.);
+        }
+
+        // Daylight columns have a solar zenith angle of up to 85 degrees.
+        const bool is_day = uniform(generator) < settings.day_fraction;
+        constexpr TF deg_to_rad = TF(3.14159265358979/180.);
+        if (is_day)
+        {
+            mu0({icol}) = std::cos(TF(85.)*deg_to_rad*uniform(generator));
+            tsi({icol}) = TF(1360.9);
+        }
+        else
+        {
+            mu0({icol}) = std::cos(TF(89.9)*deg_to_rad);
+            tsi({icol}) = TF(0.);
+        }
+    }
+
+    gas_concs.set_vmr("h2o", h2o);
+    gas_concs.set_vmr("o3", o3);
+    for (const auto& gas : well_mixed_gases<TF>)
+        gas_concs.set_vmr(gas.first, gas.second);
+}
+
+template<typename TF>
+void Synthetic_atmosphere<TF>::save(const std::string& file_name) const
+{
+    Netcdf_file nc_file(file_name, Netcdf_mode::Create);
+    nc_file.add_dimension("col", n_col);
+    nc_file.add_dimension("lay", n_lay);
+    nc_file.add_dimension("lev", n_lev);
+    nc_file.add_dimension("band_lw", emis_sfc.dim(1));
+    nc_file.add_dimension("band_sw", sfc_alb_dir.dim(1));
+
+    nc_file.add_variable<TF>("p_lay", {"lay", "col"}).insert(p_lay.v(), {0, 0});
+    nc_file.add_variable<TF>("p_lev", {"lev", "col"}).insert(p_lev.v(), {0, 0});
+    nc_file.add_variable<TF>("t_lay", {"lay", "col"}).insert(t_lay.v(), {0, 0});
+    nc_file.add_variable<TF>("t_lev", {"lev", "col"}).insert(t_lev.v(), {0, 0});
+
+    nc_file.add_variable<TF>("vmr_h2o", {"lay", "col"}).insert(gas_concs.get_vmr("h2o").v(), {0, 0});
+    nc_file.add_variable<TF>("vmr_o3" , {"lay", "col"}).insert(gas_concs.get_vmr("o3" ).v(), {0, 0});
+    for (const auto& gas : well_mixed_gases<TF>)
+        nc_file.add_variable<TF>("vmr_" + gas.first, {}).insert(gas.second, {});
+
+    nc_file.add_variable<TF>("lwp", {"lay", "col"}).insert(lwp.v(), {0, 0});
+    nc_file.add_variable<TF>("iwp", {"lay", "col"}).insert(iwp.v(), {0, 0});
+    nc_file.add_variable<TF>("rel", {"lay", "col"}).insert(rel.v(), {0, 0});
+    nc_file.add_variable<TF>("rei", {"lay", "col"}).insert(rei.v(), {0, 0});
+
+    nc_file.add_variable<TF>("t_sfc", {"col"}).insert(t_sfc.v(), {0});
+    nc_file.add_variable<TF>("emis_sfc", {"col", "band_lw"}).insert(emis_sfc.v(), {0, 0});
+    nc_file.add_variable<TF>("sfc_alb_dir", {"col", "band_sw"}).insert(sfc_alb_dir.v(), {0, 0});
+    nc_file.add_variable<TF>("sfc_alb_dif", {"col", "band_sw"}).insert(sfc_alb_dif.v(), {0, 0});
+    nc_file.add_variable<TF>("mu0", {"col"}).insert(mu0.v(), {0});
+    nc_file.add_variable<TF>("tsi", {"col"}).insert(tsi.v(), {0});
+}
+
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+template class Synthetic_atmosphere<float>;
+template class Synthetic_atmosphere<double>;
+#elif defined(FLOAT_SINGLE_RRTMGP)
+template class Synthetic_atmosphere<float>;
+#else
+template class Synthetic_atmosphere<double>;
+#endif
@@ -0,0 +1,1106 @@
+/*
+ * This file is a stand-alone executable developed for the
+ * benchmarking of the C++ interface to the RTE+RRTMGP radiation code.
+ *
+ * It is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+
+#include "Benchmark.h"
+#include "Status.h"
+#include "Array.h"
+#include "Gas_concs.h"
+#include "Optical_props.h"
+#include "Cloud_optics.h"
+#include "Source_functions.h"
+#include "Rte_lw.h"
+#include "Rte_sw.h"
+
+#include "rrtmgp_kernels.h"
+
+
+namespace
+{
+    template<typename T, int N>
+    double get_bytes(const Array<T,N>& array) { return double(array.size())*sizeof(T); }
+
+    template<typename T, int N, typename... Arrays>
+    double get_bytes(const Array<T,N>& array, const Arrays&... arrays)
+    {
+        return get_bytes(array) + get_bytes(arrays...);
+    }
+
+    template<typename TF, int N>
+    void fill_random(Array<TF,N>& array, const TF lower, const TF upper, std::mt19937& generator)
+    {
+        std::uniform_real_distribution<TF> distribution(lower, upper);
+        for (TF& value : array.v())
+            value = distribution(generator);
+    }
+
+    // Synthetic inputs of the kernels. The spectral dimensions follow the longwave
+    // k-distribution, the reference tables contain random, but physically valid, values.
+    template<typename TF>
+    struct Kernel_data
+    {
+        Kernel_data(const int n_col, const int n_lay);
+
+        const int n_col;
+        const int n_lay;
+        const int n_lev;
+
+        const int n_gas = 7;
+        const int n_flav = 10;
+        const int n_eta = 9;
+        const int n_pres = 59;
+        const int n_temp = 14;
+        const int n_bnd = 16;
+        const int n_gpt = 256;
+        const int n_planck_temp = 196;
+        const int n_minor = 16;
+        const int n_minor_k = 256;
+        const int idx_h2o = 1;
+
+        // Reference tables.
+        Array<int,2> flavor;
+        Array<int,2> gpoint_flavor;
+        Array<int,2> band_lims_gpt;
+        Array<int,1> gpoint_bands;
+        Array<TF,1> press_ref_log;
+        Array<TF,1> temp_ref;
+        TF press_ref_log_delta;
+        TF temp_ref_min;
+        TF temp_ref_delta;
+        TF press_ref_trop_log;
+        Array<TF,3> vmr_ref;
+        Array<TF,4> kmajor;
+        Array<TF,3> kminor;
+        Array<int,2> minor_limits_gpt;
+        Array<BOOL_TYPE,1> minor_scales_with_density;
+        Array<BOOL_TYPE,1> scale_by_complement;
+        Array<int,1> idx_minor;
+        Array<int,1> idx_minor_scaling;
+        Array<int,1> kminor_start;
+        Array<TF,4> krayl;
+        Array<TF,4> pfrac;
+        Array<TF,2> totplnk;
+        TF totplnk_delta;
+
+        // Atmosphere.
+        Array<TF,2> play, plev, tlay, tlev;
+        Array<TF,1> tsfc;
+        Array<TF,2> col_dry;
+        Array<TF,3> col_gas;
+
+        // Results of the interpolation.
+        Array<int,2> jtemp, jpress;
+        Array<BOOL_TYPE,2> tropo;
+        Array<TF,6> fmajor;
+        Array<TF,5> fminor;
+        Array<TF,4> col_mix;
+        Array<int,4> jeta;
+
+        void interpolation();
+    };
+
+    template<typename TF>
+    Kernel_data<TF>::Kernel_data(const int n_col, const int n_lay) :
+        n_col(n_col), n_lay(n_lay), n_lev(n_lay+1)
+    {
+        std::mt19937 generator(1234);
+
+        flavor.set_dims({2, n_flav});
+        for (int iflav=1; iflav<=n_flav; ++iflav)
+        {
+            flavor({1, iflav}) = idx_h2o;
+            flavor({2, iflav}) = (iflav-1) % (n_gas-1) + 2;
+        }
+
+        const int n_gpt_per_bnd = n_gpt / n_bnd;
+        band_lims_gpt.set_dims({2, n_bnd});
+        gpoint_bands.set_dims({n_gpt});
+        gpoint_flavor.set_dims({2, n_gpt});
+        for (int ibnd=1; ibnd<=n_bnd; ++ibnd)
+        {
+            band_lims_gpt({1, ibnd}) = (ibnd-1)*n_gpt_per_bnd + 1;
+            band_lims_gpt({2, ibnd}) = ibnd*n_gpt_per_bnd;
+
+            for (int igpt=band_lims_gpt({1, ibnd}); igpt<=band_lims_gpt({2, ibnd}); ++igpt)
+            {
+                gpoint_bands({igpt}) = ibnd;
+                gpoint_flavor({1, igpt}) = (ibnd-1) % n_flav + 1;
+                gpoint_flavor({2, igpt}) = ibnd % n_flav + 1;
+            }
+        }
+
+        // Pressure from 1096 hPa to 1 Pa, temperature from 160 to 355 K.
+        const TF press_ref_max = TF(109663.);
+        const TF press_ref_min = TF(1.);
+        press_ref_log.set_dims({n_pres});
+        press_ref_log_delta = (std::log(press_ref_min) - std::log(press_ref_max)) / (n_pres-1);
+        for (int ipres=1; ipres<=n_pres; ++ipres)
+            press_ref_log({ipres}) = std::log(press_ref_max) + (ipres-1)*press_ref_log_delta;
+
+        temp_ref_min = TF(160.);
+        temp_ref_delta = TF(15.);
+        temp_ref.set_dims({n_temp});
+        for (int itemp=1; itemp<=n_temp; ++itemp)
+            temp_ref({itemp}) = temp_ref_min + (itemp-1)*temp_ref_delta;
+
+        press_ref_trop_log = std::log(TF(9948.43));
+
+        vmr_ref.set_dims({2, n_gas+1, n_temp});
+        vmr_ref.set_offsets({0, -1, 0});
+        fill_random(vmr_ref, TF(1.e-4), TF(1.e-2), generator);
+        for (int itemp=1; itemp<=n_temp; ++itemp)
+            for (int itrop=1; itrop<=2; ++itrop)
+                vmr_ref({itrop, 0, itemp}) = TF(1.);
+
+        kmajor.set_dims({n_gpt, n_eta, n_pres+1, n_temp});
+        fill_random(kmajor, TF(1.e-26), TF(1.e-22), generator);
+
+        kminor.set_dims({n_minor_k, n_eta, n_temp});
+        fill_random(kminor, TF(1.e-28), TF(1.e-24), generator);
+
+        // Each minor absorber covers one band.
+        minor_limits_gpt.set_dims({2, n_minor});
+        minor_scales_with_density.set_dims({n_minor});
+        scale_by_complement.set_dims({n_minor});
+        idx_minor.set_dims({n_minor});
+        idx_minor_scaling.set_dims({n_minor});
+        kminor_start.set_dims({n_minor});
+        for (int imnr=1; imnr<=n_minor; ++imnr)
+        {
+            minor_limits_gpt({1, imnr}) = band_lims_gpt({1, imnr});
+            minor_limits_gpt({2, imnr}) = band_lims_gpt({2, imnr});
+            minor_scales_with_density({imnr}) = imnr % 2;
+            scale_by_complement({imnr}) = 0;
+            idx_minor({imnr}) = (imnr-1) % n_gas + 1;
+            idx_minor_scaling({imnr}) = idx_h2o;
+            kminor_start({imnr}) = (imnr-1)*n_gpt_per_bnd + 1;
+        }
+
+        krayl.set_dims({n_gpt, n_eta, n_temp, 2});
+        fill_random(krayl, TF(1.e-30), TF(1.e-28), generator);
+
+        pfrac.set_dims({n_gpt, n_eta, n_pres+1, n_temp});
+        fill_random(pfrac, TF(0.5)/n_gpt_per_bnd, TF(1.5)/n_gpt_per_bnd, generator);
+
+        totplnk_delta = TF(1.);
+        totplnk.set_dims({n_planck_temp, n_bnd});
+        for (int ibnd=1; ibnd<=n_bnd; ++ibnd)
+            for (int itemp=1; itemp<=n_planck_temp; ++itemp)
+            {
+                const TF temp = temp_ref_min + (itemp-1)*totplnk_delta;
+                totplnk({itemp, ibnd}) = TF(5.67e-8)/n_bnd * std::pow(temp, 4) / TF(3.14159);
+            }
+
+        // Atmosphere with an isothermal stratosphere on top of a troposphere with a lapse rate.
+        play.set_dims({n_col, n_lay});
+        plev.set_dims({n_col, n_lev});
+        tlay.set_dims({n_col, n_lay});
+        tlev.set_dims({n_col, n_lev});
+        tsfc.set_dims({n_col});
+        col_dry.set_dims({n_col, n_lay});
+        col_gas.set_dims({n_col, n_lay, n_gas+1});
+        col_gas.set_offsets({0, 0, -1});
+
+        auto temperature = [](const TF p) { return std::max(TF(288.) - TF(50.)*std::log(TF(1.e5)/p), TF(216.)); };
+
+        for (int icol=1; icol<=n_col; ++icol)
+        {
+            const TF p_sfc = TF(1.e5) - TF(2000.)*(icol % 5);
+            for (int ilev=1; ilev<=n_lev; ++ilev)
+            {
+                plev({icol, ilev}) = p_sfc * std::pow(TF(1.e-3), TF(ilev-1)/n_lay);
+                tlev({icol, ilev}) = temperature(plev({icol, ilev}));
+            }
+
+            for (int ilay=1; ilay<=n_lay; ++ilay)
+            {
+                play({icol, ilay}) = std::sqrt(plev({icol, ilay}) * plev({icol, ilay+1}));
+                tlay({icol, ilay}) = temperature(play({icol, ilay}));
+
+                // Molecules per cm2 of dry air, computed from the hydrostatic pressure difference.
+                col_dry({icol, ilay}) = (plev({icol, ilay}) - plev({icol, ilay+1})) * TF(2.08e20);
+            }
+
+            tsfc({icol}) = tlev({icol, 1}) + TF(1.);
+        }
+
+        for (int igas=0; igas<=n_gas; ++igas)
+        {
+            const TF vmr = (igas == 0) ? TF(1.) : TF(1.e-2) / igas;
+            for (int ilay=1; ilay<=n_lay; ++ilay)
+                for (int icol=1; icol<=n_col; ++icol)
+                    col_gas({icol, ilay, igas}) = vmr * col_dry({icol, ilay});
+        }
+
+        jtemp.set_dims({n_col, n_lay});
+        jpress.set_dims({n_col, n_lay});
+        tropo.set_dims({n_col, n_lay});
+        fmajor.set_dims({2, 2, 2, n_flav, n_col, n_lay});
+        fminor.set_dims({2, 2, n_flav, n_col, n_lay});
+        col_mix.set_dims({2, n_flav, n_col, n_lay});
+        jeta.set_dims({2, n_flav, n_col, n_lay});
+
+        // The other kernels take the results of the interpolation as input.
+        interpolation();
+    }
+
+    template<typename TF>
+    void Kernel_data<TF>::interpolation()
+    {
+        int ncol = n_col, nlay = n_lay;
+        int ngas = n_gas, nflav = n_flav, neta = n_eta, npres = n_pres, ntemp = n_temp;
+
+        rrtmgp_kernels::interpolation(
+                &ncol, &nlay,
+                &ngas, &nflav, &neta, &npres, &ntemp,
+                flavor.ptr(),
+                press_ref_log.ptr(),
+                temp_ref.ptr(),
+                &press_ref_log_delta,
+                &temp_ref_min,
+                &temp_ref_delta,
+                &press_ref_trop_log,
+                vmr_ref.ptr(),
+                play.ptr(),
+                tlay.ptr(),
+                col_gas.ptr(),
+                jtemp.ptr(),
+                fmajor.ptr(), fminor.ptr(),
+                col_mix.ptr(),
+                tropo.ptr(),
+                jeta.ptr(),
+                jpress.ptr());
+    }
+
+    // The flop counts are estimates from the operation counts in the inner loops of the kernels.
+    template<typename TF>
+    void bench_interpolation(Benchmark::State& state)
+    {
+        Kernel_data<TF> d(state.get_n_col(), state.get_n_lay());
+
+        while (state.keep_running())
+            d.interpolation();
+
+        const double n_cells = double(d.n_col)*d.n_lay;
+        state.set_bytes_per_iteration(
+                get_bytes(d.play, d.tlay, d.col_gas, d.jtemp, d.jpress, d.tropo,
+                          d.fmajor, d.fminor, d.col_mix, d.jeta));
+        state.set_flops_per_iteration(n_cells*(20. + 40.*d.n_flav));
+    }
+
+    template<typename TF>
+    void bench_compute_tau_absorption(Benchmark::State& state)
+    {
+        Kernel_data<TF> d(state.get_n_col(), state.get_n_lay());
+        Array<TF,3> tau({d.n_gpt, d.n_lay, d.n_col});
+
+        int ncol = d.n_col, nlay = d.n_lay, nbnd = d.n_bnd, ngpt = d.n_gpt;
+        int ngas = d.n_gas, nflav = d.n_flav, neta = d.n_eta, npres = d.n_pres, ntemp = d.n_temp;
+        int nminor = d.n_minor, nminork = d.n_minor_k, idx_h2o = d.idx_h2o;
+
+        while (state.keep_running())
+        {
+            rrtmgp_kernels::zero_array_3D(&ngpt, &nlay, &ncol, tau.ptr());
+
+            rrtmgp_kernels::compute_tau_absorption(
+                    &ncol, &nlay, &nbnd, &ngpt,
+                    &ngas, &nflav, &neta, &npres, &ntemp,
+                    &nminor, &nminork,
+                    &nminor, &nminork,
+                    &idx_h2o,
+                    d.gpoint_flavor.ptr(),
+                    d.band_lims_gpt.ptr(),
+                    d.kmajor.ptr(),
+                    d.kminor.ptr(),
+                    d.kminor.ptr(),
+                    d.minor_limits_gpt.ptr(),
+                    d.minor_limits_gpt.ptr(),
+                    d.minor_scales_with_density.ptr(),
+                    d.minor_scales_with_density.ptr(),
+                    d.scale_by_complement.ptr(),
+                    d.scale_by_complement.ptr(),
+                    d.idx_minor.ptr(),
+                    d.idx_minor.ptr(),
+                    d.idx_minor_scaling.ptr(),
+                    d.idx_minor_scaling.ptr(),
+                    d.kminor_start.ptr(),
+                    d.kminor_start.ptr(),
+                    d.tropo.ptr(),
+                    d.col_mix.ptr(), d.fmajor.ptr(), d.fminor.ptr(),
+                    d.play.ptr(), d.tlay.ptr(), d.col_gas.ptr(),
+                    d.jeta.ptr(), d.jtemp.ptr(), d.jpress.ptr(),
+                    tau.ptr());
+        }
+
+        const double n_cells = double(d.n_col)*d.n_lay*d.n_gpt;
+        state.set_bytes_per_iteration(
+                2.*get_bytes(tau) + get_bytes(d.col_mix, d.fmajor, d.fminor, d.col_gas, d.jeta, d.jtemp, d.jpress));
+        state.set_flops_per_iteration(n_cells*(2.*8. + 2.*2.*4.));
+    }
+
+    template<typename TF>
+    void bench_compute_tau_rayleigh(Benchmark::State& state)
+    {
+        Kernel_data<TF> d(state.get_n_col(), state.get_n_lay());
+        Array<TF,3> tau_rayleigh({d.n_gpt, d.n_lay, d.n_col});
+
+        int ncol = d.n_col, nlay = d.n_lay, nbnd = d.n_bnd, ngpt = d.n_gpt;
+        int ngas = d.n_gas, nflav = d.n_flav, neta = d.n_eta, npres = d.n_pres, ntemp = d.n_temp;
+        int idx_h2o = d.idx_h2o;
+
+        while (state.keep_running())
+            rrtmgp_kernels::compute_tau_rayleigh(
+                    &ncol, &nlay, &nbnd, &ngpt,
+                    &ngas, &nflav, &neta, &npres, &ntemp,
+                    d.gpoint_flavor.ptr(),
+                    d.band_lims_gpt.ptr(),
+                    d.krayl.ptr(),
+                    &idx_h2o, d.col_dry.ptr(), d.col_gas.ptr(),
+                    d.fminor.ptr(), d.jeta.ptr(),
+                    d.tropo.ptr(), d.jtemp.ptr(),
+                    tau_rayleigh.ptr());
+
+        const double n_cells = double(d.n_col)*d.n_lay*d.n_gpt;
+        state.set_bytes_per_iteration(get_bytes(tau_rayleigh, d.col_dry, d.col_gas, d.fminor, d.jeta, d.jtemp));
+        state.set_flops_per_iteration(n_cells*(2.*4. + 2.));
+    }
+
+    template<typename TF>
+    void bench_compute_Planck_source(Benchmark::State& state)
+    {
+        Kernel_data<TF> d(state.get_n_col(), state.get_n_lay());
+
+        Array<TF,2> sfc_src    ({d.n_gpt, d.n_col});
+        Array<TF,3> lay_src    ({d.n_gpt, d.n_lay, d.n_col});
+        Array<TF,3> lev_src_inc({d.n_gpt, d.n_lay, d.n_col});
+        Array<TF,3> lev_src_dec({d.n_gpt, d.n_lay, d.n_col});
+        Array<TF,2> sfc_src_jac({d.n_gpt, d.n_col});
+
+        int ncol = d.n_col, nlay = d.n_lay, nbnd = d.n_bnd, ngpt = d.n_gpt;
+        int nflav = d.n_flav, neta = d.n_eta, npres = d.n_pres, ntemp = d.n_temp, nplanck = d.n_planck_temp;
+        int sfc_lay = 1;
+
+        while (state.keep_running())
+            rrtmgp_kernels::compute_Planck_source(
+                    &ncol, &nlay, &nbnd, &ngpt,
+                    &nflav, &neta, &npres, &ntemp, &nplanck,
+                    d.tlay.ptr(), d.tlev.ptr(), d.tsfc.ptr(), &sfc_lay,
+                    d.fmajor.ptr(), d.jeta.ptr(), d.tropo.ptr(), d.jtemp.ptr(), d.jpress.ptr(),
+                    d.gpoint_bands.ptr(), d.band_lims_gpt.ptr(), d.pfrac.ptr(), &d.temp_ref_min,
+                    &d.totplnk_delta, d.totplnk.ptr(), d.gpoint_flavor.ptr(),
+                    sfc_src.ptr(), lay_src.ptr(), lev_src_inc.ptr(), lev_src_dec.ptr(),
+                    sfc_src_jac.ptr());
+
+        const double n_cells = double(d.n_col)*d.n_lay*d.n_gpt;
+        state.set_bytes_per_iteration(
+                get_bytes(sfc_src, lay_src, lev_src_inc, lev_src_dec, sfc_src_jac)
+                + get_bytes(d.tlay, d.tlev, d.fmajor, d.jeta, d.tropo, d.jtemp, d.jpress));
+        state.set_flops_per_iteration(n_cells*(2.*8. + 3.*4.));
+    }
+
+    template<typename TF>
+    void bench_reorder(Benchmark::State& state)
+    {
+        const int n_col = state.get_n_col();
+        const int n_lay = state.get_n_lay();
+        const int n_gpt = 256;
+
+        Array<TF,3> array_in({n_gpt, n_lay, n_col});
+        Array<TF,3> array_out({n_col, n_lay, n_gpt});
+        std::mt19937 generator(1234);
+        fill_random(array_in, TF(0.), TF(1.), generator);
+
+        int dim1 = n_gpt, dim2 = n_lay, dim3 = n_col;
+
+        while (state.keep_running())
+            rrtmgp_kernels::reorder_123x321_kernel(&dim1, &dim2, &dim3, array_in.ptr(), array_out.ptr());
+
+        state.set_bytes_per_iteration(get_bytes(array_in, array_out));
+    }
+
+    template<typename TF>
+    void bench_combine_and_reorder_2str(Benchmark::State& state)
+    {
+        const int n_col = state.get_n_col();
+        const int n_lay = state.get_n_lay();
+        const int n_gpt = 256;
+
+        Array<TF,3> tau_local({n_gpt, n_lay, n_col});
+        Array<TF,3> tau_rayleigh({n_gpt, n_lay, n_col});
+        Array<TF,3> tau({n_col, n_lay, n_gpt});
+        Array<TF,3> ssa({n_col, n_lay, n_gpt});
+        Array<TF,3> g  ({n_col, n_lay, n_gpt});
+
+        std::mt19937 generator(1234);
+        fill_random(tau_local, TF(0.), TF(1.), generator);
+        fill_random(tau_rayleigh, TF(0.), TF(0.1), generator);
+
+        int ncol = n_col, nlay = n_lay, ngpt = n_gpt;
+
+        while (state.keep_running())
+            rrtmgp_kernels::combine_and_reorder_2str(
+                    &ncol, &nlay, &ngpt,
+                    tau_local.ptr(), tau_rayleigh.ptr(),
+                    tau.ptr(), ssa.ptr(), g.ptr());
+
+        state.set_bytes_per_iteration(get_bytes(tau_local, tau_rayleigh, tau, ssa, g));
+        state.set_flops_per_iteration(double(n_col)*n_lay*n_gpt*3.);
+    }
+
+    // Optical properties and sources of the solvers.
+    template<typename TF>
+    struct Solver_data
+    {
+        Solver_data(const int n_col, const int n_lay, const int n_gpt) :
+            tau({n_col, n_lay, n_gpt}), ssa({n_col, n_lay, n_gpt}), g({n_col, n_lay, n_gpt}),
+            lay_source({n_col, n_lay, n_gpt}),
+            lev_source_inc({n_col, n_lay, n_gpt}), lev_source_dec({n_col, n_lay, n_gpt}),
+            sfc_source({n_col, n_gpt}), sfc_source_jac({n_col, n_gpt}),
+            sfc_emis({n_col, n_gpt}), sfc_alb_dir({n_col, n_gpt}), sfc_alb_dif({n_col, n_gpt}),
+            mu0({n_col}), inc_flux({n_col, n_gpt}),
+            flux_up({n_col, n_lay+1, n_gpt}), flux_dn({n_col, n_lay+1, n_gpt}),
+            flux_dir({n_col, n_lay+1, n_gpt}), flux_up_jac({n_col, n_lay+1, n_gpt})
+        {
+            std::mt19937 generator(1234);
+            fill_random(tau, TF(1.e-4), TF(1.), generator);
+            fill_random(ssa, TF(0.), TF(1.), generator);
+            fill_random(g, TF(0.), TF(0.9), generator);
+            fill_random(lay_source, TF(0.), TF(1.), generator);
+            fill_random(lev_source_inc, TF(0.), TF(1.), generator);
+            fill_random(lev_source_dec, TF(0.), TF(1.), generator);
+            fill_random(sfc_source, TF(0.), TF(1.), generator);
+            fill_random(sfc_source_jac, TF(0.), TF(0.01), generator);
+            fill_random(sfc_emis, TF(0.9), TF(1.), generator);
+            fill_random(sfc_alb_dir, TF(0.05), TF(0.3), generator);
+            fill_random(sfc_alb_dif, TF(0.05), TF(0.3), generator);
+            fill_random(mu0, TF(0.1), TF(1.), generator);
+            fill_random(inc_flux, TF(0.), TF(5.), generator);
+        }
+
+        Array<TF,3> tau, ssa, g;
+        Array<TF,3> lay_source, lev_source_inc, lev_source_dec;
+        Array<TF,2> sfc_source, sfc_source_jac;
+        Array<TF,2> sfc_emis, sfc_alb_dir, sfc_alb_dif;
+        Array<TF,1> mu0;
+        Array<TF,2> inc_flux;
+        Array<TF,3> flux_up, flux_dn, flux_dir, flux_up_jac;
+    };
+
+    template<typename TF>
+    void bench_lw_solver_noscat_GaussQuad(Benchmark::State& state, const bool switch_jacobian)
+    {
+        const int n_gpt = 256;
+        Solver_data<TF> d(state.get_n_col(), state.get_n_lay(), n_gpt);
+
+        int ncol = state.get_n_col(), nlay = state.get_n_lay(), ngpt = n_gpt;
+        int n_quad_angs = 1;
+        BOOL_TYPE top_at_1 = 0;
+        TF gauss_Ds = TF(1.66);
+        TF gauss_wts = TF(0.5);
+
+        while (state.keep_running())
+        {
+            rrtmgp_kernels::apply_BC_0(&ncol, &nlay, &ngpt, &top_at_1, d.flux_dn.ptr());
+            if (switch_jacobian)
+                rrtmgp_kernels::lw_solver_noscat_GaussQuad(
+                        &ncol, &nlay, &ngpt, &top_at_1, &n_quad_angs,
+                        &gauss_Ds, &gauss_wts,
+                        d.tau.ptr(),
+                        d.lay_source.ptr(), d.lev_source_inc.ptr(), d.lev_source_dec.ptr(),
+                        d.sfc_emis.ptr(), d.sfc_source.ptr(),
+                        d.flux_up.ptr(), d.flux_dn.ptr(),
+                        d.sfc_source_jac.ptr(), d.flux_up_jac.ptr());
+            else
+                rrtmgp_kernels::lw_solver_noscat_GaussQuad_nojac(
+                        &ncol, &nlay, &ngpt, &top_at_1, &n_quad_angs,
+                        &gauss_Ds, &gauss_wts,
+                        d.tau.ptr(),
+                        d.lay_source.ptr(), d.lev_source_inc.ptr(), d.lev_source_dec.ptr(),
+                        d.sfc_emis.ptr(), d.sfc_source.ptr(),
+                        d.flux_up.ptr(), d.flux_dn.ptr());
+        }
+
+        state.set_bytes_per_iteration(
+                get_bytes(d.tau, d.lay_source, d.lev_source_inc, d.lev_source_dec, d.sfc_emis, d.sfc_source)
+                + get_bytes(d.flux_up, d.flux_dn)
+                + (switch_jacobian ? get_bytes(d.sfc_source_jac, d.flux_up_jac) : 0.));
+        state.set_flops_per_iteration(double(ncol)*nlay*ngpt*30.);
+    }
+
+    // The boundary condition of the incoming diffuse flux per g-point, which rte_lw applies with inc_flux.
+    template<typename TF>
+    void bench_apply_BC_gpt(Benchmark::State& state)
+    {
+        const int n_gpt = 256;
+        Solver_data<TF> d(state.get_n_col(), state.get_n_lay(), n_gpt);
+
+        int ncol = state.get_n_col(), nlay = state.get_n_lay(), ngpt = n_gpt;
+        BOOL_TYPE top_at_1 = 0;
+
+        while (state.keep_running())
+            rrtmgp_kernels::apply_BC_gpt(&ncol, &nlay, &ngpt, &top_at_1, d.inc_flux.ptr(), d.flux_dn.ptr());
+
+        // The kernel reads inc_flux and writes the top level of the flux.
+        state.set_bytes_per_iteration(2.*get_bytes(d.inc_flux));
+    }
+
+    template<typename TF>
+    void bench_sw_solver_2stream(Benchmark::State& state)
+    {
+        const int n_gpt = 224;
+        Solver_data<TF> d(state.get_n_col(), state.get_n_lay(), n_gpt);
+
+        int ncol = state.get_n_col(), nlay = state.get_n_lay(), ngpt = n_gpt;
+        BOOL_TYPE top_at_1 = 0;
+
+        while (state.keep_running())
+        {
+            rrtmgp_kernels::apply_BC_factor(&ncol, &nlay, &ngpt, &top_at_1, d.inc_flux.ptr(), d.mu0.ptr(), d.flux_dir.ptr());
+            rrtmgp_kernels::apply_BC_0(&ncol, &nlay, &ngpt, &top_at_1, d.flux_dn.ptr());
+            rrtmgp_kernels::sw_solver_2stream(
+                    &ncol, &nlay, &ngpt, &top_at_1,
+                    d.tau.ptr(), d.ssa.ptr(), d.g.ptr(),
+                    d.mu0.ptr(),
+                    d.sfc_alb_dir.ptr(), d.sfc_alb_dif.ptr(),
+                    d.flux_up.ptr(), d.flux_dn.ptr(), d.flux_dir.ptr());
+        }
+
+        state.set_bytes_per_iteration(
+                get_bytes(d.tau, d.ssa, d.g, d.mu0, d.sfc_alb_dir, d.sfc_alb_dif)
+                + get_bytes(d.flux_up, d.flux_dn, d.flux_dir));
+        state.set_flops_per_iteration(double(ncol)*nlay*ngpt*60.);
+    }
+
+    template<typename TF>
+    void bench_sum_broadband(Benchmark::State& state)
+    {
+        const int n_gpt = 256;
+        Solver_data<TF> d(state.get_n_col(), state.get_n_lay(), n_gpt);
+        Array<TF,2> flux({state.get_n_col(), state.get_n_lay()+1});
+
+        int ncol = state.get_n_col(), nlev = state.get_n_lay()+1, ngpt = n_gpt;
+
+        while (state.keep_running())
+            rrtmgp_kernels::sum_broadband(&ncol, &nlev, &ngpt, d.flux_up.ptr(), flux.ptr());
+
+        state.set_bytes_per_iteration(get_bytes(d.flux_up, flux));
+        state.set_flops_per_iteration(double(ncol)*nlev*ngpt);
+    }
+
+    template<typename TF>
+    void bench_sum_byband(Benchmark::State& state)
+    {
+        const int n_gpt = 256;
+        const int n_bnd = 16;
+        Solver_data<TF> d(state.get_n_col(), state.get_n_lay(), n_gpt);
+        Array<TF,3> flux({state.get_n_col(), state.get_n_lay()+1, n_bnd});
+
+        Array<int,2> band_lims({2, n_bnd});
+        for (int ibnd=1; ibnd<=n_bnd; ++ibnd)
+        {
+            band_lims({1, ibnd}) = (ibnd-1)*(n_gpt/n_bnd) + 1;
+            band_lims({2, ibnd}) = ibnd*(n_gpt/n_bnd);
+        }
+
+        int ncol = state.get_n_col(), nlev = state.get_n_lay()+1, ngpt = n_gpt, nbnd = n_bnd;
+
+        while (state.keep_running())
+            rrtmgp_kernels::sum_byband(&ncol, &nlev, &ngpt, &nbnd, band_lims.ptr(), d.flux_up.ptr(), flux.ptr());
+
+        state.set_bytes_per_iteration(get_bytes(d.flux_up, flux));
+        state.set_flops_per_iteration(double(ncol)*nlev*ngpt);
+    }
+
+    template<typename TF>
+    void bench_net_broadband(Benchmark::State& state)
+    {
+        int ncol = state.get_n_col(), nlev = state.get_n_lay()+1;
+        Array<TF,2> flux_dn({ncol, nlev}), flux_up({ncol, nlev}), flux_net({ncol, nlev});
+
+        while (state.keep_running())
+            rrtmgp_kernels::net_broadband_precalc(&ncol, &nlev, flux_dn.ptr(), flux_up.ptr(), flux_net.ptr());
+
+        state.set_bytes_per_iteration(get_bytes(flux_dn, flux_up, flux_net));
+        state.set_flops_per_iteration(double(ncol)*nlev);
+    }
+
+    template<typename TF>
+    void bench_net_byband(Benchmark::State& state)
+    {
+        int ncol = state.get_n_col(), nlev = state.get_n_lay()+1, nbnd = 16;
+        Array<TF,3> flux_dn({ncol, nlev, nbnd}), flux_up({ncol, nlev, nbnd}), flux_net({ncol, nlev, nbnd});
+
+        while (state.keep_running())
+            rrtmgp_kernels::net_byband_precalc(&ncol, &nlev, &nbnd, flux_dn.ptr(), flux_up.ptr(), flux_net.ptr());
+
+        state.set_bytes_per_iteration(get_bytes(flux_dn, flux_up, flux_net));
+        state.set_flops_per_iteration(double(ncol)*nlev*nbnd);
+    }
+
+    template<typename TF>
+    void bench_increment_1scalar_by_1scalar(Benchmark::State& state)
+    {
+        const int n_gpt = 256;
+        Solver_data<TF> d(state.get_n_col(), state.get_n_lay(), n_gpt);
+        Array<TF,3> tau_in(d.tau);
+
+        int ncol = state.get_n_col(), nlay = state.get_n_lay(), ngpt = n_gpt;
+
+        while (state.keep_running())
+            rrtmgp_kernels::increment_1scalar_by_1scalar(&ncol, &nlay, &ngpt, d.tau.ptr(), tau_in.ptr());
+
+        state.set_bytes_per_iteration(2.*get_bytes(d.tau) + get_bytes(tau_in));
+        state.set_flops_per_iteration(double(ncol)*nlay*ngpt);
+    }
+
+    template<typename TF>
+    void bench_increment_2stream_by_2stream(Benchmark::State& state)
+    {
+        const int n_gpt = 224;
+        Solver_data<TF> d(state.get_n_col(), state.get_n_lay(), n_gpt);
+        Array<TF,3> tau_in(d.tau), ssa_in(d.ssa), g_in(d.g);
+
+        int ncol = state.get_n_col(), nlay = state.get_n_lay(), ngpt = n_gpt;
+
+        while (state.keep_running())
+            rrtmgp_kernels::increment_2stream_by_2stream(
+                    &ncol, &nlay, &ngpt,
+                    d.tau.ptr(), d.ssa.ptr(), d.g.ptr(),
+                    tau_in.ptr(), ssa_in.ptr(), g_in.ptr());
+
+        state.set_bytes_per_iteration(2.*get_bytes(d.tau, d.ssa, d.g) + get_bytes(tau_in, ssa_in, g_in));
+        state.set_flops_per_iteration(double(ncol)*nlay*ngpt*9.);
+    }
+
+    template<typename TF>
+    void bench_inc_1scalar_by_1scalar_bybnd(Benchmark::State& state)
+    {
+        const int n_gpt = 256;
+        const int n_bnd = 16;
+        Kernel_data<TF> k(1, 1);
+        Solver_data<TF> d(state.get_n_col(), state.get_n_lay(), n_gpt);
+        Array<TF,3> tau_in({state.get_n_col(), state.get_n_lay(), n_bnd});
+        tau_in.fill(TF(0.1));
+
+        int ncol = state.get_n_col(), nlay = state.get_n_lay(), ngpt = n_gpt, nbnd = n_bnd;
+
+        while (state.keep_running())
+            rrtmgp_kernels::inc_1scalar_by_1scalar_bybnd(
+                    &ncol, &nlay, &ngpt, d.tau.ptr(), tau_in.ptr(), &nbnd, k.band_lims_gpt.ptr());
+
+        state.set_bytes_per_iteration(2.*get_bytes(d.tau) + get_bytes(tau_in));
+        state.set_flops_per_iteration(double(ncol)*nlay*ngpt);
+    }
+
+    template<typename TF>
+    void bench_inc_2stream_by_2stream_bybnd(Benchmark::State& state)
+    {
+        const int n_gpt = 256;
+        const int n_bnd = 16;
+        Kernel_data<TF> k(1, 1);
+        Solver_data<TF> d(state.get_n_col(), state.get_n_lay(), n_gpt);
+        Array<TF,3> tau_in({state.get_n_col(), state.get_n_lay(), n_bnd});
+        Array<TF,3> ssa_in({state.get_n_col(), state.get_n_lay(), n_bnd});
+        Array<TF,3> g_in  ({state.get_n_col(), state.get_n_lay(), n_bnd});
+        tau_in.fill(TF(0.1));
+        ssa_in.fill(TF(0.9));
+        g_in.fill(TF(0.8));
+
+        int ncol = state.get_n_col(), nlay = state.get_n_lay(), ngpt = n_gpt, nbnd = n_bnd;
+
+        while (state.keep_running())
+            rrtmgp_kernels::inc_2stream_by_2stream_bybnd(
+                    &ncol, &nlay, &ngpt,
+                    d.tau.ptr(), d.ssa.ptr(), d.g.ptr(),
+                    tau_in.ptr(), ssa_in.ptr(), g_in.ptr(),
+                    &nbnd, k.band_lims_gpt.ptr());
+
+        state.set_bytes_per_iteration(2.*get_bytes(d.tau, d.ssa, d.g) + get_bytes(tau_in, ssa_in, g_in));
+        state.set_flops_per_iteration(double(ncol)*nlay*ngpt*9.);
+    }
+
+    template<typename TF>
+    void bench_delta_scale_2str_k(Benchmark::State& state)
+    {
+        const int n_gpt = 224;
+        Solver_data<TF> d(state.get_n_col(), state.get_n_lay(), n_gpt);
+
+        int ncol = state.get_n_col(), nlay = state.get_n_lay(), ngpt = n_gpt;
+
+        while (state.keep_running())
+            rrtmgp_kernels::delta_scale_2str_k(&ncol, &nlay, &ngpt, d.tau.ptr(), d.ssa.ptr(), d.g.ptr());
+
+        state.set_bytes_per_iteration(2.*get_bytes(d.tau, d.ssa, d.g));
+        state.set_flops_per_iteration(double(ncol)*nlay*ngpt*7.);
+    }
+
+    template<typename TF>
+    void bench_zero_array_3D(Benchmark::State& state)
+    {
+        int ni = 256, nj = state.get_n_lay(), nk = state.get_n_col();
+        Array<TF,3> array({ni, nj, nk});
+
+        while (state.keep_running())
+            rrtmgp_kernels::zero_array_3D(&ni, &nj, &nk, array.ptr());
+
+        state.set_bytes_per_iteration(get_bytes(array));
+    }
+
+    // The 4D zeroing has the size of the 3D one, split over two leading dimensions.
+    template<typename TF>
+    void bench_zero_array_4D(Benchmark::State& state)
+    {
+        int ni = 2, nj = 128, nk = state.get_n_lay(), nl = state.get_n_col();
+        Array<TF,4> array({ni, nj, nk, nl});
+
+        while (state.keep_running())
+            rrtmgp_kernels::zero_array_4D(&ni, &nj, &nk, &nl, array.ptr());
+
+        state.set_bytes_per_iteration(get_bytes(array));
+    }
+
+    template<typename TF>
+    Cloud_optics<TF> make_cloud_optics(const int n_bnd)
+    {
+        constexpr int n_size_liq = 20;
+        constexpr int n_size_ice = 18;
+        constexpr int n_rghice = 3;
+
+        std::mt19937 generator(1234);
+
+        Array<TF,2> band_lims_wvn({2, n_bnd});
+        for (int ibnd=1; ibnd<=n_bnd; ++ibnd)
+        {
+            band_lims_wvn({1, ibnd}) = TF(10.) + (ibnd-1)*TF(200.);
+            band_lims_wvn({2, ibnd}) = TF(10.) +  ibnd   *TF(200.);
+        }
+
+        Array<TF,2> lut_extliq({n_size_liq, n_bnd}), lut_ssaliq({n_size_liq, n_bnd}), lut_asyliq({n_size_liq, n_bnd});
+        Array<TF,3> lut_extice({n_size_ice, n_bnd, n_rghice}), lut_ssaice({n_size_ice, n_bnd, n_rghice}), lut_asyice({n_size_ice, n_bnd, n_rghice});
+
+        fill_random(lut_extliq, TF(0.01), TF(0.2), generator);
+        fill_random(lut_ssaliq, TF(0.5), TF(1.), generator);
+        fill_random(lut_asyliq, TF(0.7), TF(0.9), generator);
+        fill_random(lut_extice, TF(0.01), TF(0.2), generator);
+        fill_random(lut_ssaice, TF(0.5), TF(1.), generator);
+        fill_random(lut_asyice, TF(0.7), TF(0.9), generator);
+
+        return Cloud_optics<TF>(
+                band_lims_wvn,
+                TF(2.5), TF(21.5), TF(0.),
+                TF(10.), TF(180.), TF(0.),
+                lut_extliq, lut_ssaliq, lut_asyliq,
+                lut_extice, lut_ssaice, lut_asyice);
+    }
+
+    template<typename TF>
+    void bench_cloud_optics(Benchmark::State& state)
+    {
+        const int n_col = state.get_n_col();
+        const int n_lay = state.get_n_lay();
+        const int n_bnd = 14;
+
+        Cloud_optics<TF> cloud_optics = make_cloud_optics<TF>(n_bnd);
+        Optical_props_2str<TF> cloud_optical_props(n_col, n_lay, cloud_optics);
+
+        // Half of the cells are cloudy.
+        Array<TF,2> lwp({n_col, n_lay}), iwp({n_col, n_lay}), rel({n_col, n_lay}), rei({n_col, n_lay});
+        std::mt19937 generator(1234);
+        fill_random(lwp, TF(-0.1), TF(0.1), generator);
+        fill_random(iwp, TF(-0.1), TF(0.1), generator);
+        for (TF& value : lwp.v()) value = std::max(value, TF(0.));
+        for (TF& value : iwp.v()) value = std::max(value, TF(0.));
+        fill_random(rel, TF(2.5), TF(21.5), generator);
+        fill_random(rei, TF(10.), TF(180.), generator);
+
+        while (state.keep_running())
+            cloud_optics.cloud_optics(lwp, iwp, rel, rei, cloud_optical_props);
+
+        state.set_bytes_per_iteration(
+                get_bytes(lwp, iwp, rel, rei)
+                + get_bytes(cloud_optical_props.get_tau(), cloud_optical_props.get_ssa(), cloud_optical_props.get_g())*3.);
+        state.set_flops_per_iteration(double(n_col)*n_lay*n_bnd*2.*20.);
+    }
+
+    template<typename TF>
+    void bench_array_subset(Benchmark::State& state)
+    {
+        const int n_col = state.get_n_col();
+        const int n_lay = state.get_n_lay();
+        constexpr int n_col_block = 16;
+
+        Array<TF,2> array({n_col, n_lay});
+        std::mt19937 generator(1234);
+        fill_random(array, TF(0.), TF(1.), generator);
+
+        // Take the subsets in blocks, as the radiation solver does.
+        while (state.keep_running())
+            for (int col_s=1; col_s<=n_col; col_s+=n_col_block)
+            {
+                const int col_e = std::min(col_s + n_col_block - 1, n_col);
+                Array<TF,2> array_subset = array.subset({{ {col_s, col_e}, {1, n_lay} }});
+            }
+
+        state.set_bytes_per_iteration(2.*get_bytes(array));
+    }
+
+    template<typename TF>
+    Gas_concs<TF> make_gas_concs(const int n_col, const int n_lay)
+    {
+        Gas_concs<TF> gas_concs;
+
+        Array<TF,2> h2o({n_col, n_lay});
+        std::mt19937 generator(1234);
+        fill_random(h2o, TF(1.e-6), TF(2.e-2), generator);
+        gas_concs.set_vmr("h2o", h2o);
+
+        Array<TF,1> o3({n_lay});
+        for (int ilay=1; ilay<=n_lay; ++ilay)
+            o3({ilay}) = TF(1.e-7) * ilay;
+        gas_concs.set_vmr("o3", o3);
+
+        gas_concs.set_vmr("co2", TF(4.e-4));
+        gas_concs.set_vmr("ch4", TF(1.8e-6));
+        gas_concs.set_vmr("n2o", TF(3.2e-7));
+
+        return gas_concs;
+    }
+
+    template<typename TF>
+    void bench_gas_concs_subset(Benchmark::State& state)
+    {
+        const int n_col = state.get_n_col();
+        const int n_lay = state.get_n_lay();
+        constexpr int n_col_block = 16;
+
+        Gas_concs<TF> gas_concs = make_gas_concs<TF>(n_col, n_lay);
+        Array<TF,2> h2o_subset({n_col_block, n_lay});
+
+        // Create the views per block and copy the water vapor, as needed for col_dry.
+        while (state.keep_running())
+            for (int col_s=1; col_s+n_col_block-1<=n_col; col_s+=n_col_block)
+            {
+                Gas_concs<TF> gas_concs_subset(gas_concs, col_s, n_col_block);
+                gas_concs_subset.get_vmr("h2o", h2o_subset);
+            }
+
+        state.set_bytes_per_iteration(2.*get_bytes(gas_concs.get_vmr("h2o")));
+    }
+
+    template<typename TF>
+    void bench_gas_concs_reorder(Benchmark::State& state)
+    {
+        const int n_col = state.get_n_col();
+        const int n_lay = state.get_n_lay();
+
+        Gas_concs<TF> gas_concs = make_gas_concs<TF>(n_col, n_lay);
+
+        Array<int,1> col_order({n_col});
+        for (int icol=1; icol<=n_col; ++icol)
+            col_order({icol}) = n_col - icol + 1;
+
+        while (state.keep_running())
+            Gas_concs<TF> gas_concs_sorted(gas_concs, col_order);
+
+        state.set_bytes_per_iteration(2.*get_bytes(gas_concs.get_vmr("h2o")));
+    }
+
+    // The longwave solver with and without the surface temperature Jacobian, the difference
+    // is the cost of the Jacobian for users that do not request it.
+    template<typename TF>
+    void bench_rte_lw(Benchmark::State& state, const bool switch_jacobian)
+    {
+        const int n_col = state.get_n_col();
+        const int n_lay = state.get_n_lay();
+
+        Kernel_data<TF> k(1, 1);
+        Array<TF,2> band_lims_wvn({2, k.n_bnd});
+        for (int ibnd=1; ibnd<=k.n_bnd; ++ibnd)
+        {
+            band_lims_wvn({1, ibnd}) = TF(10.) + (ibnd-1)*TF(200.);
+            band_lims_wvn({2, ibnd}) = TF(10.) +  ibnd   *TF(200.);
+        }
+        Optical_props<TF> spectral_disc(band_lims_wvn, k.band_lims_gpt);
+
+        Solver_data<TF> d(n_col, n_lay, k.n_gpt);
+
+        std::unique_ptr<Optical_props_arry<TF>> optical_props =
+                std::make_unique<Optical_props_1scl<TF>>(n_col, n_lay, spectral_disc);
+        optical_props->get_tau() = d.tau;
+
+        Source_func_lw<TF> sources(n_col, n_lay, spectral_disc, switch_jacobian);
+        sources.get_lay_source() = d.lay_source;
+        sources.get_lev_source_inc() = d.lev_source_inc;
+        sources.get_lev_source_dec() = d.lev_source_dec;
+        sources.get_sfc_source() = d.sfc_source;
+        if (switch_jacobian)
+            sources.get_sfc_source_jac() = d.sfc_source_jac;
+
+        Array<TF,2> sfc_emis({k.n_bnd, n_col});
+        sfc_emis.fill(TF(0.98));
+
+        while (state.keep_running())
+        {
+            if (switch_jacobian)
+                Rte_lw<TF>::rte_lw(
+                        optical_props, false, sources, sfc_emis, Array<TF,2>(),
+                        d.flux_up, d.flux_dn, d.flux_up_jac, 1);
+            else
+                Rte_lw<TF>::rte_lw(
+                        optical_props, false, sources, sfc_emis, Array<TF,2>(),
+                        d.flux_up, d.flux_dn, 1);
+        }
+
+        state.set_bytes_per_iteration(
+                get_bytes(d.tau, d.lay_source, d.lev_source_inc, d.lev_source_dec, d.sfc_emis, d.sfc_source)
+                + get_bytes(d.flux_up, d.flux_dn, d.sfc_source_jac, d.flux_up_jac));
+        state.set_flops_per_iteration(double(n_col)*n_lay*k.n_gpt*30.);
+    }
+
+    template<typename TF>
+    void bench_source_func_lw(Benchmark::State& state, const bool switch_jacobian)
+    {
+        Kernel_data<TF> k(1, 1);
+        Array<TF,2> band_lims_wvn({2, k.n_bnd});
+        Optical_props<TF> spectral_disc(band_lims_wvn, k.band_lims_gpt);
+
+        while (state.keep_running())
+            Source_func_lw<TF> sources(state.get_n_col(), state.get_n_lay(), spectral_disc, switch_jacobian);
+
+        const double n_cells = double(state.get_n_col())*k.n_gpt;
+        state.set_bytes_per_iteration(
+                (3.*state.get_n_lay()*n_cells + (switch_jacobian ? 2. : 1.)*n_cells) * sizeof(TF));
+    }
+
+    template<typename TF>
+    void register_benchmarks(std::vector<Benchmark::Benchmark>& benchmarks)
+    {
+        const std::string p = std::is_same<TF, float>::value ? "<float>" : "<double>";
+
+        benchmarks.push_back({"interpolation" + p, bench_interpolation<TF>});
+        benchmarks.push_back({"compute_tau_absorption" + p, bench_compute_tau_absorption<TF>});
+        benchmarks.push_back({"compute_tau_rayleigh" + p, bench_compute_tau_rayleigh<TF>});
+        benchmarks.push_back({"compute_Planck_source" + p, bench_compute_Planck_source<TF>});
+        benchmarks.push_back({"reorder_123x321" + p, bench_reorder<TF>});
+        benchmarks.push_back({"combine_and_reorder_2str" + p, bench_combine_and_reorder_2str<TF>});
+        benchmarks.push_back({"zero_array_3D" + p, bench_zero_array_3D<TF>});
+        benchmarks.push_back({"zero_array_4D" + p, bench_zero_array_4D<TF>});
+        benchmarks.push_back({"apply_BC_gpt" + p, bench_apply_BC_gpt<TF>});
+        benchmarks.push_back({"lw_solver_noscat_GaussQuad" + p, [](Benchmark::State& state) { bench_lw_solver_noscat_GaussQuad<TF>(state, false); }});
+        benchmarks.push_back({"lw_solver_noscat_GaussQuad_jacobian" + p, [](Benchmark::State& state) { bench_lw_solver_noscat_GaussQuad<TF>(state, true); }});
+        benchmarks.push_back({"sw_solver_2stream" + p, bench_sw_solver_2stream<TF>});
+        benchmarks.push_back({"sum_broadband" + p, bench_sum_broadband<TF>});
+        benchmarks.push_back({"net_broadband" + p, bench_net_broadband<TF>});
+        benchmarks.push_back({"sum_byband" + p, bench_sum_byband<TF>});
+        benchmarks.push_back({"net_byband" + p, bench_net_byband<TF>});
+        benchmarks.push_back({"increment_1scalar_by_1scalar" + p, bench_increment_1scalar_by_1scalar<TF>});
+        benchmarks.push_back({"increment_2stream_by_2stream" + p, bench_increment_2stream_by_2stream<TF>});
+        benchmarks.push_back({"inc_1scalar_by_1scalar_bybnd" + p, bench_inc_1scalar_by_1scalar_bybnd<TF>});
+        benchmarks.push_back({"inc_2stream_by_2stream_bybnd" + p, bench_inc_2stream_by_2stream_bybnd<TF>});
+        benchmarks.push_back({"delta_scale_2str_k" + p, bench_delta_scale_2str_k<TF>});
+        benchmarks.push_back({"cloud_optics" + p, bench_cloud_optics<TF>});
+        benchmarks.push_back({"array_subset" + p, bench_array_subset<TF>});
+        benchmarks.push_back({"gas_concs_subset" + p, bench_gas_concs_subset<TF>});
+        benchmarks.push_back({"gas_concs_reorder" + p, bench_gas_concs_reorder<TF>});
+        benchmarks.push_back({"rte_lw" + p, [](Benchmark::State& state) { bench_rte_lw<TF>(state, false); }});
+        benchmarks.push_back({"rte_lw_jacobian" + p, [](Benchmark::State& state) { bench_rte_lw<TF>(state, true); }});
+        benchmarks.push_back({"source_func_lw" + p, [](Benchmark::State& state) { bench_source_func_lw<TF>(state, false); }});
+        benchmarks.push_back({"source_func_lw_jacobian" + p, [](Benchmark::State& state) { bench_source_func_lw<TF>(state, true); }});
+    }
+
+    std::vector<int> parse_int_list(const std::string& list)
+    {
+        std::vector<std::string> items;
+        boost::split(items, list, boost::is_any_of(","));
+
+        std::vector<int> values;
+        for (const std::string& item : items)
+            values.push_back(std::stoi(item));
+        return values;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    std::vector<int> n_cols = {16, 128, 1024};
+    std::vector<int> n_lays = {60};
+    double min_time = 0.5;
+    std::string filter;
+
+    // Parse the command line options of the form --ncol=16,128 --nlay=60 --min-time=0.5 --filter=rte_lw.
+    try
+    {
+        for (int i=1; i<argc; ++i)
+        {
+            const std::string argument(argv[i]);
+            const size_t pos = argument.find('=');
+            const std::string key = argument.substr(0, pos);
+            const std::string value = (pos == std::string::npos) ? "" : argument.substr(pos+1);
+
+            if (key == "--ncol")
+                n_cols = parse_int_list(value);
+            else if (key == "--nlay")
+                n_lays = parse_int_list(value);
+            else if (key == "--min-time")
+                min_time = std::stod(value);
+            else if (key == "--filter")
+                filter = value;
+            else
+            {
+                Status::print_message("Usage: bench_rte_rrtmgp [--ncol=16,128] [--nlay=60] [--min-time=0.5] [--filter=name]");
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        Status::print_message("EXCEPTION: " + std::string(e.what()));
+        return 1;
+    }
+
+    std::vector<Benchmark::Benchmark> benchmarks;
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+    register_benchmarks<float>(benchmarks);
+    register_benchmarks<double>(benchmarks);
+#elif defined(FLOAT_SINGLE_RRTMGP)
+    register_benchmarks<float>(benchmarks);
+#else
+    register_benchmarks<double>(benchmarks);
+#endif
+
+    Benchmark::print_header();
+
+    for (const Benchmark::Benchmark& benchmark : benchmarks)
+    {
+        if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+            continue;
+
+        for (const int n_lay : n_lays)
+            for (const int n_col : n_cols)
+                Benchmark::run(benchmark, n_col, n_lay, min_time);
+    }
+
+    return 0;
+}
@@ -0,0 +1,1394 @@
+/*
+ * This file is a stand-alone executable developed for the
+ * testing of the C++ interface to the RTE+RRTMGP radiation code.
+ *
+ * It is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Status.h"
+#include "Array.h"
+#include "Gas_concs.h"
+#include "Coefficient_file.h"
+#include "Gas_optics_rrtmgp.h"
+#include "Optical_props.h"
+#include "Source_functions.h"
+#include "Instrumentation.h"
+#include "Radiation_solver.h"
+#include "Synthetic_atmosphere.h"
+#include "rte_rrtmgp_c.h"
+
+
+#ifdef FLOAT_SINGLE_RRTMGP
+#define FLOAT_TYPE float
+#define C_ABI(name) name ## _f32
+#else
+#define FLOAT_TYPE double
+#define C_ABI(name) name ## _f64
+#endif
+
+
+// Checks of the solvers on a synthetic atmosphere, each check throws if it fails. The coefficient
+// files are read from the working directory, as in test_rte_rrtmgp.
+namespace
+{
+    using TF = FLOAT_TYPE;
+
+    void require(const bool condition, const std::string& message)
+    {
+        if (!condition)
+            throw std::runtime_error(message);
+    }
+
+    template<int N>
+    TF max_abs_diff(const Array<TF,N>& a, const Array<TF,N>& b)
+    {
+        require(a.get_dims() == b.get_dims(), "Arrays of different shape are compared");
+
+        TF diff = TF(0.);
+        for (int i=0; i<a.size(); ++i)
+            diff = std::max(diff, std::abs(a.ptr()[i] - b.ptr()[i]));
+        return diff;
+    }
+
+    template<int N>
+    void require_equal(const Array<TF,N>& a, const Array<TF,N>& b, const TF tolerance, const std::string& name)
+    {
+        const TF diff = max_abs_diff(a, b);
+
+        std::ostringstream ss;
+        ss << name << " differs by " << diff << ", the tolerance is " << tolerance;
+        require(diff <= tolerance, ss.str());
+    }
+
+    // Relative comparison, for quantities that span several orders of magnitude. Values below a
+    // thousandth of the maximum are compared relative to that fraction, to not amplify rounding.
+    template<int N>
+    void require_close(const Array<TF,N>& a, const Array<TF,N>& b, const TF tolerance, const std::string& name)
+    {
+        require(a.get_dims() == b.get_dims(), "Arrays of different shape are compared");
+
+        TF b_max = std::numeric_limits<TF>::min();
+        for (int i=0; i<b.size(); ++i)
+            b_max = std::max(b_max, std::abs(b.ptr()[i]));
+
+        TF diff = TF(0.);
+        for (int i=0; i<a.size(); ++i)
+        {
+            const TF scale = std::max(std::abs(b.ptr()[i]), TF(1.e-3) * b_max);
+            diff = std::max(diff, std::abs(a.ptr()[i] - b.ptr()[i]) / scale);
+        }
+
+        std::ostringstream ss;
+        ss << name << " differs by a fraction " << diff << ", the tolerance is " << tolerance;
+        require(diff <= tolerance, ss.str());
+    }
+
+    Array<TF,2> subset_cols(const Array<TF,2>& array, const int col_s, const int col_e)
+    {
+        return array.subset({{ {col_s, col_e}, {1, array.dim(2)} }});
+    }
+
+    // The columns in col_order of an array with its columns in dimension col_dim.
+    template<int N>
+    Array<TF,N> select_cols(const Array<TF,N>& array, const Array<int,1>& col_order, const int col_dim=1)
+    {
+        std::array<int,N> dims = array.get_dims();
+        const int n_col_in = dims[col_dim-1];
+        const int n_col = col_order.dim(1);
+        dims[col_dim-1] = n_col;
+
+        int n_inner = 1;
+        for (int i=0; i<col_dim-1; ++i)
+            n_inner *= dims[i];
+        const int n_outer = array.size() / (n_inner*n_col_in);
+
+        Array<TF,N> out(dims);
+        for (int io=0; io<n_outer; ++io)
+            for (int icol=1; icol<=n_col; ++icol)
+                for (int ii=0; ii<n_inner; ++ii)
+                    out.ptr()[ii + n_inner*((icol-1) + n_col*io)] =
+                            array.ptr()[ii + n_inner*((col_order({icol})-1) + n_col_in*io)];
+        return out;
+    }
+
+    // Copies of the columns col_s to col_e, or the columns in col_order, of an atmosphere,
+    // without the gases.
+    struct Columns
+    {
+        Columns(const Synthetic_atmosphere<TF>& atmos, const int col_s, const int col_e, const TF tsi_ref) :
+            n_col(col_e - col_s + 1),
+            n_lev(atmos.n_lev),
+            p_lay(subset_cols(atmos.p_lay, col_s, col_e)),
+            p_lev(subset_cols(atmos.p_lev, col_s, col_e)),
+            t_lay(subset_cols(atmos.t_lay, col_s, col_e)),
+            t_lev(subset_cols(atmos.t_lev, col_s, col_e)),
+            t_sfc(atmos.t_sfc.subset({{ {col_s, col_e} }})),
+            emis_sfc(atmos.emis_sfc.subset({{ {1, atmos.emis_sfc.dim(1)}, {col_s, col_e} }})),
+            sfc_alb_dir(atmos.sfc_alb_dir.subset({{ {1, atmos.sfc_alb_dir.dim(1)}, {col_s, col_e} }})),
+            sfc_alb_dif(atmos.sfc_alb_dif.subset({{ {1, atmos.sfc_alb_dif.dim(1)}, {col_s, col_e} }})),
+            mu0(atmos.mu0.subset({{ {col_s, col_e} }})),
+            tsi_scaling({n_col}),
+            lwp(subset_cols(atmos.lwp, col_s, col_e)),
+            iwp(subset_cols(atmos.iwp, col_s, col_e)),
+            rel(subset_cols(atmos.rel, col_s, col_e)),
+            rei(subset_cols(atmos.rei, col_s, col_e))
+        {
+            for (int icol=1; icol<=n_col; ++icol)
+                tsi_scaling({icol}) = atmos.tsi({icol + col_s - 1}) / tsi_ref;
+        }
+
+        Columns(const Synthetic_atmosphere<TF>& atmos, const Array<int,1>& col_order, const TF tsi_ref) :
+            n_col(col_order.dim(1)),
+            n_lev(atmos.n_lev),
+            p_lay(select_cols(atmos.p_lay, col_order)),
+            p_lev(select_cols(atmos.p_lev, col_order)),
+            t_lay(select_cols(atmos.t_lay, col_order)),
+            t_lev(select_cols(atmos.t_lev, col_order)),
+            t_sfc(select_cols(atmos.t_sfc, col_order)),
+            emis_sfc(select_cols(atmos.emis_sfc, col_order, 2)),
+            sfc_alb_dir(select_cols(atmos.sfc_alb_dir, col_order, 2)),
+            sfc_alb_dif(select_cols(atmos.sfc_alb_dif, col_order, 2)),
+            mu0(select_cols(atmos.mu0, col_order)),
+            tsi_scaling({n_col}),
+            lwp(select_cols(atmos.lwp, col_order)),
+            iwp(select_cols(atmos.iwp, col_order)),
+            rel(select_cols(atmos.rel, col_order)),
+            rei(select_cols(atmos.rei, col_order))
+        {
+            for (int icol=1; icol<=n_col; ++icol)
+                tsi_scaling({icol}) = atmos.tsi({col_order({icol})}) / tsi_ref;
+        }
+
+        const int n_col;
+        const int n_lev;
+        Array<TF,2> p_lay, p_lev, t_lay, t_lev;
+        Array<TF,1> t_sfc;
+        Array<TF,2> emis_sfc, sfc_alb_dir, sfc_alb_dif;
+        Array<TF,1> mu0, tsi_scaling;
+        Array<TF,2> lwp, iwp, rel, rei;
+    };
+
+    struct Fluxes
+    {
+        Fluxes(const int n_col, const int n_lev) :
+            flux_up({n_col, n_lev}), flux_dn({n_col, n_lev}),
+            flux_dn_dir({n_col, n_lev}), flux_net({n_col, n_lev})
+        {}
+
+        Array<TF,2> flux_up, flux_dn, flux_dn_dir, flux_net, flux_up_jac;
+    };
+
+    Fluxes solve_lw(
+            const Radiation_solver_longwave<TF>& rad_lw, const Gas_concs<TF>& gas_concs,
+            const Columns& c, const bool switch_cloud_optics, const bool switch_jacobian=false,
+            const int col_offset=0)
+    {
+        Fluxes fluxes(c.n_col, c.n_lev);
+
+        Array<TF,2> col_dry;
+        Array<TF,3> tau, lay_source, lev_source_inc, lev_source_dec;
+        Array<TF,2> sfc_source;
+        Array<TF,3> bnd_flux_up, bnd_flux_dn, bnd_flux_net;
+
+        Array<TF,2>& flux_up_jac = fluxes.flux_up_jac;
+        if (switch_jacobian)
+            flux_up_jac.set_dims({c.n_col, c.n_lev});
+
+        rad_lw.solve(
+                true, switch_cloud_optics, false, false, switch_jacobian,
+                gas_concs,
+                c.p_lay, c.p_lev, c.t_lay, c.t_lev,
+                col_dry,
+                c.t_sfc, c.emis_sfc,
+                c.lwp, c.iwp, c.rel, c.rei,
+                tau, lay_source, lev_source_inc, lev_source_dec, sfc_source,
+                fluxes.flux_up, fluxes.flux_dn, fluxes.flux_net,
+                bnd_flux_up, bnd_flux_dn, bnd_flux_net,
+                flux_up_jac,
+                col_offset);
+
+        return fluxes;
+    }
+
+    Fluxes solve_sw(
+            const Radiation_solver_shortwave<TF>& rad_sw, const Gas_concs<TF>& gas_concs,
+            const Columns& c, const bool switch_cloud_optics, const int col_offset=0)
+    {
+        Fluxes fluxes(c.n_col, c.n_lev);
+
+        Array<TF,2> col_dry;
+        Array<TF,3> tau, ssa, g;
+        Array<TF,2> toa_source;
+        Array<TF,3> bnd_flux_up, bnd_flux_dn, bnd_flux_dn_dir, bnd_flux_net;
+
+        rad_sw.solve(
+                true, switch_cloud_optics, false, false,
+                gas_concs,
+                c.p_lay, c.p_lev, c.t_lay, c.t_lev,
+                col_dry,
+                c.sfc_alb_dir, c.sfc_alb_dif,
+                c.tsi_scaling, c.mu0,
+                c.lwp, c.iwp, c.rel, c.rei,
+                tau, ssa, g,
+                toa_source,
+                fluxes.flux_up, fluxes.flux_dn, fluxes.flux_dn_dir, fluxes.flux_net,
+                bnd_flux_up, bnd_flux_dn, bnd_flux_dn_dir, bnd_flux_net,
+                col_offset);
+
+        return fluxes;
+    }
+
+    // A copy of an Array view owns its data, such that writing to the copy leaves the memory of
+    // the view untouched, while view(), set_view and moves alias the memory.
+    void check_array_view()
+    {
+        std::vector<TF> memory(6, TF(1.));
+        Array<TF,2> view(memory.data(), {2, 3});
+
+        Array<TF,2> copy = view;
+        copy({1, 1}) = TF(2.);
+        require(!copy.is_view() && copy.v().size() == 6, "The copy of a view does not own its data");
+        require(memory[0] == TF(1.), "Writing to the copy of a view changes its memory");
+
+        Array<TF,2> copy_assigned;
+        copy_assigned = view;
+        copy_assigned({2, 3}) = TF(3.);
+        require(memory[5] == TF(1.), "Writing to the assigned copy of a view changes its memory");
+
+        Array<TF,2> alias = view.view();
+        alias({2, 1}) = TF(4.);
+        Array<TF,2> moved = std::move(alias);
+        moved({1, 2}) = TF(5.);
+        require(memory[1] == TF(4.) && memory[2] == TF(5.), "view() or a moved view does not alias the memory");
+
+        Array<TF,2> set;
+        set.set_view(memory.data(), {3, 2});
+        set({3, 2}) = TF(6.);
+        require(set.is_view() && memory[5] == TF(6.), "set_view does not alias the memory");
+    }
+
+    // A view on columns in the middle of the gases has to give the same fluxes as a copy of
+    // these columns. In a dual-precision build, the solvers run in mixed precision, in which
+    // the gases of the view are converted to single precision.
+    void check_gas_concs_view()
+    {
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+        const bool switch_mixed_precision = true;
+#else
+        const bool switch_mixed_precision = false;
+#endif
+
+        Atmosphere_settings<TF> settings;
+        settings.n_col = 64;
+        const Synthetic_atmosphere<TF> atmos(settings);
+
+        const Radiation_solver_longwave<TF> rad_lw(
+                atmos.gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc", switch_mixed_precision);
+        const Radiation_solver_shortwave<TF> rad_sw(
+                atmos.gas_concs, "coefficients_sw.nc", "cloud_coefficients_sw.nc", switch_mixed_precision);
+
+        constexpr int col_s = 17;
+        constexpr int col_e = 48;
+        const Columns c(atmos, col_s, col_e, rad_sw.get_tsi());
+
+        const Gas_concs<TF> gas_concs_view(atmos.gas_concs, col_s, c.n_col);
+
+        Array<int,1> col_order({c.n_col});
+        std::iota(col_order.v().begin(), col_order.v().end(), col_s);
+        const Gas_concs<TF> gas_concs_copy(atmos.gas_concs, col_order);
+
+        // The vmr of a view is a copy of its columns.
+        for (const std::string& name : atmos.gas_concs.get_gas_names())
+            require_equal(gas_concs_view.get_vmr(name), gas_concs_copy.get_vmr(name), TF(0.), name + " of the view");
+
+        // Views beyond the columns of the gases or of the view they are made from are rejected.
+        auto is_rejected = [](const Gas_concs<TF>& gas_concs_ref, const int start, const int size)
+        {
+            try
+            {
+                const Gas_concs<TF> gas_concs_out(gas_concs_ref, start, size);
+            }
+            catch (const std::range_error&)
+            {
+                return true;
+            }
+            return false;
+        };
+        require(is_rejected(atmos.gas_concs, 0, 8) && is_rejected(atmos.gas_concs, atmos.n_col-6, 8)
+                && is_rejected(gas_concs_view, c.n_col, 2) && !is_rejected(gas_concs_view, c.n_col, 1),
+                "The range of a view is not checked");
+
+        // Without clouds, the columns are not reordered and the view is used as is.
+        for (const bool switch_cloud_optics : {false, true})
+        {
+            const Fluxes lw_view = solve_lw(rad_lw, gas_concs_view, c, switch_cloud_optics);
+            const Fluxes lw_copy = solve_lw(rad_lw, gas_concs_copy, c, switch_cloud_optics);
+            require_equal(lw_view.flux_up, lw_copy.flux_up, TF(0.), "lw_flux_up of the view");
+            require_equal(lw_view.flux_dn, lw_copy.flux_dn, TF(0.), "lw_flux_dn of the view");
+
+            const Fluxes sw_view = solve_sw(rad_sw, gas_concs_view, c, switch_cloud_optics);
+            const Fluxes sw_copy = solve_sw(rad_sw, gas_concs_copy, c, switch_cloud_optics);
+            require_equal(sw_view.flux_up, sw_copy.flux_up, TF(0.), "sw_flux_up of the view");
+            require_equal(sw_view.flux_dn, sw_copy.flux_dn, TF(0.), "sw_flux_dn of the view");
+        }
+    }
+
+    // The longwave solver without Jacobian uses its own kernel, which has to give the fluxes of the
+    // kernel that computes the Jacobian as well.
+    void check_lw_jacobian()
+    {
+        Atmosphere_settings<TF> settings;
+        const Synthetic_atmosphere<TF> atmos(settings);
+
+        const Radiation_solver_longwave<TF> rad_lw(
+                atmos.gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc");
+
+        const Columns c(atmos, 1, atmos.n_col, TF(1.));
+
+        const Fluxes lw = solve_lw(rad_lw, atmos.gas_concs, c, true, false);
+        const Fluxes lw_jac = solve_lw(rad_lw, atmos.gas_concs, c, true, true);
+
+        const TF tolerance = TF(1.e-3);
+        require_equal(lw.flux_up, lw_jac.flux_up, tolerance, "lw_flux_up without Jacobian");
+        require_equal(lw.flux_dn, lw_jac.flux_dn, tolerance, "lw_flux_dn without Jacobian");
+
+        // The upward flux increases with the surface temperature.
+        const TF jac_min = *std::min_element(lw_jac.flux_up_jac.ptr(), lw_jac.flux_up_jac.ptr() + lw_jac.flux_up_jac.size());
+        require(jac_min > TF(0.), "lw_flux_up_jac is not positive");
+    }
+
+    // The fluxes with single-precision gas optics have to be within the acceptance bound of the
+    // RFMIP validation (rfmip/README.md) of the fluxes in double precision, with and without
+    // clouds. Without a dual-precision build, the mixed-precision mode has to be rejected.
+    void check_mixed_precision()
+    {
+        Atmosphere_settings<TF> settings;
+        const Synthetic_atmosphere<TF> atmos(settings);
+
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+        const Radiation_solver_longwave<TF> rad_lw(
+                atmos.gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc");
+        const Radiation_solver_shortwave<TF> rad_sw(
+                atmos.gas_concs, "coefficients_sw.nc", "cloud_coefficients_sw.nc");
+        const Radiation_solver_longwave<TF> rad_lw_mixed(
+                atmos.gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc", true);
+        const Radiation_solver_shortwave<TF> rad_sw_mixed(
+                atmos.gas_concs, "coefficients_sw.nc", "cloud_coefficients_sw.nc", true);
+
+        const Columns c(atmos, 1, atmos.n_col, rad_sw.get_tsi());
+
+        // Acceptance bound in W m-2 on rlu, rld, rsu and rsd.
+        const TF bound = TF(0.1);
+
+        for (const bool switch_cloud_optics : {false, true})
+        {
+            const Fluxes lw = solve_lw(rad_lw, atmos.gas_concs, c, switch_cloud_optics);
+            const Fluxes lw_mixed = solve_lw(rad_lw_mixed, atmos.gas_concs, c, switch_cloud_optics);
+            require_equal(lw_mixed.flux_up, lw.flux_up, bound, "Mixed-precision lw_flux_up");
+            require_equal(lw_mixed.flux_dn, lw.flux_dn, bound, "Mixed-precision lw_flux_dn");
+
+            const Fluxes sw = solve_sw(rad_sw, atmos.gas_concs, c, switch_cloud_optics);
+            const Fluxes sw_mixed = solve_sw(rad_sw_mixed, atmos.gas_concs, c, switch_cloud_optics);
+            require_equal(sw_mixed.flux_up, sw.flux_up, bound, "Mixed-precision sw_flux_up");
+            require_equal(sw_mixed.flux_dn, sw.flux_dn, bound, "Mixed-precision sw_flux_dn");
+        }
+#else
+        bool is_rejected = false;
+        try
+        {
+            const Radiation_solver_longwave<TF> rad_lw_mixed(
+                    atmos.gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc", true);
+        }
+        catch (const std::runtime_error& e)
+        {
+            is_rejected = std::string(e.what()).find("FLOAT_TYPE=dual") != std::string::npos;
+        }
+        require(is_rejected, "Mixed precision is not rejected without a dual-precision build");
+#endif
+    }
+
+    // With the Full and Fused policies, out-of-range temperatures and gases are rejected,
+    // with Off the checks are skipped and the solver runs on the input as is.
+    void check_validation_policy()
+    {
+        Atmosphere_settings<TF> settings;
+        settings.n_col = 8;
+        const Synthetic_atmosphere<TF> atmos(settings);
+
+        Radiation_solver_longwave<TF> rad_lw(
+                atmos.gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc");
+
+        Columns c(atmos, 1, atmos.n_col, TF(1.));
+        c.t_lay({3, 2}) = TF(100.);
+
+        Array<TF,2> vmr_h2o({atmos.n_col, atmos.n_lay});
+        vmr_h2o.fill(TF(1.5));
+
+        for (const Validation_policy policy : {Validation_policy::Full, Validation_policy::Fused, Validation_policy::Off})
+        {
+            rad_lw.set_validation_policy(policy);
+
+            bool t_lay_rejected = false;
+            try
+            {
+                solve_lw(rad_lw, atmos.gas_concs, c, false);
+            }
+            catch (const std::range_error& e)
+            {
+                t_lay_rejected = true;
+            }
+
+            Gas_concs<TF> gas_concs;
+            gas_concs.set_validation_policy(policy);
+
+            bool vmr_rejected = false;
+            try
+            {
+                gas_concs.set_vmr("h2o", vmr_h2o);
+            }
+            catch (const std::range_error& e)
+            {
+                vmr_rejected = true;
+            }
+
+            const bool expect_rejected = policy != Validation_policy::Off;
+            require(t_lay_rejected == expect_rejected, "The out-of-range t_lay is not handled by the policy");
+            require(vmr_rejected == expect_rejected, "The out-of-range vmr is not handled by the policy");
+        }
+    }
+
+    // A disabled timer does not evaluate its bytes, and the counters of a thread that exits
+    // are moved to the exited threads (thread -1) without loss.
+    void check_instrumentation()
+    {
+#ifndef RTE_RRTMGP_NO_INSTRUMENTATION
+        using Instrumentation::Stage;
+
+        Instrumentation::reset();
+
+        bool bytes_evaluated = false;
+        auto bytes_function = [&]() { bytes_evaluated = true; return std::size_t(100); };
+
+        Instrumentation::set_enabled(false);
+        {
+            Instrumentation::Scoped_timer timer(Stage::Add_to, bytes_function);
+        }
+        require(!bytes_evaluated, "The bytes of a disabled timer are evaluated");
+
+        Instrumentation::set_enabled(true);
+        std::thread thread([&]()
+        {
+            Instrumentation::Scoped_timer timer(Stage::Add_to, bytes_function);
+        });
+        thread.join();
+        Instrumentation::set_enabled(false);
+
+        require(bytes_evaluated, "The bytes of an enabled timer are not evaluated");
+
+        const std::string json = Instrumentation::get_json();
+        require(json.find("\"name\": \"add_to\", \"calls\": 1, ") != std::string::npos,
+                "The call of the exited thread is not in the total");
+        require(json.find("{\"thread\": -1, \"calls\": 1, ") != std::string::npos,
+                "The counters of the exited thread are not folded");
+#endif
+    }
+
+    // The state-based gas optics port the interpolation kernel to C++, and have to give the optical
+    // properties and sources of the original path that calls the kernel, with col_dry computed
+    // from the water vapor and given as input.
+    void check_gas_optics_state()
+    {
+        Atmosphere_settings<TF> settings;
+        const Synthetic_atmosphere<TF> atmos(settings);
+        const Columns c(atmos, 1, atmos.n_col, TF(1.));
+
+        const int n_col = atmos.n_col;
+        const int n_lay = atmos.n_lay;
+
+        // The kernels may round differently from the C++ port, the tolerance allows for that only.
+        const TF tolerance = std::is_same<TF, float>::value ? TF(1.e-4) : TF(1.e-10);
+
+        const auto kdist_lw = load_gas_optics<TF>(Coefficient_file("coefficients_lw.nc"), atmos.gas_concs);
+        const auto kdist_sw = load_gas_optics<TF>(Coefficient_file("coefficients_sw.nc"), atmos.gas_concs);
+
+        // The given col_dry is that of a drier atmosphere, so that it differs from the computed one.
+        Array<TF,2> h2o({n_col, n_lay});
+        atmos.gas_concs.get_vmr("h2o", h2o);
+        for (int i=0; i<h2o.size(); ++i)
+            h2o.ptr()[i] *= TF(0.5);
+
+        Array<TF,2> col_dry_input({n_col, n_lay});
+        Gas_optics_rrtmgp<TF>::get_col_dry(col_dry_input, h2o, c.p_lev);
+
+        for (const bool switch_col_dry : {true, false})
+        {
+            const Array<TF,2> col_dry = switch_col_dry ? col_dry_input : Array<TF,2>();
+            const std::string label = switch_col_dry ? " with col_dry" : " without col_dry";
+
+            Gas_optics_state<TF> state;
+            kdist_lw->compute_state(c.p_lay, c.p_lev, c.t_lay, atmos.gas_concs, col_dry, state);
+
+            // Longwave.
+            std::unique_ptr<Optical_props_arry<TF>> optical_props_ref =
+                    std::make_unique<Optical_props_1scl<TF>>(n_col, n_lay, *kdist_lw);
+            std::unique_ptr<Optical_props_arry<TF>> optical_props =
+                    std::make_unique<Optical_props_1scl<TF>>(n_col, n_lay, *kdist_lw);
+            Source_func_lw<TF> sources_ref(n_col, n_lay, *kdist_lw);
+            Source_func_lw<TF> sources(n_col, n_lay, *kdist_lw);
+
+            kdist_lw->gas_optics(
+                    c.p_lay, c.p_lev, c.t_lay, c.t_sfc, atmos.gas_concs,
+                    optical_props_ref, sources_ref, col_dry, c.t_lev);
+            kdist_lw->gas_optics(
+                    c.p_lay, c.p_lev, c.t_lay, c.t_sfc, state,
+                    optical_props, sources, c.t_lev);
+
+            require_close(optical_props->get_tau(), optical_props_ref->get_tau(), tolerance, "lw_tau of the state" + label);
+            require_close(sources.get_lay_source(), sources_ref.get_lay_source(), tolerance, "lay_source of the state" + label);
+            require_close(sources.get_lev_source_inc(), sources_ref.get_lev_source_inc(), tolerance, "lev_source_inc of the state" + label);
+            require_close(sources.get_lev_source_dec(), sources_ref.get_lev_source_dec(), tolerance, "lev_source_dec of the state" + label);
+            require_close(sources.get_sfc_source(), sources_ref.get_sfc_source(), tolerance, "sfc_source of the state" + label);
+
+            // Shortwave, on the state of the longwave if the reference grids allow for it.
+            if (!kdist_sw->can_share_state(*kdist_lw))
+                kdist_sw->compute_state(c.p_lay, c.p_lev, c.t_lay, atmos.gas_concs, col_dry, state);
+
+            optical_props_ref = std::make_unique<Optical_props_2str<TF>>(n_col, n_lay, *kdist_sw);
+            optical_props = std::make_unique<Optical_props_2str<TF>>(n_col, n_lay, *kdist_sw);
+            Array<TF,2> toa_src_ref({n_col, kdist_sw->get_ngpt()});
+            Array<TF,2> toa_src({n_col, kdist_sw->get_ngpt()});
+
+            kdist_sw->gas_optics(
+                    c.p_lay, c.p_lev, c.t_lay, atmos.gas_concs,
+                    optical_props_ref, toa_src_ref, col_dry);
+            kdist_sw->gas_optics(
+                    c.p_lay, c.p_lev, c.t_lay, state,
+                    optical_props, toa_src);
+
+            require_close(optical_props->get_tau(), optical_props_ref->get_tau(), tolerance, "sw_tau of the state" + label);
+            require_close(optical_props->get_ssa(), optical_props_ref->get_ssa(), tolerance, "sw_ssa of the state" + label);
+            require_close(optical_props->get_g(), optical_props_ref->get_g(), tolerance, "sw_g of the state" + label);
+            require_close(toa_src, toa_src_ref, tolerance, "toa_src of the state" + label);
+        }
+    }
+
+    // The gas optics of sampled g-points have to give the optical properties and sources of the
+    // full spectrum at these g-points. Every column samples all g-points in its own order.
+    void check_gpt_sampling_gas_optics()
+    {
+        Atmosphere_settings<TF> settings;
+        const Synthetic_atmosphere<TF> atmos(settings);
+        const Columns c(atmos, 1, atmos.n_col, TF(1.));
+
+        const int n_col = atmos.n_col;
+        const int n_lay = atmos.n_lay;
+
+        const TF tolerance = std::is_same<TF, float>::value ? TF(1.e-4) : TF(1.e-10);
+
+        const auto kdist_lw = load_gas_optics<TF>(Coefficient_file("coefficients_lw.nc"), atmos.gas_concs);
+        const auto kdist_sw = load_gas_optics<TF>(Coefficient_file("coefficients_sw.nc"), atmos.gas_concs);
+
+        auto make_gpts = [&](const int n_gpt)
+        {
+            Array<int,2> gpts({n_gpt, n_col});
+            for (int icol=1; icol<=n_col; ++icol)
+                for (int isample=1; isample<=n_gpt; ++isample)
+                    gpts({isample, icol}) = 1 + (isample-1 + 7*icol) % n_gpt;
+            return gpts;
+        };
+
+        // Each sample gets its own band, as in the Monte Carlo mode of the solver.
+        auto make_sample_props = [](const int n_sample)
+        {
+            Array<TF,2> band_lims_wvn({2, n_sample});
+            for (int isample=1; isample<=n_sample; ++isample)
+            {
+                band_lims_wvn({1, isample}) = TF(isample);
+                band_lims_wvn({2, isample}) = TF(isample+1);
+            }
+            return Optical_props<TF>(band_lims_wvn);
+        };
+
+        auto gather = [&](const Array<TF,3>& full, const Array<int,2>& gpts)
+        {
+            Array<TF,3> sampled({full.dim(1), full.dim(2), gpts.dim(1)});
+            for (int isample=1; isample<=gpts.dim(1); ++isample)
+                for (int j=1; j<=full.dim(2); ++j)
+                    for (int icol=1; icol<=full.dim(1); ++icol)
+                        sampled({icol, j, isample}) = full({icol, j, gpts({isample, icol})});
+            return sampled;
+        };
+
+        auto gather_sfc = [&](const Array<TF,2>& full, const Array<int,2>& gpts)
+        {
+            Array<TF,2> sampled({full.dim(1), gpts.dim(1)});
+            for (int isample=1; isample<=gpts.dim(1); ++isample)
+                for (int icol=1; icol<=full.dim(1); ++icol)
+                    sampled({icol, isample}) = full({icol, gpts({isample, icol})});
+            return sampled;
+        };
+
+        Gas_optics_state<TF> state;
+        kdist_lw->compute_state(c.p_lay, c.p_lev, c.t_lay, atmos.gas_concs, Array<TF,2>(), state);
+
+        // Longwave, with the surface source Jacobian.
+        {
+            const int n_gpt = kdist_lw->get_ngpt();
+            const Array<int,2> gpts = make_gpts(n_gpt);
+            const Optical_props<TF> sample_props = make_sample_props(n_gpt);
+
+            std::unique_ptr<Optical_props_arry<TF>> optical_props_ref =
+                    std::make_unique<Optical_props_1scl<TF>>(n_col, n_lay, *kdist_lw);
+            std::unique_ptr<Optical_props_arry<TF>> optical_props =
+                    std::make_unique<Optical_props_1scl<TF>>(n_col, n_lay, sample_props);
+            Source_func_lw<TF> sources_ref(n_col, n_lay, *kdist_lw, true);
+            Source_func_lw<TF> sources(n_col, n_lay, sample_props, true);
+
+            kdist_lw->gas_optics(
+                    c.p_lay, c.p_lev, c.t_lay, c.t_sfc, state,
+                    optical_props_ref, sources_ref, c.t_lev);
+            kdist_lw->gas_optics(
+                    c.p_lay, c.p_lev, c.t_lay, c.t_sfc, state, gpts,
+                    optical_props, sources, c.t_lev);
+
+            require_close(optical_props->get_tau(), gather(optical_props_ref->get_tau(), gpts), tolerance, "sampled lw_tau");
+            require_close(sources.get_lay_source(), gather(sources_ref.get_lay_source(), gpts), tolerance, "sampled lay_source");
+            require_close(sources.get_lev_source_inc(), gather(sources_ref.get_lev_source_inc(), gpts), tolerance, "sampled lev_source_inc");
+            require_close(sources.get_lev_source_dec(), gather(sources_ref.get_lev_source_dec(), gpts), tolerance, "sampled lev_source_dec");
+            require_close(sources.get_sfc_source(), gather_sfc(sources_ref.get_sfc_source(), gpts), tolerance, "sampled sfc_source");
+            require_close(sources.get_sfc_source_jac(), gather_sfc(sources_ref.get_sfc_source_jac(), gpts), tolerance, "sampled sfc_source_jac");
+        }
+
+        // Shortwave.
+        {
+            if (!kdist_sw->can_share_state(*kdist_lw))
+                kdist_sw->compute_state(c.p_lay, c.p_lev, c.t_lay, atmos.gas_concs, Array<TF,2>(), state);
+
+            const int n_gpt = kdist_sw->get_ngpt();
+            const Array<int,2> gpts = make_gpts(n_gpt);
+            const Optical_props<TF> sample_props = make_sample_props(n_gpt);
+
+            std::unique_ptr<Optical_props_arry<TF>> optical_props_ref =
+                    std::make_unique<Optical_props_2str<TF>>(n_col, n_lay, *kdist_sw);
+            std::unique_ptr<Optical_props_arry<TF>> optical_props =
+                    std::make_unique<Optical_props_2str<TF>>(n_col, n_lay, sample_props);
+            Array<TF,2> toa_src_ref({n_col, n_gpt});
+            Array<TF,2> toa_src({n_col, n_gpt});
+
+            kdist_sw->gas_optics(
+                    c.p_lay, c.p_lev, c.t_lay, state,
+                    optical_props_ref, toa_src_ref);
+            kdist_sw->gas_optics(
+                    c.p_lay, c.p_lev, c.t_lay, state, gpts,
+                    optical_props, toa_src);
+
+            require_close(optical_props->get_tau(), gather(optical_props_ref->get_tau(), gpts), tolerance, "sampled sw_tau");
+            require_close(optical_props->get_ssa(), gather(optical_props_ref->get_ssa(), gpts), tolerance, "sampled sw_ssa");
+            require_close(optical_props->get_g(), gather(optical_props_ref->get_g(), gpts), tolerance, "sampled sw_g");
+            require_close(toa_src, gather_sfc(toa_src_ref, gpts), tolerance, "sampled toa_src");
+        }
+    }
+
+    // The Monte Carlo fluxes are an unbiased estimate of the full-spectrum fluxes: their mean
+    // over many seeds has to be within five standard errors of the full-spectrum flux.
+    void check_gpt_sampling_unbiased()
+    {
+        Atmosphere_settings<TF> settings;
+        settings.n_col = 8;
+        const Synthetic_atmosphere<TF> atmos(settings);
+
+        Radiation_solver_combined<TF> rad(
+                atmos.gas_concs,
+                "coefficients_lw.nc", "cloud_coefficients_lw.nc",
+                "coefficients_sw.nc", "cloud_coefficients_sw.nc");
+
+        const Columns c(atmos, 1, atmos.n_col, rad.get_tsi());
+        const int n_col = c.n_col;
+        const int n_lev = c.n_lev;
+
+        auto solve = [&]()
+        {
+            std::vector<Array<TF,2>> fluxes(7, Array<TF,2>({n_col, n_lev}));
+            rad.solve(
+                    true, atmos.gas_concs,
+                    c.p_lay, c.p_lev, c.t_lay, c.t_lev, Array<TF,2>(),
+                    c.t_sfc, c.emis_sfc,
+                    c.sfc_alb_dir, c.sfc_alb_dif,
+                    c.tsi_scaling, c.mu0,
+                    c.lwp, c.iwp, c.rel, c.rei,
+                    fluxes[0], fluxes[1], fluxes[2],
+                    fluxes[3], fluxes[4], fluxes[5], fluxes[6]);
+            return fluxes;
+        };
+
+        const std::vector<Array<TF,2>> fluxes_ref = solve();
+        const std::vector<std::string> names = {
+                "lw_flux_up", "lw_flux_dn", "lw_flux_net",
+                "sw_flux_up", "sw_flux_dn", "sw_flux_dn_dir", "sw_flux_net" };
+
+        constexpr int n_seeds = 256;
+        std::vector<Array<double,2>> sum(7, Array<double,2>({n_col, n_lev}));
+        std::vector<Array<double,2>> sum_sq(7, Array<double,2>({n_col, n_lev}));
+
+        for (int seed=1; seed<=n_seeds; ++seed)
+        {
+            rad.set_gpt_sampling(rad.get_n_gpt_lw()/8, rad.get_n_gpt_sw()/8, seed);
+            const std::vector<Array<TF,2>> fluxes = solve();
+
+            for (int i=0; i<7; ++i)
+                for (int j=0; j<fluxes[i].size(); ++j)
+                {
+                    sum[i].ptr()[j] += fluxes[i].ptr()[j];
+                    sum_sq[i].ptr()[j] += double(fluxes[i].ptr()[j]) * fluxes[i].ptr()[j];
+                }
+        }
+
+        for (int i=0; i<7; ++i)
+        {
+            double flux_max = 0.;
+            for (int j=0; j<fluxes_ref[i].size(); ++j)
+                flux_max = std::max(flux_max, std::abs(double(fluxes_ref[i].ptr()[j])));
+
+            for (int j=0; j<fluxes_ref[i].size(); ++j)
+            {
+                const double mean = sum[i].ptr()[j] / n_seeds;
+                const double variance = std::max(0., sum_sq[i].ptr()[j] / n_seeds - mean*mean);
+                const double standard_error = std::sqrt(variance / (n_seeds-1));
+
+                // The rounding of the sums allows for a small difference if all samples are equal.
+                const double diff = std::abs(mean - fluxes_ref[i].ptr()[j]);
+                if (diff > 5.*standard_error + 1.e-4*flux_max)
+                {
+                    std::ostringstream ss;
+                    ss << "Sampled " << names[i] << " is biased by " << diff
+                       << ", the standard error is " << standard_error;
+                    throw std::runtime_error(ss.str());
+                }
+            }
+        }
+    }
+
+    // Compare the fluxes of the columns col_s to col_e.
+    void require_equal_columns(
+            const Fluxes& a, const Fluxes& b, const int col_s, const int col_e,
+            const TF tolerance, const std::string& name)
+    {
+        const std::string range = " of columns " + std::to_string(col_s) + " to " + std::to_string(col_e);
+        require_close(subset_cols(a.flux_up, col_s, col_e), subset_cols(b.flux_up, col_s, col_e), tolerance, name + "_flux_up" + range);
+        require_close(subset_cols(a.flux_dn, col_s, col_e), subset_cols(b.flux_dn, col_s, col_e), tolerance, name + "_flux_dn" + range);
+        require_close(subset_cols(a.flux_dn_dir, col_s, col_e), subset_cols(b.flux_dn_dir, col_s, col_e), tolerance, name + "_flux_dn_dir" + range);
+        require_close(subset_cols(a.flux_net, col_s, col_e), subset_cols(b.flux_net, col_s, col_e), tolerance, name + "_flux_net" + range);
+    }
+
+    // The incremental mode solves only the columns of which an input changed beyond its threshold.
+    // The other columns keep the fluxes of the first solve bitwise, the solved columns get the
+    // fluxes of a full solve. Chunks with the same number of columns at different offsets keep
+    // their own state.
+    void check_incremental()
+    {
+        Atmosphere_settings<TF> settings;
+        settings.n_col = 64;
+        const Synthetic_atmosphere<TF> atmos(settings);
+
+        Radiation_solver_longwave<TF> rad_lw(
+                atmos.gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc");
+        Radiation_solver_shortwave<TF> rad_sw(
+                atmos.gas_concs, "coefficients_sw.nc", "cloud_coefficients_sw.nc");
+        const Radiation_solver_longwave<TF> rad_lw_full(
+                atmos.gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc");
+        const Radiation_solver_shortwave<TF> rad_sw_full(
+                atmos.gas_concs, "coefficients_sw.nc", "cloud_coefficients_sw.nc");
+
+        Resolve_thresholds<TF> thresholds;
+        thresholds.temperature = TF(1.);
+        rad_lw.set_incremental(true, thresholds);
+        rad_sw.set_incremental(true, thresholds);
+
+        const TF tsi = rad_sw.get_tsi();
+        const Columns c(atmos, 1, atmos.n_col, tsi);
+
+        const Fluxes lw_first = solve_lw(rad_lw, atmos.gas_concs, c, true);
+        const Fluxes sw_first = solve_sw(rad_sw, atmos.gas_concs, c, true);
+        require(rad_lw.get_recompute_fraction() == 1. && rad_sw.get_recompute_fraction() == 1.,
+                "The first incremental call does not solve all columns");
+
+        // The temperature of columns 1 to 16 changes below the threshold, of columns 17 to 24
+        // and 41 to 48 beyond it.
+        Columns c_new = c;
+        for (int icol=1; icol<=16; ++icol)
+            c_new.t_lay({icol, 1}) += TF(0.5);
+        for (const int col_s : {17, 41})
+            for (int icol=col_s; icol<col_s+8; ++icol)
+                c_new.t_lay({icol, 1}) += TF(2.);
+
+        const Fluxes lw_new = solve_lw(rad_lw, atmos.gas_concs, c_new, true);
+        const Fluxes sw_new = solve_sw(rad_sw, atmos.gas_concs, c_new, true);
+        require(rad_lw.get_recompute_fraction() == 0.25 && rad_sw.get_recompute_fraction() == 0.25,
+                "The recompute fraction differs from the fraction of changed columns");
+
+        const Fluxes lw_full = solve_lw(rad_lw_full, atmos.gas_concs, c_new, true);
+        const Fluxes sw_full = solve_sw(rad_sw_full, atmos.gas_concs, c_new, true);
+
+        // The solved columns are regrouped in other blocks than in the full solve.
+        const TF tolerance = std::is_same<TF, float>::value ? TF(1.e-5) : TF(1.e-12);
+        for (const std::pair<int, int>& cols : { std::make_pair(1, 16), std::make_pair(25, 40), std::make_pair(49, 64) })
+        {
+            require_equal_columns(lw_new, lw_first, cols.first, cols.second, TF(0.), "Unchanged lw");
+            require_equal_columns(sw_new, sw_first, cols.first, cols.second, TF(0.), "Unchanged sw");
+        }
+        for (const std::pair<int, int>& cols : { std::make_pair(17, 24), std::make_pair(41, 48) })
+        {
+            require_equal_columns(lw_new, lw_full, cols.first, cols.second, tolerance, "Changed lw");
+            require_equal_columns(sw_new, sw_full, cols.first, cols.second, tolerance, "Changed sw");
+        }
+
+        // After a reset, the chunk at offset 32 is solved in full and the unchanged chunk at offset 0
+        // is compared with its own last call, not with the chunk that was solved last.
+        rad_lw.reset_incremental();
+        rad_sw.reset_incremental();
+
+        constexpr int n_col_chunk = 32;
+        for (const int col_offset : {0, n_col_chunk, 0})
+        {
+            const Columns c_chunk(atmos, col_offset+1, col_offset+n_col_chunk, tsi);
+            const Gas_concs<TF> gas_concs_chunk(atmos.gas_concs, col_offset+1, n_col_chunk);
+            solve_lw(rad_lw, gas_concs_chunk, c_chunk, true, false, col_offset);
+            solve_sw(rad_sw, gas_concs_chunk, c_chunk, true, col_offset);
+        }
+        require(rad_lw.get_recompute_fraction() == 0. && rad_sw.get_recompute_fraction() == 0.,
+                "The incremental state of a chunk is mixed with another chunk");
+    }
+
+    bool is_cloudy(const Synthetic_atmosphere<TF>& atmos, const int icol)
+    {
+        for (int ilay=1; ilay<=atmos.n_lay; ++ilay)
+            if (atmos.lwp({icol, ilay}) > TF(0.) || atmos.iwp({icol, ilay}) > TF(0.))
+                return true;
+        return false;
+    }
+
+    // The solvers regroup the clear and cloudy columns into separate blocks, and have to return
+    // the outputs in the order of the input. Interleaved clear and cloudy columns that cross a
+    // block boundary are compared with the same columns given with the clear columns first, which
+    // the solvers do not reorder. Both are solved in the same blocks, so they match bitwise.
+    void check_regroup_order()
+    {
+        Atmosphere_settings<TF> settings;
+        const Synthetic_atmosphere<TF> atmos(settings);
+
+        constexpr int n_col_half = 16;
+        std::vector<int> cols_clear, cols_cloudy;
+        for (int icol=1; icol<=atmos.n_col; ++icol)
+            (is_cloudy(atmos, icol) ? cols_cloudy : cols_clear).push_back(icol);
+        require(int(cols_clear.size()) >= n_col_half && int(cols_cloudy.size()) >= n_col_half,
+                "The atmosphere has too few clear or cloudy columns");
+
+        // The interleaved columns start with a cloudy column, the sorted columns have the clear
+        // columns first. Column icol of the interleaved columns is column sorted_pos(icol) of the sorted.
+        constexpr int n_col = 2*n_col_half;
+        Array<int,1> col_order({n_col});
+        Array<int,1> col_order_sorted({n_col});
+        Array<int,1> sorted_pos({n_col});
+        for (int i=1; i<=n_col_half; ++i)
+        {
+            col_order({2*i-1}) = cols_cloudy[i-1];
+            col_order({2*i}) = cols_clear[i-1];
+            col_order_sorted({i}) = cols_clear[i-1];
+            col_order_sorted({n_col_half+i}) = cols_cloudy[i-1];
+            sorted_pos({2*i-1}) = n_col_half+i;
+            sorted_pos({2*i}) = i;
+        }
+
+        Radiation_solver_longwave<TF> rad_lw(
+                atmos.gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc");
+        Radiation_solver_shortwave<TF> rad_sw(
+                atmos.gas_concs, "coefficients_sw.nc", "cloud_coefficients_sw.nc");
+
+        const Columns c(atmos, col_order, rad_sw.get_tsi());
+        const Columns c_sorted(atmos, col_order_sorted, rad_sw.get_tsi());
+        const Gas_concs<TF> gas_concs(atmos.gas_concs, col_order);
+        const Gas_concs<TF> gas_concs_sorted(atmos.gas_concs, col_order_sorted);
+
+        // A block of 12 columns splits the clear and cloudy columns over several blocks.
+        for (const int n_col_block : {12, n_col})
+        {
+            rad_lw.set_n_col_block(n_col_block);
+            rad_sw.set_n_col_block(n_col_block);
+
+            const Fluxes lw = solve_lw(rad_lw, gas_concs, c, true);
+            const Fluxes lw_sorted = solve_lw(rad_lw, gas_concs_sorted, c_sorted, true);
+            require_equal(lw.flux_up, select_cols(lw_sorted.flux_up, sorted_pos), TF(0.), "Regrouped lw_flux_up");
+            require_equal(lw.flux_dn, select_cols(lw_sorted.flux_dn, sorted_pos), TF(0.), "Regrouped lw_flux_dn");
+            require_equal(lw.flux_net, select_cols(lw_sorted.flux_net, sorted_pos), TF(0.), "Regrouped lw_flux_net");
+
+            const Fluxes sw = solve_sw(rad_sw, gas_concs, c, true);
+            const Fluxes sw_sorted = solve_sw(rad_sw, gas_concs_sorted, c_sorted, true);
+            require_equal(sw.flux_up, select_cols(sw_sorted.flux_up, sorted_pos), TF(0.), "Regrouped sw_flux_up");
+            require_equal(sw.flux_dn, select_cols(sw_sorted.flux_dn, sorted_pos), TF(0.), "Regrouped sw_flux_dn");
+            require_equal(sw.flux_dn_dir, select_cols(sw_sorted.flux_dn_dir, sorted_pos), TF(0.), "Regrouped sw_flux_dn_dir");
+            require_equal(sw.flux_net, select_cols(sw_sorted.flux_net, sorted_pos), TF(0.), "Regrouped sw_flux_net");
+        }
+    }
+
+    // Copy the inputs of column icol_src to column icol.
+    void copy_column(Columns& c, const int icol_src, const int icol)
+    {
+        for (Array<TF,2>* a : {&c.p_lay, &c.p_lev, &c.t_lay, &c.t_lev, &c.lwp, &c.iwp, &c.rel, &c.rei})
+            for (int iz=1; iz<=a->dim(2); ++iz)
+                (*a)({icol, iz}) = (*a)({icol_src, iz});
+
+        for (Array<TF,2>* a : {&c.emis_sfc, &c.sfc_alb_dir, &c.sfc_alb_dif})
+            for (int ibnd=1; ibnd<=a->dim(1); ++ibnd)
+                (*a)({ibnd, icol}) = (*a)({ibnd, icol_src});
+
+        for (Array<TF,1>* a : {&c.t_sfc, &c.mu0, &c.tsi_scaling})
+            (*a)({icol}) = (*a)({icol_src});
+    }
+
+    // All outputs of the longwave solver.
+    struct Lw_outputs
+    {
+        Lw_outputs(const int n_col, const int n_lay, const int n_gpt, const int n_bnd) :
+            tau({n_col, n_lay, n_gpt}), lay_source({n_col, n_lay, n_gpt}),
+            lev_source_inc({n_col, n_lay, n_gpt}), lev_source_dec({n_col, n_lay, n_gpt}),
+            sfc_source({n_col, n_gpt}),
+            flux_up({n_col, n_lay+1}), flux_dn({n_col, n_lay+1}), flux_net({n_col, n_lay+1}),
+            bnd_flux_up({n_col, n_lay+1, n_bnd}), bnd_flux_dn({n_col, n_lay+1, n_bnd}),
+            bnd_flux_net({n_col, n_lay+1, n_bnd}),
+            flux_up_jac({n_col, n_lay+1})
+        {}
+
+        Array<TF,3> tau, lay_source, lev_source_inc, lev_source_dec;
+        Array<TF,2> sfc_source;
+        Array<TF,2> flux_up, flux_dn, flux_net;
+        Array<TF,3> bnd_flux_up, bnd_flux_dn, bnd_flux_net;
+        Array<TF,2> flux_up_jac;
+    };
+
+    // All outputs of the shortwave solver.
+    struct Sw_outputs
+    {
+        Sw_outputs(const int n_col, const int n_lay, const int n_gpt, const int n_bnd) :
+            tau({n_col, n_lay, n_gpt}), ssa({n_col, n_lay, n_gpt}), g({n_col, n_lay, n_gpt}),
+            toa_source({n_col, n_gpt}),
+            flux_up({n_col, n_lay+1}), flux_dn({n_col, n_lay+1}),
+            flux_dn_dir({n_col, n_lay+1}), flux_net({n_col, n_lay+1}),
+            bnd_flux_up({n_col, n_lay+1, n_bnd}), bnd_flux_dn({n_col, n_lay+1, n_bnd}),
+            bnd_flux_dn_dir({n_col, n_lay+1, n_bnd}), bnd_flux_net({n_col, n_lay+1, n_bnd})
+        {}
+
+        Array<TF,3> tau, ssa, g;
+        Array<TF,2> toa_source;
+        Array<TF,2> flux_up, flux_dn, flux_dn_dir, flux_net;
+        Array<TF,3> bnd_flux_up, bnd_flux_dn, bnd_flux_dn_dir, bnd_flux_net;
+    };
+
+    // The combined solver computes the gas optics state once for the longwave and shortwave, and
+    // has to give the fluxes of the separate solvers, with and without clouds and threads. The
+    // number of columns is not a multiple of the block size.
+    void check_combined()
+    {
+        Atmosphere_settings<TF> settings;
+        settings.n_col = 100;
+        const Synthetic_atmosphere<TF> atmos(settings);
+
+        Radiation_solver_combined<TF> rad(
+                atmos.gas_concs,
+                "coefficients_lw.nc", "cloud_coefficients_lw.nc",
+                "coefficients_sw.nc", "cloud_coefficients_sw.nc");
+        const Radiation_solver_longwave<TF> rad_lw(
+                atmos.gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc");
+        const Radiation_solver_shortwave<TF> rad_sw(
+                atmos.gas_concs, "coefficients_sw.nc", "cloud_coefficients_sw.nc");
+
+        const Columns c(atmos, 1, atmos.n_col, rad.get_tsi());
+
+        // The separate solvers regroup the clear and cloudy columns, which changes the rounding.
+        const TF tolerance = std::is_same<TF, float>::value ? TF(1.e-4) : TF(1.e-10);
+
+        for (const int n_threads : {1, 4})
+        {
+            rad.set_n_threads(n_threads);
+
+            for (const bool switch_cloud_optics : {false, true})
+            {
+                const Fluxes lw = solve_lw(rad_lw, atmos.gas_concs, c, switch_cloud_optics);
+                const Fluxes sw = solve_sw(rad_sw, atmos.gas_concs, c, switch_cloud_optics);
+
+                Fluxes lw_combined(c.n_col, c.n_lev);
+                Fluxes sw_combined(c.n_col, c.n_lev);
+                rad.solve(
+                        switch_cloud_optics, atmos.gas_concs,
+                        c.p_lay, c.p_lev, c.t_lay, c.t_lev, Array<TF,2>(),
+                        c.t_sfc, c.emis_sfc,
+                        c.sfc_alb_dir, c.sfc_alb_dif,
+                        c.tsi_scaling, c.mu0,
+                        c.lwp, c.iwp, c.rel, c.rei,
+                        lw_combined.flux_up, lw_combined.flux_dn, lw_combined.flux_net,
+                        sw_combined.flux_up, sw_combined.flux_dn,
+                        sw_combined.flux_dn_dir, sw_combined.flux_net);
+
+                const std::string suffix = " of the combined solver with " + std::to_string(n_threads) + " threads"
+                        + (switch_cloud_optics ? " and clouds" : "");
+                require_close(lw_combined.flux_up, lw.flux_up, tolerance, "lw_flux_up" + suffix);
+                require_close(lw_combined.flux_dn, lw.flux_dn, tolerance, "lw_flux_dn" + suffix);
+                require_close(lw_combined.flux_net, lw.flux_net, tolerance, "lw_flux_net" + suffix);
+                require_close(sw_combined.flux_up, sw.flux_up, tolerance, "sw_flux_up" + suffix);
+                require_close(sw_combined.flux_dn, sw.flux_dn, tolerance, "sw_flux_dn" + suffix);
+                require_close(sw_combined.flux_dn_dir, sw.flux_dn_dir, tolerance, "sw_flux_dn_dir" + suffix);
+                require_close(sw_combined.flux_net, sw.flux_net, tolerance, "sw_flux_net" + suffix);
+            }
+        }
+    }
+
+    // Solving the repeated columns once has to give the optical properties and fluxes of solving
+    // all columns. The columns are a mix of clear and cloudy columns in a view on the gases that
+    // starts after the first column. With one column per block, the columns are solved alone in
+    // both cases and have to match bitwise, otherwise the blocks differ and rounding may differ.
+    void check_deduplicate_columns()
+    {
+        Atmosphere_settings<TF> settings;
+        settings.n_col = 64;
+        const Synthetic_atmosphere<TF> atmos(settings);
+
+        // Columns 33 to 56 of the gases repeat columns 9 to 32, the view starts at column 9.
+        Array<int,1> col_order({atmos.n_col});
+        for (int icol=1; icol<=atmos.n_col; ++icol)
+            col_order({icol}) = (icol > 32 && icol <= 56) ? icol-24 : icol;
+        const Gas_concs<TF> gas_concs_parent(atmos.gas_concs, col_order);
+
+        constexpr int col_offset = 8;
+        constexpr int n_col = 48;
+        const Gas_concs<TF> gas_concs(gas_concs_parent, col_offset+1, n_col);
+        require(gas_concs.get_col_offset() == col_offset, "The gases are not a view with a column offset");
+
+        Radiation_solver_longwave<TF> rad_lw(
+                atmos.gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc");
+        Radiation_solver_shortwave<TF> rad_sw(
+                atmos.gas_concs, "coefficients_sw.nc", "cloud_coefficients_sw.nc");
+
+        Columns c(atmos, col_offset+1, col_offset+n_col, rad_sw.get_tsi());
+        for (int icol=25; icol<=n_col; ++icol)
+            copy_column(c, icol-24, icol);
+
+        int n_col_cloudy = 0;
+        for (int icol=1; icol<=n_col; ++icol)
+            for (int ilay=1; ilay<=atmos.n_lay; ++ilay)
+                if (c.lwp({icol, ilay}) > TF(0.) || c.iwp({icol, ilay}) > TF(0.))
+                {
+                    ++n_col_cloudy;
+                    break;
+                }
+        require(n_col_cloudy > 0 && n_col_cloudy < n_col, "The columns are not a mix of clear and cloudy columns");
+
+        Array<TF,2> col_dry;
+
+        auto solve_lw_all = [&](const bool deduplicate_columns, const bool switch_cloud_optics)
+        {
+            Lw_outputs out(n_col, atmos.n_lay, rad_lw.get_n_gpt(), rad_lw.get_n_bnd());
+            rad_lw.set_deduplicate_columns(deduplicate_columns);
+            rad_lw.solve(
+                    true, switch_cloud_optics, true, true, true,
+                    gas_concs,
+                    c.p_lay, c.p_lev, c.t_lay, c.t_lev,
+                    col_dry,
+                    c.t_sfc, c.emis_sfc,
+                    c.lwp, c.iwp, c.rel, c.rei,
+                    out.tau, out.lay_source, out.lev_source_inc, out.lev_source_dec, out.sfc_source,
+                    out.flux_up, out.flux_dn, out.flux_net,
+                    out.bnd_flux_up, out.bnd_flux_dn, out.bnd_flux_net,
+                    out.flux_up_jac);
+            return out;
+        };
+
+        auto solve_sw_all = [&](const bool deduplicate_columns, const bool switch_cloud_optics)
+        {
+            Sw_outputs out(n_col, atmos.n_lay, rad_sw.get_n_gpt(), rad_sw.get_n_bnd());
+            rad_sw.set_deduplicate_columns(deduplicate_columns);
+            rad_sw.solve(
+                    true, switch_cloud_optics, true, true,
+                    gas_concs,
+                    c.p_lay, c.p_lev, c.t_lay, c.t_lev,
+                    col_dry,
+                    c.sfc_alb_dir, c.sfc_alb_dif,
+                    c.tsi_scaling, c.mu0,
+                    c.lwp, c.iwp, c.rel, c.rei,
+                    out.tau, out.ssa, out.g,
+                    out.toa_source,
+                    out.flux_up, out.flux_dn, out.flux_dn_dir, out.flux_net,
+                    out.bnd_flux_up, out.bnd_flux_dn, out.bnd_flux_dn_dir, out.bnd_flux_net);
+            return out;
+        };
+
+        const TF tolerance_block = std::is_same<TF, float>::value ? TF(1.e-5) : TF(1.e-12);
+
+        for (const int n_col_block : {1, 16})
+        {
+            rad_lw.set_n_col_block(n_col_block);
+            rad_sw.set_n_col_block(n_col_block);
+            const TF tolerance = (n_col_block == 1) ? TF(0.) : tolerance_block;
+
+            for (const bool switch_cloud_optics : {false, true})
+            {
+                const Lw_outputs lw = solve_lw_all(false, switch_cloud_optics);
+                const Lw_outputs lw_dedup = solve_lw_all(true, switch_cloud_optics);
+                require_close(lw_dedup.tau, lw.tau, tolerance, "Deduplicated lw tau");
+                require_close(lw_dedup.lay_source, lw.lay_source, tolerance, "Deduplicated lay_source");
+                require_close(lw_dedup.lev_source_inc, lw.lev_source_inc, tolerance, "Deduplicated lev_source_inc");
+                require_close(lw_dedup.lev_source_dec, lw.lev_source_dec, tolerance, "Deduplicated lev_source_dec");
+                require_close(lw_dedup.sfc_source, lw.sfc_source, tolerance, "Deduplicated sfc_source");
+                require_close(lw_dedup.flux_up, lw.flux_up, tolerance, "Deduplicated lw_flux_up");
+                require_close(lw_dedup.flux_dn, lw.flux_dn, tolerance, "Deduplicated lw_flux_dn");
+                require_close(lw_dedup.flux_net, lw.flux_net, tolerance, "Deduplicated lw_flux_net");
+                require_close(lw_dedup.bnd_flux_up, lw.bnd_flux_up, tolerance, "Deduplicated lw_bnd_flux_up");
+                require_close(lw_dedup.bnd_flux_dn, lw.bnd_flux_dn, tolerance, "Deduplicated lw_bnd_flux_dn");
+                require_close(lw_dedup.bnd_flux_net, lw.bnd_flux_net, tolerance, "Deduplicated lw_bnd_flux_net");
+                require_close(lw_dedup.flux_up_jac, lw.flux_up_jac, tolerance, "Deduplicated lw_flux_up_jac");
+
+                const Sw_outputs sw = solve_sw_all(false, switch_cloud_optics);
+                const Sw_outputs sw_dedup = solve_sw_all(true, switch_cloud_optics);
+                require_close(sw_dedup.tau, sw.tau, tolerance, "Deduplicated sw tau");
+                require_close(sw_dedup.ssa, sw.ssa, tolerance, "Deduplicated ssa");
+                require_close(sw_dedup.g, sw.g, tolerance, "Deduplicated g");
+                require_close(sw_dedup.toa_source, sw.toa_source, tolerance, "Deduplicated toa_source");
+                require_close(sw_dedup.flux_up, sw.flux_up, tolerance, "Deduplicated sw_flux_up");
+                require_close(sw_dedup.flux_dn, sw.flux_dn, tolerance, "Deduplicated sw_flux_dn");
+                require_close(sw_dedup.flux_dn_dir, sw.flux_dn_dir, tolerance, "Deduplicated sw_flux_dn_dir");
+                require_close(sw_dedup.flux_net, sw.flux_net, tolerance, "Deduplicated sw_flux_net");
+                require_close(sw_dedup.bnd_flux_up, sw.bnd_flux_up, tolerance, "Deduplicated sw_bnd_flux_up");
+                require_close(sw_dedup.bnd_flux_dn, sw.bnd_flux_dn, tolerance, "Deduplicated sw_bnd_flux_dn");
+                require_close(sw_dedup.bnd_flux_dn_dir, sw.bnd_flux_dn_dir, tolerance, "Deduplicated sw_bnd_flux_dn_dir");
+                require_close(sw_dedup.bnd_flux_net, sw.bnd_flux_net, tolerance, "Deduplicated sw_bnd_flux_net");
+            }
+        }
+    }
+
+    // The gases in the arguments of the C interface, with the shape of each gas as stored.
+    struct C_gases
+    {
+        explicit C_gases(const Gas_concs<TF>& gas_concs) :
+            names(gas_concs.get_gas_names())
+        {
+            for (const std::string& name : names)
+            {
+                const Array<TF,2>& vmr_gas = gas_concs.get_root_vmr(name);
+
+                name_ptrs.push_back(name.c_str());
+                vmr.push_back(vmr_gas.ptr());
+
+                if (vmr_gas.dim(1) > 1)
+                    shape.push_back(RTE_RRTMGP_GAS_FIELD);
+                else if (vmr_gas.dim(2) > 1)
+                    shape.push_back(RTE_RRTMGP_GAS_PROFILE);
+                else
+                    shape.push_back(RTE_RRTMGP_GAS_SCALAR);
+            }
+        }
+
+        const std::vector<std::string> names;
+        std::vector<const char*> name_ptrs;
+        std::vector<const TF*> vmr;
+        std::vector<int> shape;
+    };
+
+    using C_solver = std::unique_ptr<rte_rrtmgp_solver, decltype(&rte_rrtmgp_solver_destroy)>;
+
+    void require_success(const int status)
+    {
+        require(status == RTE_RRTMGP_SUCCESS, "C interface: " + std::string(rte_rrtmgp_get_last_error()));
+    }
+
+    std::vector<char> read_file(const std::string& file_name)
+    {
+        std::ifstream file(file_name, std::ios::binary);
+        require(file.good(), "Cannot open " + file_name);
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // The C interface solves the blocks of columns without regrouping, so it has to give the fluxes
+    // of Radiation_solver up to rounding with and without clouds, with field, profile and scalar
+    // gases. The longwave solver is created from a file, the shortwave from a buffer.
+    void check_c_abi()
+    {
+        Atmosphere_settings<TF> settings;
+        settings.n_col = 40;
+        const Synthetic_atmosphere<TF> atmos(settings);
+
+        // O3 is given as the profile of the first column, the well-mixed gases are scalars.
+        Gas_concs<TF> gas_concs;
+        for (const std::string& name : atmos.gas_concs.get_gas_names())
+        {
+            if (name == "o3")
+            {
+                Array<TF,1> o3_profile({atmos.n_lay});
+                for (int ilay=1; ilay<=atmos.n_lay; ++ilay)
+                    o3_profile({ilay}) = atmos.gas_concs.get_vmr(name)({1, ilay});
+                gas_concs.set_vmr(name, o3_profile);
+            }
+            else
+                gas_concs.set_vmr(name, atmos.gas_concs.get_vmr(name));
+        }
+        const C_gases gases(gas_concs);
+        const int n_gas = gases.names.size();
+
+        const Radiation_solver_longwave<TF> rad_lw(gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc");
+        const Radiation_solver_shortwave<TF> rad_sw(gas_concs, "coefficients_sw.nc", "cloud_coefficients_sw.nc");
+
+        const Columns c(atmos, 1, atmos.n_col, rad_sw.get_tsi());
+
+        rte_rrtmgp_solver* solver_ptr = nullptr;
+        require_success(C_ABI(rte_rrtmgp_solver_create)(
+                &solver_ptr, "coefficients_lw.nc", "cloud_coefficients_lw.nc", n_gas, gases.name_ptrs.data()));
+        const C_solver solver_lw(solver_ptr, rte_rrtmgp_solver_destroy);
+
+        const std::vector<char> coef_gas_sw = read_file("coefficients_sw.nc");
+        const std::vector<char> coef_cloud_sw = read_file("cloud_coefficients_sw.nc");
+        require_success(C_ABI(rte_rrtmgp_solver_create_from_buffer)(
+                &solver_ptr,
+                coef_gas_sw.data(), coef_gas_sw.size(), coef_cloud_sw.data(), coef_cloud_sw.size(),
+                n_gas, gases.name_ptrs.data()));
+        const C_solver solver_sw(solver_ptr, rte_rrtmgp_solver_destroy);
+
+        // The cloudy blocks add zero cloud optics to their clear columns, which changes the rounding.
+        const TF tol = std::is_same<TF, float>::value ? TF(1.e-5) : TF(1.e-12);
+
+        for (const bool switch_cloud_optics : {false, true})
+        {
+            const TF* lwp = switch_cloud_optics ? c.lwp.ptr() : nullptr;
+            const std::string label = switch_cloud_optics ? " with clouds" : " without clouds";
+
+            const Fluxes lw_ref = solve_lw(rad_lw, gas_concs, c, switch_cloud_optics);
+            Fluxes lw(c.n_col, c.n_lev);
+            require_success(C_ABI(rte_rrtmgp_solve_lw)(
+                    solver_lw.get(), c.n_col, c.n_lev-1,
+                    gases.vmr.data(), gases.shape.data(),
+                    c.p_lay.ptr(), c.p_lev.ptr(), c.t_lay.ptr(), c.t_lev.ptr(), nullptr,
+                    c.t_sfc.ptr(), c.emis_sfc.ptr(),
+                    lwp, c.iwp.ptr(), c.rel.ptr(), c.rei.ptr(),
+                    lw.flux_up.ptr(), lw.flux_dn.ptr(), lw.flux_net.ptr()));
+
+            require_close(lw.flux_up, lw_ref.flux_up, tol, "lw_flux_up of the C interface" + label);
+            require_close(lw.flux_dn, lw_ref.flux_dn, tol, "lw_flux_dn of the C interface" + label);
+            require_close(lw.flux_net, lw_ref.flux_net, tol, "lw_flux_net of the C interface" + label);
+
+            const Fluxes sw_ref = solve_sw(rad_sw, gas_concs, c, switch_cloud_optics);
+            Fluxes sw(c.n_col, c.n_lev);
+            require_success(C_ABI(rte_rrtmgp_solve_sw)(
+                    solver_sw.get(), c.n_col, c.n_lev-1,
+                    gases.vmr.data(), gases.shape.data(),
+                    c.p_lay.ptr(), c.p_lev.ptr(), c.t_lay.ptr(), c.t_lev.ptr(), nullptr,
+                    c.sfc_alb_dir.ptr(), c.sfc_alb_dif.ptr(),
+                    c.mu0.ptr(), c.tsi_scaling.ptr(),
+                    lwp, c.iwp.ptr(), c.rel.ptr(), c.rei.ptr(),
+                    sw.flux_up.ptr(), sw.flux_dn.ptr(), sw.flux_dn_dir.ptr(), sw.flux_net.ptr()));
+
+            require_close(sw.flux_up, sw_ref.flux_up, tol, "sw_flux_up of the C interface" + label);
+            require_close(sw.flux_dn, sw_ref.flux_dn, tol, "sw_flux_dn of the C interface" + label);
+            require_close(sw.flux_dn_dir, sw_ref.flux_dn_dir, tol, "sw_flux_dn_dir of the C interface" + label);
+            require_close(sw.flux_net, sw_ref.flux_net, tol, "sw_flux_net of the C interface" + label);
+        }
+
+        // Errors are reported as a status with a message.
+        Fluxes lw(c.n_col, c.n_lev);
+        const int status = C_ABI(rte_rrtmgp_solve_sw)(
+                solver_lw.get(), c.n_col, c.n_lev-1,
+                gases.vmr.data(), gases.shape.data(),
+                c.p_lay.ptr(), c.p_lev.ptr(), c.t_lay.ptr(), c.t_lev.ptr(), nullptr,
+                c.sfc_alb_dir.ptr(), c.sfc_alb_dif.ptr(), c.mu0.ptr(), nullptr,
+                nullptr, nullptr, nullptr, nullptr,
+                lw.flux_up.ptr(), lw.flux_dn.ptr(), lw.flux_dn_dir.ptr(), lw.flux_net.ptr());
+        require(status == RTE_RRTMGP_FAILURE && std::string(rte_rrtmgp_get_last_error()).size() > 0,
+                "The shortwave solve of a longwave solver is not reported");
+
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+        // A double precision solver cannot be passed to the single precision functions.
+        Array<float,2> flux_sp({c.n_col, c.n_lev});
+        const int status_sp = rte_rrtmgp_solve_lw_f32(
+                solver_lw.get(), c.n_col, c.n_lev-1,
+                nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                nullptr, nullptr, nullptr, nullptr,
+                flux_sp.ptr(), flux_sp.ptr(), flux_sp.ptr());
+        require(status_sp == RTE_RRTMGP_FAILURE &&
+                std::string(rte_rrtmgp_get_last_error()).find("precision") != std::string::npos,
+                "The precision of the solver is not checked");
+#endif
+    }
+
+    const std::map<std::string, std::function<void()>> checks
+    {
+        {"array_view",     check_array_view},
+        {"gas_concs_view", check_gas_concs_view},
+        {"lw_jacobian",    check_lw_jacobian},
+        {"combined",       check_combined},
+        {"mixed_precision", check_mixed_precision},
+        {"regroup_order",  check_regroup_order},
+        {"incremental",    check_incremental},
+        {"deduplicate_columns", check_deduplicate_columns},
+        {"validation_policy", check_validation_policy},
+        {"instrumentation",   check_instrumentation},
+        {"c_abi",             check_c_abi},
+        {"gas_optics_state",  check_gas_optics_state},
+        {"gpt_sampling_gas_optics", check_gpt_sampling_gas_optics},
+        {"gpt_sampling_unbiased",   check_gpt_sampling_unbiased} };
+}
+
+
+// Run the checks given on the command line, or all checks if none are given.
+int main(int argc, char** argv)
+{
+    std::vector<std::string> names;
+    for (int i=1; i<argc; ++i)
+        names.push_back(argv[i]);
+
+    if (names.empty())
+        for (const auto& check : checks)
+            names.push_back(check.first);
+
+    int n_failed = 0;
+    for (const std::string& name : names)
+    {
+        try
+        {
+            auto it = checks.find(name);
+            if (it == checks.end())
+                throw std::runtime_error("The check does not exist");
+
+            it->second();
+            Status::print_message("Check " + name + " passed.");
+        }
+        catch (const std::exception& e)
+        {
+            Status::print_message("Check " + name + " FAILED: " + std::string(e.what()));
+            ++n_failed;
+        }
+    }
+
+    return (n_failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * This file is a stand-alone executable developed for the
+ * testing of the C++ interface to the RTE+RRTMGP radiation code.
+ *
+ * It is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include "Status.h"
+#include "Synthetic_atmosphere.h"
+
+
+#ifdef FLOAT_SINGLE_RRTMGP
+#define FLOAT_TYPE float
+#else
+#define FLOAT_TYPE double
+#endif
+
+
+template<typename TF>
+void generate_input(int argc, char** argv)
+{
+    Atmosphere_settings<TF> settings;
+
+    // Parse the command line options of the form --ncol=128 --cloud-fraction=0.5.
+    for (int i=1; i<argc; ++i)
+    {
+        const std::string argument(argv[i]);
+        const size_t pos = argument.find('=');
+        const std::string key = argument.substr(0, pos);
+        const std::string value = (pos == std::string::npos) ? "" : argument.substr(pos+1);
+
+        if (key == "-h" || key == "--help")
+        {
+            Status::print_message("Usage: generate_rte_rrtmgp_input [--ncol=128] [--nlay=60] [--cloud-fraction=0.5]");
+            Status::print_message("       [--lwp=100] [--iwp=20] [--day-fraction=0.5] [--seed=1]");
+            return;
+        }
+        else if (value.empty())
+            throw std::runtime_error(argument + " is an illegal command line option.");
+        else if (key == "--ncol")
+            settings.n_col = std::stoi(value);
+        else if (key == "--nlay")
+            settings.n_lay = std::stoi(value);
+        else if (key == "--cloud-fraction")
+            settings.cloud_fraction = std::stod(value);
+        else if (key == "--lwp")
+            settings.lwp = std::stod(value);
+        else if (key == "--iwp")
+            settings.iwp = std::stod(value);
+        else if (key == "--day-fraction")
+            settings.day_fraction = std::stod(value);
+        else if (key == "--seed")
+            settings.seed = std::stoul(value);
+        else
+            throw std::runtime_error(argument + " is an illegal command line option.");
+    }
+
+    Status::print_message(
+            "Generating a synthetic atmosphere of " + std::to_string(settings.n_col)
+            + " columns and " + std::to_string(settings.n_lay) + " layers.");
+
+    Synthetic_atmosphere<TF> atmosphere(settings);
+    atmosphere.save("rte_rrtmgp_input.nc");
+
+    Status::print_message("Saved rte_rrtmgp_input.nc.");
+}
+
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        generate_input<FLOAT_TYPE>(argc, argv);
+    }
+
+    // Catch any exceptions and return 1.
+    catch (const std::exception& e)
+    {
+        std::string error = "EXCEPTION: " + std::string(e.what());
+        Status::print_message(error);
+        return 1;
+    }
+    catch (...)
+    {
+        Status::print_message("UNHANDLED EXCEPTION!");
+        return 1;
+    }
+
+    // Return 0 in case of normal exit.
+    return 0;
+}
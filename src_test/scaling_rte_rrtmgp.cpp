@@ -0,0 +1,447 @@
+/*
+ * This file is a stand-alone executable developed for the
+ * testing of the C++ interface to the RTE+RRTMGP radiation code.
+ *
+ * It is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+
+#include "Status.h"
+#include "Array.h"
+#include "Gas_concs.h"
+#include "Radiation_solver.h"
+#include "Synthetic_atmosphere.h"
+
+
+namespace
+{
+    struct Scaling_settings
+    {
+        std::vector<int> n_cols = {128, 1024};
+        std::vector<int> n_lays = {60};
+        std::vector<int> n_threads = {1};
+        std::vector<int> n_col_blocks = {16};
+        std::vector<std::string> precisions;
+        int n_trials = 5;
+        int n_warmup = 1;
+        bool weak_scaling = false;
+        bool switch_longwave = true;
+        bool switch_shortwave = true;
+    };
+
+    struct Scaling_result
+    {
+        std::string precision;
+        int n_col;
+        int n_lay;
+        int n_threads;
+        int n_col_block;
+        double time_median;
+        double time_min;
+        double time_max;
+        double throughput;
+        double peak_rss;
+    };
+
+    // Reset the high-water mark of the resident set size, such that each point of the sweep
+    // reports its own peak. If the kernel does not support this, the peak of the process is used.
+    void reset_peak_rss()
+    {
+        std::ofstream clear_refs("/proc/self/clear_refs");
+        if (clear_refs)
+            clear_refs << "5";
+    }
+
+    // Peak resident set size in MB.
+    double get_peak_rss()
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, 6, "VmHWM:") == 0)
+                return std::stod(line.substr(6)) / 1024.;
+        }
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024.;
+    }
+
+    template<typename TF>
+    Array<TF,2> subset_cols(const Array<TF,2>& array, const int col_s, const int col_e)
+    {
+        return array.subset({{ {col_s, col_e}, {1, array.dim(2)} }});
+    }
+
+    Array<int,1> make_col_order(const int col_s, const int col_e)
+    {
+        Array<int,1> col_order({col_e - col_s + 1});
+        for (int icol=1; icol<=col_order.dim(1); ++icol)
+            col_order({icol}) = col_s + icol - 1;
+        return col_order;
+    }
+
+    // The columns of a thread, with the inputs including the gases copied before the timing starts.
+    template<typename TF>
+    struct Thread_data
+    {
+        Thread_data(
+                const Synthetic_atmosphere<TF>& atmos, const int col_s, const int col_e,
+                const TF tsi_ref) :
+            n_col(col_e - col_s + 1),
+            gas_concs(atmos.gas_concs, make_col_order(col_s, col_e)),
+            p_lay(subset_cols(atmos.p_lay, col_s, col_e)),
+            p_lev(subset_cols(atmos.p_lev, col_s, col_e)),
+            t_lay(subset_cols(atmos.t_lay, col_s, col_e)),
+            t_lev(subset_cols(atmos.t_lev, col_s, col_e)),
+            t_sfc(atmos.t_sfc.subset({{ {col_s, col_e} }})),
+            emis_sfc(atmos.emis_sfc.subset({{ {1, atmos.emis_sfc.dim(1)}, {col_s, col_e} }})),
+            sfc_alb_dir(atmos.sfc_alb_dir.subset({{ {1, atmos.sfc_alb_dir.dim(1)}, {col_s, col_e} }})),
+            sfc_alb_dif(atmos.sfc_alb_dif.subset({{ {1, atmos.sfc_alb_dif.dim(1)}, {col_s, col_e} }})),
+            mu0(atmos.mu0.subset({{ {col_s, col_e} }})),
+            tsi_scaling({n_col}),
+            lwp(subset_cols(atmos.lwp, col_s, col_e)),
+            iwp(subset_cols(atmos.iwp, col_s, col_e)),
+            rel(subset_cols(atmos.rel, col_s, col_e)),
+            rei(subset_cols(atmos.rei, col_s, col_e)),
+            flux_up({n_col, atmos.n_lev}), flux_dn({n_col, atmos.n_lev}),
+            flux_dn_dir({n_col, atmos.n_lev}), flux_net({n_col, atmos.n_lev})
+        {
+            for (int icol=1; icol<=n_col; ++icol)
+                tsi_scaling({icol}) = atmos.tsi({icol + col_s - 1}) / tsi_ref;
+        }
+
+        const int n_col;
+        Gas_concs<TF> gas_concs;
+        Array<TF,2> p_lay, p_lev, t_lay, t_lev;
+        Array<TF,1> t_sfc;
+        Array<TF,2> emis_sfc, sfc_alb_dir, sfc_alb_dif;
+        Array<TF,1> mu0, tsi_scaling;
+        Array<TF,2> lwp, iwp, rel, rei;
+
+        Array<TF,2> flux_up, flux_dn, flux_dn_dir, flux_net;
+    };
+
+    template<typename TF>
+    void solve_thread(
+            const Radiation_solver_longwave<TF>* rad_lw,
+            const Radiation_solver_shortwave<TF>* rad_sw,
+            Thread_data<TF>& d)
+    {
+        // Only the fluxes are computed, the empty arrays disable the other output.
+        Array<TF,2> col_dry;
+        Array<TF,3> tau, ssa, g, lay_source, lev_source_inc, lev_source_dec;
+        Array<TF,2> sfc_source, toa_source, flux_up_jac;
+        Array<TF,3> bnd_flux_up, bnd_flux_dn, bnd_flux_dn_dir, bnd_flux_net;
+
+        if (rad_lw)
+            rad_lw->solve(
+                    true, true, false, false, false,
+                    d.gas_concs,
+                    d.p_lay, d.p_lev, d.t_lay, d.t_lev,
+                    col_dry,
+                    d.t_sfc, d.emis_sfc,
+                    d.lwp, d.iwp, d.rel, d.rei,
+                    tau, lay_source, lev_source_inc, lev_source_dec, sfc_source,
+                    d.flux_up, d.flux_dn, d.flux_net,
+                    bnd_flux_up, bnd_flux_dn, bnd_flux_net,
+                    flux_up_jac);
+
+        if (rad_sw)
+            rad_sw->solve(
+                    true, true, false, false,
+                    d.gas_concs,
+                    d.p_lay, d.p_lev, d.t_lay, d.t_lev,
+                    col_dry,
+                    d.sfc_alb_dir, d.sfc_alb_dif,
+                    d.tsi_scaling, d.mu0,
+                    d.lwp, d.iwp, d.rel, d.rei,
+                    tau, ssa, g,
+                    toa_source,
+                    d.flux_up, d.flux_dn, d.flux_dn_dir, d.flux_net,
+                    bnd_flux_up, bnd_flux_dn, bnd_flux_dn_dir, bnd_flux_net);
+    }
+
+    double get_median(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        const size_t n = values.size();
+        return (n % 2 == 1) ? values[n/2] : 0.5*(values[n/2-1] + values[n/2]);
+    }
+
+    template<typename TF>
+    void run_sweep(
+            const Scaling_settings& settings, const std::string& precision,
+            const bool switch_mixed_precision,
+            std::vector<Scaling_result>& results)
+    {
+        // The solvers only need the gas names, which are the same for every size.
+        Atmosphere_settings<TF> atmos_settings_init;
+        atmos_settings_init.n_col = 1;
+        const Synthetic_atmosphere<TF> atmos_init(atmos_settings_init);
+
+        std::unique_ptr<Radiation_solver_longwave<TF>> rad_lw;
+        std::unique_ptr<Radiation_solver_shortwave<TF>> rad_sw;
+
+        int n_gpt = 0;
+        TF tsi_ref = TF(1.);
+
+        if (settings.switch_longwave)
+        {
+            rad_lw = std::make_unique<Radiation_solver_longwave<TF>>(
+                    atmos_init.gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc", switch_mixed_precision);
+            n_gpt += rad_lw->get_n_gpt();
+        }
+
+        if (settings.switch_shortwave)
+        {
+            rad_sw = std::make_unique<Radiation_solver_shortwave<TF>>(
+                    atmos_init.gas_concs, "coefficients_sw.nc", "cloud_coefficients_sw.nc", switch_mixed_precision);
+            n_gpt += rad_sw->get_n_gpt();
+            tsi_ref = rad_sw->get_tsi();
+        }
+
+        for (const int n_lay : settings.n_lays)
+            for (const int n_col_in : settings.n_cols)
+                for (const int n_threads : settings.n_threads)
+                    for (const int n_col_block : settings.n_col_blocks)
+                    {
+                        const int n_col = settings.weak_scaling ? n_col_in*n_threads : n_col_in;
+
+                        if (rad_lw) rad_lw->set_n_col_block(n_col_block);
+                        if (rad_sw) rad_sw->set_n_col_block(n_col_block);
+
+                        reset_peak_rss();
+
+                        Atmosphere_settings<TF> atmos_settings;
+                        atmos_settings.n_col = n_col;
+                        atmos_settings.n_lay = n_lay;
+                        const Synthetic_atmosphere<TF> atmos(atmos_settings);
+
+                        // Divide the columns as evenly as possible over the threads.
+                        std::vector<std::unique_ptr<Thread_data<TF>>> thread_data;
+                        for (int ithread=0; ithread<n_threads; ++ithread)
+                        {
+                            const int col_s = 1 + (ithread*n_col) / n_threads;
+                            const int col_e = ((ithread+1)*n_col) / n_threads;
+                            if (col_e >= col_s)
+                                thread_data.push_back(std::make_unique<Thread_data<TF>>(atmos, col_s, col_e, tsi_ref));
+                        }
+
+                        auto run_trial = [&]()
+                        {
+                            std::vector<std::thread> threads;
+                            for (auto& d : thread_data)
+                                threads.emplace_back(solve_thread<TF>, rad_lw.get(), rad_sw.get(), std::ref(*d));
+                            for (std::thread& thread : threads)
+                                thread.join();
+                        };
+
+                        for (int i=0; i<settings.n_warmup; ++i)
+                            run_trial();
+
+                        std::vector<double> times;
+                        for (int i=0; i<settings.n_trials; ++i)
+                        {
+                            auto time_start = std::chrono::steady_clock::now();
+                            run_trial();
+                            auto time_end = std::chrono::steady_clock::now();
+                            times.push_back(std::chrono::duration<double>(time_end-time_start).count());
+                        }
+
+                        Scaling_result result;
+                        result.precision = precision;
+                        result.n_col = n_col;
+                        result.n_lay = n_lay;
+                        result.n_threads = n_threads;
+                        result.n_col_block = n_col_block;
+                        result.time_median = get_median(times);
+                        result.time_min = *std::min_element(times.begin(), times.end());
+                        result.time_max = *std::max_element(times.begin(), times.end());
+                        result.throughput = double(n_col)*n_gpt / result.time_median;
+                        result.peak_rss = get_peak_rss();
+
+                        std::ostringstream ss;
+                        ss << std::left << std::setw(8) << precision
+                           << std::right << std::setw(8) << n_col << std::setw(6) << n_lay
+                           << std::setw(8) << n_threads << std::setw(8) << n_col_block
+                           << std::setw(14) << std::setprecision(5) << result.time_median*1.e3
+                           << std::setw(12) << (result.time_max - result.time_min) / result.time_median
+                           << std::setw(14) << result.throughput
+                           << std::setw(12) << result.peak_rss << std::endl;
+                        Status::print_message(ss);
+
+                        results.push_back(result);
+                    }
+    }
+
+    void save_csv(const std::vector<Scaling_result>& results, const std::string& file_name)
+    {
+        std::ofstream file(file_name);
+        file << "precision,n_col,n_lay,n_threads,n_col_block,time_median,time_min,time_max,spread,throughput,peak_rss_mb\n";
+        file << std::setprecision(8);
+        for (const Scaling_result& r : results)
+            file << r.precision << "," << r.n_col << "," << r.n_lay << "," << r.n_threads << ","
+                 << r.n_col_block << "," << r.time_median << "," << r.time_min << "," << r.time_max << ","
+                 << (r.time_max - r.time_min) / r.time_median << "," << r.throughput << "," << r.peak_rss << "\n";
+    }
+
+    void save_json(const std::vector<Scaling_result>& results, const std::string& file_name)
+    {
+        std::ofstream file(file_name);
+        file << std::setprecision(8);
+        file << "[\n";
+        for (size_t i=0; i<results.size(); ++i)
+        {
+            const Scaling_result& r = results[i];
+            file << "  {\"precision\": \"" << r.precision << "\", \"n_col\": " << r.n_col
+                 << ", \"n_lay\": " << r.n_lay << ", \"n_threads\": " << r.n_threads
+                 << ", \"n_col_block\": " << r.n_col_block << ", \"time_median\": " << r.time_median
+                 << ", \"time_min\": " << r.time_min << ", \"time_max\": " << r.time_max
+                 << ", \"spread\": " << (r.time_max - r.time_min) / r.time_median
+                 << ", \"throughput\": " << r.throughput << ", \"peak_rss_mb\": " << r.peak_rss << "}"
+                 << (i+1 < results.size() ? ",\n" : "\n");
+        }
+        file << "]\n";
+    }
+
+    std::vector<int> parse_int_list(const std::string& list)
+    {
+        std::vector<std::string> items;
+        boost::split(items, list, boost::is_any_of(","));
+
+        std::vector<int> values;
+        for (const std::string& item : items)
+            values.push_back(std::stoi(item));
+        return values;
+    }
+
+    void print_usage()
+    {
+        Status::print_message("Usage: scaling_rte_rrtmgp [--ncol=128,1024] [--nlay=60] [--threads=1,2,4]");
+        Status::print_message("       [--block-size=8,16,32] [--precision=float,double,mixed] [--trials=5]");
+        Status::print_message("       [--warmup=1] [--weak] [--no-longwave] [--no-shortwave]");
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    Scaling_settings settings;
+
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+    settings.precisions = {"float", "double", "mixed"};
+#elif defined(FLOAT_SINGLE_RRTMGP)
+    settings.precisions = {"float"};
+#else
+    settings.precisions = {"double"};
+#endif
+
+    std::vector<Scaling_result> results;
+
+    try
+    {
+        for (int i=1; i<argc; ++i)
+        {
+            const std::string argument(argv[i]);
+            const size_t pos = argument.find('=');
+            const std::string key = argument.substr(0, pos);
+            const std::string value = (pos == std::string::npos) ? "" : argument.substr(pos+1);
+
+            if (key == "-h" || key == "--help")
+            {
+                print_usage();
+                return 0;
+            }
+            else if (key == "--weak")
+                settings.weak_scaling = true;
+            else if (key == "--no-longwave")
+                settings.switch_longwave = false;
+            else if (key == "--no-shortwave")
+                settings.switch_shortwave = false;
+            else if (value.empty())
+                throw std::runtime_error(argument + " is an illegal command line option.");
+            else if (key == "--ncol")
+                settings.n_cols = parse_int_list(value);
+            else if (key == "--nlay")
+                settings.n_lays = parse_int_list(value);
+            else if (key == "--threads")
+                settings.n_threads = parse_int_list(value);
+            else if (key == "--block-size")
+                settings.n_col_blocks = parse_int_list(value);
+            else if (key == "--trials")
+                settings.n_trials = std::stoi(value);
+            else if (key == "--warmup")
+                settings.n_warmup = std::stoi(value);
+            else if (key == "--precision")
+                boost::split(settings.precisions, value, boost::is_any_of(","));
+            else
+                throw std::runtime_error(argument + " is an illegal command line option.");
+        }
+
+        if (settings.n_trials < 1)
+            throw std::runtime_error("At least one trial is required");
+
+        Status::print_message("###### Starting RTE+RRTMGP scaling test ######");
+        Status::print_message(
+                "precision   n_col n_lay threads   block   median (ms)      spread    col*gpt/s    RSS (MB)");
+
+        for (const std::string& precision : settings.precisions)
+        {
+#ifdef RTE_RRTMGP_DUAL_PRECISION
+            if (precision == "float")
+                run_sweep<float>(settings, precision, false, results);
+            else if (precision == "double")
+                run_sweep<double>(settings, precision, false, results);
+            else if (precision == "mixed")
+                run_sweep<double>(settings, precision, true, results);
+#elif defined(FLOAT_SINGLE_RRTMGP)
+            if (precision == "float")
+                run_sweep<float>(settings, precision, false, results);
+#else
+            if (precision == "double")
+                run_sweep<double>(settings, precision, false, results);
+#endif
+            else
+                throw std::runtime_error("Precision \"" + precision + "\" is not available in this build");
+        }
+
+        save_csv(results, "scaling_rte_rrtmgp.csv");
+        save_json(results, "scaling_rte_rrtmgp.json");
+
+        Status::print_message("###### Finished RTE+RRTMGP scaling test ######");
+    }
+
+    // Catch any exceptions and return 1.
+    catch (const std::exception& e)
+    {
+        std::string error = "EXCEPTION: " + std::string(e.what());
+        Status::print_message(error);
+        return 1;
+    }
+
+    return 0;
+}
@@ -17,12 +17,18 @@
  */
 
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <chrono>
+#include <fstream>
 #include <iomanip>
+#include <memory>
+#include <mutex>
 
 #include "Status.h"
 #include "Netcdf_interface.h"
+#include "Netcdf_writer.h"
 #include "Array.h"
+#include "Instrumentation.h"
 #include "Radiation_solver.h"
 
 
@@ -33,9 +39,38 @@
 #endif
 
 
+// Read the columns col_s to col_s+n_col_in-1 of a (z, col) variable.
+template<typename TF>
+Array<TF,2> get_columns(
+        const Netcdf_handle& input_nc, const std::string& name,
+        const int col_s, const int n_col_in, const int n_z)
+{
+    Array<TF,2> array({n_col_in, n_z});
+    input_nc.get_variable(array, name, {0, col_s-1}, {n_z, n_col_in});
+    return array;
+}
+
+
+// Write an array with the columns as first dimension into the slice of the variable that
+// starts at column col_s. The column is the last dimension in the NetCDF file. The writer
+// takes over the data of the array.
+template<typename TF, int N>
+void insert_columns(
+        Netcdf_writer& writer, Netcdf_variable<TF>& variable, Array<TF,N>&& array, const int col_s)
+{
+    std::vector<int> i_start(N, 0);
+    std::vector<int> i_count(N);
+    for (int n=0; n<N; ++n)
+        i_count[n] = array.dim(N-n);
+    i_start[N-1] = col_s-1;
+
+    writer.insert(variable, std::move(array.v()), i_start, i_count);
+}
+
+
 template<typename TF>
 void read_and_set_vmr(
-        const std::string& gas_name, const int n_col, const int n_lay,
+        const std::string& gas_name, const int col_s, const int n_col_in, const int n_lay,
         const Netcdf_handle& input_nc, Gas_concs<TF>& gas_concs)
 {
     const std::string vmr_gas_name = "vmr_" + gas_name;
@@ -59,9 +94,8 @@ void read_and_set_vmr(
         }
         else if (n_dims == 2)
         {
-            if (dims.at("lay") == n_lay && dims.at("col") == n_col)
-                gas_concs.set_vmr(gas_name,
-                        Array<TF,2>(input_nc.get_variable<TF>(vmr_gas_name, {n_lay, n_col}), {n_col, n_lay}));
+            if (dims.at("lay") == n_lay && dims.at("col") >= col_s + n_col_in - 1)
+                gas_concs.set_vmr(gas_name, get_columns<TF>(input_nc, vmr_gas_name, col_s, n_col_in, n_lay));
             else
                 throw std::runtime_error("Illegal dimensions of gas \"" + gas_name + "\" in input");
         }
@@ -73,8 +107,31 @@ void read_and_set_vmr(
 }
 
 
+template<typename TF>
+Gas_concs<TF> read_gas_concs(
+        const int col_s, const int n_col_in, const int n_lay,
+        const Netcdf_handle& input_nc,
+        const Validation_policy validation_policy=Validation_policy::Full)
+{
+    Gas_concs<TF> gas_concs;
+    gas_concs.set_validation_policy(validation_policy);
+
+    const std::vector<std::string> gas_names = {
+        "h2o", "co2", "o3", "n2o", "co", "ch4", "o2", "n2",
+        "ccl4", "cfc11", "cfc12", "cfc22", "hfc143a", "hfc125",
+        "hfc23", "hfc32", "hfc134a", "cf4", "no2" };
+
+    for (const std::string& gas_name : gas_names)
+        read_and_set_vmr(gas_name, col_s, n_col_in, n_lay, input_nc, gas_concs);
+
+    return gas_concs;
+}
+
+
 bool parse_command_line_options(
         std::map<std::string, std::pair<bool, std::string>>& command_line_options,
+        std::map<std::string, std::pair<int, std::string>>& command_line_values,
+        std::map<std::string, std::pair<std::string, std::string>>& command_line_strings,
         int argc, char** argv)
 {
     for (int i=1; i<argc; ++i)
@@ -92,6 +149,20 @@ bool parse_command_line_options(
                 ss << clo.second.second << std::endl;
                 Status::print_message(ss);
             }
+            for (const auto& clv : command_line_values)
+            {
+                std::ostringstream ss;
+                ss << std::left << std::setw(30) << ("--" + clv.first + "=N");
+                ss << clv.second.second << std::endl;
+                Status::print_message(ss);
+            }
+            for (const auto& cls : command_line_strings)
+            {
+                std::ostringstream ss;
+                ss << std::left << std::setw(30) << ("--" + cls.first + "=S");
+                ss << cls.second.second << std::endl;
+                Status::print_message(ss);
+            }
             return true;
         }
 
@@ -104,6 +175,24 @@ bool parse_command_line_options(
         else
             argument.erase(0, 2);
 
+        // Check if option has a value.
+        const size_t pos = argument.find('=');
+        if (pos != std::string::npos)
+        {
+            const std::string name = argument.substr(0, pos);
+            if (command_line_values.find(name) != command_line_values.end())
+                command_line_values.at(name).first = std::stoi(argument.substr(pos+1));
+            else if (command_line_strings.find(name) != command_line_strings.end())
+                command_line_strings.at(name).first = argument.substr(pos+1);
+            else
+            {
+                std::string error = argument + " is an illegal command line option.";
+                throw std::runtime_error(error);
+            }
+
+            continue;
+        }
+
         // Check if option has prefix no-
         bool enable = true;
         if (argument[0] == 'n' && argument[1] == 'o' && argument[2] == '-')
@@ -126,7 +215,9 @@ bool parse_command_line_options(
 
 
 void print_command_line_options(
-        const std::map<std::string, std::pair<bool, std::string>>& command_line_options)
+        const std::map<std::string, std::pair<bool, std::string>>& command_line_options,
+        const std::map<std::string, std::pair<int, std::string>>& command_line_values,
+        const std::map<std::string, std::pair<std::string, std::string>>& command_line_strings)
 {
     Status::print_message("Solver settings:");
     for (const auto& option : command_line_options)
@@ -136,6 +227,33 @@ void print_command_line_options(
         ss << " = " << std::boolalpha << option.second.first << std::endl;
         Status::print_message(ss);
     }
+    for (const auto& value : command_line_values)
+    {
+        std::ostringstream ss;
+        ss << std::left << std::setw(20) << (value.first);
+        ss << " = " << value.second.first << std::endl;
+        Status::print_message(ss);
+    }
+    for (const auto& value : command_line_strings)
+    {
+        std::ostringstream ss;
+        ss << std::left << std::setw(20) << (value.first);
+        ss << " = " << value.second.first << std::endl;
+        Status::print_message(ss);
+    }
+}
+
+
+Validation_policy parse_validation_policy(const std::string& name)
+{
+    if (name == "full")
+        return Validation_policy::Full;
+    else if (name == "fused")
+        return Validation_policy::Fused;
+    else if (name == "off")
+        return Validation_policy::Off;
+    else
+        throw std::runtime_error("The validation policy has to be full, fused or off");
 }
 
 
@@ -152,9 +270,29 @@ void solve_radiation(int argc, char** argv)
         {"fluxes"           , { true,  "Enable computation of fluxes."             }},
         {"cloud-optics"     , { false, "Enable cloud optics."                      }},
         {"output-optical"   , { false, "Enable output of optical properties."      }},
-        {"output-bnd-fluxes", { false, "Enable output of band fluxes."             }} };
-
-    if (parse_command_line_options(command_line_options, argc, argv))
+        {"output-bnd-fluxes", { false, "Enable output of band fluxes."             }},
+        {"output-jacobian"  , { false, "Enable output of longwave dF_up/dT_sfc."   }},
+        {"mixed-precision"  , { false, "Enable single-precision gas optics."       }},
+        {"instrumentation"  , { false, "Enable timing of the solver stages."       }},
+        {"streaming"        , { false, "Enable reading, solving and writing per chunk of columns."}},
+        {"async-output"     , { false, "Enable writing of the output in a background thread."}},
+        {"compress-output"  , { false, "Enable chunked and compressed output."     }},
+        {"float-output"     , { false, "Enable storage of the output as float."    }},
+        {"combined"         , { false, "Enable solving longwave and shortwave per column block."}},
+        {"dedup-columns"    , { false, "Enable solving columns with identical inputs once."}} };
+
+    std::map<std::string, std::pair<int, std::string>> command_line_values {
+        {"chunk-size"     , { 4096, "Number of columns per chunk in streaming mode."}},
+        {"block-size"     , {   16, "Number of columns per block in the solvers."   }},
+        {"threads"        , {    1, "Number of threads of the combined solver."     }},
+        {"gpt-samples-lw" , {    0, "Sampled longwave g-points per column in the combined solver, 0 is all."}},
+        {"gpt-samples-sw" , {    0, "Sampled shortwave g-points per column in the combined solver, 0 is all."}},
+        {"quantize-digits", {    0, "Significant digits kept in compressed output, 0 is lossless."}} };
+
+    std::map<std::string, std::pair<std::string, std::string>> command_line_strings {
+        {"validation", { "full", "Checking of the input: full, fused (one pass) or off."}} };
+
+    if (parse_command_line_options(command_line_options, command_line_values, command_line_strings, argc, argv))
         return;
 
     const bool switch_shortwave         = command_line_options.at("shortwave"        ).first;
@@ -163,383 +301,631 @@ void solve_radiation(int argc, char** argv)
     const bool switch_cloud_optics      = command_line_options.at("cloud-optics"     ).first;
     const bool switch_output_optical    = command_line_options.at("output-optical"   ).first;
     const bool switch_output_bnd_fluxes = command_line_options.at("output-bnd-fluxes").first;
+    const bool switch_output_jacobian   = command_line_options.at("output-jacobian"  ).first;
+    const bool switch_mixed_precision   = command_line_options.at("mixed-precision"  ).first;
+    const bool switch_instrumentation   = command_line_options.at("instrumentation"  ).first;
+    const bool switch_streaming         = command_line_options.at("streaming"        ).first;
+    const bool switch_async_output      = command_line_options.at("async-output"     ).first;
+
+    const bool switch_compress_output   = command_line_options.at("compress-output"  ).first;
+    const bool switch_float_output      = command_line_options.at("float-output"     ).first;
+    const bool switch_combined          = command_line_options.at("combined"         ).first;
+    const bool switch_dedup_columns     = command_line_options.at("dedup-columns"    ).first;
+
+    const int chunk_size      = command_line_values.at("chunk-size"     ).first;
+    const int block_size      = command_line_values.at("block-size"     ).first;
+    const int n_threads       = command_line_values.at("threads"        ).first;
+    const int n_gpt_sample_lw = command_line_values.at("gpt-samples-lw" ).first;
+    const int n_gpt_sample_sw = command_line_values.at("gpt-samples-sw" ).first;
+    const int quantize_digits = command_line_values.at("quantize-digits").first;
+
+    const Validation_policy validation_policy = parse_validation_policy(command_line_strings.at("validation").first);
+
+    if (chunk_size < 1)
+        throw std::runtime_error("The chunk size needs to be at least 1");
+
+    // The combined solver only computes the broadband fluxes.
+    if (switch_combined && !(switch_longwave && switch_shortwave && switch_fluxes))
+        throw std::runtime_error("The combined solver requires longwave, shortwave and fluxes");
+    if (switch_combined && (switch_output_optical || switch_output_bnd_fluxes || switch_output_jacobian || switch_mixed_precision))
+        throw std::runtime_error("The combined solver does not support optical, band or Jacobian output and mixed precision");
+    if (switch_combined && switch_dedup_columns)
+        throw std::runtime_error("The column deduplication is not supported by the combined solver");
+    if (!switch_combined && (n_gpt_sample_lw > 0 || n_gpt_sample_sw > 0))
+        throw std::runtime_error("The g-point sampling requires the combined solver");
 
     // Print the options to the screen.
-    print_command_line_options(command_line_options);
+    print_command_line_options(command_line_options, command_line_values, command_line_strings);
 
+    Instrumentation::set_enabled(switch_instrumentation);
 
-    ////// READ THE ATMOSPHERIC DATA //////
-    Status::print_message("Reading atmospheric input data from NetCDF.");
 
+    ////// READ THE ATMOSPHERIC DIMENSIONS //////
     Netcdf_file input_nc("rte_rrtmgp_input.nc", Netcdf_mode::Read);
 
     const int n_col = input_nc.get_dimension_size("col");
     const int n_lay = input_nc.get_dimension_size("lay");
     const int n_lev = input_nc.get_dimension_size("lev");
 
-    // Read the atmospheric fields.
-    Array<TF,2> p_lay(input_nc.get_variable<TF>("p_lay", {n_lay, n_col}), {n_col, n_lay});
-    Array<TF,2> t_lay(input_nc.get_variable<TF>("t_lay", {n_lay, n_col}), {n_col, n_lay});
-    Array<TF,2> p_lev(input_nc.get_variable<TF>("p_lev", {n_lev, n_col}), {n_col, n_lev});
-    Array<TF,2> t_lev(input_nc.get_variable<TF>("t_lev", {n_lev, n_col}), {n_col, n_lev});
+    // Without streaming, all columns are read, solved and written at once.
+    const int n_col_chunk = switch_streaming ? std::min(chunk_size, n_col) : n_col;
 
-    // Fetch the col_dry in case present.
-    Array<TF,2> col_dry;
-    if (input_nc.variable_exists("col_dry"))
-    {
-        col_dry.set_dims({n_col, n_lay});
-        col_dry = std::move(input_nc.get_variable<TF>("col_dry", {n_lay, n_col}));
-    }
 
-    // Create container for the gas concentrations and read gases.
-    Gas_concs<TF> gas_concs;
+    ////// CREATE THE OUTPUT FILE //////
+    // Create the general dimensions and arrays.
+    Status::print_message("Preparing NetCDF output file.");
 
-    read_and_set_vmr("h2o", n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("co2", n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("o3" , n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("n2o", n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("co" , n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("ch4", n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("o2" , n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("n2" , n_col, n_lay, input_nc, gas_concs);
-
-    read_and_set_vmr("ccl4"   , n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("cfc11"  , n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("cfc12"  , n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("cfc22"  , n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("hfc143a", n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("hfc125" , n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("hfc23"  , n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("hfc32"  , n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("hfc134a", n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("cf4"    , n_col, n_lay, input_nc, gas_concs);
-    read_and_set_vmr("no2"    , n_col, n_lay, input_nc, gas_concs);
-
-    Array<TF,2> lwp;
-    Array<TF,2> iwp;
-    Array<TF,2> rel;
-    Array<TF,2> rei;
-
-    if (switch_cloud_optics)
+    auto output_nc = std::make_unique<Netcdf_file>("rte_rrtmgp_output.nc", Netcdf_mode::Create);
+    std::map<std::string, int> output_dims;
+    auto add_output_dimension = [&](const std::string& name, const int size)
+    {
+        output_nc->add_dimension(name, size);
+        output_dims.emplace(name, size);
+    };
+
+    add_output_dimension("col", n_col);
+    add_output_dimension("lay", n_lay);
+    add_output_dimension("lev", n_lev);
+    add_output_dimension("pair", 2);
+
+    // The variables are created up front, such that each chunk can write its slice. Compressed
+    // variables are chunked over all other dimensions and a multiple of the column block of the
+    // solvers, with a target of about 1 MB per chunk. Writes of whole blocks then cover whole chunks.
+    std::map<std::string, Netcdf_variable<TF>> nc_vars;
+    auto add_output = [&](const std::string& name, const std::vector<std::string>& dims)
     {
-        lwp.set_dims({n_col, n_lay});
-        lwp = std::move(input_nc.get_variable<TF>("lwp", {n_lay, n_col}));
+        Netcdf_storage storage;
+        storage.store_as_float = switch_float_output;
 
-        iwp.set_dims({n_col, n_lay});
-        iwp = std::move(input_nc.get_variable<TF>("iwp", {n_lay, n_col}));
+        if (switch_compress_output)
+        {
+            int n_per_col = 1;
+            for (const std::string& dim : dims)
+            {
+                if (dim != "col")
+                {
+                    storage.chunk_sizes.push_back(output_dims.at(dim));
+                    n_per_col *= output_dims.at(dim);
+                }
+            }
 
-        rel.set_dims({n_col, n_lay});
-        rel = std::move(input_nc.get_variable<TF>("rel", {n_lay, n_col}));
+            constexpr int chunk_target_bytes = 1 << 20;
+            const int n_blocks = std::max(chunk_target_bytes / int(n_per_col*block_size*sizeof(TF)), 1);
+            storage.chunk_sizes.push_back(std::min(n_blocks*block_size, n_col));
 
-        rei.set_dims({n_col, n_lay});
-        rei = std::move(input_nc.get_variable<TF>("rei", {n_lay, n_col}));
-    }
+            storage.deflate_level = 1;
+            storage.shuffle = true;
+            storage.quantize_digits = quantize_digits;
+        }
 
+        nc_vars.emplace(name, output_nc->add_variable<TF>(name, dims, storage));
+    };
 
-    ////// CREATE THE OUTPUT FILE //////
-    // Create the general dimensions and arrays.
-    Status::print_message("Preparing NetCDF output file.");
+    add_output("p_lay", {"lay", "col"});
+    add_output("p_lev", {"lev", "col"});
 
-    Netcdf_file output_nc("rte_rrtmgp_output.nc", Netcdf_mode::Create);
-    output_nc.add_dimension("col", n_col);
-    output_nc.add_dimension("lay", n_lay);
-    output_nc.add_dimension("lev", n_lev);
-    output_nc.add_dimension("pair", 2);
 
-    auto nc_lay = output_nc.add_variable<TF>("p_lay", {"lay", "col"});
-    auto nc_lev = output_nc.add_variable<TF>("p_lev", {"lev", "col"});
+    ////// INITIALIZE THE SOLVERS //////
+    // The solvers only need the available gases, which are taken from the first column.
+    const Gas_concs<TF> gas_concs_init = read_gas_concs<TF>(1, 1, n_lay, input_nc);
 
-    nc_lay.insert(p_lay.v(), {0, 0});
-    nc_lev.insert(p_lev.v(), {0, 0});
+    std::unique_ptr<Radiation_solver_longwave<TF>> rad_lw;
+    std::unique_ptr<Radiation_solver_shortwave<TF>> rad_sw;
+    std::unique_ptr<Radiation_solver_combined<TF>> rad_combined;
 
+    int n_bnd_lw = 0;
+    int n_gpt_lw = 0;
+    int n_bnd_sw = 0;
+    int n_gpt_sw = 0;
 
-    ////// RUN THE LONGWAVE SOLVER //////
-    if (switch_longwave)
+    if (switch_combined)
     {
-        // Initialize the solver.
-        Status::print_message("Initializing the longwave solver.");
-        Radiation_solver_longwave<TF> rad_lw(gas_concs, "coefficients_lw.nc", "cloud_coefficients_lw.nc");
-
-        // Read the boundary conditions.
-        const int n_bnd_lw = rad_lw.get_n_bnd();
-        const int n_gpt_lw = rad_lw.get_n_gpt();
-
-        Array<TF,2> emis_sfc(input_nc.get_variable<TF>("emis_sfc", {n_col, n_bnd_lw}), {n_bnd_lw, n_col});
-        Array<TF,1> t_sfc(input_nc.get_variable<TF>("t_sfc", {n_col}), {n_col});
+        Status::print_message("Initializing the combined solver.");
+        rad_combined = std::make_unique<Radiation_solver_combined<TF>>(
+                gas_concs_init,
+                "coefficients_lw.nc", "cloud_coefficients_lw.nc",
+                "coefficients_sw.nc", "cloud_coefficients_sw.nc");
+
+        rad_combined->set_n_col_block(block_size);
+        rad_combined->set_validation_policy(validation_policy);
+        rad_combined->set_n_threads(n_threads);
+        rad_combined->set_gpt_sampling(n_gpt_sample_lw, n_gpt_sample_sw);
+    }
 
-        // Create output arrays.
-        Array<TF,3> lw_tau;
-        Array<TF,3> lay_source;
-        Array<TF,3> lev_source_inc;
-        Array<TF,3> lev_source_dec;
-        Array<TF,2> sfc_source;
+    if (switch_longwave)
+    {
+        Array<TF,2> lw_band_lims_wvn;
 
-        if (switch_output_optical)
+        if (switch_combined)
         {
-            lw_tau        .set_dims({n_col, n_lay, n_gpt_lw});
-            lay_source    .set_dims({n_col, n_lay, n_gpt_lw});
-            lev_source_inc.set_dims({n_col, n_lay, n_gpt_lw});
-            lev_source_dec.set_dims({n_col, n_lay, n_gpt_lw});
-            sfc_source    .set_dims({n_col, n_gpt_lw});
+            n_bnd_lw = rad_combined->get_n_bnd_lw();
+            n_gpt_lw = rad_combined->get_n_gpt_lw();
+            lw_band_lims_wvn = rad_combined->get_band_lims_wavenumber_lw();
         }
+        else
+        {
+            Status::print_message("Initializing the longwave solver.");
+            rad_lw = std::make_unique<Radiation_solver_longwave<TF>>(
+                    gas_concs_init, "coefficients_lw.nc", "cloud_coefficients_lw.nc", switch_mixed_precision);
 
-        Array<TF,2> lw_flux_up;
-        Array<TF,2> lw_flux_dn;
-        Array<TF,2> lw_flux_net;
+            rad_lw->set_n_col_block(block_size);
+            rad_lw->set_deduplicate_columns(switch_dedup_columns);
+            rad_lw->set_validation_policy(validation_policy);
 
-        if (switch_fluxes)
-        {
-            lw_flux_up .set_dims({n_col, n_lev});
-            lw_flux_dn .set_dims({n_col, n_lev});
-            lw_flux_net.set_dims({n_col, n_lev});
+            n_bnd_lw = rad_lw->get_n_bnd();
+            n_gpt_lw = rad_lw->get_n_gpt();
+            lw_band_lims_wvn = rad_lw->get_band_lims_wavenumber();
         }
 
-        Array<TF,3> lw_bnd_flux_up;
-        Array<TF,3> lw_bnd_flux_dn;
-        Array<TF,3> lw_bnd_flux_net;
+        add_output_dimension("gpt_lw", n_gpt_lw);
+        add_output_dimension("band_lw", n_bnd_lw);
+
+        auto nc_lw_band_lims_wvn = output_nc->add_variable<TF>("lw_band_lims_wvn", {"band_lw", "pair"});
+        nc_lw_band_lims_wvn.insert(lw_band_lims_wvn.v(), {0, 0});
 
-        if (switch_output_bnd_fluxes)
+        if (switch_output_optical)
         {
-            lw_bnd_flux_up .set_dims({n_col, n_lev, n_bnd_lw});
-            lw_bnd_flux_dn .set_dims({n_col, n_lev, n_bnd_lw});
-            lw_bnd_flux_net.set_dims({n_col, n_lev, n_bnd_lw});
+            auto nc_lw_band_lims_gpt = output_nc->add_variable<int>("lw_band_lims_gpt", {"band_lw", "pair"});
+            nc_lw_band_lims_gpt.insert(rad_lw->get_band_lims_gpoint().v(), {0, 0});
+
+            add_output("lw_tau"        , {"gpt_lw", "lay", "col"});
+            add_output("lay_source"    , {"gpt_lw", "lay", "col"});
+            add_output("lev_source_inc", {"gpt_lw", "lay", "col"});
+            add_output("lev_source_dec", {"gpt_lw", "lay", "col"});
+            add_output("sfc_source"    , {"gpt_lw", "col"});
         }
 
+        if (switch_fluxes)
+        {
+            add_output("lw_flux_up" , {"lev", "col"});
+            add_output("lw_flux_dn" , {"lev", "col"});
+            add_output("lw_flux_net", {"lev", "col"});
 
-        // Solve the radiation.
-        Status::print_message("Solving the longwave radiation.");
-
-        auto time_start = std::chrono::high_resolution_clock::now();
+            if (switch_output_bnd_fluxes)
+            {
+                add_output("lw_bnd_flux_up" , {"band_lw", "lev", "col"});
+                add_output("lw_bnd_flux_dn" , {"band_lw", "lev", "col"});
+                add_output("lw_bnd_flux_net", {"band_lw", "lev", "col"});
+            }
 
-        rad_lw.solve(
-                switch_fluxes,
-                switch_cloud_optics,
-                switch_output_optical,
-                switch_output_bnd_fluxes,
-                gas_concs,
-                p_lay, p_lev,
-                t_lay, t_lev,
-                col_dry,
-                t_sfc, emis_sfc,
-                lwp, iwp,
-                rel, rei,
-                lw_tau, lay_source, lev_source_inc, lev_source_dec, sfc_source,
-                lw_flux_up, lw_flux_dn, lw_flux_net,
-                lw_bnd_flux_up, lw_bnd_flux_dn, lw_bnd_flux_net);
+            if (switch_output_jacobian)
+                add_output("lw_flux_up_jac", {"lev", "col"});
+        }
+    }
 
-        auto time_end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration<double, std::milli>(time_end-time_start).count();
+    if (switch_shortwave)
+    {
+        Array<TF,2> sw_band_lims_wvn;
 
-        Status::print_message("Duration longwave solver: " + std::to_string(duration) + " (ms)");
+        if (switch_combined)
+        {
+            n_bnd_sw = rad_combined->get_n_bnd_sw();
+            n_gpt_sw = rad_combined->get_n_gpt_sw();
+            sw_band_lims_wvn = rad_combined->get_band_lims_wavenumber_sw();
+        }
+        else
+        {
+            Status::print_message("Initializing the shortwave solver.");
+            rad_sw = std::make_unique<Radiation_solver_shortwave<TF>>(
+                    gas_concs_init, "coefficients_sw.nc", "cloud_coefficients_sw.nc", switch_mixed_precision);
 
+            rad_sw->set_n_col_block(block_size);
+            rad_sw->set_deduplicate_columns(switch_dedup_columns);
+            rad_sw->set_validation_policy(validation_policy);
 
-        // Store the output.
-        Status::print_message("Storing the longwave output.");
+            n_bnd_sw = rad_sw->get_n_bnd();
+            n_gpt_sw = rad_sw->get_n_gpt();
+            sw_band_lims_wvn = rad_sw->get_band_lims_wavenumber();
+        }
 
-        output_nc.add_dimension("gpt_lw", n_gpt_lw);
-        output_nc.add_dimension("band_lw", n_bnd_lw);
+        add_output_dimension("gpt_sw", n_gpt_sw);
+        add_output_dimension("band_sw", n_bnd_sw);
 
-        auto nc_lw_band_lims_wvn = output_nc.add_variable<TF>("lw_band_lims_wvn", {"band_lw", "pair"});
-        nc_lw_band_lims_wvn.insert(rad_lw.get_band_lims_wavenumber().v(), {0, 0});
+        auto nc_sw_band_lims_wvn = output_nc->add_variable<TF>("sw_band_lims_wvn", {"band_sw", "pair"});
+        nc_sw_band_lims_wvn.insert(sw_band_lims_wvn.v(), {0, 0});
 
         if (switch_output_optical)
         {
-            auto nc_lw_band_lims_gpt = output_nc.add_variable<int>("lw_band_lims_gpt", {"band_lw", "pair"});
-            nc_lw_band_lims_gpt.insert(rad_lw.get_band_lims_gpoint().v(), {0, 0});
-
-            auto nc_lw_tau = output_nc.add_variable<TF>("lw_tau", {"gpt_lw", "lay", "col"});
-            nc_lw_tau.insert(lw_tau.v(), {0, 0, 0});
-
-            auto nc_lay_source     = output_nc.add_variable<TF>("lay_source"    , {"gpt_lw", "lay", "col"});
-            auto nc_lev_source_inc = output_nc.add_variable<TF>("lev_source_inc", {"gpt_lw", "lay", "col"});
-            auto nc_lev_source_dec = output_nc.add_variable<TF>("lev_source_dec", {"gpt_lw", "lay", "col"});
+            auto nc_sw_band_lims_gpt = output_nc->add_variable<int>("sw_band_lims_gpt", {"band_sw", "pair"});
+            nc_sw_band_lims_gpt.insert(rad_sw->get_band_lims_gpoint().v(), {0, 0});
 
-            auto nc_sfc_source = output_nc.add_variable<TF>("sfc_source", {"gpt_lw", "col"});
-
-            nc_lay_source.insert    (lay_source.v()    , {0, 0, 0});
-            nc_lev_source_inc.insert(lev_source_inc.v(), {0, 0, 0});
-            nc_lev_source_dec.insert(lev_source_dec.v(), {0, 0, 0});
-
-            nc_sfc_source.insert(sfc_source.v(), {0, 0});
+            add_output("sw_tau"    , {"gpt_sw", "lay", "col"});
+            add_output("ssa"       , {"gpt_sw", "lay", "col"});
+            add_output("g"         , {"gpt_sw", "lay", "col"});
+            add_output("toa_source", {"gpt_sw", "col"});
         }
 
         if (switch_fluxes)
         {
-            auto nc_lw_flux_up  = output_nc.add_variable<TF>("lw_flux_up" , {"lev", "col"});
-            auto nc_lw_flux_dn  = output_nc.add_variable<TF>("lw_flux_dn" , {"lev", "col"});
-            auto nc_lw_flux_net = output_nc.add_variable<TF>("lw_flux_net", {"lev", "col"});
-
-            nc_lw_flux_up .insert(lw_flux_up .v(), {0, 0});
-            nc_lw_flux_dn .insert(lw_flux_dn .v(), {0, 0});
-            nc_lw_flux_net.insert(lw_flux_net.v(), {0, 0});
+            add_output("sw_flux_up"    , {"lev", "col"});
+            add_output("sw_flux_dn"    , {"lev", "col"});
+            add_output("sw_flux_dn_dir", {"lev", "col"});
+            add_output("sw_flux_net"   , {"lev", "col"});
 
             if (switch_output_bnd_fluxes)
             {
-                auto nc_lw_bnd_flux_up  = output_nc.add_variable<TF>("lw_bnd_flux_up" , {"band_lw", "lev", "col"});
-                auto nc_lw_bnd_flux_dn  = output_nc.add_variable<TF>("lw_bnd_flux_dn" , {"band_lw", "lev", "col"});
-                auto nc_lw_bnd_flux_net = output_nc.add_variable<TF>("lw_bnd_flux_net", {"band_lw", "lev", "col"});
-
-                nc_lw_bnd_flux_up .insert(lw_bnd_flux_up .v(), {0, 0, 0});
-                nc_lw_bnd_flux_dn .insert(lw_bnd_flux_dn .v(), {0, 0, 0});
-                nc_lw_bnd_flux_net.insert(lw_bnd_flux_net.v(), {0, 0, 0});
+                add_output("sw_bnd_flux_up"    , {"band_sw", "lev", "col"});
+                add_output("sw_bnd_flux_dn"    , {"band_sw", "lev", "col"});
+                add_output("sw_bnd_flux_dn_dir", {"band_sw", "lev", "col"});
+                add_output("sw_bnd_flux_net"   , {"band_sw", "lev", "col"});
             }
         }
     }
 
+    // The writer owns the output file from here on. In asynchronous mode, the next chunk is
+    // solved while the previous one is written, the NetCDF reads then need the library mutex.
+    Netcdf_writer writer(std::move(output_nc), switch_async_output);
 
-    ////// RUN THE SHORTWAVE SOLVER //////
-    if (switch_shortwave)
+    double duration_lw = 0.;
+    double duration_sw = 0.;
+    double duration_combined = 0.;
+
+
+    ////// SOLVE THE RADIATION PER CHUNK OF COLUMNS //////
+    for (int col_s=1; col_s<=n_col; col_s+=n_col_chunk)
     {
-        // Initialize the solver.
-        Status::print_message("Initializing the shortwave solver.");
+        const int n_col_in = std::min(n_col_chunk, n_col - col_s + 1);
 
-        Radiation_solver_shortwave<TF> rad_sw(gas_concs, "coefficients_sw.nc", "cloud_coefficients_sw.nc");
+        if (switch_streaming)
+            Status::print_message(
+                    "Solving columns " + std::to_string(col_s) + " to " + std::to_string(col_s + n_col_in - 1) + ".");
 
-        // Read the boundary conditions.
-        const int n_bnd_sw = rad_sw.get_n_bnd();
-        const int n_gpt_sw = rad_sw.get_n_gpt();
+        ////// READ THE ATMOSPHERIC DATA //////
+        Status::print_message("Reading atmospheric input data from NetCDF.");
+
+        std::unique_lock<std::mutex> netcdf_lock(Netcdf_writer::get_library_mutex());
+
+        // Read the atmospheric fields.
+        Array<TF,2> p_lay(get_columns<TF>(input_nc, "p_lay", col_s, n_col_in, n_lay));
+        Array<TF,2> t_lay(get_columns<TF>(input_nc, "t_lay", col_s, n_col_in, n_lay));
+        Array<TF,2> p_lev(get_columns<TF>(input_nc, "p_lev", col_s, n_col_in, n_lev));
+        Array<TF,2> t_lev(get_columns<TF>(input_nc, "t_lev", col_s, n_col_in, n_lev));
 
-        Array<TF,1> mu0(input_nc.get_variable<TF>("mu0", {n_col}), {n_col});
-        Array<TF,2> sfc_alb_dir(input_nc.get_variable<TF>("sfc_alb_dir", {n_col, n_bnd_sw}), {n_bnd_sw, n_col});
-        Array<TF,2> sfc_alb_dif(input_nc.get_variable<TF>("sfc_alb_dif", {n_col, n_bnd_sw}), {n_bnd_sw, n_col});
+        // Fetch the col_dry in case present.
+        Array<TF,2> col_dry;
+        if (input_nc.variable_exists("col_dry"))
+            col_dry = get_columns<TF>(input_nc, "col_dry", col_s, n_col_in, n_lay);
 
-        Array<TF,1> tsi_scaling({n_col});
-        if (input_nc.variable_exists("tsi"))
+        // Create container for the gas concentrations and read gases.
+        Gas_concs<TF> gas_concs = read_gas_concs<TF>(col_s, n_col_in, n_lay, input_nc, validation_policy);
+
+        Array<TF,2> lwp;
+        Array<TF,2> iwp;
+        Array<TF,2> rel;
+        Array<TF,2> rei;
+
+        if (switch_cloud_optics)
         {
-            Array<TF,1> tsi(input_nc.get_variable<TF>("tsi", {n_col}), {n_col});
-            const TF tsi_ref = rad_sw.get_tsi();
-            for (int icol=1; icol<=n_col; ++icol)
-                tsi_scaling({icol}) = tsi({icol}) / tsi_ref;
+            lwp = get_columns<TF>(input_nc, "lwp", col_s, n_col_in, n_lay);
+            iwp = get_columns<TF>(input_nc, "iwp", col_s, n_col_in, n_lay);
+            rel = get_columns<TF>(input_nc, "rel", col_s, n_col_in, n_lay);
+            rei = get_columns<TF>(input_nc, "rei", col_s, n_col_in, n_lay);
         }
-        else
+
+        // Read the boundary conditions.
+        Array<TF,2> emis_sfc;
+        Array<TF,1> t_sfc;
+
+        if (switch_longwave)
         {
-            for (int icol=1; icol<=n_col; ++icol)
-                tsi_scaling({icol}) = TF(1.);
+            emis_sfc.set_dims({n_bnd_lw, n_col_in});
+            input_nc.get_variable(emis_sfc, "emis_sfc", {col_s-1, 0}, {n_col_in, n_bnd_lw});
+
+            t_sfc.set_dims({n_col_in});
+            input_nc.get_variable(t_sfc, "t_sfc", {col_s-1}, {n_col_in});
         }
 
-        // Create output arrays.
-        Array<TF,3> sw_tau;
-        Array<TF,3> ssa;
-        Array<TF,3> g;
-        Array<TF,2> toa_source;
+        Array<TF,1> mu0;
+        Array<TF,2> sfc_alb_dir;
+        Array<TF,2> sfc_alb_dif;
+        Array<TF,1> tsi_scaling;
 
-        if (switch_output_optical)
+        if (switch_shortwave)
         {
-            sw_tau    .set_dims({n_col, n_lay, n_gpt_sw});
-            ssa       .set_dims({n_col, n_lay, n_gpt_sw});
-            g         .set_dims({n_col, n_lay, n_gpt_sw});
-            toa_source.set_dims({n_col, n_gpt_sw});
+            mu0.set_dims({n_col_in});
+            input_nc.get_variable(mu0, "mu0", {col_s-1}, {n_col_in});
+
+            sfc_alb_dir.set_dims({n_bnd_sw, n_col_in});
+            sfc_alb_dif.set_dims({n_bnd_sw, n_col_in});
+            input_nc.get_variable(sfc_alb_dir, "sfc_alb_dir", {col_s-1, 0}, {n_col_in, n_bnd_sw});
+            input_nc.get_variable(sfc_alb_dif, "sfc_alb_dif", {col_s-1, 0}, {n_col_in, n_bnd_sw});
+
+            tsi_scaling.set_dims({n_col_in});
+            if (input_nc.variable_exists("tsi"))
+            {
+                Array<TF,1> tsi({n_col_in});
+                input_nc.get_variable(tsi, "tsi", {col_s-1}, {n_col_in});
+                const TF tsi_ref = switch_combined ? rad_combined->get_tsi() : rad_sw->get_tsi();
+                for (int icol=1; icol<=n_col_in; ++icol)
+                    tsi_scaling({icol}) = tsi({icol}) / tsi_ref;
+            }
+            else
+            {
+                for (int icol=1; icol<=n_col_in; ++icol)
+                    tsi_scaling({icol}) = TF(1.);
+            }
         }
 
-        Array<TF,2> sw_flux_up;
-        Array<TF,2> sw_flux_dn;
-        Array<TF,2> sw_flux_dn_dir;
-        Array<TF,2> sw_flux_net;
+        netcdf_lock.unlock();
 
-        if (switch_fluxes)
+
+        ////// RUN THE COMBINED SOLVER //////
+        if (switch_combined)
         {
-            sw_flux_up    .set_dims({n_col, n_lev});
-            sw_flux_dn    .set_dims({n_col, n_lev});
-            sw_flux_dn_dir.set_dims({n_col, n_lev});
-            sw_flux_net   .set_dims({n_col, n_lev});
+            Array<TF,2> lw_flux_up ({n_col_in, n_lev});
+            Array<TF,2> lw_flux_dn ({n_col_in, n_lev});
+            Array<TF,2> lw_flux_net({n_col_in, n_lev});
+
+            Array<TF,2> sw_flux_up    ({n_col_in, n_lev});
+            Array<TF,2> sw_flux_dn    ({n_col_in, n_lev});
+            Array<TF,2> sw_flux_dn_dir({n_col_in, n_lev});
+            Array<TF,2> sw_flux_net   ({n_col_in, n_lev});
+
+            Status::print_message("Solving the longwave and shortwave radiation.");
+
+            auto time_start = std::chrono::high_resolution_clock::now();
+
+            rad_combined->solve(
+                    switch_cloud_optics,
+                    gas_concs,
+                    p_lay, p_lev,
+                    t_lay, t_lev,
+                    col_dry,
+                    t_sfc, emis_sfc,
+                    sfc_alb_dir, sfc_alb_dif,
+                    tsi_scaling, mu0,
+                    lwp, iwp,
+                    rel, rei,
+                    lw_flux_up, lw_flux_dn, lw_flux_net,
+                    sw_flux_up, sw_flux_dn,
+                    sw_flux_dn_dir, sw_flux_net,
+                    0, col_s-1);
+
+            auto time_end = std::chrono::high_resolution_clock::now();
+            duration_combined += std::chrono::duration<double, std::milli>(time_end-time_start).count();
+
+            Status::print_message("Storing the longwave and shortwave output.");
+
+            insert_columns(writer, nc_vars.at("lw_flux_up") , std::move(lw_flux_up) , col_s);
+            insert_columns(writer, nc_vars.at("lw_flux_dn") , std::move(lw_flux_dn) , col_s);
+            insert_columns(writer, nc_vars.at("lw_flux_net"), std::move(lw_flux_net), col_s);
+
+            insert_columns(writer, nc_vars.at("sw_flux_up")    , std::move(sw_flux_up)    , col_s);
+            insert_columns(writer, nc_vars.at("sw_flux_dn")    , std::move(sw_flux_dn)    , col_s);
+            insert_columns(writer, nc_vars.at("sw_flux_dn_dir"), std::move(sw_flux_dn_dir), col_s);
+            insert_columns(writer, nc_vars.at("sw_flux_net")   , std::move(sw_flux_net)   , col_s);
         }
 
-        Array<TF,3> sw_bnd_flux_up;
-        Array<TF,3> sw_bnd_flux_dn;
-        Array<TF,3> sw_bnd_flux_dn_dir;
-        Array<TF,3> sw_bnd_flux_net;
 
-        if (switch_output_bnd_fluxes)
+        ////// RUN THE LONGWAVE SOLVER //////
+        if (switch_longwave && !switch_combined)
         {
-            sw_bnd_flux_up    .set_dims({n_col, n_lev, n_bnd_sw});
-            sw_bnd_flux_dn    .set_dims({n_col, n_lev, n_bnd_sw});
-            sw_bnd_flux_dn_dir.set_dims({n_col, n_lev, n_bnd_sw});
-            sw_bnd_flux_net   .set_dims({n_col, n_lev, n_bnd_sw});
-        }
+            // Create output arrays.
+            Array<TF,3> lw_tau;
+            Array<TF,3> lay_source;
+            Array<TF,3> lev_source_inc;
+            Array<TF,3> lev_source_dec;
+            Array<TF,2> sfc_source;
+
+            if (switch_output_optical)
+            {
+                lw_tau        .set_dims({n_col_in, n_lay, n_gpt_lw});
+                lay_source    .set_dims({n_col_in, n_lay, n_gpt_lw});
+                lev_source_inc.set_dims({n_col_in, n_lay, n_gpt_lw});
+                lev_source_dec.set_dims({n_col_in, n_lay, n_gpt_lw});
+                sfc_source    .set_dims({n_col_in, n_gpt_lw});
+            }
+
+            Array<TF,2> lw_flux_up;
+            Array<TF,2> lw_flux_dn;
+            Array<TF,2> lw_flux_net;
 
+            if (switch_fluxes)
+            {
+                lw_flux_up .set_dims({n_col_in, n_lev});
+                lw_flux_dn .set_dims({n_col_in, n_lev});
+                lw_flux_net.set_dims({n_col_in, n_lev});
+            }
 
-        // Solve the radiation.
-        Status::print_message("Solving the shortwave radiation.");
+            Array<TF,3> lw_bnd_flux_up;
+            Array<TF,3> lw_bnd_flux_dn;
+            Array<TF,3> lw_bnd_flux_net;
 
-        auto time_start = std::chrono::high_resolution_clock::now();
+            if (switch_output_bnd_fluxes)
+            {
+                lw_bnd_flux_up .set_dims({n_col_in, n_lev, n_bnd_lw});
+                lw_bnd_flux_dn .set_dims({n_col_in, n_lev, n_bnd_lw});
+                lw_bnd_flux_net.set_dims({n_col_in, n_lev, n_bnd_lw});
+            }
 
-        rad_sw.solve(
-                switch_fluxes,
-                switch_cloud_optics,
-                switch_output_optical,
-                switch_output_bnd_fluxes,
-                gas_concs,
-                p_lay, p_lev,
-                t_lay, t_lev,
-                col_dry,
-                sfc_alb_dir, sfc_alb_dif,
-                tsi_scaling, mu0,
-                lwp, iwp,
-                rel, rei,
-                sw_tau, ssa, g,
-                toa_source,
-                sw_flux_up, sw_flux_dn,
-                sw_flux_dn_dir, sw_flux_net,
-                sw_bnd_flux_up, sw_bnd_flux_dn,
-                sw_bnd_flux_dn_dir, sw_bnd_flux_net);
+            Array<TF,2> lw_flux_up_jac;
 
-        auto time_end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration<double, std::milli>(time_end-time_start).count();
+            if (switch_output_jacobian)
+                lw_flux_up_jac.set_dims({n_col_in, n_lev});
 
-        Status::print_message("Duration shortwave solver: " + std::to_string(duration) + " (ms)");
 
+            // Solve the radiation.
+            Status::print_message("Solving the longwave radiation.");
 
-        // Store the output.
-        Status::print_message("Storing the shortwave output.");
+            auto time_start = std::chrono::high_resolution_clock::now();
 
-        output_nc.add_dimension("gpt_sw", n_gpt_sw);
-        output_nc.add_dimension("band_sw", n_bnd_sw);
+            rad_lw->solve(
+                    switch_fluxes,
+                    switch_cloud_optics,
+                    switch_output_optical,
+                    switch_output_bnd_fluxes,
+                    switch_output_jacobian,
+                    gas_concs,
+                    p_lay, p_lev,
+                    t_lay, t_lev,
+                    col_dry,
+                    t_sfc, emis_sfc,
+                    lwp, iwp,
+                    rel, rei,
+                    lw_tau, lay_source, lev_source_inc, lev_source_dec, sfc_source,
+                    lw_flux_up, lw_flux_dn, lw_flux_net,
+                    lw_bnd_flux_up, lw_bnd_flux_dn, lw_bnd_flux_net,
+                    lw_flux_up_jac);
 
-        auto nc_sw_band_lims_wvn = output_nc.add_variable<TF>("sw_band_lims_wvn", {"band_sw", "pair"});
-        nc_sw_band_lims_wvn.insert(rad_sw.get_band_lims_wavenumber().v(), {0, 0});
+            auto time_end = std::chrono::high_resolution_clock::now();
+            duration_lw += std::chrono::duration<double, std::milli>(time_end-time_start).count();
 
-        if (switch_output_optical)
-        {
-            auto nc_sw_band_lims_gpt = output_nc.add_variable<int>("sw_band_lims_gpt", {"band_sw", "pair"});
-            nc_sw_band_lims_gpt.insert(rad_sw.get_band_lims_gpoint().v(), {0, 0});
 
-            auto nc_sw_tau = output_nc.add_variable<TF>("sw_tau", {"gpt_sw", "lay", "col"});
-            auto nc_ssa    = output_nc.add_variable<TF>("ssa"   , {"gpt_sw", "lay", "col"});
-            auto nc_g      = output_nc.add_variable<TF>("g"     , {"gpt_sw", "lay", "col"});
+            // Store the output.
+            Status::print_message("Storing the longwave output.");
 
-            nc_sw_tau.insert(sw_tau.v(), {0, 0, 0});
-            nc_ssa   .insert(ssa   .v(), {0, 0, 0});
-            nc_g     .insert(g     .v(), {0, 0, 0});
+            if (switch_output_optical)
+            {
+                insert_columns(writer, nc_vars.at("lw_tau")        , std::move(lw_tau)        , col_s);
+                insert_columns(writer, nc_vars.at("lay_source")    , std::move(lay_source)    , col_s);
+                insert_columns(writer, nc_vars.at("lev_source_inc"), std::move(lev_source_inc), col_s);
+                insert_columns(writer, nc_vars.at("lev_source_dec"), std::move(lev_source_dec), col_s);
+                insert_columns(writer, nc_vars.at("sfc_source")    , std::move(sfc_source)    , col_s);
+            }
 
-            auto nc_toa_source = output_nc.add_variable<TF>("toa_source", {"gpt_sw", "col"});
-            nc_toa_source.insert(toa_source.v(), {0, 0});
+            if (switch_fluxes)
+            {
+                insert_columns(writer, nc_vars.at("lw_flux_up") , std::move(lw_flux_up) , col_s);
+                insert_columns(writer, nc_vars.at("lw_flux_dn") , std::move(lw_flux_dn) , col_s);
+                insert_columns(writer, nc_vars.at("lw_flux_net"), std::move(lw_flux_net), col_s);
+
+                if (switch_output_bnd_fluxes)
+                {
+                    insert_columns(writer, nc_vars.at("lw_bnd_flux_up") , std::move(lw_bnd_flux_up) , col_s);
+                    insert_columns(writer, nc_vars.at("lw_bnd_flux_dn") , std::move(lw_bnd_flux_dn) , col_s);
+                    insert_columns(writer, nc_vars.at("lw_bnd_flux_net"), std::move(lw_bnd_flux_net), col_s);
+                }
+
+                if (switch_output_jacobian)
+                    insert_columns(writer, nc_vars.at("lw_flux_up_jac"), std::move(lw_flux_up_jac), col_s);
+            }
         }
 
-        if (switch_fluxes)
+
+        ////// RUN THE SHORTWAVE SOLVER //////
+        if (switch_shortwave && !switch_combined)
         {
-            auto nc_sw_flux_up     = output_nc.add_variable<TF>("sw_flux_up"    , {"lev", "col"});
-            auto nc_sw_flux_dn     = output_nc.add_variable<TF>("sw_flux_dn"    , {"lev", "col"});
-            auto nc_sw_flux_dn_dir = output_nc.add_variable<TF>("sw_flux_dn_dir", {"lev", "col"});
-            auto nc_sw_flux_net    = output_nc.add_variable<TF>("sw_flux_net"   , {"lev", "col"});
+            // Create output arrays.
+            Array<TF,3> sw_tau;
+            Array<TF,3> ssa;
+            Array<TF,3> g;
+            Array<TF,2> toa_source;
+
+            if (switch_output_optical)
+            {
+                sw_tau    .set_dims({n_col_in, n_lay, n_gpt_sw});
+                ssa       .set_dims({n_col_in, n_lay, n_gpt_sw});
+                g         .set_dims({n_col_in, n_lay, n_gpt_sw});
+                toa_source.set_dims({n_col_in, n_gpt_sw});
+            }
 
-            nc_sw_flux_up    .insert(sw_flux_up    .v(), {0, 0});
-            nc_sw_flux_dn    .insert(sw_flux_dn    .v(), {0, 0});
-            nc_sw_flux_dn_dir.insert(sw_flux_dn_dir.v(), {0, 0});
-            nc_sw_flux_net   .insert(sw_flux_net   .v(), {0, 0});
+            Array<TF,2> sw_flux_up;
+            Array<TF,2> sw_flux_dn;
+            Array<TF,2> sw_flux_dn_dir;
+            Array<TF,2> sw_flux_net;
+
+            if (switch_fluxes)
+            {
+                sw_flux_up    .set_dims({n_col_in, n_lev});
+                sw_flux_dn    .set_dims({n_col_in, n_lev});
+                sw_flux_dn_dir.set_dims({n_col_in, n_lev});
+                sw_flux_net   .set_dims({n_col_in, n_lev});
+            }
+
+            Array<TF,3> sw_bnd_flux_up;
+            Array<TF,3> sw_bnd_flux_dn;
+            Array<TF,3> sw_bnd_flux_dn_dir;
+            Array<TF,3> sw_bnd_flux_net;
 
             if (switch_output_bnd_fluxes)
             {
-                auto nc_sw_bnd_flux_up     = output_nc.add_variable<TF>("sw_bnd_flux_up"    , {"band_sw", "lev", "col"});
-                auto nc_sw_bnd_flux_dn     = output_nc.add_variable<TF>("sw_bnd_flux_dn"    , {"band_sw", "lev", "col"});
-                auto nc_sw_bnd_flux_dn_dir = output_nc.add_variable<TF>("sw_bnd_flux_dn_dir", {"band_sw", "lev", "col"});
-                auto nc_sw_bnd_flux_net    = output_nc.add_variable<TF>("sw_bnd_flux_net"   , {"band_sw", "lev", "col"});
-
-                nc_sw_bnd_flux_up    .insert(sw_bnd_flux_up    .v(), {0, 0, 0});
-                nc_sw_bnd_flux_dn    .insert(sw_bnd_flux_dn    .v(), {0, 0, 0});
-                nc_sw_bnd_flux_dn_dir.insert(sw_bnd_flux_dn_dir.v(), {0, 0, 0});
-                nc_sw_bnd_flux_net   .insert(sw_bnd_flux_net   .v(), {0, 0, 0});
+                sw_bnd_flux_up    .set_dims({n_col_in, n_lev, n_bnd_sw});
+                sw_bnd_flux_dn    .set_dims({n_col_in, n_lev, n_bnd_sw});
+                sw_bnd_flux_dn_dir.set_dims({n_col_in, n_lev, n_bnd_sw});
+                sw_bnd_flux_net   .set_dims({n_col_in, n_lev, n_bnd_sw});
+            }
+
+
+            // Solve the radiation.
+            Status::print_message("Solving the shortwave radiation.");
+
+            auto time_start = std::chrono::high_resolution_clock::now();
+
+            rad_sw->solve(
+                    switch_fluxes,
+                    switch_cloud_optics,
+                    switch_output_optical,
+                    switch_output_bnd_fluxes,
+                    gas_concs,
+                    p_lay, p_lev,
+                    t_lay, t_lev,
+                    col_dry,
+                    sfc_alb_dir, sfc_alb_dif,
+                    tsi_scaling, mu0,
+                    lwp, iwp,
+                    rel, rei,
+                    sw_tau, ssa, g,
+                    toa_source,
+                    sw_flux_up, sw_flux_dn,
+                    sw_flux_dn_dir, sw_flux_net,
+                    sw_bnd_flux_up, sw_bnd_flux_dn,
+                    sw_bnd_flux_dn_dir, sw_bnd_flux_net);
+
+            auto time_end = std::chrono::high_resolution_clock::now();
+            duration_sw += std::chrono::duration<double, std::milli>(time_end-time_start).count();
+
+
+            // Store the output.
+            Status::print_message("Storing the shortwave output.");
+
+            if (switch_output_optical)
+            {
+                insert_columns(writer, nc_vars.at("sw_tau")    , std::move(sw_tau)    , col_s);
+                insert_columns(writer, nc_vars.at("ssa")       , std::move(ssa)       , col_s);
+                insert_columns(writer, nc_vars.at("g")         , std::move(g)         , col_s);
+                insert_columns(writer, nc_vars.at("toa_source"), std::move(toa_source), col_s);
+            }
+
+            if (switch_fluxes)
+            {
+                insert_columns(writer, nc_vars.at("sw_flux_up")    , std::move(sw_flux_up)    , col_s);
+                insert_columns(writer, nc_vars.at("sw_flux_dn")    , std::move(sw_flux_dn)    , col_s);
+                insert_columns(writer, nc_vars.at("sw_flux_dn_dir"), std::move(sw_flux_dn_dir), col_s);
+                insert_columns(writer, nc_vars.at("sw_flux_net")   , std::move(sw_flux_net)   , col_s);
+
+                if (switch_output_bnd_fluxes)
+                {
+                    insert_columns(writer, nc_vars.at("sw_bnd_flux_up")    , std::move(sw_bnd_flux_up)    , col_s);
+                    insert_columns(writer, nc_vars.at("sw_bnd_flux_dn")    , std::move(sw_bnd_flux_dn)    , col_s);
+                    insert_columns(writer, nc_vars.at("sw_bnd_flux_dn_dir"), std::move(sw_bnd_flux_dn_dir), col_s);
+                    insert_columns(writer, nc_vars.at("sw_bnd_flux_net")   , std::move(sw_bnd_flux_net)   , col_s);
+                }
             }
         }
+
+        insert_columns(writer, nc_vars.at("p_lay"), std::move(p_lay), col_s);
+        insert_columns(writer, nc_vars.at("p_lev"), std::move(p_lev), col_s);
+    }
+
+    // Wait until all output is written.
+    writer.flush();
+
+    if (switch_combined)
+        Status::print_message("Duration combined solver: " + std::to_string(duration_combined) + " (ms)");
+    else
+    {
+        if (switch_longwave)
+            Status::print_message("Duration longwave solver: " + std::to_string(duration_lw) + " (ms)");
+        if (switch_shortwave)
+            Status::print_message("Duration shortwave solver: " + std::to_string(duration_sw) + " (ms)");
+    }
+
+    // Write the timings of the stages, this file can be diffed between versions.
+    if (switch_instrumentation)
+    {
+        Status::print_message("Storing the instrumentation output.");
+        std::ofstream json_file("rte_rrtmgp_instrumentation.json");
+        json_file << Instrumentation::get_json();
     }
 
     Status::print_message("###### Finished RTE+RRTMGP solver ######");